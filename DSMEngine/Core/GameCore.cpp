@@ -1,12 +1,16 @@
 #include "GameCore.h"
 
 #include "Window.h"
+#include "JobSystem.h"
 #include "../Utilities/Macros.h"
 #include "../Graphics/RenderContext.h"
 #include <iostream>
 
 namespace DSM::GameCore{
     IGameApp* g_CurrGameApp = nullptr;
+    static RenderThread s_RenderThread{};
+    // 游戏线程已更新的帧数
+    static std::uint64_t s_FrameIndex = 0;
     
     bool IGameApp::IsDown()
     {
@@ -14,27 +18,60 @@ namespace DSM::GameCore{
     }
 
 
+    static void StartRenderThread(IGameApp& app)
+    {
+        if (!app.UseRenderThread()) return;
+
+        s_RenderThread.Start(app.CreateRenderSnapshot(), app.CreateRenderSnapshot(),
+            [&app](const RenderSnapshot& snapshot) {
+                g_RenderContext.BeginFrame();
+                app.RenderFrame(g_RenderContext, snapshot);
+                g_RenderContext.EndFrame();
+            });
+    }
+
     // 初始化引擎
     void InitializeApplication(IGameApp& app, const Window& window)
     {
+        g_JobSystem.Create();
         g_RenderContext.Create(app.RequiresRaytracingSupport(), window);
         
         app.Startup();
+        StartRenderThread(app);
     }
 
     // 更新引擎
     bool UpdateApplication(IGameApp& app)
     {
-        app.Update(0);
-        app.RenderScene(g_RenderContext);
+        g_JobSystem.ProcessMainThreadJobs();
+
+        if (s_RenderThread.IsRunning()) {
+            // 游戏线程只写入快照，渲染在渲染线程中进行
+            app.Update(0);
+            auto& snapshot = s_RenderThread.BeginWrite();
+            snapshot.m_FrameIndex = s_FrameIndex;
+            app.WriteRenderSnapshot(snapshot);
+            s_RenderThread.EndWrite();
+        }
+        else {
+            // 限制 CPU 领先 GPU 的帧数，之后本帧可以安全地写入按帧资源
+            g_RenderContext.BeginFrame();
+            app.Update(0);
+            app.RenderScene(g_RenderContext);
+            g_RenderContext.EndFrame();
+        }
+        ++s_FrameIndex;
         
         return !app.IsDown();
     }
 
     void TerminateApplication(IGameApp& app)
     {
+        s_RenderThread.Stop();
         app.Cleanup();
 
+        // 任务中可能仍在使用渲染资源
+        g_JobSystem.Shutdown();
         g_RenderContext.Shutdown();
     }
 
@@ -43,6 +80,8 @@ namespace DSM::GameCore{
     {
 		width = std::max(width, 1u);
 		height = std::max(height, 1u);
+        // 渲染线程可能正在使用交换链及渲染目标
+        s_RenderThread.Flush();
         g_RenderContext.OnResize(width, height);
         if (g_CurrGameApp != nullptr) {
             g_CurrGameApp->OnResize(width, height);
@@ -82,5 +121,36 @@ namespace DSM::GameCore{
         
         return 0;
     }
+
+    int RunHeadlessApplication(
+        IGameApp& app,
+        std::uint32_t width,
+        std::uint32_t height,
+        std::uint32_t frameCount,
+        DeviceBackend backend)
+    {
+        if (!DirectX::XMVerifyCPUSupport()) {
+            return 1;
+        }
+
+        g_CurrGameApp = &app;
+
+        g_JobSystem.Create();
+        g_RenderContext.CreateHeadless(backend);
+        // 应用仍按有窗口的方式渲染并呈现到离屏的后台缓冲
+        g_RenderContext.CreateOffscreenSwapChain(std::max(width, 1u), std::max(height, 1u));
+        app.Startup();
+        OnResize(width, height);
+        StartRenderThread(app);
+
+        for (std::uint32_t i = 0; i < frameCount; ++i) {
+            if (!UpdateApplication(app)) break;
+        }
+
+        TerminateApplication(app);
+        g_CurrGameApp = nullptr;
+
+        return 0;
+    }
     
 }
@@ -3,9 +3,11 @@
 #define __GAMECORE_H__
 
 #include "../pch.h"
+#include "RenderThread.h"
 
 namespace DSM {
     class RenderContext;
+    enum class DeviceBackend;
 }
 
 namespace DSM::GameCore {
@@ -19,6 +21,15 @@ namespace DSM::GameCore {
         virtual void OnResize(std::uint32_t width, std::uint32_t height){};
         // 自定义渲染场景
         virtual void RenderScene(RenderContext& renderContext) = 0;
+
+        // 返回 true 时在独立的渲染线程中渲染，游戏线程每帧只调用 Update 及 WriteRenderSnapshot
+        virtual bool UseRenderThread() const { return false; }
+        // 渲染线程模式下创建两个交替使用的快照
+        virtual std::unique_ptr<RenderSnapshot> CreateRenderSnapshot() { return nullptr; }
+        // 游戏线程在 Update 之后写入本帧的快照
+        virtual void WriteRenderSnapshot(RenderSnapshot& snapshot) {}
+        // 渲染线程根据快照剔除、排序并录制命令，期间快照不会被修改
+        virtual void RenderFrame(RenderContext& renderContext, const RenderSnapshot& snapshot) {}
         // 程序关闭时调用，清理资源
         virtual void Cleanup() = 0;
 
@@ -36,6 +47,14 @@ namespace DSM::GameCore {
         const wchar_t* className,
         HINSTANCE hInstance,
         int nShowCmd);
+
+    // 不创建窗口，运行指定帧数后退出，用于无 GPU 环境下的测试与性能分析
+    int RunHeadlessApplication(
+        IGameApp& app,
+        std::uint32_t width,
+        std::uint32_t height,
+        std::uint32_t frameCount,
+        DeviceBackend backend);
 }
 
 
@@ -0,0 +1,390 @@
+#include "JobSystem.h"
+
+namespace DSM {
+    // 当前线程对应的双端队列，非工作线程为无效值
+    static thread_local std::uint32_t s_WorkerIndex = ~0u;
+    // 选择窃取目标的随机数状态
+    static thread_local std::uint32_t s_RandomState = 0;
+
+    static std::uint32_t NextRandom() noexcept
+    {
+        if (s_RandomState == 0) {
+            s_RandomState = static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1;
+        }
+        s_RandomState ^= s_RandomState << 13;
+        s_RandomState ^= s_RandomState >> 17;
+        s_RandomState ^= s_RandomState << 5;
+        return s_RandomState;
+    }
+
+
+    //
+    // JobCounter Implementation
+    //
+
+    JobCounter::~JobCounter()
+    {
+        // 等待递减计数的线程释放锁
+        std::lock_guard lock{m_Mutex};
+        ASSERT(m_Waiters.empty());
+    }
+
+    std::vector<Job*> JobCounter::Decrement()
+    {
+        // 在锁内递减，保证等待者看到归零后计数器不再被访问
+        std::lock_guard lock{m_Mutex};
+
+        std::vector<Job*> readyJobs{};
+        if (m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            readyJobs.swap(m_Waiters);
+        }
+        return readyJobs;
+    }
+
+    bool JobCounter::AddWaiter(Job* job)
+    {
+        std::lock_guard lock{m_Mutex};
+
+        if (m_Count.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        m_Waiters.emplace_back(job);
+        return true;
+    }
+
+
+    //
+    // WorkStealingDeque Implementation
+    //
+
+    WorkStealingDeque::WorkStealingDeque(std::int64_t capacity)
+    {
+        ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+        auto& buffer = m_Buffers.emplace_back(std::make_unique<RingBuffer>(capacity));
+        m_Buffer.store(buffer.get(), std::memory_order_relaxed);
+    }
+
+    void WorkStealingDeque::Push(Job* job)
+    {
+        auto bottom = m_Bottom.load(std::memory_order_relaxed);
+        auto top = m_Top.load(std::memory_order_acquire);
+        auto buffer = m_Buffer.load(std::memory_order_relaxed);
+
+        if (bottom - top > buffer->m_Capacity - 1) {
+            buffer = Grow(buffer, bottom, top);
+        }
+        buffer->Put(bottom, job);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    Job* WorkStealingDeque::Pop()
+    {
+        auto bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        auto buffer = m_Buffer.load(std::memory_order_relaxed);
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = m_Top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // 队列为空
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto job = buffer->Get(bottom);
+        if (top == bottom) {
+            // 最后一个元素，与窃取线程竞争
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* WorkStealingDeque::Steal()
+    {
+        auto top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = m_Bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        auto job = m_Buffer.load(std::memory_order_acquire)->Get(top);
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    WorkStealingDeque::RingBuffer* WorkStealingDeque::Grow(RingBuffer* buffer, std::int64_t bottom, std::int64_t top)
+    {
+        auto& newBuffer = m_Buffers.emplace_back(std::make_unique<RingBuffer>(buffer->m_Capacity * 2));
+        for (auto i = top; i < bottom; ++i) {
+            newBuffer->Put(i, buffer->Get(i));
+        }
+        m_Buffer.store(newBuffer.get(), std::memory_order_release);
+        return newBuffer.get();
+    }
+
+
+    //
+    // JobSystem Implementation
+    //
+
+    void JobSystem::Create(std::uint32_t numWorkers)
+    {
+        if (m_Initialized) return;
+
+        if (numWorkers == 0) {
+            numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+
+        m_MainThreadID = std::this_thread::get_id();
+        m_Stop.store(false, std::memory_order_relaxed);
+
+        for (std::uint32_t i = 0; i <= numWorkers; ++i) {
+            m_Deques.emplace_back(std::make_unique<WorkStealingDeque>());
+        }
+        s_WorkerIndex = 0;
+
+        for (std::uint32_t i = 1; i <= numWorkers; ++i) {
+            m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+
+        m_Initialized = true;
+    }
+
+    void JobSystem::Shutdown()
+    {
+        if (!m_Initialized) return;
+
+        ASSERT(IsMainThread());
+
+        m_Stop.store(true, std::memory_order_release);
+        {
+            std::lock_guard lock{m_WakeMutex};
+            m_WakeCondition.notify_all();
+        }
+        for (auto& worker : m_Workers) {
+            worker.join();
+        }
+        m_Workers.clear();
+
+        // 在主线程执行剩余的任务，保证计数器归零
+        while (TryExecuteJob()) {}
+
+        m_Deques.clear();
+        s_WorkerIndex = INVALID_WORKER_INDEX;
+        m_Initialized = false;
+    }
+
+    void JobSystem::Run(JobFunction function, JobCounter* signal, JobCounter* dependency)
+    {
+        Submit(std::move(function), signal, dependency, false);
+    }
+
+    void JobSystem::RunOnMainThread(JobFunction function, JobCounter* signal, JobCounter* dependency)
+    {
+        Submit(std::move(function), signal, dependency, true);
+    }
+
+    void JobSystem::Wait(JobCounter& counter)
+    {
+        while (!counter.IsDone()) {
+            if (!TryExecuteJob()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::ParallelFor(std::uint32_t count, std::uint32_t grainSize, const ParallelForFunction& function)
+    {
+        if (count == 0) return;
+
+        if (grainSize == 0) {
+            // 每个线程约分到四个任务，便于负载均衡
+            grainSize = std::max(count / ((GetNumWorkers() + 1) * 4), 1u);
+        }
+
+        // 第一个范围由当前线程执行
+        JobCounter counter{};
+        for (std::uint32_t begin = grainSize; begin < count; begin += grainSize) {
+            auto end = std::min(begin + grainSize, count);
+            Run([&function, begin, end]() { function(begin, end); }, &counter);
+        }
+        function(0, std::min(grainSize, count));
+
+        Wait(counter);
+    }
+
+    void JobSystem::ProcessMainThreadJobs()
+    {
+        ASSERT(IsMainThread());
+
+        // 只执行调用时已提交的任务，避免任务不断提交自身导致无法返回
+        std::deque<Job*> jobs{};
+        {
+            std::lock_guard lock{m_MainThreadMutex};
+            jobs.swap(m_MainThreadJobs);
+        }
+        for (auto job : jobs) {
+            Execute(job);
+        }
+    }
+
+    void JobSystem::Submit(JobFunction function, JobCounter* signal, JobCounter* dependency, bool mainThread)
+    {
+        // 未初始化时直接执行
+        if (!m_Initialized) {
+            ASSERT(dependency == nullptr || dependency->IsDone());
+            function();
+            return;
+        }
+
+        if (signal != nullptr) {
+            signal->Add();
+        }
+
+        auto job = new Job{std::move(function), signal, mainThread};
+        if (dependency != nullptr && dependency->AddWaiter(job)) {
+            return;
+        }
+        Schedule(job);
+    }
+
+    void JobSystem::Schedule(Job* job)
+    {
+        if (job->m_MainThread) {
+            std::lock_guard lock{m_MainThreadMutex};
+            m_MainThreadJobs.emplace_back(job);
+            return;
+        }
+
+        // 先增加计数，避免任务被取走后计数下溢
+        m_NumQueuedJobs.fetch_add(1, std::memory_order_release);
+        if (s_WorkerIndex < m_Deques.size()) {
+            m_Deques[s_WorkerIndex]->Push(job);
+        }
+        else {
+            std::lock_guard lock{m_SharedMutex};
+            m_SharedJobs.emplace_back(job);
+        }
+
+        if (m_NumSleeping.load(std::memory_order_acquire) > 0) {
+            m_WakeCondition.notify_one();
+        }
+    }
+
+    void JobSystem::Execute(Job* job)
+    {
+        job->m_Function();
+
+        auto signal = job->m_Signal;
+        delete job;
+
+        if (signal != nullptr) {
+            for (auto readyJob : signal->Decrement()) {
+                Schedule(readyJob);
+            }
+        }
+    }
+
+    bool JobSystem::TryExecuteJob()
+    {
+        if (IsMainThread()) {
+            Job* job = nullptr;
+            {
+                std::lock_guard lock{m_MainThreadMutex};
+                if (!m_MainThreadJobs.empty()) {
+                    job = m_MainThreadJobs.front();
+                    m_MainThreadJobs.pop_front();
+                }
+            }
+            if (job != nullptr) {
+                Execute(job);
+                return true;
+            }
+        }
+
+        if (auto job = FindJob(); job != nullptr) {
+            Execute(job);
+            return true;
+        }
+        return false;
+    }
+
+    Job* JobSystem::FindJob()
+    {
+        if (m_NumQueuedJobs.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+
+        Job* job = nullptr;
+        // 优先执行自己队列中最近提交的任务
+        if (s_WorkerIndex < m_Deques.size()) {
+            job = m_Deques[s_WorkerIndex]->Pop();
+        }
+
+        if (job == nullptr) {
+            std::lock_guard lock{m_SharedMutex};
+            if (!m_SharedJobs.empty()) {
+                job = m_SharedJobs.front();
+                m_SharedJobs.pop_front();
+            }
+        }
+
+        // 从随机的线程开始窃取
+        if (job == nullptr) {
+            auto numDeques = static_cast<std::uint32_t>(m_Deques.size());
+            auto startIndex = NextRandom() % numDeques;
+            for (std::uint32_t i = 0; i < numDeques && job == nullptr; ++i) {
+                auto victim = (startIndex + i) % numDeques;
+                if (victim != s_WorkerIndex) {
+                    job = m_Deques[victim]->Steal();
+                }
+            }
+        }
+
+        if (job != nullptr) {
+            m_NumQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    void JobSystem::WorkerLoop(std::uint32_t workerIndex)
+    {
+        s_WorkerIndex = workerIndex;
+
+        std::uint32_t numSpins = 0;
+        while (!m_Stop.load(std::memory_order_acquire)) {
+            if (auto job = FindJob(); job != nullptr) {
+                Execute(job);
+                numSpins = 0;
+                continue;
+            }
+
+            if (++numSpins < sm_NumIdleSpins) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // 唤醒通知不加锁，可能丢失，因此限制休眠时长
+            numSpins = 0;
+            m_NumSleeping.fetch_add(1, std::memory_order_acq_rel);
+            {
+                std::unique_lock lock{m_WakeMutex};
+                m_WakeCondition.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                    return m_Stop.load(std::memory_order_acquire) || m_NumQueuedJobs.load(std::memory_order_acquire) > 0;
+                });
+            }
+            m_NumSleeping.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        s_WorkerIndex = INVALID_WORKER_INDEX;
+    }
+}
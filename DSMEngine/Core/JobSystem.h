@@ -0,0 +1,179 @@
+#pragma once
+#ifndef __JOBSYSTEM_H__
+#define __JOBSYSTEM_H__
+
+#include "../pch.h"
+#include "../Utilities/Singleton.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+namespace DSM {
+    class JobSystem;
+    class JobCounter;
+
+    using JobFunction = std::function<void()>;
+    // 处理 [begin, end) 范围内的元素
+    using ParallelForFunction = std::function<void(std::uint32_t begin, std::uint32_t end)>;
+
+    struct Job
+    {
+        JobFunction m_Function{};
+        // 执行完毕后递减的计数器
+        JobCounter* m_Signal = nullptr;
+        // 只能在主线程执行
+        bool m_MainThread = false;
+    };
+
+    /// <summary>
+    /// 任务依赖计数器，提交任务时增加，任务完成后递减
+    /// 依赖该计数器的任务在其归零后才会被调度，计数器需在相关任务完成前保持有效
+    /// </summary>
+    class JobCounter
+    {
+    public:
+        JobCounter(std::uint32_t count = 0) noexcept : m_Count(count) {}
+        ~JobCounter();
+        DSM_NONCOPYABLE_NONMOVABLE(JobCounter);
+
+        void Add(std::uint32_t count = 1) noexcept { m_Count.fetch_add(count, std::memory_order_relaxed); }
+        bool IsDone() const noexcept { return m_Count.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        // 归零时返回等待中的任务
+        std::vector<Job*> Decrement();
+        // 计数器已归零时返回 false，由调用者直接调度任务
+        bool AddWaiter(Job* job);
+
+    private:
+        std::atomic<std::uint32_t> m_Count{};
+        std::mutex m_Mutex{};
+        std::vector<Job*> m_Waiters{};
+    };
+
+
+    /// <summary>
+    /// Chase–Lev 无锁双端队列，所属线程在底部压入和弹出，其他线程从顶部窃取
+    /// </summary>
+    class WorkStealingDeque
+    {
+    public:
+        WorkStealingDeque(std::int64_t capacity = 1024);
+        ~WorkStealingDeque() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(WorkStealingDeque);
+
+        // 仅所属线程调用
+        void Push(Job* job);
+        Job* Pop();
+        // 任意线程调用
+        Job* Steal();
+
+        bool Empty() const noexcept
+        {
+            return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct RingBuffer
+        {
+            RingBuffer(std::int64_t capacity)
+                :m_Capacity(capacity), m_Data(std::make_unique<std::atomic<Job*>[]>(capacity)) {}
+
+            Job* Get(std::int64_t index) const noexcept
+            {
+                return m_Data[index & (m_Capacity - 1)].load(std::memory_order_relaxed);
+            }
+            void Put(std::int64_t index, Job* job) noexcept
+            {
+                m_Data[index & (m_Capacity - 1)].store(job, std::memory_order_relaxed);
+            }
+
+            const std::int64_t m_Capacity{};
+            std::unique_ptr<std::atomic<Job*>[]> m_Data{};
+        };
+
+        RingBuffer* Grow(RingBuffer* buffer, std::int64_t bottom, std::int64_t top);
+
+    private:
+        alignas(64) std::atomic<std::int64_t> m_Top{};
+        alignas(64) std::atomic<std::int64_t> m_Bottom{};
+        std::atomic<RingBuffer*> m_Buffer{};
+        // 扩容后旧的缓冲区可能仍在被窃取线程读取，保留到析构
+        std::vector<std::unique_ptr<RingBuffer>> m_Buffers{};
+    };
+
+
+    /// <summary>
+    /// 基于任务窃取的任务调度器，每个工作线程拥有一个双端队列，主线程占用第 0 个
+    /// 非工作线程提交的任务放入共享队列，主线程专属的任务在 ProcessMainThreadJobs 及 Wait 中执行
+    /// </summary>
+    class JobSystem : public Singleton<JobSystem>
+    {
+    public:
+        // 为 0 时使用硬件线程数减一个工作线程
+        void Create(std::uint32_t numWorkers = 0);
+        void Shutdown();
+
+        // 提交任务，signal 在提交时加一并在任务完成后减一，dependency 归零后任务才会被调度
+        void Run(JobFunction function, JobCounter* signal = nullptr, JobCounter* dependency = nullptr);
+        // 提交只能在主线程执行的任务，如操作窗口或交换链
+        void RunOnMainThread(JobFunction function, JobCounter* signal = nullptr, JobCounter* dependency = nullptr);
+        // 等待期间当前线程会执行其他任务
+        void Wait(JobCounter& counter);
+
+        // 将 [0, count) 按 grainSize 划分为多个任务并等待全部完成，grainSize 为 0 时自动选择
+        void ParallelFor(std::uint32_t count, std::uint32_t grainSize, const ParallelForFunction& function);
+
+        // 执行所有主线程任务，每帧开始时调用
+        void ProcessMainThreadJobs();
+
+        std::uint32_t GetNumWorkers() const noexcept { return static_cast<std::uint32_t>(m_Workers.size()); }
+        bool IsMainThread() const noexcept { return std::this_thread::get_id() == m_MainThreadID; }
+        bool IsInitialized() const noexcept { return m_Initialized; }
+
+    private:
+        friend class Singleton<JobSystem>;
+        JobSystem() = default;
+        ~JobSystem() { Shutdown(); }
+
+        void Submit(JobFunction function, JobCounter* signal, JobCounter* dependency, bool mainThread);
+        // 将依赖已满足的任务放入队列
+        void Schedule(Job* job);
+        void Execute(Job* job);
+        // 执行一个可用的任务，没有任务时返回 false
+        bool TryExecuteJob();
+        Job* FindJob();
+        void WorkerLoop(std::uint32_t workerIndex);
+
+    private:
+        inline static constexpr std::uint32_t INVALID_WORKER_INDEX = ~0u;
+        // 空闲时放弃休眠前的自旋次数
+        inline static constexpr std::uint32_t sm_NumIdleSpins = 64;
+
+        bool m_Initialized = false;
+        std::thread::id m_MainThreadID{};
+        std::atomic<bool> m_Stop{};
+
+        std::vector<std::thread> m_Workers{};
+        // 第 0 个属于主线程
+        std::vector<std::unique_ptr<WorkStealingDeque>> m_Deques{};
+
+        // 非工作线程提交的任务
+        std::mutex m_SharedMutex{};
+        std::deque<Job*> m_SharedJobs{};
+
+        std::mutex m_MainThreadMutex{};
+        std::deque<Job*> m_MainThreadJobs{};
+
+        // 可被工作线程执行的任务数，用于唤醒休眠的线程
+        std::atomic<std::uint32_t> m_NumQueuedJobs{};
+        std::atomic<std::uint32_t> m_NumSleeping{};
+        std::mutex m_WakeMutex{};
+        std::condition_variable m_WakeCondition{};
+    };
+#define g_JobSystem (JobSystem::GetInstance())
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "RenderThread.h"
+
+namespace DSM {
+    void RenderThread::Start(
+        std::unique_ptr<RenderSnapshot> snapshot0,
+        std::unique_ptr<RenderSnapshot> snapshot1,
+        RenderFunction renderFunction)
+    {
+        ASSERT(!IsRunning());
+        ASSERT(snapshot0 != nullptr && snapshot1 != nullptr && renderFunction != nullptr);
+
+        m_Snapshots = {std::move(snapshot0), std::move(snapshot1)};
+        m_RenderFunction = std::move(renderFunction);
+        m_WriteIndex = 0;
+        m_PendingIndex = m_ReadIndex = INVALID_INDEX;
+        m_Stop = false;
+
+        m_Thread = std::thread{&RenderThread::ThreadLoop, this};
+    }
+
+    void RenderThread::Stop()
+    {
+        if (!IsRunning()) return;
+
+        {
+            std::lock_guard lock{m_Mutex};
+            m_Stop = true;
+        }
+        m_Condition.notify_all();
+        m_Thread.join();
+
+        m_Snapshots = {};
+        m_RenderFunction = nullptr;
+    }
+
+    RenderSnapshot& RenderThread::BeginWrite()
+    {
+        ASSERT(IsRunning());
+
+        std::unique_lock lock{m_Mutex};
+        m_Condition.wait(lock, [this]() {
+            return m_ReadIndex != m_WriteIndex && m_PendingIndex != m_WriteIndex;
+        });
+        return *m_Snapshots[m_WriteIndex];
+    }
+
+    void RenderThread::EndWrite()
+    {
+        {
+            std::unique_lock lock{m_Mutex};
+            m_Condition.wait(lock, [this]() { return m_PendingIndex == INVALID_INDEX; });
+
+            m_PendingIndex = m_WriteIndex;
+            m_WriteIndex ^= 1;
+        }
+        m_Condition.notify_all();
+    }
+
+    void RenderThread::Flush()
+    {
+        if (!IsRunning()) return;
+
+        std::unique_lock lock{m_Mutex};
+        m_Condition.wait(lock, [this]() {
+            return m_PendingIndex == INVALID_INDEX && m_ReadIndex == INVALID_INDEX;
+        });
+    }
+
+    void RenderThread::ThreadLoop()
+    {
+        while (true) {
+            {
+                std::unique_lock lock{m_Mutex};
+                m_Condition.wait(lock, [this]() { return m_Stop || m_PendingIndex != INVALID_INDEX; });
+                // 退出前渲染完已发布的快照
+                if (m_PendingIndex == INVALID_INDEX) break;
+
+                m_ReadIndex = m_PendingIndex;
+                m_PendingIndex = INVALID_INDEX;
+            }
+            m_Condition.notify_all();
+
+            m_RenderFunction(*m_Snapshots[m_ReadIndex]);
+
+            {
+                std::lock_guard lock{m_Mutex};
+                m_ReadIndex = INVALID_INDEX;
+            }
+            m_Condition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef __RENDERTHREAD_H__
+#define __RENDERTHREAD_H__
+
+#include "../pch.h"
+#include "../Utilities/Macros.h"
+#include <condition_variable>
+
+namespace DSM {
+    /// <summary>
+    /// 游戏线程写入、渲染线程只读的场景快照，由程序派生并添加渲染所需的数据
+    /// 快照中只应保存值或渲染期间不会被修改的资源的指针
+    /// </summary>
+    struct RenderSnapshot
+    {
+        virtual ~RenderSnapshot() = default;
+
+        // 写入快照时游戏线程的帧序号
+        std::uint64_t m_FrameIndex{};
+    };
+
+
+    /// <summary>
+    /// 独立的渲染线程，与游戏线程交替使用两个快照
+    /// 游戏线程写入一个快照的同时渲染线程读取另一个，游戏线程最多领先一帧
+    /// </summary>
+    class RenderThread
+    {
+    public:
+        using RenderFunction = std::function<void(const RenderSnapshot&)>;
+
+        RenderThread() = default;
+        ~RenderThread() { Stop(); }
+        DSM_NONCOPYABLE_NONMOVABLE(RenderThread);
+
+        void Start(
+            std::unique_ptr<RenderSnapshot> snapshot0,
+            std::unique_ptr<RenderSnapshot> snapshot1,
+            RenderFunction renderFunction);
+        // 渲染完已发布的快照后退出
+        void Stop();
+
+        // 游戏线程获取可写入的快照，渲染线程仍在读取时阻塞
+        RenderSnapshot& BeginWrite();
+        // 发布写入完成的快照，上一个快照尚未被渲染线程取走时阻塞
+        void EndWrite();
+        // 等待已发布的快照全部渲染完成，用于修改渲染线程使用的资源前
+        void Flush();
+
+        bool IsRunning() const noexcept { return m_Thread.joinable(); }
+
+    private:
+        void ThreadLoop();
+
+    private:
+        inline static constexpr std::uint32_t INVALID_INDEX = ~0u;
+
+        std::array<std::unique_ptr<RenderSnapshot>, 2> m_Snapshots{};
+        RenderFunction m_RenderFunction{};
+        std::thread m_Thread{};
+
+        std::mutex m_Mutex{};
+        std::condition_variable m_Condition{};
+        // 游戏线程写入的快照
+        std::uint32_t m_WriteIndex{};
+        // 已发布但渲染线程尚未取走的快照
+        std::uint32_t m_PendingIndex = INVALID_INDEX;
+        // 渲染线程正在读取的快照
+        std::uint32_t m_ReadIndex = INVALID_INDEX;
+        bool m_Stop = false;
+    };
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include "BindlessDescriptorHeap.h"
+#include "RenderContext.h"
+
+namespace DSM {
+	void BindlessDescriptorHeap::Create(const std::wstring& name, std::uint32_t numDescriptors)
+	{
+		std::lock_guard lock{m_Mutex};
+
+		m_Heap = std::make_unique<DescriptorHeap>(name, m_HeapType, numDescriptors, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE);
+		m_FreeIndices.clear();
+		m_NextIndex = 0;
+	}
+
+	void BindlessDescriptorHeap::Destroy()
+	{
+		std::lock_guard lock{m_Mutex};
+
+		m_FreeIndices.clear();
+		m_NextIndex = 0;
+		m_Heap = nullptr;
+	}
+
+	std::uint32_t BindlessDescriptorHeap::Allocate()
+	{
+		std::lock_guard lock{m_Mutex};
+		ASSERT(m_Heap != nullptr);
+
+		if (!m_FreeIndices.empty()) {
+			auto index = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+			return index;
+		}
+
+		ASSERT(m_NextIndex < m_Heap->GetHeapSize(), "Bindless descriptor heap is full!");
+		return m_NextIndex++;
+	}
+
+	std::uint32_t BindlessDescriptorHeap::Allocate(D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptor)
+	{
+		auto index = Allocate();
+		Update(index, srcDescriptor);
+		return index;
+	}
+
+	void BindlessDescriptorHeap::Update(std::uint32_t index, D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptor)
+	{
+		ASSERT(index < GetCapacity());
+		g_RenderContext.GetDevice()->CopyDescriptorsSimple(1, (*m_Heap)[index], srcDescriptor, m_HeapType);
+	}
+
+	void BindlessDescriptorHeap::Free(std::uint32_t index, std::uint64_t fenceValue)
+	{
+		{
+			std::lock_guard lock{m_Mutex};
+
+			// 堆销毁后释放的槽位直接忽略
+			if (index == INVALID_INDEX || m_Heap == nullptr) {
+				return;
+			}
+			ASSERT(index < m_NextIndex);
+		}
+
+		g_RenderContext.GetDeferredReleaseQueue().Release(fenceValue, [this, index]() {
+			std::lock_guard lock{m_Mutex};
+			if (m_Heap != nullptr) {
+				m_FreeIndices.push_back(index);
+			}
+		});
+	}
+
+	std::uint32_t BindlessDescriptorHeap::GetNumAllocated()
+	{
+		std::lock_guard lock{m_Mutex};
+		return m_NextIndex - static_cast<std::uint32_t>(m_FreeIndices.size());
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef __BINDLESSDESCRIPTORHEAP_H__
+#define __BINDLESSDESCRIPTORHEAP_H__
+
+#include "DescriptorHeap.h"
+
+namespace DSM {
+    /// <summary>
+    /// 常驻的着色器可见描述符堆，每个槽位有固定的索引，着色器通过索引访问资源
+    /// </summary>
+    class BindlessDescriptorHeap
+    {
+    public:
+        inline static constexpr std::uint32_t INVALID_INDEX = (std::numeric_limits<std::uint32_t>::max)();
+
+        BindlessDescriptorHeap() = default;
+        ~BindlessDescriptorHeap() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(BindlessDescriptorHeap);
+
+        void Create(const std::wstring& name, std::uint32_t numDescriptors);
+        void Destroy();
+
+        std::uint32_t Allocate();
+        // 分配槽位并拷贝 CPU 描述符
+        std::uint32_t Allocate(D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptor);
+        void Update(std::uint32_t index, D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptor);
+        // 槽位在围栏值完成后由延迟释放队列归还
+        void Free(std::uint32_t index, std::uint64_t fenceValue);
+
+        bool IsValid() const noexcept { return m_Heap != nullptr; }
+        ID3D12DescriptorHeap* GetHeap() const noexcept { return m_Heap->GetHeap(); }
+        std::uint32_t GetCapacity() const noexcept { return m_Heap != nullptr ? m_Heap->GetHeapSize() : 0; }
+        std::uint32_t GetNumAllocated();
+
+        DescriptorHandle operator[](std::uint32_t index) const noexcept { return (*m_Heap)[index]; }
+
+    private:
+        std::unique_ptr<DescriptorHeap> m_Heap{};
+        D3D12_DESCRIPTOR_HEAP_TYPE m_HeapType = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        
+        std::vector<std::uint32_t> m_FreeIndices{};
+        // 从未使用过的第一个槽位
+        std::uint32_t m_NextIndex{};
+        std::mutex m_Mutex{};
+    };
+}
+
+#endif
@@ -1,39 +1,123 @@
 #include "CommandAllocatorPool.h"
+#include "RenderContext.h"
 #include "../Utilities/Macros.h"
 
 namespace DSM{
-    ID3D12CommandAllocator* CommandAllocatorPool::RequestAllocator(std::uint64_t completedFenceValue)
+    void CommandAllocatorPool::Create(ID3D12Device* pDevice) noexcept
     {
-        std::lock_guard<std::mutex> guard{m_AllocatorMutex};
+        m_pDevice = pDevice;
+        m_PoolID = sm_NextPoolID.fetch_add(1, std::memory_order_relaxed);
+    }
 
-        ID3D12CommandAllocator* pAllocator = nullptr;
+    void CommandAllocatorPool::Shutdown() noexcept
+    {
+        std::lock_guard<std::mutex> guard{m_ThreadPoolMutex};
 
-        // 从已有的分配者获取
-        if (!m_ReadyAllocators.empty()) {
-            auto& [fenceValue, allocator] = m_ReadyAllocators.front();
+        // 使用中的分配器由命令列表归还，此时应当都已经归还
+        m_ThreadPools.clear();
+        m_PoolID = 0;
+        m_NumLive = 0;
+    }
 
-            // 若命令队列已经执行完内部命令,重置后获取
-            if (fenceValue <= completedFenceValue) {
-                pAllocator = allocator;
-                ASSERT_SUCCEEDED(pAllocator->Reset());
-                m_ReadyAllocators.pop();
+    ID3D12CommandAllocator* CommandAllocatorPool::RequestAllocator()
+    {
+        auto& threadPool = GetThreadPool();
+
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> pAllocator{};
+        {
+            std::lock_guard<std::mutex> guard{threadPool.m_Mutex};
+            
+            // 优先使用最近归还的分配器，其中的分配器已经执行完内部命令
+            if (!threadPool.m_IdleAllocators.empty()) {
+                pAllocator = std::move(threadPool.m_IdleAllocators.back().m_Allocator);
+                threadPool.m_IdleAllocators.pop_back();
             }
         }
 
-        // 获取失败则额外创建
-        if (pAllocator == nullptr) {
-            ASSERT_SUCCEEDED(m_pDevice->CreateCommandAllocator(m_CommandListType, IID_PPV_ARGS(&pAllocator)));
-            std::wstring name = L"CommandAllocatorPool::pAllocator" + std::to_wstring(completedFenceValue);
+        if (pAllocator != nullptr) {
+            ASSERT_SUCCEEDED(pAllocator->Reset());
+            m_NumReused.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {  // 获取失败则额外创建
+            ASSERT_SUCCEEDED(m_pDevice->CreateCommandAllocator(m_CommandListType, IID_PPV_ARGS(pAllocator.GetAddressOf())));
+            auto index = m_NumCreated.fetch_add(1, std::memory_order_relaxed);
+            std::wstring name = L"CommandAllocatorPool::pAllocator" + std::to_wstring(index);
             pAllocator->SetName(name.c_str());
-            m_Allocators.emplace_back(pAllocator);
+
+            auto numLive = m_NumLive.fetch_add(1, std::memory_order_relaxed) + 1;
+            auto peakLive = m_PeakLive.load(std::memory_order_relaxed);
+            while (peakLive < numLive && !m_PeakLive.compare_exchange_weak(peakLive, numLive, std::memory_order_relaxed));
         }
 
-        return pAllocator;
+        // 引用交由命令列表持有，归还时再接管
+        return pAllocator.Detach();
     }
 
     void CommandAllocatorPool::DiscardAllocator(std::uint64_t fenceValue, ID3D12CommandAllocator* pAllocator)
     {
-        std::lock_guard<std::mutex> guard{m_AllocatorMutex};
-        m_ReadyAllocators.emplace(std::make_pair(fenceValue, pAllocator));
+        ASSERT(pAllocator != nullptr);
+
+        auto threadPool = &GetThreadPool();
+        g_RenderContext.GetDeferredReleaseQueue().Release(fenceValue, [this, threadPool, pAllocator]() {
+            IdleAllocator idleAllocator{};
+            idleAllocator.m_Allocator.Attach(pAllocator);
+            idleAllocator.m_IdleFrame = m_FrameIndex.load(std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> guard{threadPool->m_Mutex};
+            threadPool->m_IdleAllocators.push_back(std::move(idleAllocator));
+        });
+    }
+
+    void CommandAllocatorPool::EndFrame()
+    {
+        auto frameIndex = m_FrameIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        std::lock_guard<std::mutex> guard{m_ThreadPoolMutex};
+        for (auto& threadPool : m_ThreadPools) {
+            std::lock_guard<std::mutex> threadGuard{threadPool->m_Mutex};
+
+            // 空闲列表按空闲时间排列，从头部开始释放
+            auto& idleAllocators = threadPool->m_IdleAllocators;
+            while (!idleAllocators.empty() && frameIndex - idleAllocators.front().m_IdleFrame > m_IdleFrames) {
+                idleAllocators.pop_front();
+                m_NumLive.fetch_sub(1, std::memory_order_relaxed);
+                m_NumTrimmed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    CommandAllocatorPoolStats CommandAllocatorPool::GetStats()
+    {
+        CommandAllocatorPoolStats stats{};
+        stats.m_NumCreated = m_NumCreated.load(std::memory_order_relaxed);
+        stats.m_NumReused = m_NumReused.load(std::memory_order_relaxed);
+        stats.m_NumTrimmed = m_NumTrimmed.load(std::memory_order_relaxed);
+        stats.m_NumLive = m_NumLive.load(std::memory_order_relaxed);
+        stats.m_PeakLive = m_PeakLive.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> guard{m_ThreadPoolMutex};
+        for (auto& threadPool : m_ThreadPools) {
+            std::lock_guard<std::mutex> threadGuard{threadPool->m_Mutex};
+            stats.m_NumIdle += static_cast<std::uint32_t>(threadPool->m_IdleAllocators.size());
+        }
+        return stats;
+    }
+
+    CommandAllocatorPool::ThreadPool& CommandAllocatorPool::GetThreadPool()
+    {
+        ASSERT(m_PoolID != 0);
+
+        // 每个线程缓存自己在各个池中的子池
+        thread_local std::vector<std::pair<std::uint64_t, ThreadPool*>> s_ThreadPools{};
+        for (auto& [poolID, threadPool] : s_ThreadPools) {
+            if (poolID == m_PoolID) {
+                return *threadPool;
+            }
+        }
+
+        std::lock_guard<std::mutex> guard{m_ThreadPoolMutex};
+        auto threadPool = m_ThreadPools.emplace_back(std::make_unique<ThreadPool>()).get();
+        s_ThreadPools.emplace_back(m_PoolID, threadPool);
+        return *threadPool;
     }
 }
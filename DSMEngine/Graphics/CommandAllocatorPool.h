@@ -7,9 +7,25 @@
 #include <d3d12.h>
 #include <mutex>
 #include <queue>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <wrl/client.h>
 
 namespace DSM {
+    // 命令分配器的使用情况
+    struct CommandAllocatorPoolStats
+    {
+        std::uint64_t m_NumCreated{};
+        std::uint64_t m_NumReused{};
+        std::uint64_t m_NumTrimmed{};
+        // 当前存在的分配器，包括使用中与空闲的
+        std::uint32_t m_NumLive{};
+        std::uint32_t m_PeakLive{};
+        std::uint32_t m_NumIdle{};
+    };
+    
     class CommandAllocatorPool
     {
     public:
@@ -20,33 +36,57 @@ namespace DSM {
             Shutdown();
         }
 
-        void Create(ID3D12Device* pDevice) noexcept
-        {
-            m_pDevice = pDevice;
-        }
-        void Shutdown() noexcept
-        {
-            m_Allocators.clear();
-            while (!m_ReadyAllocators.empty()) {
-                m_ReadyAllocators.pop();
-            }
-        }
+        void Create(ID3D12Device* pDevice) noexcept;
+        void Shutdown() noexcept;
 
-        // 请求一个命令分配
-        ID3D12CommandAllocator* RequestAllocator(std::uint64_t completedFenceValue);
-        // 提交命令列表后回收
+        // 从当前线程的池中请求一个命令分配器
+        ID3D12CommandAllocator* RequestAllocator();
+        // 提交命令列表后回收，栅栏完成后由延迟释放队列归还到当前线程的池中
         void DiscardAllocator(std::uint64_t fenceValue, ID3D12CommandAllocator* pAllocator);
+        // 每帧结束时调用，释放长时间未使用的分配器
+        void EndFrame();
 
-        std::size_t Size() const noexcept{ return m_Allocators.size(); }
+        std::size_t Size() const noexcept{ return m_NumLive.load(std::memory_order_relaxed); }
+        CommandAllocatorPoolStats GetStats();
+        // 空闲超过该帧数的分配器会被释放
+        void SetIdleFrames(std::uint32_t numFrames) noexcept { m_IdleFrames = numFrames; }
 
     private:
-        std::mutex m_AllocatorMutex;
+        struct IdleAllocator
+        {
+            Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_Allocator{};
+            // 归还时的帧序号
+            std::uint64_t m_IdleFrame{};
+        };
+        // 每个线程独立的池，只有归还与裁剪时才会被其他线程访问
+        struct ThreadPool
+        {
+            std::mutex m_Mutex{};
+            // 末尾为最近归还的分配器
+            std::deque<IdleAllocator> m_IdleAllocators{};
+        };
+
+        ThreadPool& GetThreadPool();
 
+    private:
+        // 用于区分不同的池，池重新创建后线程缓存的旧池不会再被使用
+        inline static std::atomic<std::uint64_t> sm_NextPoolID{1};
+        
         const D3D12_COMMAND_LIST_TYPE m_CommandListType;
         ID3D12Device* m_pDevice = nullptr;
+        std::uint64_t m_PoolID{};
+
+        std::mutex m_ThreadPoolMutex;
+        std::vector<std::unique_ptr<ThreadPool>> m_ThreadPools;
+
+        std::atomic<std::uint64_t> m_FrameIndex{};
+        std::uint32_t m_IdleFrames = 120;
 
-        std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_Allocators;
-        std::queue<std::pair<std::uint64_t, ID3D12CommandAllocator*>> m_ReadyAllocators;
+        std::atomic<std::uint64_t> m_NumCreated{};
+        std::atomic<std::uint64_t> m_NumReused{};
+        std::atomic<std::uint64_t> m_NumTrimmed{};
+        std::atomic<std::uint32_t> m_NumLive{};
+        std::atomic<std::uint32_t> m_PeakLive{};
     };
 }
 
@@ -0,0 +1,145 @@
+#include "BindStateCache.h"
+#include "../../Utilities/Macros.h"
+
+namespace DSM {
+    // 视图及矩形均为不含填充的 POD 结构，可直接按字节比较
+    template <typename T>
+    static bool IsSameRange(const T* cached, std::span<const T> values) noexcept
+    {
+        return std::memcmp(cached, values.data(), values.size_bytes()) == 0;
+    }
+
+
+    bool BindStateCache::SetRootDescriptor(std::uint32_t rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address) noexcept
+    {
+        return SetRootArgument(rootIndex, address, false);
+    }
+
+    bool BindStateCache::SetRootDescriptorTable(std::uint32_t rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE handle) noexcept
+    {
+        return SetRootArgument(rootIndex, handle.ptr, true);
+    }
+
+    bool BindStateCache::SetVertexBuffers(std::uint32_t startSlot, std::span<const D3D12_VERTEX_BUFFER_VIEW> VBVs) noexcept
+    {
+        ASSERT(startSlot + VBVs.size() <= sm_MaxVertexBuffers);
+
+        auto numSlots = static_cast<std::uint32_t>(VBVs.size());
+        auto slotMask = (numSlots == 32 ? ~0u : (1u << numSlots) - 1) << startSlot;
+        bool isSame = (m_ValidVertexBuffers & slotMask) == slotMask &&
+            IsSameRange(m_VertexBuffers.data() + startSlot, VBVs);
+        if (!isSame) {
+            std::copy(VBVs.begin(), VBVs.end(), m_VertexBuffers.begin() + startSlot);
+            m_ValidVertexBuffers |= slotMask;
+        }
+        return Filter(isSame);
+    }
+
+    bool BindStateCache::SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& ibv) noexcept
+    {
+        bool isSame = m_IndexBufferValid && IsSameRange(&m_IndexBuffer, std::span{&ibv, 1});
+        m_IndexBuffer = ibv;
+        m_IndexBufferValid = true;
+        return Filter(isSame);
+    }
+
+    bool BindStateCache::SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) noexcept
+    {
+        bool isSame = m_Topology == topology;
+        m_Topology = topology;
+        return Filter(isSame);
+    }
+
+    bool BindStateCache::SetViewports(std::span<const D3D12_VIEWPORT> viewports) noexcept
+    {
+        ASSERT(!viewports.empty() && viewports.size() <= sm_MaxViewports);
+
+        // 设置时会覆盖全部视口，数量不同也需要重新设置
+        bool isSame = m_NumViewports == viewports.size() && IsSameRange(m_Viewports.data(), viewports);
+        if (!isSame) {
+            std::copy(viewports.begin(), viewports.end(), m_Viewports.begin());
+            m_NumViewports = static_cast<std::uint32_t>(viewports.size());
+        }
+        return Filter(isSame);
+    }
+
+    bool BindStateCache::SetScissors(std::span<const D3D12_RECT> rects) noexcept
+    {
+        ASSERT(!rects.empty() && rects.size() <= sm_MaxViewports);
+
+        bool isSame = m_NumScissors == rects.size() && IsSameRange(m_Scissors.data(), rects);
+        if (!isSame) {
+            std::copy(rects.begin(), rects.end(), m_Scissors.begin());
+            m_NumScissors = static_cast<std::uint32_t>(rects.size());
+        }
+        return Filter(isSame);
+    }
+
+    void BindStateCache::InvalidateIndirectBindings() noexcept
+    {
+        m_ValidRootArguments = 0;
+        m_ValidVertexBuffers = 0;
+        m_IndexBufferValid = false;
+    }
+
+    void BindStateCache::Reset() noexcept
+    {
+        // 重置后命令列表的状态恢复为默认值
+        m_ValidRootArguments = 0;
+        m_RootTableMask = 0;
+        m_ValidVertexBuffers = 0;
+        m_IndexBufferValid = false;
+        m_Topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        m_NumViewports = 0;
+        m_NumScissors = 0;
+    }
+
+    void BindStateCache::CommitStats() noexcept
+    {
+        sm_NumIssued.fetch_add(m_Stats.m_NumIssued, std::memory_order_relaxed);
+        sm_NumFiltered.fetch_add(m_Stats.m_NumFiltered, std::memory_order_relaxed);
+        m_Stats = {};
+    }
+
+    void BindStateCache::EndFrame() noexcept
+    {
+        sm_LastFrameIssued.store(sm_NumIssued.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        sm_LastFrameFiltered.store(sm_NumFiltered.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    BindStateStats BindStateCache::GetFrameStats() noexcept
+    {
+        BindStateStats stats{};
+        stats.m_NumIssued = sm_LastFrameIssued.load(std::memory_order_relaxed);
+        stats.m_NumFiltered = sm_LastFrameFiltered.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    bool BindStateCache::Filter(bool isSame) noexcept
+    {
+        if (isSame) {
+            ++m_Stats.m_NumFiltered;
+        }
+        else {
+            ++m_Stats.m_NumIssued;
+        }
+        return !isSame;
+    }
+
+    bool BindStateCache::SetRootArgument(std::uint32_t rootIndex, std::uint64_t value, bool isTable) noexcept
+    {
+        ASSERT(rootIndex < sm_MaxRootParameters);
+
+        auto rootBit = 1ull << rootIndex;
+        bool isSame = (m_ValidRootArguments & rootBit) != 0 && m_RootArguments[rootIndex] == value;
+        m_RootArguments[rootIndex] = value;
+        m_ValidRootArguments |= rootBit;
+        if (isTable) {
+            m_RootTableMask |= rootBit;
+        }
+        else {
+            m_RootTableMask &= ~rootBit;
+        }
+        return Filter(isSame);
+    }
+}
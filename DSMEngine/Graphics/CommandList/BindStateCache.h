@@ -0,0 +1,84 @@
+#pragma once
+#ifndef __BINDSTATECACHE_H__
+#define __BINDSTATECACHE_H__
+
+#include "../../pch.h"
+#include <atomic>
+#include <span>
+
+namespace DSM {
+    // 图形管线绑定调用的统计
+    struct BindStateStats
+    {
+        // 实际写入命令列表的调用数
+        std::uint64_t m_NumIssued{};
+        // 与当前绑定相同而省去的调用数
+        std::uint64_t m_NumFiltered{};
+    };
+
+    /// <summary>
+    /// 命令列表中图形管线绑定的影子状态，用于跳过与当前绑定相同的设置
+    /// 命令列表重置后全部失效，根签名改变后根参数失效，描述符堆改变后描述符表失效
+    /// </summary>
+    class BindStateCache
+    {
+    public:
+        // 以下函数更新记录的状态，返回是否需要写入命令列表
+        bool SetRootDescriptor(std::uint32_t rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address) noexcept;
+        bool SetRootDescriptorTable(std::uint32_t rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE handle) noexcept;
+        bool SetVertexBuffers(std::uint32_t startSlot, std::span<const D3D12_VERTEX_BUFFER_VIEW> VBVs) noexcept;
+        bool SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& ibv) noexcept;
+        bool SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) noexcept;
+        bool SetViewports(std::span<const D3D12_VIEWPORT> viewports) noexcept;
+        bool SetScissors(std::span<const D3D12_RECT> rects) noexcept;
+
+        void InvalidateRootArguments() noexcept { m_ValidRootArguments = 0; }
+        void InvalidateDescriptorTables() noexcept { m_ValidRootArguments &= ~m_RootTableMask; }
+        // ExecuteIndirect 的命令签名可能修改根参数及顶点、索引缓冲区
+        void InvalidateIndirectBindings() noexcept;
+        void Reset() noexcept;
+
+        // 将本列表的统计累加到当前帧，提交时调用
+        void CommitStats() noexcept;
+
+        // 结束当前帧的统计，每帧结束时调用
+        static void EndFrame() noexcept;
+        // 上一帧的统计
+        static BindStateStats GetFrameStats() noexcept;
+
+    private:
+        bool Filter(bool isSame) noexcept;
+        bool SetRootArgument(std::uint32_t rootIndex, std::uint64_t value, bool isTable) noexcept;
+
+    private:
+        inline static constexpr std::uint32_t sm_MaxRootParameters = 64;
+        inline static constexpr std::uint32_t sm_MaxVertexBuffers = D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT;
+        inline static constexpr std::uint32_t sm_MaxViewports = D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+
+        // 根描述符的地址或描述符表的句柄
+        std::array<std::uint64_t, sm_MaxRootParameters> m_RootArguments{};
+        std::uint64_t m_ValidRootArguments{};
+        std::uint64_t m_RootTableMask{};
+
+        std::array<D3D12_VERTEX_BUFFER_VIEW, sm_MaxVertexBuffers> m_VertexBuffers{};
+        std::uint32_t m_ValidVertexBuffers{};
+        D3D12_INDEX_BUFFER_VIEW m_IndexBuffer{};
+        bool m_IndexBufferValid = false;
+
+        D3D12_PRIMITIVE_TOPOLOGY m_Topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        std::array<D3D12_VIEWPORT, sm_MaxViewports> m_Viewports{};
+        std::uint32_t m_NumViewports{};
+        std::array<D3D12_RECT, sm_MaxViewports> m_Scissors{};
+        std::uint32_t m_NumScissors{};
+
+        // 在提交时合并到当前帧的统计
+        BindStateStats m_Stats{};
+
+        inline static std::atomic<std::uint64_t> sm_NumIssued{};
+        inline static std::atomic<std::uint64_t> sm_NumFiltered{};
+        inline static std::atomic<std::uint64_t> sm_LastFrameIssued{};
+        inline static std::atomic<std::uint64_t> sm_LastFrameFiltered{};
+    };
+}
+
+#endif
@@ -2,14 +2,30 @@
 #include "../DynamicDescriptorHeap.h"
 #include "../RenderContext.h"
 #include "../PipelineState.h"
+#include "UploadBatch.h"
+#include "../../Core/JobSystem.h"
 
 namespace DSM {
-    CommandList::CommandList(const std::wstring& id, D3D12_COMMAND_LIST_TYPE type)
+    // 提交路径临时数组的栈上缓冲大小
+    static constexpr std::size_t s_SubmitScratchSize = 1024;
+
+    CommandList::CommandList(const std::wstring& id, D3D12_COMMAND_LIST_TYPE type, bool deferred)
         :m_CmdListType(type){
         auto listName = id + L" CommandList";
-        g_RenderContext.CreateCommandList(m_CmdListType, &m_CmdList, &m_CurrAllocator);
+        auto& cmdQueue = g_RenderContext.GetCommandQueue(m_CmdListType);
+        // 分配器留给提交时翻译得到的命令列表使用
+        m_CurrAllocator = cmdQueue.RequestCommandAllocator();
+        if (deferred) {
+            m_CommandStream = std::make_unique<CommandStream>();
+            ASSERT_SUCCEEDED(CreateCommandStreamList(
+                *m_CommandStream, m_CmdListType, IID_PPV_ARGS(m_CmdList.GetAddressOf())));
+        }
+        else {
+            // 从队列中复用已提交的命令列表，避免每次创建
+            m_CmdList = cmdQueue.RequestCommandList(m_CurrAllocator);
+            ASSERT_SUCCEEDED(m_CmdList->Reset(m_CurrAllocator, nullptr));
+        }
         m_CmdList->SetName(listName.c_str());
-        m_ResourceBarriers.reserve(16);
         
         m_ViewDescriptorHeap = DynamicDescriptorHeap::AllocateDynamicDescriptorHeap(this, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
         m_SampleDescriptorHeap = DynamicDescriptorHeap::AllocateDynamicDescriptorHeap(this, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
@@ -21,14 +37,24 @@ namespace DSM {
         auto& cmdQueue = g_RenderContext.GetCommandQueue(m_CmdListType);
         auto fenceValue = cmdQueue.GetNextFenceValue();
         cmdQueue.DiscardCommandAllocator(fenceValue, m_CurrAllocator);
+        // 写入命令流的命令列表不属于队列，直接释放
+        if (IsDeferred()) {
+            m_CmdList = nullptr;
+        }
+        else {
+            cmdQueue.DiscardCommandList(std::move(m_CmdList));
+        }
         
         DynamicDescriptorHeap::FreeDynamicDescriptorHeap(fenceValue, m_ViewDescriptorHeap);
         DynamicDescriptorHeap::FreeDynamicDescriptorHeap(fenceValue, m_SampleDescriptorHeap);
+        g_RenderContext.GetCpuBufferAllocator().ReleaseContext(m_UploadBufferContext, fenceValue);
     }
 
     void CommandList::Reset()
     {
         m_CmdList->Reset(m_CurrAllocator, nullptr);
+        m_StateTracker.Reset();
+        m_BindCache.Reset();
 
         if (m_CurrComputeRootSignature != nullptr) {
             m_CmdList->SetComputeRootSignature(m_CurrComputeRootSignature);
@@ -45,10 +71,7 @@ namespace DSM {
 
     void CommandList::FlushResourceBarriers()
     {
-        if (!m_ResourceBarriers.empty()) {
-            m_CmdList->ResourceBarrier(m_ResourceBarriers.size(), m_ResourceBarriers.data());
-        }
-        m_ResourceBarriers.clear();
+        m_StateTracker.FlushResourceBarriers(m_CmdList.Get());
     }
     
     void CommandList::ClearUAV(GpuResource& resource, D3D12_CPU_DESCRIPTOR_HANDLE uav, const float* clearColor)
@@ -155,63 +178,68 @@ namespace DSM {
 
     void CommandList::FillBuffer(GpuResource& dest, std::size_t destOffset, DWParam value, std::size_t byteSize)
     {
-        auto uploadBuffer = GetUploadBuffer(byteSize);
-        std::vector<DWParam> data{};
-        data.resize(Math::AlignUp(byteSize, sizeof(DWParam)) / sizeof(DWParam), value);
-        memcpy(uploadBuffer.m_MappedAddress, data.data(), byteSize);
+        auto uploadBuffer = GetUploadBuffer(byteSize, sizeof(DWParam));
+        // 直接写入映射的上传缓冲区，不足一个 DWORD 的尾部单独拷贝
+        auto mappedAddress = static_cast<std::byte*>(uploadBuffer.m_MappedAddress);
+        auto numDWords = byteSize / sizeof(DWParam);
+        std::fill_n(reinterpret_cast<DWParam*>(mappedAddress), numDWords, value);
+        memcpy(mappedAddress + numDWords * sizeof(DWParam), &value, byteSize % sizeof(DWParam));
         CopyBufferRegion(dest, destOffset, *uploadBuffer.m_Resource, uploadBuffer.m_Offset, byteSize);
     }
 
     void CommandList::InsertUAVBarrier(GpuResource& resource, bool flush)
     {
-        D3D12_RESOURCE_BARRIER resourceBarrier = {};
-        resourceBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-        resourceBarrier.UAV.pResource = resource.GetResource();
-        resourceBarrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-        m_ResourceBarriers.push_back(std::move(resourceBarrier));
+        m_StateTracker.InsertUAVBarrier(resource);
         
         if (flush) {
             FlushResourceBarriers();
         }
     }
 
+    void CommandList::InsertAliasBarrier(GpuResource* before, GpuResource& after, bool flush)
+    {
+        m_StateTracker.InsertAliasBarrier(before, after);
+
+        if (flush) {
+            FlushResourceBarriers();
+        }
+    }
+
     void CommandList::TransitionResource(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flush)
     {
-        auto preState = resource.GetUsageState();
+        TransitionSubresource(resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, newState, flush);
+    }
+
+    void CommandList::TransitionSubresource(GpuResource& resource, std::uint32_t subresource, D3D12_RESOURCE_STATES newState, bool flush)
+    {
         if (m_CmdListType == D3D12_COMMAND_LIST_TYPE_COMPUTE) {
-            auto valieComputeQueueResourceState =
+            auto validComputeQueueResourceState =
                 D3D12_RESOURCE_STATE_UNORDERED_ACCESS |
                 D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
                 D3D12_RESOURCE_STATE_COPY_DEST |
                 D3D12_RESOURCE_STATE_COPY_SOURCE;
-            ASSERT(preState & valieComputeQueueResourceState == preState);
-            ASSERT(newState & valieComputeQueueResourceState == newState);
+            ASSERT((newState & ~validComputeQueueResourceState) == 0);
         }
 
-        if (preState != newState) {
-            D3D12_RESOURCE_BARRIER resourceBarrier = {};
-            resourceBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            resourceBarrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-            resourceBarrier.Transition.pResource = resource.GetResource();
-            resourceBarrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-            resourceBarrier.Transition.StateBefore = resource.GetUsageState();
-            resourceBarrier.Transition.StateAfter = newState;
-            m_ResourceBarriers.push_back(std::move(resourceBarrier));
+        m_StateTracker.TransitionResource(resource, subresource, newState);
 
-            resource.SetUsageState(newState);
-        }
-        else if (newState == D3D12_RESOURCE_STATE_UNORDERED_ACCESS) {
-            InsertUAVBarrier(resource, flush);
+        if (flush) {
+            FlushResourceBarriers();
         }
+    }
 
-        if (m_ResourceBarriers.size() >= 16 || flush) {
+    void CommandList::BeginResourceTransition(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flush)
+    {
+        m_StateTracker.BeginTransition(resource, newState);
+
+        if (flush) {
             FlushResourceBarriers();
         }
     }
 
     GpuResourceLocatioin CommandList::GetUploadBuffer(std::uint64_t bufferSize, std::uint32_t alignment)
     {
-        return g_RenderContext.GetCpuBufferAllocator().Allocate(bufferSize, alignment);
+        return g_RenderContext.GetCpuBufferAllocator().Allocate(m_UploadBufferContext, bufferSize, alignment);
     }
 
     void CommandList::SetDescriptorHeap(ID3D12DescriptorHeap* descriptorHeap)
@@ -243,100 +271,226 @@ namespace DSM {
         }
     }
 
-    void CommandList::ExecuteCommandList(bool waitForCompletion)
+    std::uint64_t CommandList::ExecuteCommandList(bool waitForCompletion)
     {
-        ASSERT(m_CmdList != nullptr);
-        ASSERT(m_CmdListType == D3D12_COMMAND_LIST_TYPE_DIRECT ||
-            m_CmdListType == D3D12_COMMAND_LIST_TYPE_COMPUTE);
+        CommandList* cmdList = this;
+        return ExecuteCommandLists({&cmdList, 1}, waitForCompletion);
+    }
 
-        // 清空屏障
-        FlushResourceBarriers();
+    std::uint64_t CommandList::ExecuteCommandLists(std::span<CommandList* const> cmdLists, bool waitForCompletion)
+    {
+        ASSERT(!cmdLists.empty());
+        auto cmdListType = cmdLists[0]->m_CmdListType;
+        ASSERT(cmdListType == D3D12_COMMAND_LIST_TYPE_DIRECT ||
+            cmdListType == D3D12_COMMAND_LIST_TYPE_COMPUTE ||
+            cmdListType == D3D12_COMMAND_LIST_TYPE_COPY);
+
+        for (auto cmdList : cmdLists) {
+            ASSERT(cmdList->m_CmdList != nullptr && cmdList->m_CmdListType == cmdListType);
+            // 清空屏障
+            cmdList->m_StateTracker.FlushForSubmit(cmdList->GetCommandList());
+        }
 
-        auto& cmdQueue = g_RenderContext.GetCommandQueue(m_CmdListType);
-        auto fenceValue = cmdQueue.ExecuteCommandList(GetCommandList());
+        auto& cmdQueue = g_RenderContext.GetCommandQueue(cmdListType);
+        // 翻译不依赖全局状态，在加锁前完成
+        TranslateCommandStreams(cmdQueue, cmdLists);
+        // 提交可能来自任意线程，而帧内存只在渲染线程 EndFrame 时回收，临时数组放在栈上，超出时再从堆上分配
+        alignas(std::max_align_t) std::array<std::byte, s_SubmitScratchSize> scratchBuffer;
+        std::pmr::monotonic_buffer_resource scratch{scratchBuffer.data(), scratchBuffer.size()};
+        std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> d3dCmdLists{&scratch};
+        std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> pooledCmdLists{&scratch};
+        std::pmr::vector<ID3D12CommandAllocator*> barrierAllocators{&scratch};
+        std::pmr::vector<ID3D12CommandList*> submitCmdLists{&scratch};
+        std::uint64_t fenceValue{};
+        {
+            // 全局状态需按提交的顺序更新
+            std::lock_guard lock{ResourceStateTracker::GetGlobalMutex()};
+            ResolveResourceStates(cmdQueue, cmdLists, false, d3dCmdLists, pooledCmdLists, barrierAllocators);
+
+            submitCmdLists.reserve(d3dCmdLists.size());
+            for (const auto& d3dCmdList : d3dCmdLists) {
+                submitCmdLists.emplace_back(d3dCmdList.Get());
+            }
+            fenceValue = cmdQueue.ExecuteCommandLists(submitCmdLists);
+        }
+        for (auto barrierAllocator : barrierAllocators) {
+            cmdQueue.DiscardCommandAllocator(fenceValue, barrierAllocator);
+        }
+        cmdQueue.RecycleCommandLists(pooledCmdLists);
 
-        g_RenderContext.CleanupDynamicBuffer(fenceValue);
-        m_ViewDescriptorHeap->Cleanup(fenceValue);
-        m_SampleDescriptorHeap->Cleanup(fenceValue);
+        for (auto cmdList : cmdLists) {
+            cmdList->OnSubmitted(cmdQueue, fenceValue);
+        }
         
         if (waitForCompletion) {
             cmdQueue.WaitForFence(fenceValue);
         }
 
-        Reset();
+        for (auto cmdList : cmdLists) {
+            cmdList->Reset();
+        }
+        return fenceValue;
     }
 
+    std::uint64_t CommandList::QueueCommandList()
+    {
+        CommandList* cmdList = this;
+        return QueueCommandLists({&cmdList, 1});
+    }
 
-    void CommandList::InitTexture(GpuResource& dest, std::span<D3D12_SUBRESOURCE_DATA> subResources)
+    std::uint64_t CommandList::QueueCommandLists(std::span<CommandList* const> cmdLists)
     {
-        // 获取拷贝信息
-        auto numSubResource = subResources.size();
-        Microsoft::WRL::ComPtr<ID3D12Device> pDevice;
-        dest->GetDevice(IID_PPV_ARGS(pDevice.GetAddressOf()));
-        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprint(numSubResource);	// 子资源的宽高偏移等信息
-        std::vector<std::uint32_t> numRows(numSubResource);	// 子资源的行数
-        std::vector<std::uint64_t> rowByteSize(numSubResource);	// 子资源每一行的字节大小
-        std::uint64_t uploadBufferSize{};	// 整个纹理数据的大小
-        const auto& texDesc = dest->GetDesc();
-        pDevice->GetCopyableFootprints(
-            &texDesc, 0,
-            numSubResource, 0,
-            footprint.data(), numRows.data(),
-            rowByteSize.data(), &uploadBufferSize);
-        
-        CommandList cmdList{L"InitTexture"};
-        
-        auto uploadBuffer = cmdList.GetUploadBuffer(uploadBufferSize);
-
-        // 拷贝纹理资源
-        BYTE* mappedData = reinterpret_cast<BYTE*>(uploadBuffer.m_MappedAddress);
-        // 每一个子资源
-        for (std::uint32_t i = 0; i < numSubResource; i++) {
-            BYTE* destData = mappedData + footprint[i].Offset;
-            auto srcData = reinterpret_cast<const BYTE*>(subResources[i].pData);
-            // 每一个深度
-            for (std::uint32_t z = 0; z < footprint[i].Footprint.Depth; z++) {
-                auto destDepthOffsetData = destData + footprint[i].Footprint.RowPitch * numRows[i] * z;
-                auto srcDepthOffsetData = srcData + subResources[i].SlicePitch * z;
-                // 每一行
-                for (std::uint32_t y = 0; y < numRows[i]; y++) {
-                    auto destRowOffsetData = destDepthOffsetData + footprint[i].Footprint.RowPitch * y;
-                    auto srcRowOffsetData = srcDepthOffsetData + subResources[i].RowPitch * y;
-                    memcpy(destRowOffsetData, srcRowOffsetData, rowByteSize[i]);
-                }
+        ASSERT(!cmdLists.empty());
+        auto cmdListType = cmdLists[0]->m_CmdListType;
+        ASSERT(cmdListType == D3D12_COMMAND_LIST_TYPE_DIRECT ||
+            cmdListType == D3D12_COMMAND_LIST_TYPE_COMPUTE ||
+            cmdListType == D3D12_COMMAND_LIST_TYPE_COPY);
+
+        for (auto cmdList : cmdLists) {
+            ASSERT(cmdList->m_CmdList != nullptr && cmdList->m_CmdListType == cmdListType);
+            cmdList->m_StateTracker.FlushForSubmit(cmdList->GetCommandList());
+        }
+
+        auto& cmdQueue = g_RenderContext.GetCommandQueue(cmdListType);
+        TranslateCommandStreams(cmdQueue, cmdLists);
+        alignas(std::max_align_t) std::array<std::byte, s_SubmitScratchSize> scratchBuffer;
+        std::pmr::monotonic_buffer_resource scratch{scratchBuffer.data(), scratchBuffer.size()};
+        std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> d3dCmdLists{&scratch};
+        std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> pooledCmdLists{&scratch};
+        std::pmr::vector<ID3D12CommandAllocator*> barrierAllocators{&scratch};
+        std::uint64_t fenceValue{};
+        {
+            std::lock_guard lock{ResourceStateTracker::GetGlobalMutex()};
+            // 排队的命令列表在提交前不能重置，由队列接管，屏障及翻译得到的列表提交后由队列回收
+            ResolveResourceStates(cmdQueue, cmdLists, true, d3dCmdLists, pooledCmdLists, barrierAllocators);
+            fenceValue = cmdQueue.QueueCommandLists(d3dCmdLists);
+        }
+        for (auto barrierAllocator : barrierAllocators) {
+            cmdQueue.DiscardCommandAllocator(fenceValue, barrierAllocator);
+        }
+
+        for (auto cmdList : cmdLists) {
+            cmdList->OnSubmitted(cmdQueue, fenceValue);
+            if (!cmdList->IsDeferred()) {
+                cmdList->m_CmdList = cmdQueue.RequestCommandList(cmdList->m_CurrAllocator);
             }
+            cmdList->Reset();
         }
+        return fenceValue;
+    }
 
-        cmdList.TransitionResource(dest, D3D12_RESOURCE_STATE_COPY_DEST);
-        cmdList.FlushResourceBarriers();
-        
-        // 拷贝所有子资源
-        for (std::size_t i = 0; i < numSubResource; i++) {
-            D3D12_TEXTURE_COPY_LOCATION destLocation{};
-            destLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-            destLocation.SubresourceIndex = i;
-            destLocation.pResource = dest.GetResource();
-
-            D3D12_TEXTURE_COPY_LOCATION src{};
-            src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-            src.PlacedFootprint = footprint[i];
-            src.PlacedFootprint.Offset += uploadBuffer.m_Offset;
-            src.pResource = uploadBuffer.m_Resource->GetResource();
-            cmdList.m_CmdList->CopyTextureRegion(&destLocation,0,0,0,&src,nullptr);
+    void CommandList::TranslateCommandStreams(CommandQueue& cmdQueue, std::span<CommandList* const> cmdLists)
+    {
+        alignas(std::max_align_t) std::array<std::byte, s_SubmitScratchSize> scratchBuffer;
+        std::pmr::monotonic_buffer_resource scratch{scratchBuffer.data(), scratchBuffer.size()};
+        std::pmr::vector<CommandList*> deferredCmdLists{&scratch};
+        for (auto cmdList : cmdLists) {
+            if (cmdList->IsDeferred()) {
+                deferredCmdLists.emplace_back(cmdList);
+            }
         }
-        
-        cmdList.TransitionResource(dest, D3D12_RESOURCE_STATE_GENERIC_READ);
+        if (deferredCmdLists.empty()) return;
+
+        auto translate = [&cmdQueue](CommandList* cmdList) {
+            auto nativeCmdList = cmdQueue.RequestCommandList(cmdList->m_CurrAllocator);
+            ASSERT_SUCCEEDED(nativeCmdList->Reset(cmdList->m_CurrAllocator, nullptr));
+            cmdList->m_CommandStream->Replay(nativeCmdList.Get());
+            cmdList->m_NativeCmdList = std::move(nativeCmdList);
+        };
+
+        // 各列表使用各自的分配器，可以并行翻译
+        if (deferredCmdLists.size() == 1) {
+            translate(deferredCmdLists[0]);
+        }
+        else {
+            g_JobSystem.ParallelFor(static_cast<std::uint32_t>(deferredCmdLists.size()), 1,
+                [&](std::uint32_t begin, std::uint32_t end) {
+                    for (auto i = begin; i < end; ++i) {
+                        translate(deferredCmdLists[i]);
+                    }
+                });
+        }
+    }
 
-        // 等待GPU完成拷贝工作
-        cmdList.ExecuteCommandList(true);
+    void CommandList::ResolveResourceStates(
+        CommandQueue& cmdQueue,
+        std::span<CommandList* const> cmdLists,
+        bool moveCmdLists,
+        std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>>& d3dCmdLists,
+        std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>>& pooledCmdLists,
+        std::pmr::vector<ID3D12CommandAllocator*>& barrierAllocators)
+    {
+        alignas(std::max_align_t) std::array<std::byte, s_SubmitScratchSize> scratchBuffer;
+        std::pmr::monotonic_buffer_resource scratch{scratchBuffer.data(), scratchBuffer.size()};
+        std::pmr::vector<D3D12_RESOURCE_BARRIER> barriers{&scratch};
+        d3dCmdLists.reserve(cmdLists.size() * 2);
+
+        for (auto cmdList : cmdLists) {
+            auto& stateTracker = cmdList->m_StateTracker;
+
+            // 后面的列表需根据前面列表的最终状态解析
+            barriers.clear();
+            stateTracker.ResolvePendingBarriers(barriers);
+            stateTracker.CommitFinalStates();
+
+            if (!barriers.empty()) {
+                // 提交前列表处于录制状态，每个列表需独占一个分配器
+                auto barrierAllocator = cmdQueue.RequestCommandAllocator();
+                auto barrierCmdList = cmdQueue.RequestCommandList(barrierAllocator);
+                ASSERT_SUCCEEDED(barrierCmdList->Reset(barrierAllocator, nullptr));
+                barrierCmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+
+                barrierAllocators.emplace_back(barrierAllocator);
+
+                pooledCmdLists.emplace_back(barrierCmdList);
+                d3dCmdLists.emplace_back(std::move(barrierCmdList));
+            }
+
+            if (cmdList->m_NativeCmdList != nullptr) {
+                // 翻译得到的列表只使用一次，提交后归还给队列
+                pooledCmdLists.emplace_back(cmdList->m_NativeCmdList);
+                d3dCmdLists.emplace_back(std::move(cmdList->m_NativeCmdList));
+            }
+            else if (moveCmdLists) {
+                d3dCmdLists.emplace_back(std::move(cmdList->m_CmdList));
+            }
+            else {
+                d3dCmdLists.emplace_back(cmdList->m_CmdList);
+            }
+        }
+    }
+
+    void CommandList::OnSubmitted(CommandQueue& cmdQueue, std::uint64_t fenceValue)
+    {
+        // 每个命令列表的上传缓冲区只按其所在队列的栅栏退役，不涉及其他队列正在使用的页
+        g_RenderContext.GetCpuBufferAllocator().Cleanup(m_UploadBufferContext, fenceValue);
+        m_ViewDescriptorHeap->Cleanup(fenceValue);
+        m_SampleDescriptorHeap->Cleanup(fenceValue);
+        m_BindCache.CommitStats();
+
+        // 分配器在 GPU 执行完之前不能重置，换一个新的继续录制
+        cmdQueue.DiscardCommandAllocator(fenceValue, m_CurrAllocator);
+        m_CurrAllocator = cmdQueue.RequestCommandAllocator();
+    }
+
+
+    void CommandList::InitTexture(GpuResource& dest, std::span<D3D12_SUBRESOURCE_DATA> subResources)
+    {
+        UploadBatch uploadBatch{L"InitTexture"};
+        uploadBatch.UploadTexture(dest, subResources);
+        // 只让 GPU 端等待拷贝完成，不阻塞 CPU
+        auto ticket = uploadBatch.Submit();
+        ticket.StallQueue(g_RenderContext.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT));
+        ticket.StallQueue(g_RenderContext.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_COMPUTE));
     }
 
     void CommandList::InitBuffer(GpuResource& dest, const void* data, std::size_t byteSize, std::size_t destOffset)
     {
-        CommandList cmdList{L"InitBuffer"};
-        cmdList.WriteBuffer(dest, destOffset, data, byteSize);
-        cmdList.TransitionResource(dest, D3D12_RESOURCE_STATE_GENERIC_READ);
-        cmdList.ExecuteCommandList(true);
+        UploadBatch uploadBatch{L"InitBuffer"};
+        uploadBatch.UploadBuffer(dest, data, byteSize, destOffset);
+        auto ticket = uploadBatch.Submit();
+        ticket.StallQueue(g_RenderContext.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT));
+        ticket.StallQueue(g_RenderContext.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_COMPUTE));
     }
 
     void CommandList::InitTextureArraySlice(GpuResource& dest, std::uint32_t sliceIndex, GpuResource& src)
@@ -378,6 +532,11 @@ namespace DSM {
                 heaps[size++] = heap;
             }
         }
-        m_CmdList->SetDescriptorHeaps(size, heaps.data());
+        // 复制命令列表不能设置描述符堆
+        if (size > 0) {
+            m_CmdList->SetDescriptorHeaps(size, heaps.data());
+            // 之前设置的描述符表指向旧的描述符堆
+            m_BindCache.InvalidateDescriptorTables();
+        }
     }
 }
@@ -7,8 +7,12 @@
 #include <vector>
 #include <array>
 #include <span>
+#include <memory_resource>
 #include "../../Utilities/Macros.h"
 #include "Graphics/RenderContext.h"
+#include "ResourceStateTracker.h"
+#include "BindStateCache.h"
+#include "CommandStream.h"
 
 
 namespace DSM {
@@ -44,7 +48,11 @@ namespace DSM {
     {
         friend class RenderContext;
     public:
-        CommandList(const std::wstring& id = L"", D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+        // deferred 为真时命令先录制到 CPU 端的命令流，提交时再翻译为 D3D12 命令列表
+        CommandList(
+            const std::wstring& id = L"",
+            D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT,
+            bool deferred = false);
         ~CommandList();
         DSM_NONCOPYABLE(CommandList);
 
@@ -58,7 +66,10 @@ namespace DSM {
             return reinterpret_cast<ComputeCommandList&>(*this);
         }
 
+        // 延迟录制时返回写入命令流的命令列表
         ID3D12GraphicsCommandList* GetCommandList() { return m_CmdList.Get(); }
+        bool IsDeferred() const noexcept { return m_CommandStream != nullptr; }
+        const CommandStream* GetCommandStream() const noexcept { return m_CommandStream.get(); }
 
         void Reset();
         void FlushResourceBarriers();
@@ -83,7 +94,13 @@ namespace DSM {
         void FillBuffer(GpuResource& dest, std::size_t destOffset, DWParam value, std::size_t byteSize);
 
         void InsertUAVBarrier(GpuResource& resource, bool flush = false);
+        // 切换共享同一块内存的放置资源，before 为空时表示任意先前使用该内存的资源
+        void InsertAliasBarrier(GpuResource* before, GpuResource& after, bool flush = false);
+        // 屏障在下一次使用资源的命令前批量写入，冗余的转换会被省去
         void TransitionResource(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flush = false);
+        void TransitionSubresource(GpuResource& resource, std::uint32_t subresource, D3D12_RESOURCE_STATES newState, bool flush = false);
+        // 开始拆分屏障，GPU 可在之后的命令执行期间完成转换，下一次 TransitionResource 到相同状态时结束
+        void BeginResourceTransition(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flush = false);
 
         GpuResourceLocatioin GetUploadBuffer(std::uint64_t bufferSize, std::uint32_t alignment = 0);
 
@@ -91,8 +108,15 @@ namespace DSM {
         void SetDescriptorHeaps(std::uint32_t count , ID3D12DescriptorHeap** descriptorHeaps);
         void SetPipelineState(PSO& pso);
 
-        void ExecuteCommandList(bool waitForCompletion = false);
+        // 返回本次提交的栅栏值
+        std::uint64_t ExecuteCommandList(bool waitForCompletion = false);
+        // 按顺序将同一类型的多个命令列表作为一批提交，共享一个栅栏值
+        static std::uint64_t ExecuteCommandLists(std::span<CommandList* const> cmdLists, bool waitForCompletion = false);
+        // 暂不提交，在队列下一次提交或帧结束时与其他命令列表一并提交，返回完成时的栅栏值
+        std::uint64_t QueueCommandList();
+        static std::uint64_t QueueCommandLists(std::span<CommandList* const> cmdLists);
 
+        // 在复制队列上传初始数据，图形及计算队列在 GPU 端等待拷贝完成，不阻塞 CPU
         static void InitTexture(GpuResource& dest, std::span<D3D12_SUBRESOURCE_DATA> subResources);
         static void InitBuffer(GpuResource& dest, const void* data, std::size_t byteSize, std::size_t destOffset = 0);
         static void InitTextureArraySlice(GpuResource& dest, std::uint32_t sliceIndex, GpuResource& src);
@@ -100,11 +124,28 @@ namespace DSM {
         
     protected:
         void BindDescriptorHeaps();
+        // 提交后回收本次录制使用的资源并换用新的分配器
+        void OnSubmitted(CommandQueue& cmdQueue, std::uint64_t fenceValue);
+        // 将延迟录制的命令流回放到新的 D3D12 命令列表，多个列表时并行翻译
+        static void TranslateCommandStreams(CommandQueue& cmdQueue, std::span<CommandList* const> cmdLists);
+        // 需持有全局状态锁，按顺序解析各列表的待定屏障并更新全局状态
+        // 需要时在列表前插入只包含屏障的命令列表，由队列在提交时关闭
+        // 屏障列表及翻译得到的列表放入 pooledCmdLists，提交后归还给队列
+        static void ResolveResourceStates(
+            CommandQueue& cmdQueue,
+            std::span<CommandList* const> cmdLists,
+            bool moveCmdLists,
+            std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>>& d3dCmdLists,
+            std::pmr::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>>& pooledCmdLists,
+            std::pmr::vector<ID3D12CommandAllocator*>& barrierAllocators);
         
     protected:
         D3D12_COMMAND_LIST_TYPE m_CmdListType{};
         Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_CmdList{};
         ID3D12CommandAllocator* m_CurrAllocator{};
+        // 延迟录制的命令流及提交时翻译得到的命令列表
+        std::unique_ptr<CommandStream> m_CommandStream{};
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_NativeCmdList{};
 
         ID3D12RootSignature* m_CurrGraphicsRootSignature{};
         ID3D12RootSignature* m_CurrComputeRootSignature{};
@@ -112,8 +153,12 @@ namespace DSM {
 
         DynamicDescriptorHeap* m_ViewDescriptorHeap{};
         DynamicDescriptorHeap* m_SampleDescriptorHeap{};
+        // 上传缓冲区的分配上下文，录制期间的分配无需加锁
+        DynamicBufferContext m_UploadBufferContext{};
 
-        std::vector<D3D12_RESOURCE_BARRIER> m_ResourceBarriers{};
+        ResourceStateTracker m_StateTracker{};
+        // GraphicsCommandList 由本类直接转换得到，绑定状态需保存在基类中
+        BindStateCache m_BindCache{};
         std::array<ID3D12DescriptorHeap*, D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES> m_CurrDescriptorHeaps{};
     };
 
@@ -0,0 +1,1130 @@
+#include "CommandStream.h"
+#include "../RenderContext.h"
+#include "../../Math/MathCommon.h"
+#include <atomic>
+
+namespace DSM {
+    struct CommandStreamBlock
+    {
+        std::uint32_t m_Capacity{};
+        std::uint32_t m_Used{};
+
+        // 数据紧跟在块头之后
+        std::byte* GetData() noexcept { return reinterpret_cast<std::byte*>(this + 1); }
+    };
+    static_assert(sizeof(CommandStreamBlock) == 8);
+
+    struct CommandHeader
+    {
+        CommandOp m_Op{};
+        // 包含命令头在内的大小
+        std::uint32_t m_Size{};
+    };
+    static_assert(sizeof(CommandHeader) == 8);
+
+
+    //
+    // 内存块的缓存
+    //
+
+    // 每个线程最多缓存的空闲块，多余的归还给共享的缓存
+    static constexpr std::size_t s_MaxThreadBlocks = 16;
+
+    struct SharedBlockPool
+    {
+        ~SharedBlockPool()
+        {
+            for (auto block : m_Blocks) {
+                ::operator delete(block);
+            }
+        }
+
+        std::mutex m_Mutex{};
+        std::vector<CommandStreamBlock*> m_Blocks{};
+    };
+    static SharedBlockPool s_SharedBlocks{};
+
+    struct ThreadBlockCache
+    {
+        ~ThreadBlockCache()
+        {
+            std::lock_guard lock{s_SharedBlocks.m_Mutex};
+            s_SharedBlocks.m_Blocks.insert(s_SharedBlocks.m_Blocks.end(), m_Blocks.begin(), m_Blocks.end());
+        }
+
+        std::vector<CommandStreamBlock*> m_Blocks{};
+    };
+    static thread_local ThreadBlockCache s_ThreadBlocks{};
+
+    static CommandStreamBlock* AcquireBlock(std::size_t size)
+    {
+        CommandStreamBlock* block = nullptr;
+        if (size <= CommandStream::BLOCK_SIZE) {
+            size = CommandStream::BLOCK_SIZE;
+            if (!s_ThreadBlocks.m_Blocks.empty()) {
+                block = s_ThreadBlocks.m_Blocks.back();
+                s_ThreadBlocks.m_Blocks.pop_back();
+            }
+            else {
+                std::lock_guard lock{s_SharedBlocks.m_Mutex};
+                if (!s_SharedBlocks.m_Blocks.empty()) {
+                    block = s_SharedBlocks.m_Blocks.back();
+                    s_SharedBlocks.m_Blocks.pop_back();
+                }
+            }
+        }
+
+        if (block == nullptr) {
+            block = new(::operator new(sizeof(CommandStreamBlock) + size)) CommandStreamBlock{};
+            block->m_Capacity = static_cast<std::uint32_t>(size);
+        }
+        block->m_Used = 0;
+        return block;
+    }
+
+    static void ReleaseBlock(CommandStreamBlock* block)
+    {
+        // 单独分配的大块不缓存
+        if (block->m_Capacity != CommandStream::BLOCK_SIZE) {
+            ::operator delete(block);
+        }
+        else if (s_ThreadBlocks.m_Blocks.size() < s_MaxThreadBlocks) {
+            s_ThreadBlocks.m_Blocks.emplace_back(block);
+        }
+        else {
+            std::lock_guard lock{s_SharedBlocks.m_Mutex};
+            s_SharedBlocks.m_Blocks.emplace_back(block);
+        }
+    }
+
+
+    //
+    // 命令的参数
+    //
+
+    struct alignas(8) DrawInstancedCommand
+    {
+        UINT m_VertexCountPerInstance;
+        UINT m_InstanceCount;
+        UINT m_StartVertexLocation;
+        UINT m_StartInstanceLocation;
+    };
+    struct alignas(8) DrawIndexedInstancedCommand
+    {
+        UINT m_IndexCountPerInstance;
+        UINT m_InstanceCount;
+        UINT m_StartIndexLocation;
+        INT m_BaseVertexLocation;
+        UINT m_StartInstanceLocation;
+    };
+    struct alignas(8) DispatchCommand
+    {
+        UINT m_ThreadGroupCountX;
+        UINT m_ThreadGroupCountY;
+        UINT m_ThreadGroupCountZ;
+    };
+    struct alignas(8) CopyBufferRegionCommand
+    {
+        ID3D12Resource* m_DstBuffer;
+        UINT64 m_DstOffset;
+        ID3D12Resource* m_SrcBuffer;
+        UINT64 m_SrcOffset;
+        UINT64 m_NumBytes;
+    };
+    struct alignas(8) CopyTextureRegionCommand
+    {
+        D3D12_TEXTURE_COPY_LOCATION m_Dst;
+        D3D12_TEXTURE_COPY_LOCATION m_Src;
+        D3D12_BOX m_SrcBox;
+        UINT m_DstX;
+        UINT m_DstY;
+        UINT m_DstZ;
+        BOOL m_HasSrcBox;
+    };
+    struct alignas(8) CopyTilesCommand
+    {
+        ID3D12Resource* m_TiledResource;
+        ID3D12Resource* m_Buffer;
+        UINT64 m_BufferStartOffsetInBytes;
+        D3D12_TILED_RESOURCE_COORDINATE m_TileRegionStartCoordinate;
+        D3D12_TILE_REGION_SIZE m_TileRegionSize;
+        D3D12_TILE_COPY_FLAGS m_Flags;
+    };
+    struct alignas(8) ResolveSubresourceCommand
+    {
+        ID3D12Resource* m_DstResource;
+        ID3D12Resource* m_SrcResource;
+        UINT m_DstSubresource;
+        UINT m_SrcSubresource;
+        DXGI_FORMAT m_Format;
+    };
+    // 只有一个对象或指针参数的命令共用
+    struct alignas(8) PointerCommand
+    {
+        void* m_Pointer;
+    };
+    struct alignas(8) ValueCommand
+    {
+        UINT m_Value;
+    };
+    // 参数之后附带数组的命令共用
+    struct alignas(8) ArrayCommand
+    {
+        UINT m_Count;
+    };
+    struct alignas(8) BlendFactorCommand
+    {
+        FLOAT m_BlendFactor[4];
+    };
+    struct alignas(8) RootDescriptorTableCommand
+    {
+        D3D12_GPU_DESCRIPTOR_HANDLE m_BaseDescriptor;
+        UINT m_RootParameterIndex;
+    };
+    struct alignas(8) Root32BitConstantCommand
+    {
+        UINT m_RootParameterIndex;
+        UINT m_SrcData;
+        UINT m_DestOffsetIn32BitValues;
+    };
+    // 之后附带 m_Num32BitValuesToSet 个常量
+    struct alignas(8) Root32BitConstantsCommand
+    {
+        UINT m_RootParameterIndex;
+        UINT m_Num32BitValuesToSet;
+        UINT m_DestOffsetIn32BitValues;
+    };
+    struct alignas(8) RootDescriptorCommand
+    {
+        D3D12_GPU_VIRTUAL_ADDRESS m_BufferLocation;
+        UINT m_RootParameterIndex;
+    };
+    struct alignas(8) IndexBufferCommand
+    {
+        D3D12_INDEX_BUFFER_VIEW m_View;
+        // 为空时表示解除绑定
+        BOOL m_HasView;
+    };
+    // 之后附带 m_NumViews 个视图，m_HasViews 为假时表示解除绑定
+    struct alignas(8) BufferViewsCommand
+    {
+        UINT m_StartSlot;
+        UINT m_NumViews;
+        BOOL m_HasViews;
+    };
+    // 之后附带 m_NumHandles 个渲染目标的描述符
+    struct alignas(8) RenderTargetsCommand
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE m_DepthStencilDescriptor;
+        UINT m_NumRenderTargetDescriptors;
+        UINT m_NumHandles;
+        BOOL m_RTsSingleHandleToDescriptorRange;
+        BOOL m_HasDepthStencil;
+    };
+    // 之后附带 m_NumRects 个矩形
+    struct alignas(8) ClearDepthStencilCommand
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE m_DepthStencilView;
+        D3D12_CLEAR_FLAGS m_ClearFlags;
+        FLOAT m_Depth;
+        UINT8 m_Stencil;
+        UINT m_NumRects;
+    };
+    struct alignas(8) ClearRenderTargetCommand
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE m_RenderTargetView;
+        FLOAT m_ColorRGBA[4];
+        UINT m_NumRects;
+    };
+    // 浮点与整数的清除共用，m_Values 按位保存
+    struct alignas(8) ClearUnorderedAccessCommand
+    {
+        D3D12_GPU_DESCRIPTOR_HANDLE m_ViewGPUHandleInCurrentHeap;
+        D3D12_CPU_DESCRIPTOR_HANDLE m_ViewCPUHandle;
+        ID3D12Resource* m_Resource;
+        UINT m_Values[4];
+        UINT m_NumRects;
+    };
+    struct alignas(8) DiscardResourceCommand
+    {
+        ID3D12Resource* m_Resource;
+        UINT m_FirstSubresource;
+        UINT m_NumSubresources;
+        UINT m_NumRects;
+        BOOL m_HasRegion;
+    };
+    struct alignas(8) QueryCommand
+    {
+        ID3D12QueryHeap* m_QueryHeap;
+        D3D12_QUERY_TYPE m_Type;
+        UINT m_Index;
+    };
+    struct alignas(8) ResolveQueryDataCommand
+    {
+        ID3D12QueryHeap* m_QueryHeap;
+        ID3D12Resource* m_DestinationBuffer;
+        UINT64 m_AlignedDestinationBufferOffset;
+        D3D12_QUERY_TYPE m_Type;
+        UINT m_StartIndex;
+        UINT m_NumQueries;
+    };
+    struct alignas(8) SetPredicationCommand
+    {
+        ID3D12Resource* m_Buffer;
+        UINT64 m_AlignedBufferOffset;
+        D3D12_PREDICATION_OP m_Operation;
+    };
+    // 之后附带 m_Size 字节的数据
+    struct alignas(8) EventCommand
+    {
+        UINT m_Metadata;
+        UINT m_Size;
+    };
+    struct alignas(8) EmptyCommand
+    {
+    };
+    struct alignas(8) ExecuteIndirectCommand
+    {
+        ID3D12CommandSignature* m_CommandSignature;
+        ID3D12Resource* m_ArgumentBuffer;
+        UINT64 m_ArgumentBufferOffset;
+        ID3D12Resource* m_CountBuffer;
+        UINT64 m_CountBufferOffset;
+        UINT m_MaxCommandCount;
+    };
+
+
+    //
+    // CommandStream Implementation
+    //
+
+    CommandStream::CommandStream(CommandStream&& other) noexcept
+        :m_Blocks(std::move(other.m_Blocks)),
+        m_NumCommands(std::exchange(other.m_NumCommands, 0)),
+        m_SizeInBytes(std::exchange(other.m_SizeInBytes, 0)){
+        other.m_Blocks.clear();
+    }
+
+    CommandStream& CommandStream::operator=(CommandStream&& other) noexcept
+    {
+        if (this != &other) {
+            Reset();
+            m_Blocks = std::move(other.m_Blocks);
+            m_NumCommands = std::exchange(other.m_NumCommands, 0);
+            m_SizeInBytes = std::exchange(other.m_SizeInBytes, 0);
+            other.m_Blocks.clear();
+        }
+        return *this;
+    }
+
+    void CommandStream::Reset() noexcept
+    {
+        for (auto block : m_Blocks) {
+            ReleaseBlock(block);
+        }
+        m_Blocks.clear();
+        m_NumCommands = 0;
+        m_SizeInBytes = 0;
+    }
+
+    void* CommandStream::Allocate(CommandOp op, std::size_t size)
+    {
+        ASSERT(op < CommandOp::Count);
+
+        auto commandSize = sizeof(CommandHeader) + Math::AlignUp(size, 8);
+        if (m_Blocks.empty() || m_Blocks.back()->m_Capacity - m_Blocks.back()->m_Used < commandSize) {
+            m_Blocks.emplace_back(AcquireBlock(commandSize));
+        }
+
+        auto block = m_Blocks.back();
+        auto header = reinterpret_cast<CommandHeader*>(block->GetData() + block->m_Used);
+        header->m_Op = op;
+        header->m_Size = static_cast<std::uint32_t>(commandSize);
+        block->m_Used += header->m_Size;
+
+        ++m_NumCommands;
+        m_SizeInBytes += commandSize;
+        return header + 1;
+    }
+
+    // 将一条命令翻译为原生的调用
+    static void ReplayCommand(ID3D12GraphicsCommandList* cmdList, CommandOp op, const void* payload)
+    {
+        switch (op) {
+            case CommandOp::ClearState: {
+                auto command = static_cast<const PointerCommand*>(payload);
+                cmdList->ClearState(static_cast<ID3D12PipelineState*>(command->m_Pointer));
+                break;
+            }
+            case CommandOp::DrawInstanced: {
+                auto command = static_cast<const DrawInstancedCommand*>(payload);
+                cmdList->DrawInstanced(command->m_VertexCountPerInstance, command->m_InstanceCount,
+                    command->m_StartVertexLocation, command->m_StartInstanceLocation);
+                break;
+            }
+            case CommandOp::DrawIndexedInstanced: {
+                auto command = static_cast<const DrawIndexedInstancedCommand*>(payload);
+                cmdList->DrawIndexedInstanced(command->m_IndexCountPerInstance, command->m_InstanceCount,
+                    command->m_StartIndexLocation, command->m_BaseVertexLocation, command->m_StartInstanceLocation);
+                break;
+            }
+            case CommandOp::Dispatch: {
+                auto command = static_cast<const DispatchCommand*>(payload);
+                cmdList->Dispatch(command->m_ThreadGroupCountX, command->m_ThreadGroupCountY, command->m_ThreadGroupCountZ);
+                break;
+            }
+            case CommandOp::CopyBufferRegion: {
+                auto command = static_cast<const CopyBufferRegionCommand*>(payload);
+                cmdList->CopyBufferRegion(command->m_DstBuffer, command->m_DstOffset,
+                    command->m_SrcBuffer, command->m_SrcOffset, command->m_NumBytes);
+                break;
+            }
+            case CommandOp::CopyTextureRegion: {
+                auto command = static_cast<const CopyTextureRegionCommand*>(payload);
+                cmdList->CopyTextureRegion(&command->m_Dst, command->m_DstX, command->m_DstY, command->m_DstZ,
+                    &command->m_Src, command->m_HasSrcBox ? &command->m_SrcBox : nullptr);
+                break;
+            }
+            case CommandOp::CopyResource: {
+                auto command = static_cast<const CopyBufferRegionCommand*>(payload);
+                cmdList->CopyResource(command->m_DstBuffer, command->m_SrcBuffer);
+                break;
+            }
+            case CommandOp::CopyTiles: {
+                auto command = static_cast<const CopyTilesCommand*>(payload);
+                cmdList->CopyTiles(command->m_TiledResource, &command->m_TileRegionStartCoordinate,
+                    &command->m_TileRegionSize, command->m_Buffer, command->m_BufferStartOffsetInBytes, command->m_Flags);
+                break;
+            }
+            case CommandOp::ResolveSubresource: {
+                auto command = static_cast<const ResolveSubresourceCommand*>(payload);
+                cmdList->ResolveSubresource(command->m_DstResource, command->m_DstSubresource,
+                    command->m_SrcResource, command->m_SrcSubresource, command->m_Format);
+                break;
+            }
+            case CommandOp::IASetPrimitiveTopology: {
+                auto command = static_cast<const ValueCommand*>(payload);
+                cmdList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(command->m_Value));
+                break;
+            }
+            case CommandOp::RSSetViewports: {
+                auto command = static_cast<const ArrayCommand*>(payload);
+                cmdList->RSSetViewports(command->m_Count, CommandStream::GetExtraData<const D3D12_VIEWPORT>(command));
+                break;
+            }
+            case CommandOp::RSSetScissorRects: {
+                auto command = static_cast<const ArrayCommand*>(payload);
+                cmdList->RSSetScissorRects(command->m_Count, CommandStream::GetExtraData<const D3D12_RECT>(command));
+                break;
+            }
+            case CommandOp::OMSetBlendFactor: {
+                auto command = static_cast<const BlendFactorCommand*>(payload);
+                cmdList->OMSetBlendFactor(command->m_BlendFactor);
+                break;
+            }
+            case CommandOp::OMSetStencilRef: {
+                auto command = static_cast<const ValueCommand*>(payload);
+                cmdList->OMSetStencilRef(command->m_Value);
+                break;
+            }
+            case CommandOp::SetPipelineState: {
+                auto command = static_cast<const PointerCommand*>(payload);
+                cmdList->SetPipelineState(static_cast<ID3D12PipelineState*>(command->m_Pointer));
+                break;
+            }
+            case CommandOp::ResourceBarrier: {
+                auto command = static_cast<const ArrayCommand*>(payload);
+                cmdList->ResourceBarrier(command->m_Count, CommandStream::GetExtraData<const D3D12_RESOURCE_BARRIER>(command));
+                break;
+            }
+            case CommandOp::ExecuteBundle: {
+                auto command = static_cast<const PointerCommand*>(payload);
+                cmdList->ExecuteBundle(static_cast<ID3D12GraphicsCommandList*>(command->m_Pointer));
+                break;
+            }
+            case CommandOp::SetDescriptorHeaps: {
+                auto command = static_cast<const ArrayCommand*>(payload);
+                cmdList->SetDescriptorHeaps(command->m_Count, CommandStream::GetExtraData<ID3D12DescriptorHeap* const>(command));
+                break;
+            }
+            case CommandOp::SetComputeRootSignature: {
+                auto command = static_cast<const PointerCommand*>(payload);
+                cmdList->SetComputeRootSignature(static_cast<ID3D12RootSignature*>(command->m_Pointer));
+                break;
+            }
+            case CommandOp::SetGraphicsRootSignature: {
+                auto command = static_cast<const PointerCommand*>(payload);
+                cmdList->SetGraphicsRootSignature(static_cast<ID3D12RootSignature*>(command->m_Pointer));
+                break;
+            }
+            case CommandOp::SetComputeRootDescriptorTable: {
+                auto command = static_cast<const RootDescriptorTableCommand*>(payload);
+                cmdList->SetComputeRootDescriptorTable(command->m_RootParameterIndex, command->m_BaseDescriptor);
+                break;
+            }
+            case CommandOp::SetGraphicsRootDescriptorTable: {
+                auto command = static_cast<const RootDescriptorTableCommand*>(payload);
+                cmdList->SetGraphicsRootDescriptorTable(command->m_RootParameterIndex, command->m_BaseDescriptor);
+                break;
+            }
+            case CommandOp::SetComputeRoot32BitConstant: {
+                auto command = static_cast<const Root32BitConstantCommand*>(payload);
+                cmdList->SetComputeRoot32BitConstant(command->m_RootParameterIndex,
+                    command->m_SrcData, command->m_DestOffsetIn32BitValues);
+                break;
+            }
+            case CommandOp::SetGraphicsRoot32BitConstant: {
+                auto command = static_cast<const Root32BitConstantCommand*>(payload);
+                cmdList->SetGraphicsRoot32BitConstant(command->m_RootParameterIndex,
+                    command->m_SrcData, command->m_DestOffsetIn32BitValues);
+                break;
+            }
+            case CommandOp::SetComputeRoot32BitConstants: {
+                auto command = static_cast<const Root32BitConstantsCommand*>(payload);
+                cmdList->SetComputeRoot32BitConstants(command->m_RootParameterIndex, command->m_Num32BitValuesToSet,
+                    CommandStream::GetExtraData<const UINT>(command), command->m_DestOffsetIn32BitValues);
+                break;
+            }
+            case CommandOp::SetGraphicsRoot32BitConstants: {
+                auto command = static_cast<const Root32BitConstantsCommand*>(payload);
+                cmdList->SetGraphicsRoot32BitConstants(command->m_RootParameterIndex, command->m_Num32BitValuesToSet,
+                    CommandStream::GetExtraData<const UINT>(command), command->m_DestOffsetIn32BitValues);
+                break;
+            }
+            case CommandOp::SetComputeRootConstantBufferView: {
+                auto command = static_cast<const RootDescriptorCommand*>(payload);
+                cmdList->SetComputeRootConstantBufferView(command->m_RootParameterIndex, command->m_BufferLocation);
+                break;
+            }
+            case CommandOp::SetGraphicsRootConstantBufferView: {
+                auto command = static_cast<const RootDescriptorCommand*>(payload);
+                cmdList->SetGraphicsRootConstantBufferView(command->m_RootParameterIndex, command->m_BufferLocation);
+                break;
+            }
+            case CommandOp::SetComputeRootShaderResourceView: {
+                auto command = static_cast<const RootDescriptorCommand*>(payload);
+                cmdList->SetComputeRootShaderResourceView(command->m_RootParameterIndex, command->m_BufferLocation);
+                break;
+            }
+            case CommandOp::SetGraphicsRootShaderResourceView: {
+                auto command = static_cast<const RootDescriptorCommand*>(payload);
+                cmdList->SetGraphicsRootShaderResourceView(command->m_RootParameterIndex, command->m_BufferLocation);
+                break;
+            }
+            case CommandOp::SetComputeRootUnorderedAccessView: {
+                auto command = static_cast<const RootDescriptorCommand*>(payload);
+                cmdList->SetComputeRootUnorderedAccessView(command->m_RootParameterIndex, command->m_BufferLocation);
+                break;
+            }
+            case CommandOp::SetGraphicsRootUnorderedAccessView: {
+                auto command = static_cast<const RootDescriptorCommand*>(payload);
+                cmdList->SetGraphicsRootUnorderedAccessView(command->m_RootParameterIndex, command->m_BufferLocation);
+                break;
+            }
+            case CommandOp::IASetIndexBuffer: {
+                auto command = static_cast<const IndexBufferCommand*>(payload);
+                cmdList->IASetIndexBuffer(command->m_HasView ? &command->m_View : nullptr);
+                break;
+            }
+            case CommandOp::IASetVertexBuffers: {
+                auto command = static_cast<const BufferViewsCommand*>(payload);
+                cmdList->IASetVertexBuffers(command->m_StartSlot, command->m_NumViews,
+                    command->m_HasViews ? CommandStream::GetExtraData<const D3D12_VERTEX_BUFFER_VIEW>(command) : nullptr);
+                break;
+            }
+            case CommandOp::SOSetTargets: {
+                auto command = static_cast<const BufferViewsCommand*>(payload);
+                cmdList->SOSetTargets(command->m_StartSlot, command->m_NumViews,
+                    command->m_HasViews ? CommandStream::GetExtraData<const D3D12_STREAM_OUTPUT_BUFFER_VIEW>(command) : nullptr);
+                break;
+            }
+            case CommandOp::OMSetRenderTargets: {
+                auto command = static_cast<const RenderTargetsCommand*>(payload);
+                cmdList->OMSetRenderTargets(command->m_NumRenderTargetDescriptors,
+                    command->m_NumHandles > 0 ? CommandStream::GetExtraData<const D3D12_CPU_DESCRIPTOR_HANDLE>(command) : nullptr,
+                    command->m_RTsSingleHandleToDescriptorRange,
+                    command->m_HasDepthStencil ? &command->m_DepthStencilDescriptor : nullptr);
+                break;
+            }
+            case CommandOp::ClearDepthStencilView: {
+                auto command = static_cast<const ClearDepthStencilCommand*>(payload);
+                cmdList->ClearDepthStencilView(command->m_DepthStencilView, command->m_ClearFlags,
+                    command->m_Depth, command->m_Stencil, command->m_NumRects,
+                    command->m_NumRects > 0 ? CommandStream::GetExtraData<const D3D12_RECT>(command) : nullptr);
+                break;
+            }
+            case CommandOp::ClearRenderTargetView: {
+                auto command = static_cast<const ClearRenderTargetCommand*>(payload);
+                cmdList->ClearRenderTargetView(command->m_RenderTargetView, command->m_ColorRGBA, command->m_NumRects,
+                    command->m_NumRects > 0 ? CommandStream::GetExtraData<const D3D12_RECT>(command) : nullptr);
+                break;
+            }
+            case CommandOp::ClearUnorderedAccessViewUint: {
+                auto command = static_cast<const ClearUnorderedAccessCommand*>(payload);
+                cmdList->ClearUnorderedAccessViewUint(command->m_ViewGPUHandleInCurrentHeap, command->m_ViewCPUHandle,
+                    command->m_Resource, command->m_Values, command->m_NumRects,
+                    command->m_NumRects > 0 ? CommandStream::GetExtraData<const D3D12_RECT>(command) : nullptr);
+                break;
+            }
+            case CommandOp::ClearUnorderedAccessViewFloat: {
+                auto command = static_cast<const ClearUnorderedAccessCommand*>(payload);
+                cmdList->ClearUnorderedAccessViewFloat(command->m_ViewGPUHandleInCurrentHeap, command->m_ViewCPUHandle,
+                    command->m_Resource, reinterpret_cast<const FLOAT*>(command->m_Values), command->m_NumRects,
+                    command->m_NumRects > 0 ? CommandStream::GetExtraData<const D3D12_RECT>(command) : nullptr);
+                break;
+            }
+            case CommandOp::DiscardResource: {
+                auto command = static_cast<const DiscardResourceCommand*>(payload);
+                D3D12_DISCARD_REGION region{};
+                region.NumRects = command->m_NumRects;
+                region.pRects = command->m_NumRects > 0 ? CommandStream::GetExtraData<const D3D12_RECT>(command) : nullptr;
+                region.FirstSubresource = command->m_FirstSubresource;
+                region.NumSubresources = command->m_NumSubresources;
+                cmdList->DiscardResource(command->m_Resource, command->m_HasRegion ? &region : nullptr);
+                break;
+            }
+            case CommandOp::BeginQuery: {
+                auto command = static_cast<const QueryCommand*>(payload);
+                cmdList->BeginQuery(command->m_QueryHeap, command->m_Type, command->m_Index);
+                break;
+            }
+            case CommandOp::EndQuery: {
+                auto command = static_cast<const QueryCommand*>(payload);
+                cmdList->EndQuery(command->m_QueryHeap, command->m_Type, command->m_Index);
+                break;
+            }
+            case CommandOp::ResolveQueryData: {
+                auto command = static_cast<const ResolveQueryDataCommand*>(payload);
+                cmdList->ResolveQueryData(command->m_QueryHeap, command->m_Type, command->m_StartIndex,
+                    command->m_NumQueries, command->m_DestinationBuffer, command->m_AlignedDestinationBufferOffset);
+                break;
+            }
+            case CommandOp::SetPredication: {
+                auto command = static_cast<const SetPredicationCommand*>(payload);
+                cmdList->SetPredication(command->m_Buffer, command->m_AlignedBufferOffset, command->m_Operation);
+                break;
+            }
+            case CommandOp::SetMarker: {
+                auto command = static_cast<const EventCommand*>(payload);
+                cmdList->SetMarker(command->m_Metadata,
+                    command->m_Size > 0 ? CommandStream::GetExtraData<const std::byte>(command) : nullptr, command->m_Size);
+                break;
+            }
+            case CommandOp::BeginEvent: {
+                auto command = static_cast<const EventCommand*>(payload);
+                cmdList->BeginEvent(command->m_Metadata,
+                    command->m_Size > 0 ? CommandStream::GetExtraData<const std::byte>(command) : nullptr, command->m_Size);
+                break;
+            }
+            case CommandOp::EndEvent: {
+                cmdList->EndEvent();
+                break;
+            }
+            case CommandOp::ExecuteIndirect: {
+                auto command = static_cast<const ExecuteIndirectCommand*>(payload);
+                cmdList->ExecuteIndirect(command->m_CommandSignature, command->m_MaxCommandCount,
+                    command->m_ArgumentBuffer, command->m_ArgumentBufferOffset,
+                    command->m_CountBuffer, command->m_CountBufferOffset);
+                break;
+            }
+            default:
+                ASSERT(false, "Unknown command in CommandStream");
+                break;
+        }
+    }
+
+    void CommandStream::Replay(ID3D12GraphicsCommandList* cmdList) const
+    {
+        ASSERT(cmdList != nullptr);
+
+        for (auto block : m_Blocks) {
+            auto data = block->GetData();
+            for (std::uint32_t offset = 0; offset < block->m_Used;) {
+                auto header = reinterpret_cast<const CommandHeader*>(data + offset);
+                ReplayCommand(cmdList, header->m_Op, header + 1);
+                offset += header->m_Size;
+            }
+        }
+    }
+
+
+    //
+    // 写入命令流的命令列表
+    //
+    class CommandStreamList : public ID3D12GraphicsCommandList
+    {
+    public:
+        CommandStreamList(CommandStream& stream, D3D12_COMMAND_LIST_TYPE type)
+            :m_Stream(stream), m_Type(type) {}
+        virtual ~CommandStreamList() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(CommandStreamList);
+
+        // IUnknown
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+        {
+            if (ppvObject == nullptr) return E_POINTER;
+
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D12Object) ||
+                riid == __uuidof(ID3D12DeviceChild) || riid == __uuidof(ID3D12CommandList) ||
+                riid == __uuidof(ID3D12GraphicsCommandList)) {
+                *ppvObject = static_cast<ID3D12GraphicsCommandList*>(this);
+                AddRef();
+                return S_OK;
+            }
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return ++m_RefCount;
+        }
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            auto refCount = --m_RefCount;
+            if (refCount == 0) {
+                delete this;
+            }
+            return refCount;
+        }
+
+        // ID3D12Object
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID guid, UINT* pDataSize, void* pData) override
+        {
+            return DXGI_ERROR_NOT_FOUND;
+        }
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID guid, UINT DataSize, const void* pData) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID guid, const IUnknown* pData) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE SetName(LPCWSTR Name) override { return S_OK; }
+
+        // ID3D12DeviceChild
+        HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override
+        {
+            return g_RenderContext.GetDevice()->QueryInterface(riid, ppvDevice);
+        }
+
+        // ID3D12CommandList
+        D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return m_Type; }
+
+        // ID3D12GraphicsCommandList
+        HRESULT STDMETHODCALLTYPE Close() override { return S_OK; }
+        // 命令流翻译到原生命令列表后才会提交，因此无需关闭即可重置
+        HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* pInitialState) override
+        {
+            m_Stream.Reset();
+            if (pInitialState != nullptr) {
+                SetPipelineState(pInitialState);
+            }
+            return S_OK;
+        }
+        void STDMETHODCALLTYPE ClearState(ID3D12PipelineState* pPipelineState) override
+        {
+            m_Stream.Write<PointerCommand>(CommandOp::ClearState)->m_Pointer = pPipelineState;
+        }
+        void STDMETHODCALLTYPE DrawInstanced(
+            UINT VertexCountPerInstance,
+            UINT InstanceCount,
+            UINT StartVertexLocation,
+            UINT StartInstanceLocation) override
+        {
+            *m_Stream.Write<DrawInstancedCommand>(CommandOp::DrawInstanced) = {
+                VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation};
+        }
+        void STDMETHODCALLTYPE DrawIndexedInstanced(
+            UINT IndexCountPerInstance,
+            UINT InstanceCount,
+            UINT StartIndexLocation,
+            INT BaseVertexLocation,
+            UINT StartInstanceLocation) override
+        {
+            *m_Stream.Write<DrawIndexedInstancedCommand>(CommandOp::DrawIndexedInstanced) = {
+                IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation};
+        }
+        void STDMETHODCALLTYPE Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY, UINT ThreadGroupCountZ) override
+        {
+            *m_Stream.Write<DispatchCommand>(CommandOp::Dispatch) = {ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ};
+        }
+        void STDMETHODCALLTYPE CopyBufferRegion(
+            ID3D12Resource* pDstBuffer,
+            UINT64 DstOffset,
+            ID3D12Resource* pSrcBuffer,
+            UINT64 SrcOffset,
+            UINT64 NumBytes) override
+        {
+            *m_Stream.Write<CopyBufferRegionCommand>(CommandOp::CopyBufferRegion) = {
+                pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes};
+        }
+        void STDMETHODCALLTYPE CopyTextureRegion(
+            const D3D12_TEXTURE_COPY_LOCATION* pDst,
+            UINT DstX,
+            UINT DstY,
+            UINT DstZ,
+            const D3D12_TEXTURE_COPY_LOCATION* pSrc,
+            const D3D12_BOX* pSrcBox) override
+        {
+            auto command = m_Stream.Write<CopyTextureRegionCommand>(CommandOp::CopyTextureRegion);
+            command->m_Dst = *pDst;
+            command->m_Src = *pSrc;
+            command->m_DstX = DstX;
+            command->m_DstY = DstY;
+            command->m_DstZ = DstZ;
+            command->m_HasSrcBox = pSrcBox != nullptr;
+            if (pSrcBox != nullptr) {
+                command->m_SrcBox = *pSrcBox;
+            }
+        }
+        void STDMETHODCALLTYPE CopyResource(ID3D12Resource* pDstResource, ID3D12Resource* pSrcResource) override
+        {
+            auto command = m_Stream.Write<CopyBufferRegionCommand>(CommandOp::CopyResource);
+            command->m_DstBuffer = pDstResource;
+            command->m_SrcBuffer = pSrcResource;
+        }
+        void STDMETHODCALLTYPE CopyTiles(
+            ID3D12Resource* pTiledResource,
+            const D3D12_TILED_RESOURCE_COORDINATE* pTileRegionStartCoordinate,
+            const D3D12_TILE_REGION_SIZE* pTileRegionSize,
+            ID3D12Resource* pBuffer,
+            UINT64 BufferStartOffsetInBytes,
+            D3D12_TILE_COPY_FLAGS Flags) override
+        {
+            *m_Stream.Write<CopyTilesCommand>(CommandOp::CopyTiles) = {
+                pTiledResource, pBuffer, BufferStartOffsetInBytes,
+                *pTileRegionStartCoordinate, *pTileRegionSize, Flags};
+        }
+        void STDMETHODCALLTYPE ResolveSubresource(
+            ID3D12Resource* pDstResource,
+            UINT DstSubresource,
+            ID3D12Resource* pSrcResource,
+            UINT SrcSubresource,
+            DXGI_FORMAT Format) override
+        {
+            *m_Stream.Write<ResolveSubresourceCommand>(CommandOp::ResolveSubresource) = {
+                pDstResource, pSrcResource, DstSubresource, SrcSubresource, Format};
+        }
+        void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY PrimitiveTopology) override
+        {
+            m_Stream.Write<ValueCommand>(CommandOp::IASetPrimitiveTopology)->m_Value = static_cast<UINT>(PrimitiveTopology);
+        }
+        void STDMETHODCALLTYPE RSSetViewports(UINT NumViewports, const D3D12_VIEWPORT* pViewports) override
+        {
+            WriteArray(CommandOp::RSSetViewports, NumViewports, pViewports);
+        }
+        void STDMETHODCALLTYPE RSSetScissorRects(UINT NumRects, const D3D12_RECT* pRects) override
+        {
+            WriteArray(CommandOp::RSSetScissorRects, NumRects, pRects);
+        }
+        void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT BlendFactor[4]) override
+        {
+            auto command = m_Stream.Write<BlendFactorCommand>(CommandOp::OMSetBlendFactor);
+            // 为空时等同于全为 1
+            for (int i = 0; i < 4; ++i) {
+                command->m_BlendFactor[i] = BlendFactor != nullptr ? BlendFactor[i] : 1.0f;
+            }
+        }
+        void STDMETHODCALLTYPE OMSetStencilRef(UINT StencilRef) override
+        {
+            m_Stream.Write<ValueCommand>(CommandOp::OMSetStencilRef)->m_Value = StencilRef;
+        }
+        void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* pPipelineState) override
+        {
+            m_Stream.Write<PointerCommand>(CommandOp::SetPipelineState)->m_Pointer = pPipelineState;
+        }
+        void STDMETHODCALLTYPE ResourceBarrier(UINT NumBarriers, const D3D12_RESOURCE_BARRIER* pBarriers) override
+        {
+            WriteArray(CommandOp::ResourceBarrier, NumBarriers, pBarriers);
+        }
+        void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList* pCommandList) override
+        {
+            m_Stream.Write<PointerCommand>(CommandOp::ExecuteBundle)->m_Pointer = pCommandList;
+        }
+        void STDMETHODCALLTYPE SetDescriptorHeaps(UINT NumDescriptorHeaps, ID3D12DescriptorHeap* const* ppDescriptorHeaps) override
+        {
+            WriteArray(CommandOp::SetDescriptorHeaps, NumDescriptorHeaps, ppDescriptorHeaps);
+        }
+        void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature* pRootSignature) override
+        {
+            m_Stream.Write<PointerCommand>(CommandOp::SetComputeRootSignature)->m_Pointer = pRootSignature;
+        }
+        void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* pRootSignature) override
+        {
+            m_Stream.Write<PointerCommand>(CommandOp::SetGraphicsRootSignature)->m_Pointer = pRootSignature;
+        }
+        void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+        {
+            *m_Stream.Write<RootDescriptorTableCommand>(CommandOp::SetComputeRootDescriptorTable) = {BaseDescriptor, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+        {
+            *m_Stream.Write<RootDescriptorTableCommand>(CommandOp::SetGraphicsRootDescriptorTable) = {BaseDescriptor, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues) override
+        {
+            *m_Stream.Write<Root32BitConstantCommand>(CommandOp::SetComputeRoot32BitConstant) = {
+                RootParameterIndex, SrcData, DestOffsetIn32BitValues};
+        }
+        void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues) override
+        {
+            *m_Stream.Write<Root32BitConstantCommand>(CommandOp::SetGraphicsRoot32BitConstant) = {
+                RootParameterIndex, SrcData, DestOffsetIn32BitValues};
+        }
+        void STDMETHODCALLTYPE SetComputeRoot32BitConstants(
+            UINT RootParameterIndex,
+            UINT Num32BitValuesToSet,
+            const void* pSrcData,
+            UINT DestOffsetIn32BitValues) override
+        {
+            WriteConstants(CommandOp::SetComputeRoot32BitConstants,
+                RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+        }
+        void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(
+            UINT RootParameterIndex,
+            UINT Num32BitValuesToSet,
+            const void* pSrcData,
+            UINT DestOffsetIn32BitValues) override
+        {
+            WriteConstants(CommandOp::SetGraphicsRoot32BitConstants,
+                RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+        }
+        void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            *m_Stream.Write<RootDescriptorCommand>(CommandOp::SetComputeRootConstantBufferView) = {BufferLocation, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            *m_Stream.Write<RootDescriptorCommand>(CommandOp::SetGraphicsRootConstantBufferView) = {BufferLocation, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            *m_Stream.Write<RootDescriptorCommand>(CommandOp::SetComputeRootShaderResourceView) = {BufferLocation, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            *m_Stream.Write<RootDescriptorCommand>(CommandOp::SetGraphicsRootShaderResourceView) = {BufferLocation, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            *m_Stream.Write<RootDescriptorCommand>(CommandOp::SetComputeRootUnorderedAccessView) = {BufferLocation, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            *m_Stream.Write<RootDescriptorCommand>(CommandOp::SetGraphicsRootUnorderedAccessView) = {BufferLocation, RootParameterIndex};
+        }
+        void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* pView) override
+        {
+            auto command = m_Stream.Write<IndexBufferCommand>(CommandOp::IASetIndexBuffer);
+            command->m_HasView = pView != nullptr;
+            if (pView != nullptr) {
+                command->m_View = *pView;
+            }
+        }
+        void STDMETHODCALLTYPE IASetVertexBuffers(UINT StartSlot, UINT NumViews, const D3D12_VERTEX_BUFFER_VIEW* pViews) override
+        {
+            WriteBufferViews(CommandOp::IASetVertexBuffers, StartSlot, NumViews, pViews);
+        }
+        void STDMETHODCALLTYPE SOSetTargets(UINT StartSlot, UINT NumViews, const D3D12_STREAM_OUTPUT_BUFFER_VIEW* pViews) override
+        {
+            WriteBufferViews(CommandOp::SOSetTargets, StartSlot, NumViews, pViews);
+        }
+        void STDMETHODCALLTYPE OMSetRenderTargets(
+            UINT NumRenderTargetDescriptors,
+            const D3D12_CPU_DESCRIPTOR_HANDLE* pRenderTargetDescriptors,
+            BOOL RTsSingleHandleToDescriptorRange,
+            const D3D12_CPU_DESCRIPTOR_HANDLE* pDepthStencilDescriptor) override
+        {
+            // 连续的描述符只需记录第一个
+            UINT numHandles = pRenderTargetDescriptors == nullptr ? 0 :
+                RTsSingleHandleToDescriptorRange ? std::min(NumRenderTargetDescriptors, 1u) : NumRenderTargetDescriptors;
+            auto command = m_Stream.Write<RenderTargetsCommand>(
+                CommandOp::OMSetRenderTargets, numHandles * sizeof(D3D12_CPU_DESCRIPTOR_HANDLE));
+            command->m_NumRenderTargetDescriptors = NumRenderTargetDescriptors;
+            command->m_NumHandles = numHandles;
+            command->m_RTsSingleHandleToDescriptorRange = RTsSingleHandleToDescriptorRange;
+            command->m_HasDepthStencil = pDepthStencilDescriptor != nullptr;
+            if (pDepthStencilDescriptor != nullptr) {
+                command->m_DepthStencilDescriptor = *pDepthStencilDescriptor;
+            }
+            std::copy_n(pRenderTargetDescriptors, numHandles,
+                CommandStream::GetExtraData<D3D12_CPU_DESCRIPTOR_HANDLE>(command));
+        }
+        void STDMETHODCALLTYPE ClearDepthStencilView(
+            D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView,
+            D3D12_CLEAR_FLAGS ClearFlags,
+            FLOAT Depth,
+            UINT8 Stencil,
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            auto command = m_Stream.Write<ClearDepthStencilCommand>(CommandOp::ClearDepthStencilView, NumRects * sizeof(D3D12_RECT));
+            command->m_DepthStencilView = DepthStencilView;
+            command->m_ClearFlags = ClearFlags;
+            command->m_Depth = Depth;
+            command->m_Stencil = Stencil;
+            command->m_NumRects = NumRects;
+            std::copy_n(pRects, NumRects, CommandStream::GetExtraData<D3D12_RECT>(command));
+        }
+        void STDMETHODCALLTYPE ClearRenderTargetView(
+            D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView,
+            const FLOAT ColorRGBA[4],
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            auto command = m_Stream.Write<ClearRenderTargetCommand>(CommandOp::ClearRenderTargetView, NumRects * sizeof(D3D12_RECT));
+            command->m_RenderTargetView = RenderTargetView;
+            std::copy_n(ColorRGBA, 4, command->m_ColorRGBA);
+            command->m_NumRects = NumRects;
+            std::copy_n(pRects, NumRects, CommandStream::GetExtraData<D3D12_RECT>(command));
+        }
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(
+            D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+            D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+            ID3D12Resource* pResource,
+            const UINT Values[4],
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            WriteClearUAV(CommandOp::ClearUnorderedAccessViewUint,
+                ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource, Values, NumRects, pRects);
+        }
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(
+            D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+            D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+            ID3D12Resource* pResource,
+            const FLOAT Values[4],
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            WriteClearUAV(CommandOp::ClearUnorderedAccessViewFloat,
+                ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource, Values, NumRects, pRects);
+        }
+        void STDMETHODCALLTYPE DiscardResource(ID3D12Resource* pResource, const D3D12_DISCARD_REGION* pRegion) override
+        {
+            UINT numRects = pRegion != nullptr && pRegion->pRects != nullptr ? pRegion->NumRects : 0;
+            auto command = m_Stream.Write<DiscardResourceCommand>(CommandOp::DiscardResource, numRects * sizeof(D3D12_RECT));
+            command->m_Resource = pResource;
+            command->m_HasRegion = pRegion != nullptr;
+            if (pRegion != nullptr) {
+                command->m_FirstSubresource = pRegion->FirstSubresource;
+                command->m_NumSubresources = pRegion->NumSubresources;
+                command->m_NumRects = numRects;
+                std::copy_n(pRegion->pRects, numRects, CommandStream::GetExtraData<D3D12_RECT>(command));
+            }
+        }
+        void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+        {
+            *m_Stream.Write<QueryCommand>(CommandOp::BeginQuery) = {pQueryHeap, Type, Index};
+        }
+        void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+        {
+            *m_Stream.Write<QueryCommand>(CommandOp::EndQuery) = {pQueryHeap, Type, Index};
+        }
+        void STDMETHODCALLTYPE ResolveQueryData(
+            ID3D12QueryHeap* pQueryHeap,
+            D3D12_QUERY_TYPE Type,
+            UINT StartIndex,
+            UINT NumQueries,
+            ID3D12Resource* pDestinationBuffer,
+            UINT64 AlignedDestinationBufferOffset) override
+        {
+            *m_Stream.Write<ResolveQueryDataCommand>(CommandOp::ResolveQueryData) = {
+                pQueryHeap, pDestinationBuffer, AlignedDestinationBufferOffset, Type, StartIndex, NumQueries};
+        }
+        void STDMETHODCALLTYPE SetPredication(ID3D12Resource* pBuffer, UINT64 AlignedBufferOffset, D3D12_PREDICATION_OP Operation) override
+        {
+            *m_Stream.Write<SetPredicationCommand>(CommandOp::SetPredication) = {pBuffer, AlignedBufferOffset, Operation};
+        }
+        void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override
+        {
+            WriteEvent(CommandOp::SetMarker, Metadata, pData, Size);
+        }
+        void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override
+        {
+            WriteEvent(CommandOp::BeginEvent, Metadata, pData, Size);
+        }
+        void STDMETHODCALLTYPE EndEvent() override
+        {
+            m_Stream.Write<EmptyCommand>(CommandOp::EndEvent);
+        }
+        void STDMETHODCALLTYPE ExecuteIndirect(
+            ID3D12CommandSignature* pCommandSignature,
+            UINT MaxCommandCount,
+            ID3D12Resource* pArgumentBuffer,
+            UINT64 ArgumentBufferOffset,
+            ID3D12Resource* pCountBuffer,
+            UINT64 CountBufferOffset) override
+        {
+            *m_Stream.Write<ExecuteIndirectCommand>(CommandOp::ExecuteIndirect) = {
+                pCommandSignature, pArgumentBuffer, ArgumentBufferOffset, pCountBuffer, CountBufferOffset, MaxCommandCount};
+        }
+
+    private:
+        template <typename T>
+        void WriteArray(CommandOp op, UINT count, const T* data)
+        {
+            auto command = m_Stream.Write<ArrayCommand>(op, count * sizeof(T));
+            command->m_Count = count;
+            std::copy_n(data, count, CommandStream::GetExtraData<std::remove_const_t<T>>(command));
+        }
+        template <typename T>
+        void WriteBufferViews(CommandOp op, UINT startSlot, UINT numViews, const T* views)
+        {
+            auto numCopied = views != nullptr ? numViews : 0;
+            auto command = m_Stream.Write<BufferViewsCommand>(op, numCopied * sizeof(T));
+            command->m_StartSlot = startSlot;
+            command->m_NumViews = numViews;
+            command->m_HasViews = views != nullptr;
+            std::copy_n(views, numCopied, CommandStream::GetExtraData<T>(command));
+        }
+        void WriteConstants(CommandOp op, UINT rootIndex, UINT numValues, const void* data, UINT destOffset)
+        {
+            auto command = m_Stream.Write<Root32BitConstantsCommand>(op, numValues * sizeof(UINT));
+            *command = {rootIndex, numValues, destOffset};
+            memcpy(CommandStream::GetExtraData<UINT>(command), data, numValues * sizeof(UINT));
+        }
+        template <typename T>
+        void WriteClearUAV(
+            CommandOp op,
+            D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle,
+            D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle,
+            ID3D12Resource* resource,
+            const T values[4],
+            UINT numRects,
+            const D3D12_RECT* rects)
+        {
+            static_assert(sizeof(T) == sizeof(UINT));
+            auto command = m_Stream.Write<ClearUnorderedAccessCommand>(op, numRects * sizeof(D3D12_RECT));
+            command->m_ViewGPUHandleInCurrentHeap = gpuHandle;
+            command->m_ViewCPUHandle = cpuHandle;
+            command->m_Resource = resource;
+            memcpy(command->m_Values, values, sizeof(command->m_Values));
+            command->m_NumRects = numRects;
+            std::copy_n(rects, numRects, CommandStream::GetExtraData<D3D12_RECT>(command));
+        }
+        void WriteEvent(CommandOp op, UINT metadata, const void* data, UINT size)
+        {
+            auto dataSize = data != nullptr ? size : 0;
+            auto command = m_Stream.Write<EventCommand>(op, dataSize);
+            *command = {metadata, dataSize};
+            if (dataSize > 0) {
+                memcpy(CommandStream::GetExtraData<std::byte>(command), data, dataSize);
+            }
+        }
+
+    private:
+        std::atomic<ULONG> m_RefCount{1};
+        CommandStream& m_Stream;
+        const D3D12_COMMAND_LIST_TYPE m_Type;
+    };
+
+    HRESULT CreateCommandStreamList(CommandStream& stream, D3D12_COMMAND_LIST_TYPE type, REFIID riid, void** ppCmdList)
+    {
+        auto pCmdList = new CommandStreamList(stream, type);
+        HRESULT hr = pCmdList->QueryInterface(riid, ppCmdList);
+        pCmdList->Release();
+        return hr;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#ifndef __COMMANDSTREAM_H__
+#define __COMMANDSTREAM_H__
+
+#include "../../pch.h"
+#include "../../Utilities/Macros.h"
+
+namespace DSM {
+    struct CommandStreamBlock;
+
+    // 命令流中的命令类型，与 ID3D12GraphicsCommandList 的接口一一对应
+    enum class CommandOp : std::uint32_t
+    {
+        ClearState,
+        DrawInstanced,
+        DrawIndexedInstanced,
+        Dispatch,
+        CopyBufferRegion,
+        CopyTextureRegion,
+        CopyResource,
+        CopyTiles,
+        ResolveSubresource,
+        IASetPrimitiveTopology,
+        RSSetViewports,
+        RSSetScissorRects,
+        OMSetBlendFactor,
+        OMSetStencilRef,
+        SetPipelineState,
+        ResourceBarrier,
+        ExecuteBundle,
+        SetDescriptorHeaps,
+        SetComputeRootSignature,
+        SetGraphicsRootSignature,
+        SetComputeRootDescriptorTable,
+        SetGraphicsRootDescriptorTable,
+        SetComputeRoot32BitConstant,
+        SetGraphicsRoot32BitConstant,
+        SetComputeRoot32BitConstants,
+        SetGraphicsRoot32BitConstants,
+        SetComputeRootConstantBufferView,
+        SetGraphicsRootConstantBufferView,
+        SetComputeRootShaderResourceView,
+        SetGraphicsRootShaderResourceView,
+        SetComputeRootUnorderedAccessView,
+        SetGraphicsRootUnorderedAccessView,
+        IASetIndexBuffer,
+        IASetVertexBuffers,
+        SOSetTargets,
+        OMSetRenderTargets,
+        ClearDepthStencilView,
+        ClearRenderTargetView,
+        ClearUnorderedAccessViewUint,
+        ClearUnorderedAccessViewFloat,
+        DiscardResource,
+        BeginQuery,
+        EndQuery,
+        ResolveQueryData,
+        SetPredication,
+        SetMarker,
+        BeginEvent,
+        EndEvent,
+        ExecuteIndirect,
+        Count
+    };
+
+    /// <summary>
+    /// 紧凑的 CPU 端命令流，每条命令由命令头与参数组成，按 8 字节对齐连续存放
+    /// 内存块取自当前线程的缓存，录制时无需加锁，清空后归还给清空的线程
+    /// 只记录资源等对象的指针而不持有引用，回放时需保证其仍然有效
+    /// OMSetRenderTargets、ClearRenderTargetView 与 ClearDepthStencilView 只记录 CPU 描述符句柄，
+    /// 描述符的内容在回放时才读取，回放前不能释放或改写这些描述符
+    /// 回放不会修改命令流，同一命令流可以在任意线程多次回放
+    /// </summary>
+    class CommandStream
+    {
+    public:
+        // 内存块的大小，超过该大小的命令单独分配
+        inline static constexpr std::uint32_t BLOCK_SIZE = 64 * 1024;
+
+        CommandStream() = default;
+        ~CommandStream() { Reset(); }
+        CommandStream(CommandStream&& other) noexcept;
+        CommandStream& operator=(CommandStream&& other) noexcept;
+        DSM_NONCOPYABLE(CommandStream);
+
+        // 写入一条命令，参数之后附带 extraSize 字节的数组，通过 GetExtraData 访问
+        template <typename T>
+        T* Write(CommandOp op, std::size_t extraSize = 0)
+        {
+            static_assert(alignof(T) <= 8 && sizeof(T) % 8 == 0);
+            return new(Allocate(op, sizeof(T) + extraSize)) T{};
+        }
+        template <typename U, typename T>
+        static U* GetExtraData(T* payload) noexcept
+        {
+            return reinterpret_cast<U*>(payload + 1);
+        }
+
+        // 将所有命令按顺序写入 cmdList，cmdList 需处于录制状态
+        void Replay(ID3D12GraphicsCommandList* cmdList) const;
+        // 清空命令并归还内存块
+        void Reset() noexcept;
+
+        bool Empty() const noexcept { return m_NumCommands == 0; }
+        std::uint64_t GetNumCommands() const noexcept { return m_NumCommands; }
+        std::uint64_t GetSizeInBytes() const noexcept { return m_SizeInBytes; }
+
+    private:
+        void* Allocate(CommandOp op, std::size_t size);
+
+    private:
+        std::vector<CommandStreamBlock*> m_Blocks{};
+        std::uint64_t m_NumCommands{};
+        std::uint64_t m_SizeInBytes{};
+    };
+
+    // 创建将命令写入 stream 的命令列表，接口与 D3D12 命令列表一致，Reset 时清空 stream
+    // 命令列表不持有 stream，使用期间需保证其有效
+    HRESULT CreateCommandStreamList(CommandStream& stream, D3D12_COMMAND_LIST_TYPE type, REFIID riid, void** ppCmdList);
+}
+
+#endif
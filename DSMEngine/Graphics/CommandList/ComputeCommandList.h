@@ -12,8 +12,8 @@ namespace DSM {
     class ComputeCommandList : public CommandList
     {
     public:
-        ComputeCommandList(const std::wstring& id, bool async = false)
-            :CommandList(id, async ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT){}
+        ComputeCommandList(const std::wstring& id, bool async = false, bool deferred = false)
+            :CommandList(id, async ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT, deferred){}
         
         void SetRootSignature(const RootSignature& rootSig);
 
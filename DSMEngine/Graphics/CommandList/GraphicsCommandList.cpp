@@ -23,6 +23,8 @@ namespace DSM {
         if (m_CurrGraphicsRootSignature == rootSig.GetRootSignature()) return;
 
         m_CmdList->SetGraphicsRootSignature(rootSig.GetRootSignature());
+        // 改变根签名后所有根参数都需要重新设置
+        m_BindCache.InvalidateRootArguments();
 
         m_ViewDescriptorHeap->ParseGraphicsRootSignature(rootSig);
         m_SampleDescriptorHeap->ParseGraphicsRootSignature(rootSig);
@@ -50,20 +52,26 @@ namespace DSM {
         ASSERT(pData != nullptr && bufferSize > 0);
         auto uploadBuffer = GetUploadBuffer(bufferSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
         memcpy(uploadBuffer.m_MappedAddress, pData, bufferSize);
-        m_CmdList->SetGraphicsRootConstantBufferView(rootIndex, uploadBuffer.m_GpuAddress);
+        SetConstantBuffer(rootIndex, uploadBuffer.m_GpuAddress);
     }
 
     void GraphicsCommandList::SetShaderResource(std::uint32_t rootIndex, const GpuResource& resource, std::uint64_t offset)
     {
         auto state = (D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
         ASSERT(resource.GetUsageState() & state != 0);
-        m_CmdList->SetGraphicsRootShaderResourceView(rootIndex, resource.GetGpuVirtualAddress() + offset);
+        auto address = resource.GetGpuVirtualAddress() + offset;
+        if (m_BindCache.SetRootDescriptor(rootIndex, address)) {
+            m_CmdList->SetGraphicsRootShaderResourceView(rootIndex, address);
+        }
     }
 
     void GraphicsCommandList::SetUnorderedAccess(std::uint32_t rootIndex, const GpuResource& resource,std::uint64_t offset)
     {
         ASSERT(resource.GetUsageState() & D3D12_RESOURCE_STATE_UNORDERED_ACCESS != 0);
-        m_CmdList->SetGraphicsRootUnorderedAccessView(rootIndex, resource.GetGpuVirtualAddress() + offset);
+        auto address = resource.GetGpuVirtualAddress() + offset;
+        if (m_BindCache.SetRootDescriptor(rootIndex, address)) {
+            m_CmdList->SetGraphicsRootUnorderedAccessView(rootIndex, address);
+        }
     }
 
     void GraphicsCommandList::SetDynamicSRV(std::uint32_t rootIndex, std::size_t bufferSize, const void* pData)
@@ -73,7 +81,9 @@ namespace DSM {
         auto uploadBuffer = GetUploadBuffer(bufferSize);
         memcpy(uploadBuffer.m_MappedAddress, pData, bufferSize);
 
-        m_CmdList->SetGraphicsRootShaderResourceView(rootIndex, uploadBuffer.m_GpuAddress);
+        if (m_BindCache.SetRootDescriptor(rootIndex, uploadBuffer.m_GpuAddress)) {
+            m_CmdList->SetGraphicsRootShaderResourceView(rootIndex, uploadBuffer.m_GpuAddress);
+        }
     }
     
     void GraphicsCommandList::SetDynamicDescriptors(
@@ -106,7 +116,7 @@ namespace DSM {
         indexView.Format = DXGI_FORMAT_R16_UINT;
         indexView.BufferLocation = uploadBuffer.m_GpuAddress;
         indexView.SizeInBytes = bufferSize;
-        m_CmdList->IASetIndexBuffer(&indexView);
+        SetIndexBuffer(indexView);
     }
 
     void GraphicsCommandList::SetDynamicIB(std::size_t indexCount, const std::uint32_t* indexData)
@@ -121,7 +131,7 @@ namespace DSM {
         indexView.Format = DXGI_FORMAT_R32_UINT;
         indexView.BufferLocation = uploadBuffer.m_GpuAddress;
         indexView.SizeInBytes = bufferSize;
-        m_CmdList->IASetIndexBuffer(&indexView);
+        SetIndexBuffer(indexView);
     }
 
     void GraphicsCommandList::DrawInstanced(std::uint32_t vertexCountPerInstance, std::uint32_t instanceCount,
@@ -163,5 +173,6 @@ namespace DSM {
         m_CmdList->ExecuteIndirect(
             cmdSig.GetCommandSignature(), maxCommands, argumentBuffer.GetResource(), argumentOffset,
             counterBuffer == nullptr ? nullptr : counterBuffer->GetResource(), counterOffset);
+        m_BindCache.InvalidateIndirectBindings();
     }
 }
@@ -14,8 +14,8 @@ namespace DSM {
     class GraphicsCommandList : public CommandList
     {
     public:
-        GraphicsCommandList(const std::wstring& id)
-            : CommandList(id){}
+        GraphicsCommandList(const std::wstring& id, bool deferred = false)
+            : CommandList(id, D3D12_COMMAND_LIST_TYPE_DIRECT, deferred){}
         void ClearRenderTarget(
             D3D12_CPU_DESCRIPTOR_HANDLE rtv,
             const float* clearColor = nullptr,
@@ -52,17 +52,24 @@ namespace DSM {
         void SetRenderTarget(const D3D12_CPU_DESCRIPTOR_HANDLE rtv, const D3D12_CPU_DESCRIPTOR_HANDLE dsv){SetRenderTargets({&rtv, 1}, dsv);}
         void SetDepthStencilTarget(const D3D12_CPU_DESCRIPTOR_HANDLE dsv) { SetRenderTargets({}, dsv); }
 
-        void SetViewport(const D3D12_VIEWPORT& viewport){ m_CmdList->RSSetViewports(1, &viewport);}
+        void SetViewport(const D3D12_VIEWPORT& viewport)
+        {
+            if (m_BindCache.SetViewports({&viewport, 1})) {
+                m_CmdList->RSSetViewports(1, &viewport);
+            }
+        }
         void SetViewport(float x, float y, float width, float height, float minDepth = 0, float maxDepth = 1)
         {
             D3D12_VIEWPORT viewport{.TopLeftX = x,.TopLeftY = y,
                 .Width = width, .Height = height, .MinDepth = minDepth, .MaxDepth = maxDepth};
-            m_CmdList->RSSetViewports(1, &viewport);
+            SetViewport(viewport);
         }
         void SetScissor(const D3D12_RECT& rect)
         {
             ASSERT(rect.left < rect.right && rect.top < rect.bottom);
-            m_CmdList->RSSetScissorRects(1, &rect);
+            if (m_BindCache.SetScissors({&rect, 1})) {
+                m_CmdList->RSSetScissorRects(1, &rect);
+            }
         }
         void SetScissor(long left, long top, long right, long botton)
         {
@@ -81,7 +88,12 @@ namespace DSM {
         }
         void SetStencilRef(std::uint32_t ref){ m_CmdList->OMSetStencilRef(ref);}
         void SetBlendFactor(const float factor[4]){m_CmdList->OMSetBlendFactor(factor);}
-        void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology){m_CmdList->IASetPrimitiveTopology(topology);}
+        void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+        {
+            if (m_BindCache.SetPrimitiveTopology(topology)) {
+                m_CmdList->IASetPrimitiveTopology(topology);
+            }
+        }
 
         template <typename T>
         void SetConstantArray(std::uint32_t rootIndex, std::uint32_t numConstants, const void * pConstants)
@@ -102,11 +114,15 @@ namespace DSM {
         void SetConstants(std::uint32_t rootIndex, DWParam x, DWParam y, DWParam z, DWParam w);
         void SetDescriptorTable(std::uint32_t rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE firstHandle)
         {
-            m_CmdList->SetGraphicsRootDescriptorTable(rootIndex, firstHandle);
+            if (m_BindCache.SetRootDescriptorTable(rootIndex, firstHandle)) {
+                m_CmdList->SetGraphicsRootDescriptorTable(rootIndex, firstHandle);
+            }
         }
         void SetConstantBuffer(std::uint32_t rootIndex, D3D12_GPU_VIRTUAL_ADDRESS cbv)
         {
-            m_CmdList->SetGraphicsRootConstantBufferView(rootIndex, cbv);
+            if (m_BindCache.SetRootDescriptor(rootIndex, cbv)) {
+                m_CmdList->SetGraphicsRootConstantBufferView(rootIndex, cbv);
+            }
         }
         void SetDynamicConstantBuffer(std::uint32_t rootIndex, std::size_t bufferSize, const void* pData);
         void SetShaderResource(std::uint32_t rootIndex, const GpuResource& resource, std::uint64_t offset = 0);
@@ -126,12 +142,19 @@ namespace DSM {
             std::uint32_t offset,
             std::span<D3D12_CPU_DESCRIPTOR_HANDLE> handles);
 
-        void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& ibv){m_CmdList->IASetIndexBuffer(&ibv);}
+        void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& ibv)
+        {
+            if (m_BindCache.SetIndexBuffer(ibv)) {
+                m_CmdList->IASetIndexBuffer(&ibv);
+            }
+        }
         void SetVertexBuffer(std::uint32_t slot, const D3D12_VERTEX_BUFFER_VIEW& vbv) { SetVertexBuffers(slot, {&vbv, 1}); }
         void SetVertexBuffers(std::uint32_t startSlot, std::span<const D3D12_VERTEX_BUFFER_VIEW> VBVs)
         {
             ASSERT(VBVs.size() > 0);
-            m_CmdList->IASetVertexBuffers(startSlot, VBVs.size(), VBVs.data());
+            if (m_BindCache.SetVertexBuffers(startSlot, VBVs)) {
+                m_CmdList->IASetVertexBuffers(startSlot, VBVs.size(), VBVs.data());
+            }
         }
         void SetDynamicIB(std::size_t indexCount, const std::uint16_t* indexData);
         void SetDynamicIB(std::size_t indexCount, const std::uint32_t* indexData);
@@ -178,7 +201,7 @@ namespace DSM {
         vbv.BufferLocation = uploadBuffer.m_GpuAddress;
         vbv.SizeInBytes = bufferSize;
         vbv.StrideInBytes = sizeof(T);
-        m_CmdList->IASetVertexBuffers(slot, 1, &vbv);
+        SetVertexBuffer(slot, vbv);
     }
 }
 
@@ -0,0 +1,361 @@
+#include "ResourceStateTracker.h"
+#include "../RenderContext.h"
+#include "../Resource/GpuResource.h"
+
+namespace DSM {
+    // 只读状态之间可以合并，合并后在这些状态间切换无需屏障
+    static constexpr D3D12_RESOURCE_STATES s_ReadOnlyStates =
+        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+        D3D12_RESOURCE_STATE_INDEX_BUFFER |
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+        D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT |
+        D3D12_RESOURCE_STATE_COPY_SOURCE |
+        D3D12_RESOURCE_STATE_DEPTH_READ;
+
+    static bool IsReadOnlyState(D3D12_RESOURCE_STATES state) noexcept
+    {
+        return state != D3D12_RESOURCE_STATE_COMMON && (state & ~s_ReadOnlyStates) == 0;
+    }
+
+    static bool ReferencesResource(const D3D12_RESOURCE_BARRIER& barrier, ID3D12Resource* resource) noexcept
+    {
+        switch (barrier.Type) {
+            case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION: return barrier.Transition.pResource == resource;
+            case D3D12_RESOURCE_BARRIER_TYPE_UAV: return barrier.UAV.pResource == resource;
+            case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+                return barrier.Aliasing.pResourceBefore == resource || barrier.Aliasing.pResourceAfter == resource;
+            default: return false;
+        }
+    }
+
+    static D3D12_RESOURCE_BARRIER GetTransitionBarrier(
+        ID3D12Resource* resource,
+        std::uint32_t subresource,
+        D3D12_RESOURCE_STATES before,
+        D3D12_RESOURCE_STATES after,
+        D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE) noexcept
+    {
+        D3D12_RESOURCE_BARRIER barrier{};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Flags = flags;
+        barrier.Transition.pResource = resource;
+        barrier.Transition.Subresource = subresource;
+        barrier.Transition.StateBefore = before;
+        barrier.Transition.StateAfter = after;
+        return barrier;
+    }
+
+
+    void ResourceStateTracker::TransitionResource(GpuResource& resource, std::uint32_t subresource, D3D12_RESOURCE_STATES newState)
+    {
+        auto& localState = GetLocalState(resource);
+
+        if (localState.m_SplitState != UNKNOWN_STATE) {
+            auto splitState = localState.m_SplitState;
+            EndSplitTransition(resource, localState);
+            // 拆分屏障已转换到目标状态
+            if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES && splitState == newState) return;
+        }
+
+        if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) {
+            if (localState.m_Subresources.empty()) {
+                auto prevState = localState.m_State;
+                TransitionSubresource(resource, localState.m_State, subresource, newState);
+                // 状态未变时没有记录转换，仍可以在提交时沿用全局状态
+                localState.m_IsUnresolved = prevState == UNKNOWN_STATE ||
+                    (localState.m_IsUnresolved && localState.m_State == prevState);
+                return;
+            }
+            for (std::uint32_t i = 0; i < localState.m_Subresources.size(); ++i) {
+                TransitionSubresource(resource, localState.m_Subresources[i], i, newState);
+            }
+        }
+        else {
+            if (localState.m_Subresources.empty()) {
+                localState.m_Subresources.assign(GetNumSubresources(resource), localState.m_State);
+            }
+            ASSERT(subresource < localState.m_Subresources.size());
+            TransitionSubresource(resource, localState.m_Subresources[subresource], subresource, newState);
+        }
+        localState.m_IsUnresolved = false;
+        CollapseStates(localState.m_State, localState.m_Subresources);
+    }
+
+    void ResourceStateTracker::BeginTransition(GpuResource& resource, D3D12_RESOURCE_STATES newState)
+    {
+        auto pLocalState = m_States.Find(&resource);
+        // 首次使用或各子资源状态不同时无法开始拆分屏障，之后转换时再处理
+        if (pLocalState == nullptr) return;
+        auto& localState = *pLocalState;
+        if (localState.m_State == UNKNOWN_STATE ||
+            !localState.m_Subresources.empty() ||
+            localState.m_SplitState != UNKNOWN_STATE ||
+            localState.m_State == newState) return;
+
+        m_ResourceBarriers.push_back(GetTransitionBarrier(
+            resource.GetResource(), D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+            localState.m_State, newState, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY));
+        localState.m_SplitState = newState;
+        localState.m_IsUnresolved = false;
+        m_SplitResources.push_back(&resource);
+        ++m_NumSplit;
+    }
+
+    void ResourceStateTracker::InsertUAVBarrier(GpuResource& resource)
+    {
+        D3D12_RESOURCE_BARRIER resourceBarrier = {};
+        resourceBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+        resourceBarrier.UAV.pResource = resource.GetResource();
+        resourceBarrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        m_ResourceBarriers.push_back(resourceBarrier);
+    }
+
+    void ResourceStateTracker::InsertAliasBarrier(GpuResource* before, GpuResource& after)
+    {
+        D3D12_RESOURCE_BARRIER resourceBarrier = {};
+        resourceBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        resourceBarrier.Aliasing.pResourceBefore = before == nullptr ? nullptr : before->GetResource();
+        resourceBarrier.Aliasing.pResourceAfter = after.GetResource();
+        resourceBarrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        m_ResourceBarriers.push_back(resourceBarrier);
+    }
+
+    void ResourceStateTracker::FlushResourceBarriers(ID3D12GraphicsCommandList* cmdList)
+    {
+        if (m_ResourceBarriers.empty()) return;
+
+        cmdList->ResourceBarrier(static_cast<UINT>(m_ResourceBarriers.size()), m_ResourceBarriers.data());
+        sm_NumIssued.fetch_add(m_ResourceBarriers.size(), std::memory_order_relaxed);
+        m_ResourceBarriers.clear();
+    }
+
+    void ResourceStateTracker::FlushForSubmit(ID3D12GraphicsCommandList* cmdList)
+    {
+        for (auto resource : m_SplitResources) {
+            auto& localState = *m_States.Find(resource);
+            if (localState.m_SplitState != UNKNOWN_STATE) {
+                EndSplitTransition(*resource, localState);
+            }
+        }
+        m_SplitResources.clear();
+
+        FlushResourceBarriers(cmdList);
+    }
+
+    void ResourceStateTracker::ResolvePendingBarriers(std::pmr::vector<D3D12_RESOURCE_BARRIER>& barriers)
+    {
+        auto numBarriers = barriers.size();
+        for (const auto& pending : m_PendingBarriers) {
+            auto& resource = *pending.m_Resource;
+            const auto& subresourceStates = resource.m_SubresourceStates;
+
+            if (pending.m_Subresource != D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES || subresourceStates.empty()) {
+                auto committedState = subresourceStates.empty() ? resource.m_UsageState : subresourceStates[pending.m_Subresource];
+                // 已处于包含所需状态的合并只读状态时无需转换，之后没有记录转换时本列表可以沿用全局状态
+                if (pending.m_Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES &&
+                    IsReadOnlyState(committedState) && IsReadOnlyState(pending.m_StateAfter) &&
+                    (committedState & pending.m_StateAfter) == pending.m_StateAfter) {
+                    auto& localState = *m_States.Find(&resource);
+                    if (localState.m_IsUnresolved) {
+                        localState.m_State = committedState;
+                        ++m_NumElided;
+                        continue;
+                    }
+                }
+                if (committedState != pending.m_StateAfter) {
+                    barriers.push_back(GetTransitionBarrier(resource.GetResource(),
+                        pending.m_Subresource, committedState, pending.m_StateAfter));
+                }
+                else {
+                    ++m_NumElided;
+                }
+                continue;
+            }
+
+            // 全局状态中各子资源的状态不同，分别转换
+            for (std::uint32_t i = 0; i < subresourceStates.size(); ++i) {
+                if (subresourceStates[i] != pending.m_StateAfter) {
+                    barriers.push_back(GetTransitionBarrier(resource.GetResource(),
+                        i, subresourceStates[i], pending.m_StateAfter));
+                }
+            }
+        }
+
+        auto numResolved = barriers.size() - numBarriers;
+        sm_NumIssued.fetch_add(numResolved, std::memory_order_relaxed);
+        sm_NumResolved.fetch_add(numResolved, std::memory_order_relaxed);
+    }
+
+    void ResourceStateTracker::CommitFinalStates()
+    {
+        for (auto& [resource, localState] : m_States.GetEntries()) {
+            ASSERT(localState.m_SplitState == UNKNOWN_STATE);
+
+            if (localState.m_Subresources.empty()) {
+                if (localState.m_State != UNKNOWN_STATE) {
+                    resource->m_UsageState = localState.m_State;
+                    resource->m_SubresourceStates.clear();
+                }
+                continue;
+            }
+
+            auto& subresourceStates = resource->m_SubresourceStates;
+            if (subresourceStates.empty()) {
+                subresourceStates.assign(localState.m_Subresources.size(), resource->m_UsageState);
+            }
+            for (std::uint32_t i = 0; i < localState.m_Subresources.size(); ++i) {
+                if (localState.m_Subresources[i] != UNKNOWN_STATE) {
+                    subresourceStates[i] = localState.m_Subresources[i];
+                }
+            }
+            CollapseStates(resource->m_UsageState, subresourceStates);
+        }
+
+        sm_NumElided.fetch_add(m_NumElided, std::memory_order_relaxed);
+        sm_NumSplit.fetch_add(m_NumSplit, std::memory_order_relaxed);
+        m_NumElided = m_NumSplit = 0;
+    }
+
+    void ResourceStateTracker::Reset()
+    {
+        ASSERT(m_ResourceBarriers.empty() && m_SplitResources.empty());
+        m_States.Clear();
+        m_PendingBarriers.clear();
+    }
+
+    void ResourceStateTracker::SetResourceState(GpuResource& resource, D3D12_RESOURCE_STATES state)
+    {
+        std::lock_guard lock{sm_GlobalMutex};
+        resource.m_UsageState = state;
+        resource.m_SubresourceStates.clear();
+    }
+
+    ResourceBarrierStats ResourceStateTracker::GetStats() noexcept
+    {
+        ResourceBarrierStats stats{};
+        stats.m_NumIssued = sm_NumIssued.load(std::memory_order_relaxed);
+        stats.m_NumElided = sm_NumElided.load(std::memory_order_relaxed);
+        stats.m_NumResolved = sm_NumResolved.load(std::memory_order_relaxed);
+        stats.m_NumSplit = sm_NumSplit.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void ResourceStateTracker::TransitionSubresource(
+        GpuResource& resource,
+        D3D12_RESOURCE_STATES& state,
+        std::uint32_t subresource,
+        D3D12_RESOURCE_STATES newState)
+    {
+        // 之前的状态未知，提交时再解析
+        if (state == UNKNOWN_STATE) {
+            m_PendingBarriers.push_back({&resource, subresource, newState});
+            state = newState;
+            return;
+        }
+
+        if (state == newState) {
+            if (newState == D3D12_RESOURCE_STATE_UNORDERED_ACCESS) {
+                InsertUAVBarrier(resource);
+            }
+            else {
+                ++m_NumElided;
+            }
+            return;
+        }
+
+        // 已处于包含目标状态的只读状态时无需转换，否则转换到合并后的只读状态
+        if (IsReadOnlyState(state) && IsReadOnlyState(newState)) {
+            if ((state & newState) == newState) {
+                ++m_NumElided;
+                return;
+            }
+            newState |= state;
+        }
+
+        AddTransition(resource.GetResource(), subresource, state, newState);
+        state = newState;
+    }
+
+    void ResourceStateTracker::AddTransition(
+        ID3D12Resource* resource,
+        std::uint32_t subresource,
+        D3D12_RESOURCE_STATES before,
+        D3D12_RESOURCE_STATES after,
+        D3D12_RESOURCE_BARRIER_FLAGS flags)
+    {
+        // 屏障写入前不会有命令使用该资源，中间状态可以省去
+        for (auto it = m_ResourceBarriers.rbegin(); it != m_ResourceBarriers.rend(); ++it) {
+            if (!ReferencesResource(*it, resource)) continue;
+
+            auto& transition = it->Transition;
+            if (flags == D3D12_RESOURCE_BARRIER_FLAG_NONE &&
+                it->Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION &&
+                it->Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE &&
+                transition.Subresource == subresource) {
+                ASSERT(transition.StateAfter == before);
+                ++m_NumElided;
+                if (transition.StateBefore == after) {
+                    // 两次转换相互抵消
+                    m_ResourceBarriers.erase(std::next(it).base());
+                    ++m_NumElided;
+                }
+                else {
+                    transition.StateAfter = after;
+                }
+                return;
+            }
+            break;
+        }
+
+        m_ResourceBarriers.push_back(GetTransitionBarrier(resource, subresource, before, after, flags));
+    }
+
+    void ResourceStateTracker::EndSplitTransition(GpuResource& resource, LocalState& localState)
+    {
+        m_ResourceBarriers.push_back(GetTransitionBarrier(
+            resource.GetResource(), D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+            localState.m_State, localState.m_SplitState, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY));
+        localState.m_State = localState.m_SplitState;
+        localState.m_SplitState = UNKNOWN_STATE;
+    }
+
+    ResourceStateTracker::LocalState& ResourceStateTracker::GetLocalState(GpuResource& resource)
+    {
+        bool inserted{};
+        auto& localState = *m_States.FindOrInsert(&resource, inserted);
+        if (inserted) {
+            // 复用之前提交时的元素，保留子资源数组的内存
+            localState.m_State = UNKNOWN_STATE;
+            localState.m_Subresources.clear();
+            localState.m_SplitState = UNKNOWN_STATE;
+            localState.m_IsUnresolved = false;
+        }
+        return localState;
+    }
+
+    std::uint32_t ResourceStateTracker::GetNumSubresources(GpuResource& resource)
+    {
+        const auto& desc = resource->GetDesc();
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) return 1;
+
+        std::uint32_t arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+        // 深度模板等格式的每个平面是单独的子资源
+        D3D12_FEATURE_DATA_FORMAT_INFO formatInfo{desc.Format, 1};
+        if (FAILED(g_RenderContext.GetDevice()->CheckFeatureSupport(D3D12_FEATURE_FORMAT_INFO, &formatInfo, sizeof(formatInfo)))) {
+            formatInfo.PlaneCount = 1;
+        }
+        return desc.MipLevels * arraySize * formatInfo.PlaneCount;
+    }
+
+    void ResourceStateTracker::CollapseStates(D3D12_RESOURCE_STATES& state, std::vector<D3D12_RESOURCE_STATES>& subresources)
+    {
+        if (subresources.empty()) return;
+
+        auto first = subresources.front();
+        if (std::all_of(subresources.begin(), subresources.end(), [first](auto s) { return s == first; })) {
+            state = first;
+            subresources.clear();
+        }
+    }
+}
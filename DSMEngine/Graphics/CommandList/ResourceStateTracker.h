@@ -0,0 +1,120 @@
+#pragma once
+#ifndef __RESOURCESTATETRACKER_H__
+#define __RESOURCESTATETRACKER_H__
+
+#include "../../pch.h"
+#include "../../Utilities/FlatHashMap.h"
+#include <atomic>
+#include <memory_resource>
+
+namespace DSM {
+    class GpuResource;
+
+    // 资源屏障的统计
+    struct ResourceBarrierStats
+    {
+        // 实际写入命令列表的屏障数
+        std::uint64_t m_NumIssued{};
+        // 因冗余、合并或抵消而省去的状态转换
+        std::uint64_t m_NumElided{};
+        // 提交时根据全局状态解析出的屏障数，包含在 m_NumIssued 中
+        std::uint64_t m_NumResolved{};
+        // 拆分屏障的数量
+        std::uint64_t m_NumSplit{};
+    };
+
+    /// <summary>
+    /// 命令列表内的资源状态跟踪，按子资源记录状态
+    /// 资源在列表中首次使用时之前的状态未知，转换推迟到提交时根据全局状态解析
+    /// 全局状态保存在 GpuResource 中，只在提交时持有全局锁读取与更新
+    /// </summary>
+    class ResourceStateTracker
+    {
+    public:
+        ResourceStateTracker() = default;
+        ~ResourceStateTracker() = default;
+        DSM_NONCOPYABLE(ResourceStateTracker);
+
+        void TransitionResource(GpuResource& resource, std::uint32_t subresource, D3D12_RESOURCE_STATES newState);
+        // 开始拆分屏障，下一次转换到相同状态时结束，之前的状态未知时忽略
+        void BeginTransition(GpuResource& resource, D3D12_RESOURCE_STATES newState);
+        void InsertUAVBarrier(GpuResource& resource);
+        void InsertAliasBarrier(GpuResource* before, GpuResource& after);
+
+        void FlushResourceBarriers(ID3D12GraphicsCommandList* cmdList);
+        // 结束所有未结束的拆分屏障并写入命令列表，提交前调用
+        void FlushForSubmit(ID3D12GraphicsCommandList* cmdList);
+        bool HasPendingBarriers() const noexcept { return !m_PendingBarriers.empty(); }
+
+        // 需持有全局锁，根据全局状态生成待定的屏障，需在本列表之前执行
+        void ResolvePendingBarriers(std::pmr::vector<D3D12_RESOURCE_BARRIER>& barriers);
+        // 需持有全局锁，将本列表中的最终状态写回资源
+        void CommitFinalStates();
+        // 清空本列表的状态，提交后调用
+        void Reset();
+
+        // 保证全局状态的解析与更新顺序和提交顺序一致
+        static std::mutex& GetGlobalMutex() noexcept { return sm_GlobalMutex; }
+        // 直接设置资源的全局状态，用于复制队列上衰减为 COMMON 的资源
+        static void SetResourceState(GpuResource& resource, D3D12_RESOURCE_STATES state);
+        static ResourceBarrierStats GetStats() noexcept;
+
+    private:
+        // 状态未知的子资源
+        inline static constexpr auto UNKNOWN_STATE = static_cast<D3D12_RESOURCE_STATES>(-1);
+
+        struct LocalState
+        {
+            // 所有子资源状态相同时不记录子资源
+            D3D12_RESOURCE_STATES m_State = UNKNOWN_STATE;
+            std::vector<D3D12_RESOURCE_STATES> m_Subresources{};
+            // 尚未结束的拆分屏障的目标状态
+            D3D12_RESOURCE_STATES m_SplitState = UNKNOWN_STATE;
+            // 整个资源的状态仍是首次使用时待解析的状态，之后没有记录过转换
+            bool m_IsUnresolved = false;
+        };
+        struct PendingBarrier
+        {
+            GpuResource* m_Resource{};
+            std::uint32_t m_Subresource{};
+            D3D12_RESOURCE_STATES m_StateAfter{};
+        };
+
+        void TransitionSubresource(
+            GpuResource& resource,
+            D3D12_RESOURCE_STATES& state,
+            std::uint32_t subresource,
+            D3D12_RESOURCE_STATES newState);
+        // 与尚未写入命令列表的同一子资源的转换合并
+        void AddTransition(
+            ID3D12Resource* resource,
+            std::uint32_t subresource,
+            D3D12_RESOURCE_STATES before,
+            D3D12_RESOURCE_STATES after,
+            D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE);
+        void EndSplitTransition(GpuResource& resource, LocalState& localState);
+        LocalState& GetLocalState(GpuResource& resource);
+
+        static std::uint32_t GetNumSubresources(GpuResource& resource);
+        static void CollapseStates(D3D12_RESOURCE_STATES& state, std::vector<D3D12_RESOURCE_STATES>& subresources);
+
+    private:
+        // 重置时保留存储，避免每次提交都重新分配
+        FlatHashMap<GpuResource*, LocalState> m_States{};
+        std::vector<PendingBarrier> m_PendingBarriers{};
+        std::vector<D3D12_RESOURCE_BARRIER> m_ResourceBarriers{};
+        std::vector<GpuResource*> m_SplitResources{};
+
+        // 在提交时合并到全局统计
+        std::uint64_t m_NumElided{};
+        std::uint64_t m_NumSplit{};
+
+        inline static std::mutex sm_GlobalMutex{};
+        inline static std::atomic<std::uint64_t> sm_NumIssued{};
+        inline static std::atomic<std::uint64_t> sm_NumElided{};
+        inline static std::atomic<std::uint64_t> sm_NumResolved{};
+        inline static std::atomic<std::uint64_t> sm_NumSplit{};
+    };
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include "UploadBatch.h"
+#include "../RenderContext.h"
+
+namespace DSM {
+    //
+    // UploadTicket Implementation
+    //
+
+    bool UploadTicket::IsComplete() const
+    {
+        return !IsValid() || g_RenderContext.IsFenceComplete(m_FenceValue);
+    }
+
+    void UploadTicket::StallQueue(CommandQueue& queue) const
+    {
+        if (IsValid()) {
+            queue.StallForFence(m_FenceValue);
+        }
+    }
+
+    void UploadTicket::Wait() const
+    {
+        if (IsValid()) {
+            g_RenderContext.WaitForFence(m_FenceValue);
+        }
+    }
+
+
+    //
+    // UploadBatch Implementation
+    //
+
+    UploadBatch::UploadBatch(const std::wstring& id)
+        :m_CmdList(id, D3D12_COMMAND_LIST_TYPE_COPY){
+    }
+
+    UploadBatch::~UploadBatch()
+    {
+        Submit();
+    }
+
+    void UploadBatch::UploadBuffer(GpuResource& dest, const void* data, std::size_t byteSize, std::size_t destOffset)
+    {
+        ASSERT(data != nullptr && byteSize > 0);
+        AddDest(dest);
+
+        auto uploadBuffer = m_CmdList.GetUploadBuffer(byteSize);
+        memcpy(uploadBuffer.m_MappedAddress, data, byteSize);
+
+        // 复制队列上 COMMON 状态的资源会隐式提升为 COPY_DEST，无需屏障
+        m_CmdList.GetCommandList()->CopyBufferRegion(
+            dest.GetResource(), destOffset,
+            uploadBuffer.m_Resource->GetResource(), uploadBuffer.m_Offset,
+            byteSize);
+        ++m_NumUploads;
+    }
+
+    void UploadBatch::UploadTexture(GpuResource& dest, std::span<const D3D12_SUBRESOURCE_DATA> subResources, std::uint32_t firstSubresource)
+    {
+        ASSERT(!subResources.empty());
+        AddDest(dest);
+
+        // 获取拷贝信息
+        auto numSubResource = static_cast<std::uint32_t>(subResources.size());
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprint(numSubResource);	// 子资源的宽高偏移等信息
+        std::vector<std::uint32_t> numRows(numSubResource);	// 子资源的行数
+        std::vector<std::uint64_t> rowByteSize(numSubResource);	// 子资源每一行的字节大小
+        std::uint64_t uploadBufferSize{};	// 整个纹理数据的大小
+        const auto& texDesc = dest->GetDesc();
+        g_RenderContext.GetDevice()->GetCopyableFootprints(
+            &texDesc, firstSubresource,
+            numSubResource, 0,
+            footprint.data(), numRows.data(),
+            rowByteSize.data(), &uploadBufferSize);
+
+        auto uploadBuffer = m_CmdList.GetUploadBuffer(uploadBufferSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+        // 拷贝纹理资源
+        auto mappedData = static_cast<BYTE*>(uploadBuffer.m_MappedAddress);
+        // 每一个子资源
+        for (std::uint32_t i = 0; i < numSubResource; i++) {
+            BYTE* destData = mappedData + footprint[i].Offset;
+            auto srcData = static_cast<const BYTE*>(subResources[i].pData);
+            // 每一个深度
+            for (std::uint32_t z = 0; z < footprint[i].Footprint.Depth; z++) {
+                auto destDepthOffsetData = destData + footprint[i].Footprint.RowPitch * numRows[i] * z;
+                auto srcDepthOffsetData = srcData + subResources[i].SlicePitch * z;
+                // 每一行
+                for (std::uint32_t y = 0; y < numRows[i]; y++) {
+                    auto destRowOffsetData = destDepthOffsetData + footprint[i].Footprint.RowPitch * y;
+                    auto srcRowOffsetData = srcDepthOffsetData + subResources[i].RowPitch * y;
+                    memcpy(destRowOffsetData, srcRowOffsetData, rowByteSize[i]);
+                }
+            }
+        }
+
+        // 拷贝所有子资源
+        for (std::uint32_t i = 0; i < numSubResource; i++) {
+            D3D12_TEXTURE_COPY_LOCATION destLocation{};
+            destLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            destLocation.SubresourceIndex = firstSubresource + i;
+            destLocation.pResource = dest.GetResource();
+
+            D3D12_TEXTURE_COPY_LOCATION src{};
+            src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            src.PlacedFootprint = footprint[i];
+            src.PlacedFootprint.Offset += uploadBuffer.m_Offset;
+            src.pResource = uploadBuffer.m_Resource->GetResource();
+            m_CmdList.GetCommandList()->CopyTextureRegion(&destLocation, 0, 0, 0, &src, nullptr);
+        }
+        ++m_NumUploads;
+    }
+
+    UploadTicket UploadBatch::Submit()
+    {
+        if (Empty()) return {};
+
+        UploadTicket ticket{m_CmdList.ExecuteCommandList()};
+
+        // 复制队列执行完后资源衰减为 COMMON，其他队列使用时会隐式提升
+        for (auto dest : m_Dests) {
+            ResourceStateTracker::SetResourceState(*dest, D3D12_RESOURCE_STATE_COMMON);
+        }
+        m_Dests.clear();
+        m_NumUploads = 0;
+
+        return ticket;
+    }
+
+    void UploadBatch::AddDest(GpuResource& dest)
+    {
+        auto state = dest.GetUsageState();
+        ASSERT(state == D3D12_RESOURCE_STATE_COMMON || state == D3D12_RESOURCE_STATE_COPY_DEST,
+            "Upload destination must be in COMMON or COPY_DEST state");
+
+        if (std::find(m_Dests.begin(), m_Dests.end(), &dest) == m_Dests.end()) {
+            m_Dests.emplace_back(&dest);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef __UPLOADBATCH_H__
+#define __UPLOADBATCH_H__
+
+#include "CommandList.h"
+
+namespace DSM {
+    class CommandQueue;
+
+    // 一次上传提交的凭据
+    struct UploadTicket
+    {
+        // 复制队列上的栅栏值，为 0 时表示没有需要等待的上传
+        std::uint64_t m_FenceValue{};
+
+        bool IsValid() const noexcept { return m_FenceValue != 0; }
+        bool IsComplete() const;
+        // 让 queue 在 GPU 端等待上传完成，不阻塞 CPU
+        void StallQueue(CommandQueue& queue) const;
+        // CPU 等待上传完成
+        void Wait() const;
+    };
+
+    /// <summary>
+    /// 在复制队列上录制上传命令，多次上传合并为一次提交
+    /// 数据在调用时即拷贝到上传缓冲区，之后可立即释放
+    /// 目标资源需处于 COMMON 或 COPY_DEST 状态，上传完成后会衰减为 COMMON
+    /// </summary>
+    class UploadBatch
+    {
+    public:
+        UploadBatch(const std::wstring& id = L"UploadBatch");
+        // 未提交的上传会在析构时提交
+        ~UploadBatch();
+        DSM_NONCOPYABLE_NONMOVABLE(UploadBatch);
+
+        void UploadBuffer(GpuResource& dest, const void* data, std::size_t byteSize, std::size_t destOffset = 0);
+        void UploadTexture(GpuResource& dest, std::span<const D3D12_SUBRESOURCE_DATA> subResources, std::uint32_t firstSubresource = 0);
+
+        // 提交到复制队列，没有上传时返回无效的凭据
+        UploadTicket Submit();
+        bool Empty() const noexcept { return m_NumUploads == 0; }
+
+    private:
+        void AddDest(GpuResource& dest);
+
+    private:
+        CommandList m_CmdList;
+        // 提交后需要更新状态的资源
+        std::vector<GpuResource*> m_Dests{};
+        std::uint32_t m_NumUploads{};
+    };
+}
+
+#endif
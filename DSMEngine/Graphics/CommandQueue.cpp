@@ -27,10 +27,6 @@ namespace DSM {
         m_pFence->SetName(L"CommandQueue::m_pFence");
         // 区分不同队列的 Fence
         m_pFence->Signal((std::uint64_t)m_CommandListType << QUEUE_TYPE_MOVEBITS);
-
-        // 创建事件
-        m_FenceEventHandle = CreateEvent(nullptr, false, false, nullptr);
-        ASSERT(m_FenceEventHandle != nullptr);
         
         m_CommandAllocatorPool.Create(device);
         
@@ -42,17 +38,28 @@ namespace DSM {
         if (m_pCommandQueue == nullptr) return;
 
         m_CommandAllocatorPool.Shutdown();
+        m_PendingCommandLists.clear();
+        m_IdleCommandLists.clear();
         m_pFence = nullptr;
         m_pCommandQueue = nullptr;
-        CloseHandle(m_FenceEventHandle);
     }
 
     std::uint64_t CommandQueue::IncrementFence()
     {
-        std::lock_guard<std::mutex> guard{m_FenceMutex};
+        std::lock_guard<std::mutex> guard{m_EventMutex};
 
-        m_pCommandQueue->Signal(m_pFence.Get(), m_NextFenceValue);
-        return m_NextFenceValue++;
+        // 排队的命令列表与本次信号共用栅栏值
+        return SubmitPendingCommandLists();
+    }
+
+    std::uint64_t CommandQueue::FlushPendingCommandLists()
+    {
+        std::lock_guard<std::mutex> guard{m_EventMutex};
+
+        if (m_PendingCommandLists.empty()) {
+            return m_NextFenceValue - 1;
+        }
+        return SubmitPendingCommandLists();
     }
 
     bool CommandQueue::IsFenceComplete(std::uint64_t fenceValue)
@@ -66,15 +73,28 @@ namespace DSM {
         return fenceValue <= m_LastCompletedFenceValue;
     }
 
+    std::uint64_t CommandQueue::GetCompletedFenceValue()
+    {
+        std::lock_guard<std::mutex> guard{m_FenceMutex};
+
+        m_LastCompletedFenceValue = std::max(m_LastCompletedFenceValue, m_pFence->GetCompletedValue());
+        return m_LastCompletedFenceValue;
+    }
+
     void CommandQueue::StallForFence(std::uint64_t fenceValue)
     {
         // 当前队列等待其他队列
         auto& producer = g_RenderContext.GetCommandQueue((D3D12_COMMAND_LIST_TYPE)(fenceValue >> QUEUE_TYPE_MOVEBITS));
+        {
+            std::lock_guard<std::mutex> guard{producer.m_EventMutex};
+            producer.EnsureSubmitted(fenceValue);
+        }
         m_pCommandQueue->Wait(producer.m_pFence.Get(), fenceValue);
     }
 
     void CommandQueue::StallForProducer(CommandQueue& producer)
     {
+        producer.FlushPendingCommandLists();
         ASSERT(producer.GetNextFenceValue() > 0);
         m_pCommandQueue->Wait(producer.m_pFence.Get(), producer.GetNextFenceValue() - 1);
     }
@@ -84,30 +104,119 @@ namespace DSM {
         // 已经执行过了则无需等待
         if (IsFenceComplete(fenceValue)) return;
 
-        // 等待 GPU 执行到栅栏点
+        {
+            std::lock_guard<std::mutex> guard{m_EventMutex};
+            EnsureSubmitted(fenceValue);
+        }
+
+        // 等待期间不持有锁，以免阻塞其他线程的提交，事件为空时阻塞到 GPU 执行到栅栏点
+        ASSERT_SUCCEEDED(m_pFence->SetEventOnCompletion(fenceValue, nullptr));
+
+        std::lock_guard<std::mutex> guard{m_FenceMutex};
+        m_LastCompletedFenceValue = std::max(m_LastCompletedFenceValue, fenceValue);
+    }
+
+    std::uint64_t CommandQueue::ExecuteCommandLists(std::span<ID3D12CommandList* const> lists)
+    {
+        ASSERT(!lists.empty());
+
         std::lock_guard<std::mutex> guard{m_EventMutex};
-        m_pFence->SetEventOnCompletion(fenceValue, m_FenceEventHandle);
-        WaitForSingleObject(m_FenceEventHandle, INFINITE);
-        m_LastCompletedFenceValue = fenceValue;
+
+        for (auto list : lists) {
+            ASSERT(list != nullptr);
+            ASSERT_SUCCEEDED(((ID3D12GraphicsCommandList*)list)->Close());
+        }
+
+        return SubmitPendingCommandLists(lists);
     }
 
-    std::uint64_t CommandQueue::ExecuteCommandList(ID3D12CommandList* list)
+    std::uint64_t CommandQueue::QueueCommandLists(std::span<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists)
+    {
+        ASSERT(!lists.empty());
+
+        std::lock_guard<std::mutex> guard{m_EventMutex};
+
+        for (auto& list : lists) {
+            ASSERT(list != nullptr);
+            ASSERT_SUCCEEDED(list->Close());
+            m_PendingCommandLists.emplace_back(std::move(list));
+        }
+        return m_NextFenceValue;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> CommandQueue::RequestCommandList(ID3D12CommandAllocator* allocator)
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_EventMutex};
+
+            if (!m_IdleCommandLists.empty()) {
+                auto list = std::move(m_IdleCommandLists.back());
+                m_IdleCommandLists.pop_back();
+                return list;
+            }
+        }
+
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> list{};
+        ASSERT_SUCCEEDED(g_RenderContext.GetDevice()->CreateCommandList(
+            1, m_CommandListType, allocator, nullptr, IID_PPV_ARGS(list.GetAddressOf())));
+        list->SetName(L"CommandQueue::PooledCommandList");
+        ASSERT_SUCCEEDED(list->Close());
+        return list;
+    }
+
+    void CommandQueue::DiscardCommandList(Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> list)
     {
         ASSERT(list != nullptr);
+        // 关闭后即可重置，其中录制的命令将被丢弃
+        ASSERT_SUCCEEDED(list->Close());
 
         std::lock_guard<std::mutex> guard{m_EventMutex};
-        
-        ASSERT_SUCCEEDED(((ID3D12GraphicsCommandList*)list)->Close());
+        m_IdleCommandLists.emplace_back(std::move(list));
+    }
 
-        m_pCommandQueue->ExecuteCommandLists(1, &list);
+    void CommandQueue::RecycleCommandLists(std::span<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists)
+    {
+        if (lists.empty()) return;
+
+        std::lock_guard<std::mutex> guard{m_EventMutex};
+        for (auto& list : lists) {
+            ASSERT(list != nullptr);
+            m_IdleCommandLists.emplace_back(std::move(list));
+        }
+    }
+
+    std::uint64_t CommandQueue::SubmitPendingCommandLists(std::span<ID3D12CommandList* const> lists)
+    {
+        // 排队的命令列表先于本次的命令列表执行
+        for (const auto& list : m_PendingCommandLists) {
+            m_SubmitCommandLists.emplace_back(list.Get());
+        }
+        m_SubmitCommandLists.insert(m_SubmitCommandLists.end(), lists.begin(), lists.end());
+        if (!m_SubmitCommandLists.empty()) {
+            m_pCommandQueue->ExecuteCommandLists(static_cast<UINT>(m_SubmitCommandLists.size()), m_SubmitCommandLists.data());
+            m_SubmitCommandLists.clear();
+        }
         m_pCommandQueue->Signal(m_pFence.Get(), m_NextFenceValue);
-        
+
+        // 提交后的命令列表即可重置
+        for (auto& list : m_PendingCommandLists) {
+            m_IdleCommandLists.emplace_back(std::move(list));
+        }
+        m_PendingCommandLists.clear();
+
         return m_NextFenceValue++;
     }
 
+    void CommandQueue::EnsureSubmitted(std::uint64_t fenceValue)
+    {
+        if (fenceValue >= m_NextFenceValue && !m_PendingCommandLists.empty()) {
+            SubmitPendingCommandLists();
+        }
+    }
+
     ID3D12CommandAllocator* CommandQueue::RequestCommandAllocator()
     {
-        return m_CommandAllocatorPool.RequestAllocator(m_pFence->GetCompletedValue());
+        return m_CommandAllocatorPool.RequestAllocator();
     }
 
     void CommandQueue::DiscardCommandAllocator(std::uint64_t fenceValueForReset, ID3D12CommandAllocator* allocator)
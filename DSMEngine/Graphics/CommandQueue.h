@@ -3,6 +3,7 @@
 #define __COMMANDQUEUE_H__
 
 #include "CommandAllocatorPool.h"
+#include <span>
 
 namespace DSM {
     class CommandQueue
@@ -25,21 +26,43 @@ namespace DSM {
         // 增加栅栏值
         std::uint64_t IncrementFence(void);
         bool IsFenceComplete(std::uint64_t fenceValue);
+        // 查询一次 GPU 已完成的栅栏值
+        std::uint64_t GetCompletedFenceValue();
         // GPU 进行等待
         void StallForFence(std::uint64_t fenceValue);
         void StallForProducer(CommandQueue& producer);
         // CPU 进行等待
         void WaitForFence(std::uint64_t fenceValue);
         void WaitForIdle(void) { WaitForFence(IncrementFence()); }
+        // 提交所有排队的命令列表，返回最后一次提交的栅栏值
+        std::uint64_t FlushPendingCommandLists();
 
         ID3D12CommandQueue* GetCommandQueue() const {return m_pCommandQueue.Get();}
         std::uint64_t GetNextFenceValue() {return m_NextFenceValue;}
+        CommandAllocatorPool& GetCommandAllocatorPool() noexcept { return m_CommandAllocatorPool; }
 
     protected:
-        std::uint64_t ExecuteCommandList(ID3D12CommandList* list);
+        std::uint64_t ExecuteCommandList(ID3D12CommandList* list) { return ExecuteCommandLists({&list, 1}); }
+        // 按顺序提交多个命令列表，只发出一次栅栏信号，排队中的命令列表会在其之前一并提交
+        std::uint64_t ExecuteCommandLists(std::span<ID3D12CommandList* const> lists);
+        // 关闭命令列表并排队，在该队列下一次提交、发出信号或等待时按顺序一并提交
+        // 未提交前命令列表不能重置，因此由队列接管，返回其完成时的栅栏值
+        std::uint64_t QueueCommandLists(std::span<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists);
+        // 返回一个处于关闭状态的命令列表，优先复用已提交的命令列表
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> RequestCommandList(ID3D12CommandAllocator* allocator);
+        // 归还处于录制状态且不会再提交的命令列表
+        void DiscardCommandList(Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> list);
+        // 归还已通过 ExecuteCommandLists 提交的命令列表
+        void RecycleCommandLists(std::span<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists);
         ID3D12CommandAllocator* RequestCommandAllocator();
         void DiscardCommandAllocator(std::uint64_t fenceValueForReset, ID3D12CommandAllocator* allocator);
 
+    private:
+        // 需持有 m_EventMutex，依次提交排队的命令列表及 lists 并发出信号
+        std::uint64_t SubmitPendingCommandLists(std::span<ID3D12CommandList* const> lists = {});
+        // 需持有 m_EventMutex，栅栏值属于尚未提交的命令列表时先提交
+        void EnsureSubmitted(std::uint64_t fenceValue);
+
     protected:
         const D3D12_COMMAND_LIST_TYPE m_CommandListType{};
         Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_pCommandQueue{};
@@ -53,8 +76,14 @@ namespace DSM {
         // 当前命令队列的分配池
         CommandAllocatorPool m_CommandAllocatorPool;
 
-        HANDLE m_FenceEventHandle{};
+        // 同时保护提交、发出信号及排队的命令列表
         std::mutex m_EventMutex{};
+        // 已关闭但尚未提交的命令列表，将使用 m_NextFenceValue 发出信号
+        std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> m_PendingCommandLists{};
+        // 已提交的命令列表，可直接重置后继续录制
+        std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> m_IdleCommandLists{};
+        // 提交时使用的临时数组，避免每次分配
+        std::vector<ID3D12CommandList*> m_SubmitCommandLists{};
     };
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "DeferredReleaseQueue.h"
+#include "RenderContext.h"
+
+namespace DSM {
+    DeferredReleaseQueue::~DeferredReleaseQueue()
+    {
+        // 销毁前需调用 Flush 执行所有回调，否则回调持有的堆及描述符等将会泄漏
+        ASSERT(m_IncomingList.load(std::memory_order_acquire) == nullptr, "Pending releases are not flushed");
+        ASSERT(std::ranges::all_of(m_PendingReleases, [](const PendingHeap& pendingReleases) {
+            return pendingReleases.empty();
+        }), "Pending releases are not flushed");
+
+        CollectIncoming();
+        for (auto& pendingReleases : m_PendingReleases) {
+            for (; !pendingReleases.empty(); pendingReleases.pop()) {
+                delete pendingReleases.top();
+            }
+        }
+    }
+
+    void DeferredReleaseQueue::Release(std::uint64_t fenceValue, ReleaseCallback callback, std::uint64_t size)
+    {
+        ASSERT(callback != nullptr);
+
+        auto node = new ReleaseNode{};
+        node->m_FenceValue = fenceValue;
+        node->m_Size = size;
+        node->m_ReleaseTime = std::chrono::steady_clock::now();
+        node->m_Callback = std::move(callback);
+
+        m_NumPending.fetch_add(1, std::memory_order_relaxed);
+        m_PendingBytes.fetch_add(size, std::memory_order_relaxed);
+
+        // 压入无锁链表，由处理释放的线程统一取出
+        auto head = m_IncomingList.load(std::memory_order_relaxed);
+        do {
+            node->m_Next = head;
+        } while (!m_IncomingList.compare_exchange_weak(head, node,
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void DeferredReleaseQueue::ProcessReleases()
+    {
+        std::vector<ReleaseNode*> nodes{};
+        {
+            std::lock_guard lock{m_Mutex};
+
+            CollectIncoming();
+            for (std::uint32_t i = 0; i < sm_NumQueueTypes; ++i) {
+                auto& pendingReleases = m_PendingReleases[i];
+                if (pendingReleases.empty()) continue;
+
+                auto& queue = g_RenderContext.GetCommandQueue(static_cast<D3D12_COMMAND_LIST_TYPE>(i));
+                auto completedFenceValue = queue.GetCompletedFenceValue();
+                while (!pendingReleases.empty() && pendingReleases.top()->m_FenceValue <= completedFenceValue) {
+                    nodes.push_back(pendingReleases.top());
+                    pendingReleases.pop();
+                }
+            }
+        }
+
+        // 回调中可能会获取其他分配器的锁，因此在锁外执行
+        ExecuteReleases(nodes);
+    }
+
+    void DeferredReleaseQueue::Flush()
+    {
+        // 回调中可能再提交新的释放，如等待其他队列后再释放，循环直到没有剩余的节点
+        std::vector<ReleaseNode*> nodes{};
+        do {
+            {
+                std::lock_guard lock{m_Mutex};
+
+                CollectIncoming();
+                for (std::uint32_t i = 0; i < sm_NumQueueTypes; ++i) {
+                    auto& pendingReleases = m_PendingReleases[i];
+                    if (pendingReleases.empty()) continue;
+
+                    // 释放时使用的可能是尚未发出的栅栏值，因此重新发出一次栅栏并等待
+                    g_RenderContext.GetCommandQueue(static_cast<D3D12_COMMAND_LIST_TYPE>(i)).WaitForIdle();
+                    for (; !pendingReleases.empty(); pendingReleases.pop()) {
+                        nodes.push_back(pendingReleases.top());
+                    }
+                }
+            }
+            if (nodes.empty()) break;
+            ExecuteReleases(nodes);
+        } while (true);
+    }
+
+    DeferredReleaseStats DeferredReleaseQueue::GetStats()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        DeferredReleaseStats stats{};
+        stats.m_NumPending = m_NumPending.load(std::memory_order_relaxed);
+        stats.m_PendingBytes = m_PendingBytes.load(std::memory_order_relaxed);
+        stats.m_NumReleased = m_NumReleased;
+        stats.m_ReleasedBytes = m_ReleasedBytes;
+        stats.m_AverageLatency = m_NumReleased == 0 ? 0 : m_TotalLatency / m_NumReleased;
+        stats.m_MaxLatency = m_MaxLatency;
+        return stats;
+    }
+
+    void DeferredReleaseQueue::ResetStats()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        m_NumReleased = 0;
+        m_ReleasedBytes = 0;
+        m_TotalLatency = 0;
+        m_MaxLatency = 0;
+    }
+
+    std::uint32_t DeferredReleaseQueue::GetQueueIndex(std::uint64_t fenceValue) noexcept
+    {
+        auto index = static_cast<std::uint32_t>(fenceValue >> QUEUE_TYPE_MOVEBITS);
+        ASSERT(index < sm_NumQueueTypes && index != D3D12_COMMAND_LIST_TYPE_BUNDLE, "Invalid fence value");
+        return index;
+    }
+
+    void DeferredReleaseQueue::CollectIncoming()
+    {
+        auto node = m_IncomingList.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr) {
+            auto next = node->m_Next;
+            node->m_Next = nullptr;
+            m_PendingReleases[GetQueueIndex(node->m_FenceValue)].push(node);
+            node = next;
+        }
+    }
+
+    void DeferredReleaseQueue::ExecuteReleases(std::vector<ReleaseNode*>& nodes)
+    {
+        if (nodes.empty()) return;
+
+        auto currTime = std::chrono::steady_clock::now();
+        std::uint64_t releasedBytes{};
+        double totalLatency{};
+        double maxLatency{};
+        for (auto node : nodes) {
+            node->m_Callback();
+
+            auto latency = std::chrono::duration<double, std::milli>(currTime - node->m_ReleaseTime).count();
+            totalLatency += latency;
+            maxLatency = std::max(maxLatency, latency);
+            releasedBytes += node->m_Size;
+            delete node;
+        }
+
+        m_NumPending.fetch_sub(nodes.size(), std::memory_order_relaxed);
+        m_PendingBytes.fetch_sub(releasedBytes, std::memory_order_relaxed);
+
+        std::lock_guard lock{m_Mutex};
+        m_NumReleased += nodes.size();
+        m_ReleasedBytes += releasedBytes;
+        m_TotalLatency += totalLatency;
+        m_MaxLatency = std::max(m_MaxLatency, maxLatency);
+        nodes.clear();
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#ifndef __DEFERREDRELEASEQUEUE_H__
+#define __DEFERREDRELEASEQUEUE_H__
+
+#include "../pch.h"
+#include "../Utilities/Macros.h"
+#include <atomic>
+#include <chrono>
+
+namespace DSM {
+    // 延迟释放的统计信息
+    struct DeferredReleaseStats
+    {
+        // 尚未执行的释放，包括还未取出的部分
+        std::uint64_t m_NumPending{};
+        std::uint64_t m_PendingBytes{};
+        std::uint64_t m_NumReleased{};
+        std::uint64_t m_ReleasedBytes{};
+        // 从提交释放到执行回调的耗时，单位为毫秒
+        double m_AverageLatency{};
+        double m_MaxLatency{};
+    };
+
+    // 按 (队列类型, 栅栏值) 统一管理需要等待 GPU 完成后才能回收的资源
+    // 任意线程都可以无锁地提交释放，每帧统一取出并批量执行已完成的部分
+    class DeferredReleaseQueue
+    {
+    public:
+        using ReleaseCallback = std::function<void()>;
+
+        DeferredReleaseQueue() = default;
+        ~DeferredReleaseQueue();
+        DSM_NONCOPYABLE_NONMOVABLE(DeferredReleaseQueue);
+
+        // 栅栏完成后执行回调，size 仅用于统计
+        void Release(std::uint64_t fenceValue, ReleaseCallback callback, std::uint64_t size = 0);
+        // 执行所有栅栏已完成的回调，每个队列只查询一次栅栏
+        void ProcessReleases();
+        // 等待相关队列空闲并执行所有回调，包括回调中新提交的释放，用于销毁资源前
+        void Flush();
+
+        DeferredReleaseStats GetStats();
+        void ResetStats();
+
+    private:
+        struct ReleaseNode
+        {
+            std::uint64_t m_FenceValue{};
+            std::uint64_t m_Size{};
+            std::chrono::steady_clock::time_point m_ReleaseTime{};
+            ReleaseCallback m_Callback{};
+            ReleaseNode* m_Next{};
+        };
+        // 栅栏值小的在堆顶
+        struct FenceGreater
+        {
+            bool operator()(const ReleaseNode* lhs, const ReleaseNode* rhs) const noexcept
+            {
+                return lhs->m_FenceValue > rhs->m_FenceValue;
+            }
+        };
+        using PendingHeap = std::priority_queue<ReleaseNode*, std::vector<ReleaseNode*>, FenceGreater>;
+
+        static std::uint32_t GetQueueIndex(std::uint64_t fenceValue) noexcept;
+        // 取出无锁链表中的节点并按队列类型分类
+        void CollectIncoming();
+        // 执行回调并释放节点，需在 m_Mutex 之外调用
+        void ExecuteReleases(std::vector<ReleaseNode*>& nodes);
+
+    private:
+        inline static constexpr std::uint32_t sm_NumQueueTypes = D3D12_COMMAND_LIST_TYPE_COPY + 1;
+
+        // 各线程提交的释放，通过无锁链表提交，处理时再统一取出
+        std::atomic<ReleaseNode*> m_IncomingList{};
+        std::atomic<std::uint64_t> m_NumPending{};
+        std::atomic<std::uint64_t> m_PendingBytes{};
+
+        // 仅由处理释放的线程访问
+        std::mutex m_Mutex{};
+        std::array<PendingHeap, sm_NumQueueTypes> m_PendingReleases{};
+        std::uint64_t m_NumReleased{};
+        std::uint64_t m_ReleasedBytes{};
+        double m_TotalLatency{};
+        double m_MaxLatency{};
+    };
+}
+
+#endif
@@ -166,65 +166,216 @@ namespace DSM {
 	//
 	// DescriptorAllocator Implementation
 	//
-	DescriptorAllocator::~DescriptorAllocator()
+	std::uint32_t DescriptorAllocator::DescriptorPage::FindFreeRange(std::uint32_t count) const noexcept
 	{
-		std::lock_guard lock{sm_Mutex};
-		for (auto& page : m_FullPages) {
-			sm_AvailablePages[m_HeapType].push(page);
+		if (count > m_FreeCount) {
+			return INVALID_OFFSET;
 		}
-		if (m_CurrHeap != nullptr) {
-			sm_AvailablePages[m_HeapType].push(m_CurrHeap);
+
+		std::uint32_t rangeStart = 0;
+		std::uint32_t rangeSize = 0;
+		for (std::uint32_t i = 0; i < sm_NumDescriptorsPerHeap;) {
+			auto word = m_UsedMask[i / 64] >> (i % 64);
+			auto bitsLeft = 64 - i % 64;
+			if (word == 0) {
+				// 剩余位全部空闲
+				if (rangeSize == 0) {
+					rangeStart = i;
+				}
+				rangeSize += bitsLeft;
+				i += bitsLeft;
+			}
+			else if (auto numFree = static_cast<std::uint32_t>(std::countr_zero(word)); numFree > 0) {
+				if (rangeSize == 0) {
+					rangeStart = i;
+				}
+				rangeSize += numFree;
+				i += numFree;
+			}
+			else {
+				// 跳过已占用的位
+				rangeSize = 0;
+				i += std::min<std::uint32_t>(std::countr_one(word), bitsLeft);
+			}
+
+			if (rangeSize >= count) {
+				return rangeStart;
+			}
 		}
+
+		return INVALID_OFFSET;
 	}
 
-	DescriptorHandle DescriptorAllocator::AllocateDescriptor(std::uint32_t count)
+	void DescriptorAllocator::DescriptorPage::MarkRange(std::uint32_t offset, std::uint32_t count, bool used) noexcept
 	{
-		if (m_CurrHeap == nullptr || !m_CurrHeap->m_Heap.HasValidSpace(count)) {
-			std::lock_guard lock{sm_Mutex};
-			if (m_CurrHeap != nullptr) {
-				m_CurrHeap->m_Heap.Clear();
-				m_FullPages.push_back(m_CurrHeap);
+		ASSERT(offset + count <= sm_NumDescriptorsPerHeap);
+
+		while (count > 0) {
+			auto bitOffset = offset % 64;
+			auto numBits = std::min(count, 64 - bitOffset);
+			auto mask = (numBits == 64 ? ~0ull : ((1ull << numBits) - 1)) << bitOffset;
+			auto& word = m_UsedMask[offset / 64];
+			if (used) {
+				ASSERT((word & mask) == 0);
+				word |= mask;
 			}
-			
-			if (sm_AvailablePages[m_HeapType].empty()) {
-				DescriptorHeap newHeap{
-					L"DescriptorAllocator::DescriptorHeap",
-					m_HeapType,
-					sm_NumDescriptorsPerHeap,
-					D3D12_DESCRIPTOR_HEAP_FLAG_NONE };
-				DescriptorPage* newPage = new DescriptorPage{ .m_Heap = std::move(newHeap), .m_UsedCount = 0 };
-				m_CurrHeap = newPage;
-				sm_DescriptorPagePool.emplace_back(newPage);
+			else {
+				ASSERT((word & mask) == mask);
+				word &= ~mask;
+			}
+			offset += numBits;
+			count -= numBits;
+		}
+	}
+
+	std::uint32_t DescriptorAllocator::DescriptorPage::GetLargestFreeRange() const noexcept
+	{
+		std::uint32_t largestRange = 0;
+		std::uint32_t rangeSize = 0;
+		for (std::uint32_t i = 0; i < sm_NumDescriptorsPerHeap; ++i) {
+			if ((m_UsedMask[i / 64] >> (i % 64)) & 1) {
+				rangeSize = 0;
 			}
 			else {
-				m_CurrHeap = sm_AvailablePages[m_HeapType].front();
-				sm_AvailablePages[m_HeapType].pop();
+				largestRange = std::max(largestRange, ++rangeSize);
 			}
 		}
+		return largestRange;
+	}
+
+	DescriptorHandle DescriptorAllocator::AllocateDescriptor(std::uint32_t count)
+	{
+		ASSERT(count > 0 && count <= sm_NumDescriptorsPerHeap);
+
+		std::lock_guard lock{m_Mutex};
 
-		m_CurrHeap->m_UsedCount += count;
-		return m_CurrHeap->m_Heap.Allocate(count);
+		auto offset = m_CurrPage != nullptr ? m_CurrPage->FindFreeRange(count) : INVALID_OFFSET;
+		if (offset == INVALID_OFFSET) {
+			m_CurrPage = RequestPage(count);
+			offset = m_CurrPage->FindFreeRange(count);
+			ASSERT(offset != INVALID_OFFSET);
+		}
+
+		m_CurrPage->MarkRange(offset, count, true);
+		m_CurrPage->m_FreeCount -= count;
+		m_NumUsedDescriptors += count;
+		m_PeakUsedDescriptors = std::max(m_PeakUsedDescriptors, m_NumUsedDescriptors);
+		++m_NumAllocations;
+		return m_CurrPage->m_Heap[offset];
 	}
 
-	void DescriptorAllocator::FreeDescriptor(const DescriptorHandle& handle, std::uint32_t count)
+	void DescriptorAllocator::FreeDescriptor(const DescriptorHandle& handle, std::uint32_t count, std::uint64_t fenceValue)
 	{
-		std::lock_guard lock{ sm_Mutex };
+		DescriptorPage* page{};
+		std::uint32_t offset{};
+		{
+			std::lock_guard lock{m_Mutex};
 
-		if (m_CurrHeap != nullptr && m_CurrHeap->m_Heap.IsValidHandle(handle)) {
-			m_CurrHeap->m_UsedCount -= count;
+			page = FindPage(handle);
+			if (page == nullptr) {
+				return;
+			}
+			offset = page->m_Heap.GetOffsetOfHandle(handle);
 		}
-		else {
-			auto it = std::find_if(m_FullPages.begin(), m_FullPages.end(),[&handle](DescriptorPage* page) {
-				return page->m_Heap.IsValidHandle(handle);
-			});
-			if (it != m_FullPages.end()) {
-				(*it)->m_UsedCount -= count;
-				if ((*it)->m_UsedCount <=0) {
-					sm_AvailablePages[m_HeapType].push(*it);
-					*it = std::move(m_FullPages.back());
-					m_FullPages.pop_back();
-				}
+
+		g_RenderContext.GetDeferredReleaseQueue().Release(fenceValue, [this, page, offset, count]() {
+			ReleaseRange(page, offset, count);
+		});
+	}
+
+	void DescriptorAllocator::Destroy()
+	{
+		std::lock_guard lock{m_Mutex};
+
+		m_CurrPage = nullptr;
+		m_AvailablePages.clear();
+		m_PageMap.clear();
+		m_PagePool.clear();
+		m_NumUsedDescriptors = 0;
+	}
+
+	std::uint32_t DescriptorAllocator::GetNumPages()
+	{
+		std::lock_guard lock{m_Mutex};
+		return static_cast<std::uint32_t>(m_PagePool.size());
+	}
+
+	std::uint32_t DescriptorAllocator::GetNumFreeDescriptors()
+	{
+		std::lock_guard lock{m_Mutex};
+		return std::accumulate(m_PagePool.begin(), m_PagePool.end(), 0u, [](std::uint32_t sum, const auto& page) {
+			return sum + page->m_FreeCount;
+		});
+	}
+
+	DescriptorAllocatorStats DescriptorAllocator::GetStats()
+	{
+		std::lock_guard lock{m_Mutex};
+
+		DescriptorAllocatorStats stats{};
+		stats.m_NumPages = static_cast<std::uint32_t>(m_PagePool.size());
+		stats.m_NumDescriptors = stats.m_NumPages * sm_NumDescriptorsPerHeap;
+		stats.m_NumUsedDescriptors = m_NumUsedDescriptors;
+		stats.m_PeakUsedDescriptors = m_PeakUsedDescriptors;
+		stats.m_NumAllocations = m_NumAllocations;
+		for (const auto& page : m_PagePool) {
+			if (page->m_FreeCount > stats.m_LargestFreeRange) {
+				stats.m_LargestFreeRange = std::max(stats.m_LargestFreeRange, page->GetLargestFreeRange());
+			}
+		}
+		return stats;
+	}
+
+	DescriptorAllocator::DescriptorPage* DescriptorAllocator::FindPage(const DescriptorHandle& handle) const
+	{
+		// 找到起始地址不大于句柄地址的最后一页
+		auto it = m_PageMap.upper_bound(handle.GetCpuPtr());
+		if (it == m_PageMap.begin()) {
+			return nullptr;
+		}
+		auto page = std::prev(it)->second;
+		return page->m_Heap.IsValidHandle(handle) ? page : nullptr;
+	}
+
+	DescriptorAllocator::DescriptorPage* DescriptorAllocator::RequestPage(std::uint32_t count)
+	{
+		// 从后往前查找有足够连续空间的页，顺便移除已经没有空闲的页
+		for (auto i = m_AvailablePages.size(); i-- > 0;) {
+			auto page = m_AvailablePages[i];
+			if (page->m_FreeCount == 0) {
+				page->m_IsAvailable = false;
+				m_AvailablePages[i] = m_AvailablePages.back();
+				m_AvailablePages.pop_back();
+			}
+			else if (page != m_CurrPage && page->FindFreeRange(count) != INVALID_OFFSET) {
+				return page;
 			}
 		}
+
+		DescriptorHeap newHeap{
+			L"DescriptorAllocator::DescriptorHeap",
+			m_HeapType,
+			sm_NumDescriptorsPerHeap,
+			D3D12_DESCRIPTOR_HEAP_FLAG_NONE };
+		auto newPage = new DescriptorPage{ .m_Heap = std::move(newHeap) };
+		newPage->m_IsAvailable = true;
+		m_PagePool.emplace_back(newPage);
+		m_PageMap.emplace(newPage->m_Heap[0].GetCpuPtr(), newPage);
+		m_AvailablePages.push_back(newPage);
+
+		return newPage;
+	}
+
+	void DescriptorAllocator::ReleaseRange(DescriptorPage* page, std::uint32_t offset, std::uint32_t count)
+	{
+		std::lock_guard lock{m_Mutex};
+
+		page->MarkRange(offset, count, false);
+		page->m_FreeCount += count;
+		m_NumUsedDescriptors -= count;
+		if (!page->m_IsAvailable) {
+			page->m_IsAvailable = true;
+			m_AvailablePages.push_back(page);
+		}
 	}
 }
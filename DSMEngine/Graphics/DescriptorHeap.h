@@ -9,6 +9,9 @@
 #include <mutex>
 #include <queue>
 #include <set>
+#include <map>
+#include <limits>
+#include <bit>
 #include "../Utilities/LinearAllocator.h"
 #include "../Utilities/Macros.h"
 
@@ -90,42 +93,77 @@ namespace DSM {
     };
 
 
+    // CPU 描述符分配器的使用情况，以描述符为单位
+    struct DescriptorAllocatorStats
+    {
+        std::uint32_t m_NumPages{};
+        std::uint32_t m_NumDescriptors{};
+        std::uint32_t m_NumUsedDescriptors{};
+        std::uint32_t m_PeakUsedDescriptors{};
+        // 各页中最大的连续空闲范围
+        std::uint32_t m_LargestFreeRange{};
+        std::uint64_t m_NumAllocations{};
+    };
     
     /// <summary>
-    /// 存放CPU可见的描述符
+    /// 存放CPU可见的描述符，每页使用位图记录占用情况，支持连续范围的分配与复用
     /// </summary>
     class DescriptorAllocator
     {
     private:
+        inline static constexpr std::uint32_t sm_NumDescriptorsPerHeap = 256;
+        inline static constexpr std::uint32_t sm_NumMaskWords = sm_NumDescriptorsPerHeap / 64;
+        inline static constexpr std::uint32_t INVALID_OFFSET = (std::numeric_limits<std::uint32_t>::max)();
+        
         struct DescriptorPage
         {
+            // 查找可容纳 count 个描述符的连续空闲范围
+            std::uint32_t FindFreeRange(std::uint32_t count) const noexcept;
+            void MarkRange(std::uint32_t offset, std::uint32_t count, bool used) noexcept;
+            std::uint32_t GetLargestFreeRange() const noexcept;
+            
             DescriptorHeap m_Heap;
-            std::uint32_t m_UsedCount = 0;
+            std::array<std::uint64_t, sm_NumMaskWords> m_UsedMask{};
+            std::uint32_t m_FreeCount = sm_NumDescriptorsPerHeap;
+            // 是否位于可用列表中
+            bool m_IsAvailable{};
         };
         
     public:
         DescriptorAllocator(D3D12_DESCRIPTOR_HEAP_TYPE heapTyep)
             :m_HeapType(heapTyep){}
-        ~DescriptorAllocator();
+        ~DescriptorAllocator() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(DescriptorAllocator);
         
         DescriptorHandle AllocateDescriptor(std::uint32_t count);
-        void FreeDescriptor(const DescriptorHandle& handle, std::uint32_t count);
+        // 描述符在围栏值完成后由延迟释放队列归还
+        void FreeDescriptor(const DescriptorHandle& handle, std::uint32_t count, std::uint64_t fenceValue);
+        // 调用前需先处理完延迟释放队列
+        void Destroy();
 
-        static void DestroyAll()
-        {
-            sm_DescriptorPagePool.clear();
-            sm_AvailablePages.fill({});
-        }
+        std::uint32_t GetNumPages();
+        std::uint32_t GetNumFreeDescriptors();
+        DescriptorAllocatorStats GetStats();
 
-    protected:
-        inline static constexpr std::uint32_t sm_NumDescriptorsPerHeap = 256;
-        inline static std::vector<std::unique_ptr<DescriptorPage>> sm_DescriptorPagePool{};
-        inline static std::array<std::queue<DescriptorPage*>, D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES> sm_AvailablePages{};
-        inline static std::mutex sm_Mutex{};
-        
+    private:
+        DescriptorPage* FindPage(const DescriptorHandle& handle) const;
+        DescriptorPage* RequestPage(std::uint32_t count);
+        void ReleaseRange(DescriptorPage* page, std::uint32_t offset, std::uint32_t count);
+
+    private:
         const D3D12_DESCRIPTOR_HEAP_TYPE m_HeapType{};
-        DescriptorPage* m_CurrHeap{};
-        std::vector<DescriptorPage*> m_FullPages{};
+        std::mutex m_Mutex{};
+        
+        std::vector<std::unique_ptr<DescriptorPage>> m_PagePool{};
+        // 以堆起始的 CPU 地址为键，用于由句柄找到所在的页
+        std::map<std::size_t, DescriptorPage*> m_PageMap{};
+        // 存在空闲描述符的页
+        std::vector<DescriptorPage*> m_AvailablePages{};
+        DescriptorPage* m_CurrPage{};
+
+        std::uint32_t m_NumUsedDescriptors{};
+        std::uint32_t m_PeakUsedDescriptors{};
+        std::uint64_t m_NumAllocations{};
     };
     
 }
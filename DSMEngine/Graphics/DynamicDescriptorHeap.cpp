@@ -2,14 +2,14 @@
 #include "DescriptorHeap.h"
 #include "RenderContext.h"
 #include "RootSignature.h"
-#include "CommandList/CommandList.h"
+#include "CommandList/GraphicsCommandList.h"
+#include "../Utilities/Hash.h"
 
 namespace DSM {
     class DynamicDescriptorHeapAllocator
     {
     public:
         using DescriptorHeapArray = std::vector<std::unique_ptr<DescriptorHeap>>;
-        using RetiredDescriptorHeapQueue = std::queue<std::pair<std::uint64_t, DescriptorHeap*>>;
         using DescriptorHeapQueue = std::queue<DescriptorHeap*>;
 
         DescriptorHeap* RequestDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType)
@@ -18,25 +18,22 @@ namespace DSM {
             
             std::lock_guard lock{m_Mutex};
 
-            while (!m_RetiredDescriptorHeaps[index].empty() &&
-                g_RenderContext.IsFenceComplete(m_RetiredDescriptorHeaps[index].front().first)) {
-                m_AvaildDescriptorHeaps[index].push(m_RetiredDescriptorHeaps[index].front().second);
-                m_RetiredDescriptorHeaps[index].pop();
-                }
-
             if (m_AvaildDescriptorHeaps[index].empty()) {
                 D3D12_DESCRIPTOR_HEAP_DESC desc = {};
                 desc.Type = heapType;
-                desc.NumDescriptors = m_NumDescriptorsPerHeap;
+                desc.NumDescriptors = DynamicDescriptorHeap::sm_NumDescriptorsPerHeap;
                 desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
                 desc.NodeMask = 1;
-                auto newHeap = new DescriptorHeap{L"DynamicDescriptorHeapManager::DescriptorHeap", heapType, m_NumDescriptorsPerHeap};
+                auto newHeap = new DescriptorHeap{
+                    L"DynamicDescriptorHeapManager::DescriptorHeap", heapType, DynamicDescriptorHeap::sm_NumDescriptorsPerHeap};
                 m_DescriptorHeapPool[index].emplace_back(newHeap);
+                UpdatePeakUsage(index);
                 return newHeap;
             }
             else {
                 auto ptr = m_AvaildDescriptorHeaps[index].front();
                 m_AvaildDescriptorHeaps[index].pop();
+                UpdatePeakUsage(index);
                 return ptr;
             }    
         }
@@ -47,12 +44,14 @@ namespace DSM {
             const std::vector<DescriptorHeap*>& descriptorHeaps)
         {
             int index = heapType == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ? 0 : 1;
-            
-            std::lock_guard lock{m_Mutex};
 
             for (const auto& heap : descriptorHeaps) {
-                m_RetiredDescriptorHeaps[index].push(std::make_pair(fenceValue, heap));
                 heap->Clear();
+                // GPU 使用完毕后再放回可用队列
+                g_RenderContext.GetDeferredReleaseQueue().Release(fenceValue, [this, index, heap]() {
+                    std::lock_guard lock{m_Mutex};
+                    m_AvaildDescriptorHeaps[index].push(heap);
+                });
             }
         }
         
@@ -60,21 +59,34 @@ namespace DSM {
         {
             for (int i = 0; i < 2; ++i) {
                 m_DescriptorHeapPool[i].clear();
-                while (m_RetiredDescriptorHeaps[i].empty()) {
-                    m_RetiredDescriptorHeaps[i].pop();
-                }
-                while (m_AvaildDescriptorHeaps[i].empty()) {
+                while (!m_AvaildDescriptorHeaps[i].empty()) {
                     m_AvaildDescriptorHeaps[i].pop();
                 }
             }
         }
 
+        void GetStats(DynamicDescriptorHeapStats& stats)
+        {
+            std::lock_guard lock{m_Mutex};
+            for (int i = 0; i < 2; ++i) {
+                stats.m_NumHeaps[i] = static_cast<std::uint32_t>(m_DescriptorHeapPool[i].size());
+                stats.m_NumIdleHeaps[i] = static_cast<std::uint32_t>(m_AvaildDescriptorHeaps[i].size());
+                stats.m_PeakUsedHeaps[i] = m_PeakUsedHeaps[i];
+            }
+        }
+
+    private:
+        void UpdatePeakUsage(int index) noexcept
+        {
+            auto numUsed = static_cast<std::uint32_t>(m_DescriptorHeapPool[index].size() - m_AvaildDescriptorHeaps[index].size());
+            m_PeakUsedHeaps[index] = std::max(m_PeakUsedHeaps[index], numUsed);
+        }
+
     private:
         // 管理需要绑定到渲染管线上的描述符
         std::array<DescriptorHeapArray, 2> m_DescriptorHeapPool;
-        std::array<RetiredDescriptorHeapQueue, 2> m_RetiredDescriptorHeaps;
         std::array<DescriptorHeapQueue, 2> m_AvaildDescriptorHeaps;
-        const std::uint32_t m_NumDescriptorsPerHeap = 1024;
+        std::array<std::uint32_t, 2> m_PeakUsedHeaps{};
         std::mutex m_Mutex;
     };
 
@@ -96,6 +108,10 @@ namespace DSM {
         m_StaleRootParamsBitMap = 0;
         m_RootDescriptorTableBitMap = heapType == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ?
             rootSig.GetDescriptorTableBitMap() : rootSig.GetSamplerTableBitMap();
+        // 绑定动态描述符堆会替换常驻描述符堆，两者不能在同一个根签名中混用
+        ASSERT(heapType != D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ||
+            rootSig.GetBindlessTableBitMap() == 0 || m_RootDescriptorTableBitMap == 0,
+            "Root signature mixes bindless and dynamic descriptor tables");
 
         
         std::uint32_t offset = 0;
@@ -128,9 +144,7 @@ namespace DSM {
         while (_BitScanForward(&rootIndex, staleParam)) {
             staleParam ^= (1 << rootIndex);
 
-            unsigned long maxBindTableSize{};
-            ASSERT(_BitScanReverse(&maxBindTableSize, m_DescriptorTables[rootIndex].m_AssignedHandlesBitMap));
-            usedSize += maxBindTableSize + 1;
+            usedSize += m_DescriptorTables[rootIndex].GetBoundSize();
         }
         return usedSize;
     }
@@ -167,106 +181,65 @@ namespace DSM {
         m_StaleRootParamsBitMap |= (1 << rootIndex);
     }
 
-    void DynamicDescriptorHeap::DescriptorHandleCache::CopyAndBindStaleTables(D3D12_DESCRIPTOR_HEAP_TYPE heapType,
-        std::uint32_t descriptorSize, DescriptorHandle handleStart,
-        std::function<void(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)> setFunc)
+    void DynamicDescriptorHeap::DescriptorHandleCache::Cleanup()
     {
-                std::uint32_t staleParamCount{};
-        std::vector<std::uint32_t> usedTableSizes(m_DescriptorTables.size());
-        std::vector<std::uint32_t> rootIndexs(m_DescriptorTables.size());
-        auto staleBitMap = m_StaleRootParamsBitMap;
+        // 命令列表重置后会沿用之前的根签名而不重新解析，因此保留描述符表的布局
         m_StaleRootParamsBitMap = 0;
-        unsigned long rootIndex{};
-        // 获取绑定了资源的根参数
-        while (_BitScanForward(&rootIndex, staleBitMap)) {
-            staleBitMap ^= (1 << rootIndex);
-
-            auto& descriptorTable = m_DescriptorTables[rootIndex];
-            ASSERT(_BitScanReverse(&rootIndex, descriptorTable.m_AssignedHandlesBitMap));
-            
-            usedTableSizes[staleParamCount] = descriptorTable.m_TableHandles.size();
-            rootIndexs[staleParamCount] = rootIndex;
-            ++staleParamCount;
+        for (auto& descriptorTable : m_DescriptorTables) {
+            descriptorTable.m_AssignedHandlesBitMap = 0;
         }
+    }
 
-        // 每次拷贝 16 个
-        static constexpr std::uint32_t maxDescriptorPerCopy = 16;
-        std::uint32_t numDestDescriptorRanges= 0 ;
-        D3D12_CPU_DESCRIPTOR_HANDLE pDestDescriptorRangesStarts[maxDescriptorPerCopy];
-        std::uint32_t pDestDescriptorRangesSizes[maxDescriptorPerCopy];
-        std::uint32_t numSrcDescriptorRanges = 0;
-        D3D12_CPU_DESCRIPTOR_HANDLE pSrcDescriptorRangesStarts[maxDescriptorPerCopy];
-        std::uint32_t pSrcDescriptorRangesSizes[maxDescriptorPerCopy];
-        
-        // 每一个描述符表
-        for (std::uint32_t i = 0; i < staleParamCount; ++i) {
-            rootIndex = rootIndexs[i];
-            setFunc(rootIndex, handleStart);
-
-            auto& descriptorTable = m_DescriptorTables[rootIndex];
-            std::uint32_t setHandle = descriptorTable.m_AssignedHandlesBitMap;
-            auto srcHandle = descriptorTable.m_TableHandles.data();
-            D3D12_CPU_DESCRIPTOR_HANDLE destHandle = handleStart;
-
-            unsigned long skipCount{};
-            while (_BitScanForward(&skipCount, setHandle)) {
-                // 跳过未绑定的描述符
-                setHandle >>= skipCount;
-                srcHandle += skipCount;
-                destHandle.ptr += skipCount * descriptorSize;
-
-                // 计算描述符的数量,取反之后第一个索引即为数量
-                unsigned long descriptorCount{};
-                _BitScanForward(&descriptorCount, ~setHandle);
-                setHandle >>= descriptorCount;
-
-                // 若描述符超过16个，进行拷贝
-                if (numDestDescriptorRanges + descriptorCount > maxDescriptorPerCopy) {
-                    g_RenderContext.GetDevice()->CopyDescriptors(
-                        numDestDescriptorRanges,pDestDescriptorRangesStarts,pDestDescriptorRangesSizes,
-                        numSrcDescriptorRanges,pSrcDescriptorRangesStarts,pSrcDescriptorRangesSizes,heapType);
-                }
 
-                // 设置目标范围
-                pDestDescriptorRangesStarts[numDestDescriptorRanges] = destHandle;
-                pDestDescriptorRangesSizes[numDestDescriptorRanges] = descriptorCount;
-                ++numDestDescriptorRanges;
 
-                // 设置源的范围，由于只拷贝设置了描述符的描述符表索引，因此不一定是连续的
-                for (int j = 0 ; j < descriptorCount; ++j) {
-                    pSrcDescriptorRangesStarts[numDestDescriptorRanges] = srcHandle[j];
-                    pSrcDescriptorRangesSizes[numDestDescriptorRanges] = 1;
-                    ++numDestDescriptorRanges;
-                }
+    //
+    // DescriptorTableCache
+    //
+    std::size_t DynamicDescriptorHeap::DescriptorTableCache::ComputeHash() const noexcept
+    {
+        auto hash = Utility::HashState(&m_AssignedHandlesBitMap);
+        auto setHandle = m_AssignedHandlesBitMap;
+        unsigned long index{};
+        while (_BitScanForward(&index, setHandle)) {
+            setHandle ^= (1 << index);
+            hash = Utility::HashState(&m_TableHandles[index], 1, hash);
+        }
+        return hash;
+    }
 
-                // 进行偏移
-                destHandle.ptr += descriptorSize * descriptorSize;
-                srcHandle += descriptorSize;
+    bool DynamicDescriptorHeap::DescriptorTableCache::IsSameBinding(const DescriptorTableCache& other) const noexcept
+    {
+        if (m_AssignedHandlesBitMap != other.m_AssignedHandlesBitMap) {
+            return false;
+        }
+        auto setHandle = m_AssignedHandlesBitMap;
+        unsigned long index{};
+        while (_BitScanForward(&index, setHandle)) {
+            setHandle ^= (1 << index);
+            if (m_TableHandles[index].ptr != other.m_TableHandles[index].ptr) {
+                return false;
             }
-            g_RenderContext.GetDevice()->CopyDescriptors(
-                numDestDescriptorRanges,pDestDescriptorRangesStarts,pDestDescriptorRangesSizes,
-                numSrcDescriptorRanges,pSrcDescriptorRangesStarts,pSrcDescriptorRangesSizes, heapType);
         }
+        return true;
     }
 
+    std::uint32_t DynamicDescriptorHeap::DescriptorTableCache::GetBoundSize() const noexcept
+    {
+        unsigned long maxBindIndex{};
+        return _BitScanReverse(&maxBindIndex, m_AssignedHandlesBitMap) ? maxBindIndex + 1 : 0;
+    }
 
 
 
     //
     // DynamicDescriptorHeap
     //
-    void DynamicDescriptorHeap::DescriptorHandleCache::Cleanup()
-    {
-        m_StaleRootParamsBitMap = 0;
-        m_RootDescriptorTableBitMap = 0;
-        m_DescriptorTables.clear();
-    }
-
     void DynamicDescriptorHeap::CommitGraphicsRootDescriptorTables()
     {
         if (m_GraphicsHandleCache.m_StaleRootParamsBitMap != 0) {
             auto func = [&](UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
-                m_OwningCmdList->GetCommandList()->SetGraphicsRootDescriptorTable(rootIndex, handle);
+                // 经由绑定缓存设置，之后相同的描述符表可以被过滤
+                m_OwningCmdList->GetGraphicsCommandList().SetDescriptorTable(rootIndex, handle);
             };
             CopyAndBindStaleTables(m_GraphicsHandleCache, func);
         }
@@ -274,11 +247,11 @@ namespace DSM {
 
     void DynamicDescriptorHeap::CommitComputeRootDescriptorTables()
     {
-        if (m_GraphicsHandleCache.m_StaleRootParamsBitMap != 0) {
+        if (m_ComputeHandleCache.m_StaleRootParamsBitMap != 0) {
             auto func = [&](UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
-                m_OwningCmdList->GetCommandList()->SetGraphicsRootDescriptorTable(rootIndex, handle);
+                m_OwningCmdList->GetCommandList()->SetComputeRootDescriptorTable(rootIndex, handle);
             };
-            CopyAndBindStaleTables(m_GraphicsHandleCache, func);
+            CopyAndBindStaleTables(m_ComputeHandleCache, func);
         }
     }
 
@@ -305,8 +278,15 @@ namespace DSM {
         }
         s_DynamicDescriptorHeapManager.DiscardDescriptorHeap(m_HeapType, fenceValue, m_FullDescriptorHeaps);
         m_FullDescriptorHeaps.clear();
+        m_CopiedTables.Clear();
         m_GraphicsHandleCache.Cleanup();
         m_ComputeHandleCache.Cleanup();
+
+        sm_NumTablesCopied += m_Stats.m_NumTablesCopied;
+        sm_NumTablesReused += m_Stats.m_NumTablesReused;
+        sm_NumDescriptorsCopied += m_Stats.m_NumDescriptorsCopied;
+        sm_NumDescriptorsSaved += m_Stats.m_NumDescriptorsSaved;
+        m_Stats = {};
     }
 
     DynamicDescriptorHeap* DynamicDescriptorHeap::AllocateDynamicDescriptorHeap(
@@ -318,7 +298,7 @@ namespace DSM {
 
         std::lock_guard lock{sm_Mutex};
         
-        if (sm_AvailableDescriptorHeaps.empty()) {
+        if (!sm_AvailableDescriptorHeaps[index].empty()) {
             ret = sm_AvailableDescriptorHeaps[index].front();
             sm_AvailableDescriptorHeaps[index].pop();
         }
@@ -343,7 +323,7 @@ namespace DSM {
     void DynamicDescriptorHeap::DestroyAll()
     {
         for (int i = 0;i<sm_DynamicDescriptorHeapPools.size();++i) {
-            while (sm_AvailableDescriptorHeaps[i].empty()) {
+            while (!sm_AvailableDescriptorHeaps[i].empty()) {
                 sm_AvailableDescriptorHeaps[i].pop();
             }
             sm_DynamicDescriptorHeapPools[i].clear();
@@ -351,18 +331,152 @@ namespace DSM {
         s_DynamicDescriptorHeapManager.DestroyAll();
     }
 
+    DynamicDescriptorHeapStats DynamicDescriptorHeap::GetStats() noexcept
+    {
+        DynamicDescriptorHeapStats stats{};
+        stats.m_NumTablesCopied = sm_NumTablesCopied;
+        stats.m_NumTablesReused = sm_NumTablesReused;
+        stats.m_NumDescriptorsCopied = sm_NumDescriptorsCopied;
+        stats.m_NumDescriptorsSaved = sm_NumDescriptorsSaved;
+        stats.m_NumHeapPagesSaved = stats.m_NumDescriptorsSaved / sm_NumDescriptorsPerHeap;
+        s_DynamicDescriptorHeapManager.GetStats(stats);
+        return stats;
+    }
+
+    void DynamicDescriptorHeap::ResetStats() noexcept
+    {
+        sm_NumTablesCopied = 0;
+        sm_NumTablesReused = 0;
+        sm_NumDescriptorsCopied = 0;
+        sm_NumDescriptorsSaved = 0;
+    }
+
+    // 绑定的 CPU 描述符与当前堆中已拷贝的描述符表相同时直接复用，
+    // 以 CPU 描述符的地址作为判断依据，录制期间原地重写 CPU 描述符的内容不会被检测到
     void DynamicDescriptorHeap::CopyAndBindStaleTables(DescriptorHandleCache& handleCache,
         std::function<void(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)> setFunc)
     {
-        auto usedSize = handleCache.ComputeStaledSize();
-        if (m_pCurrentHeap == nullptr || !m_pCurrentHeap->HasValidSpace(usedSize)) {
+        std::uint32_t staleParamCount{};
+        std::array<std::uint32_t, 32> rootIndexs{};
+        std::array<std::size_t, 32> tableHashes{};
+
+        // 获取需要重新绑定的描述符表，并计算未命中缓存的描述符表需要的空间
+        auto collectStaleTables = [&]() {
+            std::uint32_t requiredSize = 0;
+            staleParamCount = 0;
+            auto staleBitMap = handleCache.m_StaleRootParamsBitMap;
+            unsigned long rootIndex{};
+            while (_BitScanForward(&rootIndex, staleBitMap)) {
+                staleBitMap ^= (1 << rootIndex);
+
+                const auto& descriptorTable = handleCache.m_DescriptorTables[rootIndex];
+                auto hash = descriptorTable.ComputeHash();
+                auto copiedTable = m_CopiedTables.Find(hash);
+                if (copiedTable == nullptr || !copiedTable->m_Table.IsSameBinding(descriptorTable)) {
+                    requiredSize += descriptorTable.GetBoundSize();
+                }
+                rootIndexs[staleParamCount] = rootIndex;
+                tableHashes[staleParamCount] = hash;
+                ++staleParamCount;
+            }
+            return requiredSize;
+        };
+
+        auto requiredSize = collectStaleTables();
+        if (m_pCurrentHeap == nullptr || !m_pCurrentHeap->HasValidSpace(requiredSize)) {
             RequestDescriptorHeap();
             m_GraphicsHandleCache.UnbindAllValid();
             m_ComputeHandleCache.UnbindAllValid();
+            // 新的堆中没有可以复用的描述符表，需要重新收集
+            requiredSize = collectStaleTables();
+            ASSERT(m_pCurrentHeap->HasValidSpace(requiredSize));
         }
+        handleCache.m_StaleRootParamsBitMap = 0;
 
         m_OwningCmdList->SetDescriptorHeap(m_pCurrentHeap->GetHeap());
-        handleCache.CopyAndBindStaleTables(m_HeapType, usedSize, m_pCurrentHeap->Allocate(usedSize), setFunc);
+
+        for (std::uint32_t i = 0; i < staleParamCount; ++i) {
+            auto rootIndex = rootIndexs[i];
+            const auto& descriptorTable = handleCache.m_DescriptorTables[rootIndex];
+            auto boundSize = descriptorTable.GetBoundSize();
+
+            // 同一批次中相同的描述符表也会复用前面刚拷贝的结果
+            bool inserted{};
+            auto copiedTable = m_CopiedTables.FindOrInsert(tableHashes[i], inserted);
+            DescriptorHandle gpuHandle{};
+            if (copiedTable != nullptr && !inserted && copiedTable->m_Table.IsSameBinding(descriptorTable)) {
+                gpuHandle = copiedTable->m_GpuHandle;
+                ++m_Stats.m_NumTablesReused;
+                m_Stats.m_NumDescriptorsSaved += boundSize;
+            }
+            else {
+                gpuHandle = m_pCurrentHeap->Allocate(boundSize);
+                CopyDescriptorTable(descriptorTable, gpuHandle);
+                // 表已满时不再记录，Hash 冲突时直接覆盖旧的记录
+                if (copiedTable != nullptr) {
+                    copiedTable->m_GpuHandle = gpuHandle;
+                    copiedTable->m_Table.m_AssignedHandlesBitMap = descriptorTable.m_AssignedHandlesBitMap;
+                    copiedTable->m_Table.m_TableHandles.assign(
+                        descriptorTable.m_TableHandles.begin(),
+                        descriptorTable.m_TableHandles.begin() + boundSize);
+                }
+
+                ++m_Stats.m_NumTablesCopied;
+                m_Stats.m_NumDescriptorsCopied += boundSize;
+            }
+            setFunc(rootIndex, gpuHandle);
+        }
+    }
+
+    void DynamicDescriptorHeap::CopyDescriptorTable(const DescriptorTableCache& table, DescriptorHandle destHandle)
+    {
+        // 每次最多拷贝 16 个源范围
+        static constexpr std::uint32_t maxDescriptorPerCopy = 16;
+        std::uint32_t numDestDescriptorRanges = 0;
+        D3D12_CPU_DESCRIPTOR_HANDLE pDestDescriptorRangesStarts[maxDescriptorPerCopy];
+        UINT pDestDescriptorRangesSizes[maxDescriptorPerCopy];
+        std::uint32_t numSrcDescriptorRanges = 0;
+        D3D12_CPU_DESCRIPTOR_HANDLE pSrcDescriptorRangesStarts[maxDescriptorPerCopy];
+        UINT pSrcDescriptorRangesSizes[maxDescriptorPerCopy];
+
+        auto flush = [&]() {
+            g_RenderContext.GetDevice()->CopyDescriptors(
+                numDestDescriptorRanges, pDestDescriptorRangesStarts, pDestDescriptorRangesSizes,
+                numSrcDescriptorRanges, pSrcDescriptorRangesStarts, pSrcDescriptorRangesSizes, m_HeapType);
+            numDestDescriptorRanges = 0;
+            numSrcDescriptorRanges = 0;
+        };
+
+        auto descriptorSize = m_pCurrentHeap->GetDescriptorSize();
+        auto setHandle = table.m_AssignedHandlesBitMap;
+        unsigned long index{};
+        while (_BitScanForward(&index, setHandle)) {
+            // 计算连续绑定的描述符数量，取反之后第一个索引即为数量
+            unsigned long descriptorCount{};
+            if (!_BitScanForward(&descriptorCount, ~(setHandle >> index))) {
+                descriptorCount = 32 - index;
+            }
+            setHandle &= descriptorCount + index >= 32 ? 0 : ~0u << (descriptorCount + index);
+
+            // 目标范围是连续的，源描述符不一定连续，因此逐个拷贝
+            for (std::uint32_t j = 0; j < descriptorCount;) {
+                if (numSrcDescriptorRanges == maxDescriptorPerCopy) {
+                    flush();
+                }
+                auto count = std::min<std::uint32_t>(descriptorCount - j, maxDescriptorPerCopy - numSrcDescriptorRanges);
+                pDestDescriptorRangesStarts[numDestDescriptorRanges] = destHandle + (index + j) * descriptorSize;
+                pDestDescriptorRangesSizes[numDestDescriptorRanges] = count;
+                ++numDestDescriptorRanges;
+                for (std::uint32_t k = 0; k < count; ++k, ++j) {
+                    pSrcDescriptorRangesStarts[numSrcDescriptorRanges] = table.m_TableHandles[index + j];
+                    pSrcDescriptorRangesSizes[numSrcDescriptorRanges] = 1;
+                    ++numSrcDescriptorRanges;
+                }
+            }
+        }
+        if (numSrcDescriptorRanges > 0) {
+            flush();
+        }
     }
 
     void DynamicDescriptorHeap::RequestDescriptorHeap()
@@ -372,5 +486,7 @@ namespace DSM {
         }
 
         m_pCurrentHeap = s_DynamicDescriptorHeapManager.RequestDescriptorHeap(m_HeapType);
+        // 旧堆中拷贝的描述符表不能在新堆中复用
+        m_CopiedTables.Clear();
     }
 }
@@ -5,12 +5,31 @@
 #include <queue>
 #include <functional>
 #include <array>
+#include <atomic>
 #include "DescriptorHeap.h"
+#include "../Utilities/FlatHashMap.h"
 
 namespace DSM {
     class RootSignature;
     class CommandList;
     class DescriptorHandle;
+
+    // 描述符表拷贝的统计信息
+    struct DynamicDescriptorHeapStats
+    {
+        std::uint64_t m_NumTablesCopied{};
+        // 命中缓存而直接复用的描述符表
+        std::uint64_t m_NumTablesReused{};
+        std::uint64_t m_NumDescriptorsCopied{};
+        // 因复用而避免拷贝的描述符
+        std::uint64_t m_NumDescriptorsSaved{};
+        // 节省的描述符相当于多少个 GPU 描述符堆
+        std::uint64_t m_NumHeapPagesSaved{};
+        // 已创建的着色器可见描述符堆，下标 0 为 CBV_SRV_UAV，1 为 Sampler
+        std::array<std::uint32_t, 2> m_NumHeaps{};
+        std::array<std::uint32_t, 2> m_NumIdleHeaps{};
+        std::array<std::uint32_t, 2> m_PeakUsedHeaps{};
+    };
     
     class DynamicDescriptorHeap
     {
@@ -18,10 +37,23 @@ namespace DSM {
         // 描述符表的缓冲
         struct DescriptorTableCache
         {
+            // 已绑定描述符的 Hash，未绑定的位置不参与计算
+            std::size_t ComputeHash() const noexcept;
+            // 已绑定的描述符是否完全相同
+            bool IsSameBinding(const DescriptorTableCache& other) const noexcept;
+            // 需要占用的描述符数量，即最后一个绑定的位置加一
+            std::uint32_t GetBoundSize() const noexcept;
+            
             // 用于描述描述符表中绑定了多少描述符
             std::uint32_t m_AssignedHandlesBitMap{};
             std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_TableHandles;
         };
+        // 已经拷贝到当前 GPU 描述符堆中的描述符表
+        struct CopiedDescriptorTable
+        {
+            DescriptorHandle m_GpuHandle{};
+            DescriptorTableCache m_Table{};
+        };
         // 储存所有的描述符表及描述符
         struct DescriptorHandleCache
         {
@@ -44,11 +76,6 @@ namespace DSM {
                 std::uint32_t offset,
                 std::uint32_t numHandles,
                 const D3D12_CPU_DESCRIPTOR_HANDLE handles[]);
-            void CopyAndBindStaleTables(
-                D3D12_DESCRIPTOR_HEAP_TYPE heapType,
-                std::uint32_t descriptorSize,
-                DescriptorHandle handleStart,
-                std::function<void(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)> setFunc);
             void Cleanup();
         };
         
@@ -98,18 +125,32 @@ namespace DSM {
         static DynamicDescriptorHeap* AllocateDynamicDescriptorHeap(CommandList* owningList, D3D12_DESCRIPTOR_HEAP_TYPE heapType);
         static void FreeDynamicDescriptorHeap(std::uint64_t fenceValue, DynamicDescriptorHeap* heap);
         static void DestroyAll();
+        
+        static DynamicDescriptorHeapStats GetStats() noexcept;
+        static void ResetStats() noexcept;
 
     private:
         void CopyAndBindStaleTables(
             DescriptorHandleCache& handleCache,
             std::function<void(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)> setFunc);
+        void CopyDescriptorTable(const DescriptorTableCache& table, DescriptorHandle destHandle);
         void RequestDescriptorHeap();
         
+    public:
+        inline static constexpr std::uint32_t sm_NumDescriptorsPerHeap = 1024;
+        // 每个堆中最多记录的已拷贝描述符表，超出后拷贝的表不再参与复用
+        inline static constexpr std::uint32_t sm_MaxCopiedTables = 256;
+        
     private:
         using DynamicDescriptorHeapPool = std::vector<std::unique_ptr<DynamicDescriptorHeap>>;
         inline static std::array<DynamicDescriptorHeapPool, 2> sm_DynamicDescriptorHeapPools{};
         inline static std::array<std::queue<DynamicDescriptorHeap*>, 2> sm_AvailableDescriptorHeaps{};
         inline static std::mutex sm_Mutex;
+
+        inline static std::atomic<std::uint64_t> sm_NumTablesCopied{};
+        inline static std::atomic<std::uint64_t> sm_NumTablesReused{};
+        inline static std::atomic<std::uint64_t> sm_NumDescriptorsCopied{};
+        inline static std::atomic<std::uint64_t> sm_NumDescriptorsSaved{};
         
         CommandList* m_OwningCmdList{};
         const D3D12_DESCRIPTOR_HEAP_TYPE m_HeapType{};
@@ -118,6 +159,11 @@ namespace DSM {
 
         DescriptorHandleCache m_GraphicsHandleCache{};
         DescriptorHandleCache m_ComputeHandleCache{};
+
+        // 以描述符表的 Hash 为键，当前堆中已拷贝过的描述符表，切换堆时清空，容量固定且存储在清空后复用
+        FlatHashMap<std::size_t, CopiedDescriptorTable> m_CopiedTables{sm_MaxCopiedTables};
+        // 提交命令列表时再累加到全局的统计中，避免每次绘制都访问原子变量
+        DynamicDescriptorHeapStats m_Stats{};
     };
 
     
@@ -46,6 +46,7 @@ namespace DSM::Graphics {
 
     std::array<Texture, kNumDefaultTexture> DefaultTextures;
     std::array<DescriptorHandle, kNumDefaultTexture> DefaultTextureHandles;
+    std::array<std::uint32_t, kNumDefaultTexture> DefaultTextureIndices;
     
     bool IsDirectXRaytracingSupported(ID3D12Device* device)
     {
@@ -62,6 +63,12 @@ namespace DSM::Graphics {
         return DefaultTextureHandles[texID];
     }
 
+    std::uint32_t GetDefaultTextureIndex(eDefaultTexture texID)
+    {
+        ASSERT(texID < kNumDefaultTexture);
+        return DefaultTextureIndices[texID];
+    }
+
     void InitializeCommon()
     {
         D3D12_SAMPLER_DESC samplerDesc{};
@@ -283,6 +290,11 @@ namespace DSM::Graphics {
         srvDesc.TextureCube.MipLevels = 1;
         g_RenderContext.GetDevice()->CreateShaderResourceView(
             DefaultTextures[kBlackCubeTex].GetResource(), &srvDesc, DefaultTextureHandles[kBlackCubeTex]);
+
+        // 默认纹理在常驻描述符堆中的索引
+        for (int i = 0; i < kNumDefaultTexture; ++i) {
+            DefaultTextureIndices[i] = g_RenderContext.GetBindlessHeap().Allocate(DefaultTextureHandles[i]);
+        }
     }
 
     void DestroyCommon()
@@ -293,6 +305,7 @@ namespace DSM::Graphics {
 
         for (int i = 0; i < kNumDefaultTexture; ++i) {
             g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, DefaultTextureHandles[i]);
+            g_RenderContext.FreeBindlessDescriptor(DefaultTextureIndices[i]);
         }
     }
 }
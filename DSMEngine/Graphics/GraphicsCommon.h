@@ -29,6 +29,8 @@ namespace DSM::Graphics {
     bool IsDirectXRaytracingSupported(ID3D12Device* device);
 
     D3D12_CPU_DESCRIPTOR_HANDLE GetDefaultTexture(eDefaultTexture texID);
+    // 默认纹理在常驻描述符堆中的索引
+    std::uint32_t GetDefaultTextureIndex(eDefaultTexture texID);
 
     extern D3D12_SAMPLER_DESC SamplerLinearWrap;
     extern D3D12_SAMPLER_DESC SamplerLinearBorder;
@@ -0,0 +1,355 @@
+#include "MemoryTelemetry.h"
+#include "RenderContext.h"
+#include "DynamicDescriptorHeap.h"
+#include "Resource/GpuResourceAllocator.h"
+
+namespace DSM {
+    static const char* GetHeapTypeName(D3D12_HEAP_TYPE heapType) noexcept
+    {
+        switch (heapType) {
+            case D3D12_HEAP_TYPE_DEFAULT: return "Default";
+            case D3D12_HEAP_TYPE_UPLOAD: return "Upload";
+            case D3D12_HEAP_TYPE_READBACK: return "Readback";
+            default: return "Custom";
+        }
+    }
+
+    static const char* GetDescriptorHeapTypeName(D3D12_DESCRIPTOR_HEAP_TYPE heapType) noexcept
+    {
+        switch (heapType) {
+            case D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV: return "CBV_SRV_UAV";
+            case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER: return "Sampler";
+            case D3D12_DESCRIPTOR_HEAP_TYPE_RTV: return "RTV";
+            case D3D12_DESCRIPTOR_HEAP_TYPE_DSV: return "DSV";
+            default: return "Unknown";
+        }
+    }
+
+    static const char* GetSizeClassName(GpuResourceSizeClass sizeClass) noexcept
+    {
+        switch (sizeClass) {
+            case GpuResourceSizeClass::Small: return "Small";
+            case GpuResourceSizeClass::Medium: return "Medium";
+            case GpuResourceSizeClass::MSAA: return "MSAA";
+            default: return "Large";
+        }
+    }
+
+    // 名称均由引擎生成，只需转义引号及反斜杠
+    static void AppendJsonString(std::string& json, std::string_view str)
+    {
+        json += '"';
+        for (auto c : str) {
+            if (c == '"' || c == '\\') {
+                json += '\\';
+            }
+            json += c;
+        }
+        json += '"';
+    }
+
+
+
+
+    //
+    // MemoryTelemetrySnapshot Implementation
+    //
+    const AllocatorTelemetry* MemoryTelemetrySnapshot::Find(std::string_view allocator, std::string_view heapType) const noexcept
+    {
+        auto it = std::find_if(m_Allocators.begin(), m_Allocators.end(), [&](const AllocatorTelemetry& telemetry) {
+            return telemetry.m_Allocator == allocator && telemetry.m_HeapType == heapType;
+        });
+        return it != m_Allocators.end() ? &*it : nullptr;
+    }
+
+    std::string MemoryTelemetrySnapshot::ToJson() const
+    {
+        std::string json{};
+        json += std::format("{{\"frame\":{},\"time\":{:.6f},\"totalReservedBytes\":{},\"totalUsedBytes\":{},\"allocators\":[",
+            m_FrameIndex, m_Time, m_TotalReservedBytes, m_TotalUsedBytes);
+        for (std::size_t i = 0; i < m_Allocators.size(); ++i) {
+            const auto& telemetry = m_Allocators[i];
+            json += i == 0 ? "{\"allocator\":" : ",{\"allocator\":";
+            AppendJsonString(json, telemetry.m_Allocator);
+            json += ",\"heapType\":";
+            AppendJsonString(json, telemetry.m_HeapType);
+            json += std::format(
+                ",\"reservedBytes\":{},\"usedBytes\":{},\"peakReservedBytes\":{},\"peakUsedBytes\":{},"
+                "\"pages\":{},\"fragmentation\":{:.4f},\"allocations\":{},\"allocationRate\":{:.2f},\"countedInTotal\":{}}}",
+                telemetry.m_ReservedBytes, telemetry.m_UsedBytes, telemetry.m_PeakReservedBytes, telemetry.m_PeakUsedBytes,
+                telemetry.m_NumPages, telemetry.m_Fragmentation, telemetry.m_NumAllocations, telemetry.m_AllocationRate,
+                telemetry.m_CountedInTotal);
+        }
+        json += "]}";
+        return json;
+    }
+
+
+
+
+    //
+    // MemoryTelemetry Implementation
+    //
+    std::uint32_t MemoryTelemetry::AddSource(TelemetrySource source)
+    {
+        ASSERT(source != nullptr);
+
+        std::lock_guard lock{m_Mutex};
+        auto sourceID = m_NextSourceID++;
+        m_Sources.emplace_back(sourceID, std::move(source));
+        return sourceID;
+    }
+
+    void MemoryTelemetry::RemoveSource(std::uint32_t sourceID)
+    {
+        std::lock_guard lock{m_Mutex};
+        std::erase_if(m_Sources, [sourceID](const auto& source) { return source.first == sourceID; });
+    }
+
+    MemoryTelemetrySnapshot MemoryTelemetry::Capture()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        MemoryTelemetrySnapshot snapshot{};
+        snapshot.m_FrameIndex = g_RenderContext.GetFrameIndex();
+        snapshot.m_Time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+        // 设备销毁后各个分配器已不可用
+        if (g_RenderContext.GetDevice() != nullptr) {
+            CollectGpuResourceAllocators(snapshot.m_Allocators);
+            CollectDynamicBufferAllocators(snapshot.m_Allocators);
+            CollectDescriptorHeaps(snapshot.m_Allocators);
+            CollectDeferredReleases(snapshot.m_Allocators);
+            CollectFrameArena(snapshot.m_Allocators);
+            for (const auto& [sourceID, source] : m_Sources) {
+                source(snapshot.m_Allocators);
+            }
+        }
+
+        for (auto& telemetry : snapshot.m_Allocators) {
+            auto& history = m_AllocatorHistory[telemetry.m_Allocator + '/' + telemetry.m_HeapType];
+            // 分配次数减少说明分配器被重新创建，此时不计算速率
+            if (history.m_Time != 0 && snapshot.m_Time > history.m_Time && telemetry.m_NumAllocations >= history.m_NumAllocations) {
+                telemetry.m_AllocationRate = (telemetry.m_NumAllocations - history.m_NumAllocations) / (snapshot.m_Time - history.m_Time);
+            }
+            history.m_PeakReservedBytes = std::max({history.m_PeakReservedBytes, telemetry.m_PeakReservedBytes, telemetry.m_ReservedBytes});
+            history.m_PeakUsedBytes = std::max({history.m_PeakUsedBytes, telemetry.m_PeakUsedBytes, telemetry.m_UsedBytes});
+            history.m_NumAllocations = telemetry.m_NumAllocations;
+            history.m_Time = snapshot.m_Time;
+            telemetry.m_PeakReservedBytes = history.m_PeakReservedBytes;
+            telemetry.m_PeakUsedBytes = history.m_PeakUsedBytes;
+
+            if (telemetry.m_CountedInTotal) {
+                snapshot.m_TotalReservedBytes += telemetry.m_ReservedBytes;
+                snapshot.m_TotalUsedBytes += telemetry.m_UsedBytes;
+            }
+        }
+
+        if (m_HistorySize > 0) {
+            if (m_History.size() >= m_HistorySize) {
+                m_History.pop_front();
+            }
+            m_History.push_back(snapshot);
+        }
+        return snapshot;
+    }
+
+    void MemoryTelemetry::EndFrame(std::uint64_t frameIndex)
+    {
+        if (m_CaptureInterval != 0 && frameIndex % m_CaptureInterval == 0) {
+            Capture();
+        }
+    }
+
+    void MemoryTelemetry::Reset()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        m_StartTime = std::chrono::steady_clock::now();
+        m_AllocatorHistory.clear();
+        m_History.clear();
+    }
+
+    void MemoryTelemetry::SetHistorySize(std::uint32_t historySize)
+    {
+        std::lock_guard lock{m_Mutex};
+
+        m_HistorySize = historySize;
+        while (m_History.size() > m_HistorySize) {
+            m_History.pop_front();
+        }
+    }
+
+    std::vector<MemoryTelemetrySnapshot> MemoryTelemetry::GetHistory()
+    {
+        std::lock_guard lock{m_Mutex};
+        return {m_History.begin(), m_History.end()};
+    }
+
+    std::string MemoryTelemetry::ExportJson()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        std::string json = "[";
+        for (std::size_t i = 0; i < m_History.size(); ++i) {
+            if (i != 0) {
+                json += ",\n";
+            }
+            json += m_History[i].ToJson();
+        }
+        json += "]\n";
+        return json;
+    }
+
+    bool MemoryTelemetry::ExportJson(const std::string& filename)
+    {
+        std::ofstream file{filename, std::ios::out | std::ios::trunc};
+        if (!file.is_open()) {
+            return false;
+        }
+        file << ExportJson();
+        return file.good();
+    }
+
+    void MemoryTelemetry::CollectGpuResourceAllocators(std::vector<AllocatorTelemetry>& allocators)
+    {
+        for (auto allocator : GetGpuResourceAllocators()) {
+            auto heapDesc = allocator->GetHeapDesc();
+            std::string heapName = GetHeapTypeName(heapDesc.m_HeapType);
+            if (heapDesc.m_HeapFlags != D3D12_HEAP_FLAG_NONE) {
+                heapName += std::format("|0x{:x}", static_cast<std::uint32_t>(heapDesc.m_HeapFlags));
+            }
+
+            // 以空闲空间加权各页的碎片率
+            constexpr auto numClasses = static_cast<std::size_t>(GpuResourceSizeClass::Count);
+            std::array<double, numClasses> weightedFragmentation{};
+            std::array<std::uint64_t, numClasses> freeBytes{};
+            for (const auto& pageStats : allocator->GetPageStats()) {
+                auto index = static_cast<std::size_t>(pageStats.m_SizeClass);
+                auto pageFreeBytes = pageStats.m_HeapSize - pageStats.m_UsedSize;
+                weightedFragmentation[index] += static_cast<double>(pageStats.m_Fragmentation) * pageFreeBytes;
+                freeBytes[index] += pageFreeBytes;
+            }
+
+            for (std::size_t i = 0; i < numClasses; ++i) {
+                auto sizeClass = static_cast<GpuResourceSizeClass>(i);
+                auto classStats = allocator->GetClassStats(sizeClass);
+                if (classStats.m_NumAllocations == 0) continue;
+
+                auto& telemetry = allocators.emplace_back();
+                telemetry.m_Allocator = "GpuResourceAllocator";
+                telemetry.m_HeapType = heapName + '/' + GetSizeClassName(sizeClass);
+                telemetry.m_ReservedBytes = classStats.m_HeapBytes + classStats.m_CommittedBytes;
+                telemetry.m_UsedBytes = classStats.m_AllocatedBytes;
+                telemetry.m_PeakReservedBytes = classStats.m_PeakReservedBytes;
+                telemetry.m_PeakUsedBytes = classStats.m_PeakAllocatedBytes;
+                telemetry.m_NumPages = classStats.m_NumHeaps;
+                telemetry.m_Fragmentation = freeBytes[i] == 0 ? 0 : static_cast<float>(weightedFragmentation[i] / freeBytes[i]);
+                telemetry.m_NumAllocations = classStats.m_NumAllocations;
+            }
+        }
+    }
+
+    void MemoryTelemetry::CollectDynamicBufferAllocators(std::vector<AllocatorTelemetry>& allocators)
+    {
+        auto collect = [&allocators](const char* name, DynamicBufferAllocator& allocator) {
+            auto stats = allocator.GetStats();
+            auto& telemetry = allocators.emplace_back();
+            telemetry.m_Allocator = name;
+            telemetry.m_HeapType = allocator.GetAllocateMode() == DynamicBufferAllocator::AllocateMode::GpuExclusive ?
+                GetHeapTypeName(D3D12_HEAP_TYPE_DEFAULT) : GetHeapTypeName(D3D12_HEAP_TYPE_UPLOAD);
+            telemetry.m_ReservedBytes = stats.m_ReservedBytes;
+            telemetry.m_UsedBytes = stats.m_UsedBytes;
+            telemetry.m_PeakReservedBytes = stats.m_PeakReservedBytes;
+            telemetry.m_PeakUsedBytes = stats.m_PeakUsedBytes;
+            telemetry.m_NumPages = stats.m_NumPages;
+            telemetry.m_NumAllocations = stats.m_NumAllocations;
+            // 缓冲区由资源分配器创建，已计入其中
+            telemetry.m_CountedInTotal = false;
+        };
+        collect("CpuBufferAllocator", g_RenderContext.GetCpuBufferAllocator());
+        collect("GpuBufferAllocator", g_RenderContext.GetGpuBufferAllocator());
+    }
+
+    void MemoryTelemetry::CollectDescriptorHeaps(std::vector<AllocatorTelemetry>& allocators)
+    {
+        auto pDevice = g_RenderContext.GetDevice();
+
+        for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i) {
+            auto heapType = static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i);
+            auto stats = g_RenderContext.GetDescriptorAllocatorStats(heapType);
+            if (stats.m_NumPages == 0) continue;
+
+            std::uint64_t descriptorSize = pDevice->GetDescriptorHandleIncrementSize(heapType);
+            auto& telemetry = allocators.emplace_back();
+            telemetry.m_Allocator = "DescriptorAllocator";
+            telemetry.m_HeapType = GetDescriptorHeapTypeName(heapType);
+            telemetry.m_ReservedBytes = stats.m_NumDescriptors * descriptorSize;
+            telemetry.m_UsedBytes = stats.m_NumUsedDescriptors * descriptorSize;
+            telemetry.m_PeakUsedBytes = stats.m_PeakUsedDescriptors * descriptorSize;
+            telemetry.m_NumPages = stats.m_NumPages;
+            // 单次分配不能跨页，因此以单页能容纳的最大范围为基准
+            if (auto numFree = std::min(stats.m_NumDescriptors - stats.m_NumUsedDescriptors, stats.m_NumDescriptors / stats.m_NumPages);
+                numFree > 0) {
+                telemetry.m_Fragmentation = 1.0f - static_cast<float>(stats.m_LargestFreeRange) / numFree;
+            }
+            telemetry.m_NumAllocations = stats.m_NumAllocations;
+        }
+
+        auto& bindlessHeap = g_RenderContext.GetBindlessHeap();
+        if (bindlessHeap.IsValid()) {
+            std::uint64_t descriptorSize = pDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+            auto& telemetry = allocators.emplace_back();
+            telemetry.m_Allocator = "BindlessDescriptorHeap";
+            telemetry.m_HeapType = GetDescriptorHeapTypeName(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+            telemetry.m_ReservedBytes = bindlessHeap.GetCapacity() * descriptorSize;
+            telemetry.m_UsedBytes = bindlessHeap.GetNumAllocated() * descriptorSize;
+            telemetry.m_NumPages = 1;
+        }
+
+        // 着色器可见的描述符堆整页分配给命令列表，拷贝的描述符表视为一次分配
+        auto dynamicStats = DynamicDescriptorHeap::GetStats();
+        for (int i = 0; i < 2; ++i) {
+            if (dynamicStats.m_NumHeaps[i] == 0) continue;
+
+            auto heapType = i == 0 ? D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV : D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+            std::uint64_t heapBytes = pDevice->GetDescriptorHandleIncrementSize(heapType) * DynamicDescriptorHeap::sm_NumDescriptorsPerHeap;
+            auto& telemetry = allocators.emplace_back();
+            telemetry.m_Allocator = "DynamicDescriptorHeap";
+            telemetry.m_HeapType = GetDescriptorHeapTypeName(heapType);
+            telemetry.m_ReservedBytes = dynamicStats.m_NumHeaps[i] * heapBytes;
+            telemetry.m_UsedBytes = (dynamicStats.m_NumHeaps[i] - dynamicStats.m_NumIdleHeaps[i]) * heapBytes;
+            telemetry.m_PeakUsedBytes = dynamicStats.m_PeakUsedHeaps[i] * heapBytes;
+            telemetry.m_NumPages = dynamicStats.m_NumHeaps[i];
+            if (i == 0) {
+                telemetry.m_NumAllocations = dynamicStats.m_NumTablesCopied;
+            }
+        }
+    }
+
+    void MemoryTelemetry::CollectDeferredReleases(std::vector<AllocatorTelemetry>& allocators)
+    {
+        // 等待 GPU 完成的资源已计入各自的分配器，仅用于观察回收是否滞后
+        auto stats = g_RenderContext.GetDeferredReleaseQueue().GetStats();
+        auto& telemetry = allocators.emplace_back();
+        telemetry.m_Allocator = "DeferredReleaseQueue";
+        telemetry.m_HeapType = "Pending";
+        telemetry.m_ReservedBytes = stats.m_PendingBytes;
+        telemetry.m_UsedBytes = stats.m_PendingBytes;
+        telemetry.m_NumPages = static_cast<std::uint32_t>(stats.m_NumPending);
+        telemetry.m_NumAllocations = stats.m_NumReleased + stats.m_NumPending;
+        telemetry.m_CountedInTotal = false;
+    }
+
+    void MemoryTelemetry::CollectFrameArena(std::vector<AllocatorTelemetry>& allocators)
+    {
+        // 帧内存为 CPU 内存，不计入显存总量
+        auto stats = g_RenderContext.GetFrameArena().GetStats();
+        auto& telemetry = allocators.emplace_back();
+        telemetry.m_Allocator = "FrameArena";
+        telemetry.m_HeapType = "Cpu";
+        telemetry.m_ReservedBytes = stats.m_ReservedBytes;
+        telemetry.m_NumPages = stats.m_NumBlocks;
+        telemetry.m_CountedInTotal = false;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+#ifndef __MEMORYTELEMETRY_H__
+#define __MEMORYTELEMETRY_H__
+
+#include "../pch.h"
+#include "../Utilities/Macros.h"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string_view>
+
+namespace DSM {
+    // 单个分配器在某一堆类型上的内存使用情况，描述符以字节计
+    struct AllocatorTelemetry
+    {
+        std::string m_Allocator{};
+        std::string m_HeapType{};
+        std::uint64_t m_ReservedBytes{};
+        std::uint64_t m_UsedBytes{};
+        // 取分配器内部记录的峰值与历次快照中的最大值
+        std::uint64_t m_PeakReservedBytes{};
+        std::uint64_t m_PeakUsedBytes{};
+        std::uint32_t m_NumPages{};
+        // 外部碎片率，0 表示空闲空间完全连续
+        float m_Fragmentation{};
+        // 累计分配次数，及与上一次快照之间每秒的分配次数
+        std::uint64_t m_NumAllocations{};
+        double m_AllocationRate{};
+        // 空间已被其他分配器统计时不计入总量，如纹理及动态缓冲区占用的堆
+        bool m_CountedInTotal = true;
+    };
+
+    // 某一时刻所有分配器的内存使用情况
+    struct MemoryTelemetrySnapshot
+    {
+        std::uint64_t m_FrameIndex{};
+        // 距离开始测量的时间，单位为秒
+        double m_Time{};
+        std::uint64_t m_TotalReservedBytes{};
+        std::uint64_t m_TotalUsedBytes{};
+        std::vector<AllocatorTelemetry> m_Allocators{};
+
+        const AllocatorTelemetry* Find(std::string_view allocator, std::string_view heapType) const noexcept;
+        std::string ToJson() const;
+    };
+
+    // 汇总引擎中各个分配器的统计信息，支持按帧自动采集快照及导出为 JSON
+    class MemoryTelemetry
+    {
+    public:
+        // 向快照中追加引擎外部模块的统计
+        using TelemetrySource = std::function<void(std::vector<AllocatorTelemetry>&)>;
+        inline static constexpr std::uint32_t INVALID_SOURCE_ID = 0;
+
+        MemoryTelemetry() = default;
+        ~MemoryTelemetry() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(MemoryTelemetry);
+
+        std::uint32_t AddSource(TelemetrySource source);
+        void RemoveSource(std::uint32_t sourceID);
+
+        // 采集所有分配器的当前状态，更新峰值及分配速率并记入历史
+        MemoryTelemetrySnapshot Capture();
+        // 每帧结束时调用，按采集间隔自动采集快照
+        void EndFrame(std::uint64_t frameIndex);
+        // 清除峰值、速率及历史，用于开始新一轮测量
+        void Reset();
+
+        // 每隔多少帧自动采集一次，为 0 时关闭
+        void SetCaptureInterval(std::uint32_t numFrames) noexcept { m_CaptureInterval = numFrames; }
+        // 保留最近的快照数量，为 0 时不记录历史
+        void SetHistorySize(std::uint32_t historySize);
+        std::vector<MemoryTelemetrySnapshot> GetHistory();
+
+        // 以数组导出历史中的所有快照
+        std::string ExportJson();
+        bool ExportJson(const std::string& filename);
+
+    private:
+        // 同一分配器及堆类型在历次快照之间累积的信息
+        struct AllocatorHistory
+        {
+            std::uint64_t m_PeakReservedBytes{};
+            std::uint64_t m_PeakUsedBytes{};
+            std::uint64_t m_NumAllocations{};
+            double m_Time{};
+        };
+
+        static void CollectGpuResourceAllocators(std::vector<AllocatorTelemetry>& allocators);
+        static void CollectDynamicBufferAllocators(std::vector<AllocatorTelemetry>& allocators);
+        static void CollectDescriptorHeaps(std::vector<AllocatorTelemetry>& allocators);
+        static void CollectDeferredReleases(std::vector<AllocatorTelemetry>& allocators);
+        static void CollectFrameArena(std::vector<AllocatorTelemetry>& allocators);
+
+    private:
+        std::mutex m_Mutex{};
+        std::chrono::steady_clock::time_point m_StartTime = std::chrono::steady_clock::now();
+
+        std::vector<std::pair<std::uint32_t, TelemetrySource>> m_Sources{};
+        std::uint32_t m_NextSourceID = INVALID_SOURCE_ID + 1;
+
+        std::unordered_map<std::string, AllocatorHistory> m_AllocatorHistory{};
+        std::deque<MemoryTelemetrySnapshot> m_History{};
+        std::uint32_t m_HistorySize = 64;
+        std::uint32_t m_CaptureInterval{};
+    };
+}
+
+#endif
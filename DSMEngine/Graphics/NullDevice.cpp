@@ -0,0 +1,1568 @@
+#include "NullDevice.h"
+#include "../Math/MathCommon.h"
+#include "../Utilities/FormatUtil.h"
+#include <condition_variable>
+#include <deque>
+
+namespace DSM {
+    static NullDeviceStats s_NullDeviceStats{};
+
+    void NullDeviceStats::ResetCounters() noexcept
+    {
+        m_NumHeapsCreated = 0;
+        m_NumCommittedResources = 0;
+        m_NumPlacedResources = 0;
+        m_NumDescriptorsCreated = 0;
+        m_NumDescriptorsCopied = 0;
+        m_NumCommandListsExecuted = 0;
+        m_NumCommands = 0;
+        m_NumDrawCalls = 0;
+        m_NumDispatches = 0;
+        m_NumBarriers = 0;
+        m_NumCopies = 0;
+        m_NumFenceSignals = 0;
+    }
+
+    NullDeviceStats& GetNullDeviceStats() noexcept
+    {
+        return s_NullDeviceStats;
+    }
+
+
+    //
+    // 公共的 COM 实现
+    //
+    template <typename TInterface, typename... TOthers>
+    class NullObject : public TInterface
+    {
+    public:
+        NullObject() = default;
+        virtual ~NullObject() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(NullObject);
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+        {
+            if (ppvObject == nullptr) return E_POINTER;
+
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D12Object) ||
+                riid == __uuidof(TInterface) || ((riid == __uuidof(TOthers)) || ...)) {
+                *ppvObject = static_cast<TInterface*>(this);
+                AddRef();
+                return S_OK;
+            }
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return ++m_RefCount;
+        }
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            auto refCount = --m_RefCount;
+            if (refCount == 0) {
+                delete this;
+            }
+            return refCount;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID guid, UINT* pDataSize, void* pData) override
+        {
+            if (pDataSize == nullptr) return E_INVALIDARG;
+
+            std::lock_guard lock{m_PrivateDataMutex};
+            auto it = std::find_if(m_PrivateData.begin(), m_PrivateData.end(),
+                [&guid](const auto& data) { return data.first == guid; });
+            if (it == m_PrivateData.end()) {
+                *pDataSize = 0;
+                return DXGI_ERROR_NOT_FOUND;
+            }
+
+            auto dataSize = static_cast<UINT>(it->second.size());
+            if (pData != nullptr) {
+                if (*pDataSize < dataSize) {
+                    *pDataSize = dataSize;
+                    return DXGI_ERROR_MORE_DATA;
+                }
+                memcpy(pData, it->second.data(), dataSize);
+            }
+            *pDataSize = dataSize;
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID guid, UINT DataSize, const void* pData) override
+        {
+            std::lock_guard lock{m_PrivateDataMutex};
+            std::erase_if(m_PrivateData, [&guid](const auto& data) { return data.first == guid; });
+            if (pData != nullptr && DataSize > 0) {
+                auto bytes = static_cast<const std::uint8_t*>(pData);
+                m_PrivateData.emplace_back(guid, std::vector<std::uint8_t>(bytes, bytes + DataSize));
+            }
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID guid, const IUnknown* pData) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE SetName(LPCWSTR Name) override
+        {
+            std::lock_guard lock{m_PrivateDataMutex};
+            m_Name = Name != nullptr ? Name : L"";
+            return S_OK;
+        }
+
+    private:
+        std::atomic<ULONG> m_RefCount{1};
+
+        std::mutex m_PrivateDataMutex{};
+        std::wstring m_Name{};
+        std::vector<std::pair<GUID, std::vector<std::uint8_t>>> m_PrivateData{};
+    };
+
+    // 创建对象并查询所需的接口
+    template <typename T, typename... Args>
+    HRESULT CreateNullObject(REFIID riid, void** ppvObject, Args&&... args)
+    {
+        auto pObject = new T(std::forward<Args>(args)...);
+        // 与 D3D12 一致，不传入输出指针时只做参数校验
+        HRESULT hr = ppvObject != nullptr ? pObject->QueryInterface(riid, ppvObject) : S_FALSE;
+        pObject->Release();
+        return hr;
+    }
+
+
+    //
+    // 描述符，记录视图的类型及其引用的资源
+    //
+    struct alignas(32) NullDescriptor
+    {
+        enum class Type : std::uint32_t { None, CBV, SRV, UAV, RTV, DSV, Sampler };
+
+        Type m_Type = Type::None;
+        DXGI_FORMAT m_Format = DXGI_FORMAT_UNKNOWN;
+        ID3D12Resource* m_Resource = nullptr;
+        // 常量缓冲区的地址
+        D3D12_GPU_VIRTUAL_ADDRESS m_Location = 0;
+    };
+
+    static void WriteNullDescriptor(
+        D3D12_CPU_DESCRIPTOR_HANDLE handle,
+        NullDescriptor::Type type,
+        ID3D12Resource* resource,
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN,
+        D3D12_GPU_VIRTUAL_ADDRESS location = 0)
+    {
+        ASSERT(handle.ptr != 0);
+
+        auto& descriptor = *reinterpret_cast<NullDescriptor*>(handle.ptr);
+        descriptor.m_Type = type;
+        descriptor.m_Format = format;
+        descriptor.m_Resource = resource;
+        descriptor.m_Location = location;
+        ++s_NullDeviceStats.m_NumDescriptorsCreated;
+    }
+
+
+    //
+    // 由 CPU 内存模拟的显存，GPU 虚拟地址即为 CPU 地址
+    //
+    class NullMemory
+    {
+    public:
+        NullMemory(std::uint64_t size, bool cpuAccessible)
+            :m_Size(size)
+        {
+            // CPU 不可访问的内存只保留地址空间，不占用物理内存
+            DWORD allocType = cpuAccessible ? MEM_RESERVE | MEM_COMMIT : MEM_RESERVE;
+            DWORD protect = cpuAccessible ? PAGE_READWRITE : PAGE_NOACCESS;
+            m_Data = static_cast<std::uint8_t*>(VirtualAlloc(nullptr, static_cast<SIZE_T>(size), allocType, protect));
+        }
+        ~NullMemory()
+        {
+            if (m_Data != nullptr) {
+                VirtualFree(m_Data, 0, MEM_RELEASE);
+            }
+        }
+        DSM_NONCOPYABLE_NONMOVABLE(NullMemory);
+
+        std::uint8_t* GetData() const noexcept { return m_Data; }
+        std::uint64_t GetSize() const noexcept { return m_Size; }
+
+    private:
+        std::uint8_t* m_Data = nullptr;
+        std::uint64_t m_Size = 0;
+    };
+
+    static bool IsCpuAccessible(const D3D12_HEAP_PROPERTIES& heapProps) noexcept
+    {
+        switch (heapProps.Type) {
+            case D3D12_HEAP_TYPE_UPLOAD:
+            case D3D12_HEAP_TYPE_READBACK: return true;
+            case D3D12_HEAP_TYPE_CUSTOM: return heapProps.CPUPageProperty != D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE;
+            default: return false;
+        }
+    }
+
+    static std::uint32_t GetNullMipLevels(const D3D12_RESOURCE_DESC& desc) noexcept
+    {
+        if (desc.MipLevels != 0) return desc.MipLevels;
+
+        // 0 表示完整的 Mip 链
+        auto maxExtent = std::max<std::uint64_t>(desc.Width, desc.Height);
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) {
+            maxExtent = std::max<std::uint64_t>(maxExtent, desc.DepthOrArraySize);
+        }
+        std::uint32_t mipLevels = 1;
+        while (maxExtent > 1) {
+            maxExtent >>= 1;
+            ++mipLevels;
+        }
+        return mipLevels;
+    }
+
+    static std::uint32_t GetNullArraySize(const D3D12_RESOURCE_DESC& desc) noexcept
+    {
+        return desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1u : desc.DepthOrArraySize;
+    }
+
+    static std::uint32_t GetNullMipDepth(const D3D12_RESOURCE_DESC& desc, std::uint32_t mipIndex) noexcept
+    {
+        return desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ?
+            std::max(1u, static_cast<std::uint32_t>(desc.DepthOrArraySize) >> mipIndex) : 1u;
+    }
+
+    // 模拟 D3D12 的对齐规则：默认 64KB，MSAA 4MB，
+    // 不作为渲染目标的小纹理可以申请 4KB(MSAA 为 64KB) 的小对齐
+    static D3D12_RESOURCE_ALLOCATION_INFO GetNullAllocationInfo(const D3D12_RESOURCE_DESC& desc) noexcept
+    {
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+            const std::uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            if (desc.Alignment != 0 && desc.Alignment != alignment) {
+                return {UINT64_MAX, alignment};
+            }
+            return {Math::AlignUp(desc.Width, alignment), alignment};
+        }
+
+        bool isMSAA = desc.SampleDesc.Count > 1;
+        std::uint64_t size = 0;
+        auto mipLevels = GetNullMipLevels(desc);
+        for (std::uint32_t mip = 0; mip < mipLevels; ++mip) {
+            auto slicePitch = Utility::GetSlicePitch(
+                desc.Format, static_cast<std::uint32_t>(desc.Width), desc.Height, mip);
+            size += slicePitch * GetNullMipDepth(desc, mip);
+        }
+        size *= GetNullArraySize(desc) * std::max(1u, desc.SampleDesc.Count);
+
+        std::uint64_t alignment = isMSAA ?
+            D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        if (desc.Alignment != 0 && desc.Alignment < alignment) {
+            std::uint64_t smallAlignment = isMSAA ?
+                D3D12_SMALL_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+            bool isTarget = desc.Flags &
+                (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+            if (desc.Alignment != smallAlignment || isTarget || size > alignment) {
+                return {UINT64_MAX, alignment};
+            }
+            alignment = smallAlignment;
+        }
+        else if (desc.Alignment > alignment) {
+            alignment = desc.Alignment;
+        }
+
+        return {Math::AlignUp(size, alignment), alignment};
+    }
+
+
+    //
+    // 设备
+    //
+    class NullDevice : public NullObject<ID3D12Device5,
+        ID3D12Device4, ID3D12Device3, ID3D12Device2, ID3D12Device1, ID3D12Device>
+    {
+    public:
+        NullDevice(const NullDeviceDesc& desc) : m_Desc(desc) {}
+
+        // 模拟的 GPU 时间线，每次提交命令列表推进一次
+        std::uint64_t GetSubmitTick() const noexcept { return m_SubmitTick; }
+        std::uint64_t AdvanceSubmitTick() noexcept { return ++m_SubmitTick; }
+        std::uint32_t GetFenceLatency() const noexcept { return m_Desc.m_FenceLatency; }
+
+        // ID3D12Device
+        UINT STDMETHODCALLTYPE GetNodeCount() override { return 1; }
+        HRESULT STDMETHODCALLTYPE CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc, REFIID riid, void** ppCommandQueue) override;
+        HRESULT STDMETHODCALLTYPE CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE type, REFIID riid, void** ppCommandAllocator) override;
+        HRESULT STDMETHODCALLTYPE CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc, REFIID riid, void** ppPipelineState) override;
+        HRESULT STDMETHODCALLTYPE CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* pDesc, REFIID riid, void** ppPipelineState) override;
+        HRESULT STDMETHODCALLTYPE CreateCommandList(
+            UINT nodeMask,
+            D3D12_COMMAND_LIST_TYPE type,
+            ID3D12CommandAllocator* pCommandAllocator,
+            ID3D12PipelineState* pInitialState,
+            REFIID riid,
+            void** ppCommandList) override;
+        HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D12_FEATURE Feature, void* pFeatureSupportData, UINT FeatureSupportDataSize) override;
+        HRESULT STDMETHODCALLTYPE CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc, REFIID riid, void** ppvHeap) override;
+        UINT STDMETHODCALLTYPE GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapType) override
+        {
+            return sizeof(NullDescriptor);
+        }
+        HRESULT STDMETHODCALLTYPE CreateRootSignature(
+            UINT nodeMask,
+            const void* pBlobWithRootSignature,
+            SIZE_T blobLengthInBytes,
+            REFIID riid,
+            void** ppvRootSignature) override;
+        void STDMETHODCALLTYPE CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override
+        {
+            WriteNullDescriptor(DestDescriptor, NullDescriptor::Type::CBV, nullptr,
+                DXGI_FORMAT_UNKNOWN, pDesc != nullptr ? pDesc->BufferLocation : 0);
+        }
+        void STDMETHODCALLTYPE CreateShaderResourceView(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override
+        {
+            WriteNullDescriptor(DestDescriptor, NullDescriptor::Type::SRV, pResource,
+                pDesc != nullptr ? pDesc->Format : DXGI_FORMAT_UNKNOWN);
+        }
+        void STDMETHODCALLTYPE CreateUnorderedAccessView(
+            ID3D12Resource* pResource,
+            ID3D12Resource* pCounterResource,
+            const D3D12_UNORDERED_ACCESS_VIEW_DESC* pDesc,
+            D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override
+        {
+            WriteNullDescriptor(DestDescriptor, NullDescriptor::Type::UAV, pResource,
+                pDesc != nullptr ? pDesc->Format : DXGI_FORMAT_UNKNOWN);
+        }
+        void STDMETHODCALLTYPE CreateRenderTargetView(ID3D12Resource* pResource, const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override
+        {
+            WriteNullDescriptor(DestDescriptor, NullDescriptor::Type::RTV, pResource,
+                pDesc != nullptr ? pDesc->Format : DXGI_FORMAT_UNKNOWN);
+        }
+        void STDMETHODCALLTYPE CreateDepthStencilView(ID3D12Resource* pResource, const D3D12_DEPTH_STENCIL_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override
+        {
+            WriteNullDescriptor(DestDescriptor, NullDescriptor::Type::DSV, pResource,
+                pDesc != nullptr ? pDesc->Format : DXGI_FORMAT_UNKNOWN);
+        }
+        void STDMETHODCALLTYPE CreateSampler(const D3D12_SAMPLER_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override
+        {
+            WriteNullDescriptor(DestDescriptor, NullDescriptor::Type::Sampler, nullptr);
+        }
+        void STDMETHODCALLTYPE CopyDescriptors(
+            UINT NumDestDescriptorRanges,
+            const D3D12_CPU_DESCRIPTOR_HANDLE* pDestDescriptorRangeStarts,
+            const UINT* pDestDescriptorRangeSizes,
+            UINT NumSrcDescriptorRanges,
+            const D3D12_CPU_DESCRIPTOR_HANDLE* pSrcDescriptorRangeStarts,
+            const UINT* pSrcDescriptorRangeSizes,
+            D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapsType) override;
+        void STDMETHODCALLTYPE CopyDescriptorsSimple(
+            UINT NumDescriptors,
+            D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptorRangeStart,
+            D3D12_CPU_DESCRIPTOR_HANDLE SrcDescriptorRangeStart,
+            D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapsType) override
+        {
+            CopyDescriptors(1, &DestDescriptorRangeStart, &NumDescriptors,
+                1, &SrcDescriptorRangeStart, &NumDescriptors, DescriptorHeapsType);
+        }
+        D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GetResourceAllocationInfo(
+            UINT visibleMask,
+            UINT numResourceDescs,
+            const D3D12_RESOURCE_DESC* pResourceDescs) override
+        {
+            return GetResourceAllocationInfo1(visibleMask, numResourceDescs, pResourceDescs, nullptr);
+        }
+        D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GetCustomHeapProperties(UINT nodeMask, D3D12_HEAP_TYPE heapType) override;
+        HRESULT STDMETHODCALLTYPE CreateCommittedResource(
+            const D3D12_HEAP_PROPERTIES* pHeapProperties,
+            D3D12_HEAP_FLAGS HeapFlags,
+            const D3D12_RESOURCE_DESC* pDesc,
+            D3D12_RESOURCE_STATES InitialResourceState,
+            const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+            REFIID riidResource,
+            void** ppvResource) override;
+        HRESULT STDMETHODCALLTYPE CreateHeap(const D3D12_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap) override;
+        HRESULT STDMETHODCALLTYPE CreatePlacedResource(
+            ID3D12Heap* pHeap,
+            UINT64 HeapOffset,
+            const D3D12_RESOURCE_DESC* pDesc,
+            D3D12_RESOURCE_STATES InitialState,
+            const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+            REFIID riid,
+            void** ppvResource) override;
+        HRESULT STDMETHODCALLTYPE CreateReservedResource(
+            const D3D12_RESOURCE_DESC* pDesc,
+            D3D12_RESOURCE_STATES InitialState,
+            const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+            REFIID riid,
+            void** ppvResource) override;
+        HRESULT STDMETHODCALLTYPE CreateSharedHandle(
+            ID3D12DeviceChild* pObject,
+            const SECURITY_ATTRIBUTES* pAttributes,
+            DWORD Access,
+            LPCWSTR Name,
+            HANDLE* pHandle) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE OpenSharedHandle(HANDLE NTHandle, REFIID riid, void** ppvObj) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE OpenSharedHandleByName(LPCWSTR Name, DWORD Access, HANDLE* pNTHandle) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE MakeResident(UINT NumObjects, ID3D12Pageable* const* ppObjects) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE Evict(UINT NumObjects, ID3D12Pageable* const* ppObjects) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS Flags, REFIID riid, void** ppFence) override;
+        HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override
+        {
+            return m_Removed ? DXGI_ERROR_DEVICE_REMOVED : S_OK;
+        }
+        void STDMETHODCALLTYPE GetCopyableFootprints(
+            const D3D12_RESOURCE_DESC* pResourceDesc,
+            UINT FirstSubresource,
+            UINT NumSubresources,
+            UINT64 BaseOffset,
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts,
+            UINT* pNumRows,
+            UINT64* pRowSizeInBytes,
+            UINT64* pTotalBytes) override;
+        HRESULT STDMETHODCALLTYPE CreateQueryHeap(const D3D12_QUERY_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap) override;
+        HRESULT STDMETHODCALLTYPE SetStablePowerState(BOOL Enable) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE CreateCommandSignature(
+            const D3D12_COMMAND_SIGNATURE_DESC* pDesc,
+            ID3D12RootSignature* pRootSignature,
+            REFIID riid,
+            void** ppvCommandSignature) override;
+        void STDMETHODCALLTYPE GetResourceTiling(
+            ID3D12Resource* pTiledResource,
+            UINT* pNumTilesForEntireResource,
+            D3D12_PACKED_MIP_INFO* pPackedMipDesc,
+            D3D12_TILE_SHAPE* pStandardTileShapeForNonPackedMips,
+            UINT* pNumSubresourceTilings,
+            UINT FirstSubresourceTilingToGet,
+            D3D12_SUBRESOURCE_TILING* pSubresourceTilingsForNonPackedMips) override
+        {
+            if (pNumTilesForEntireResource != nullptr) *pNumTilesForEntireResource = 0;
+            if (pPackedMipDesc != nullptr) *pPackedMipDesc = {};
+            if (pStandardTileShapeForNonPackedMips != nullptr) *pStandardTileShapeForNonPackedMips = {};
+            if (pNumSubresourceTilings != nullptr) *pNumSubresourceTilings = 0;
+        }
+        LUID STDMETHODCALLTYPE GetAdapterLuid() override { return LUID{}; }
+
+        // ID3D12Device1
+        HRESULT STDMETHODCALLTYPE CreatePipelineLibrary(const void* pLibraryBlob, SIZE_T BlobLength, REFIID riid, void** ppPipelineLibrary) override
+        {
+            return DXGI_ERROR_UNSUPPORTED;
+        }
+        HRESULT STDMETHODCALLTYPE SetEventOnMultipleFenceCompletion(
+            ID3D12Fence* const* ppFences,
+            const UINT64* pFenceValues,
+            UINT NumFences,
+            D3D12_MULTIPLE_FENCE_WAIT_FLAGS Flags,
+            HANDLE hEvent) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE SetResidencyPriority(UINT NumObjects, ID3D12Pageable* const* ppObjects, const D3D12_RESIDENCY_PRIORITY* pPriorities) override
+        {
+            return S_OK;
+        }
+
+        // ID3D12Device2
+        HRESULT STDMETHODCALLTYPE CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC* pDesc, REFIID riid, void** ppPipelineState) override;
+
+        // ID3D12Device3
+        HRESULT STDMETHODCALLTYPE OpenExistingHeapFromAddress(const void* pAddress, REFIID riid, void** ppvHeap) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE OpenExistingHeapFromFileMapping(HANDLE hFileMapping, REFIID riid, void** ppvHeap) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE EnqueueMakeResident(
+            D3D12_RESIDENCY_FLAGS Flags,
+            UINT NumObjects,
+            ID3D12Pageable* const* ppObjects,
+            ID3D12Fence* pFenceToSignal,
+            UINT64 FenceValueToSignal) override
+        {
+            return pFenceToSignal != nullptr ? pFenceToSignal->Signal(FenceValueToSignal) : E_INVALIDARG;
+        }
+
+        // ID3D12Device4
+        HRESULT STDMETHODCALLTYPE CreateCommandList1(
+            UINT nodeMask,
+            D3D12_COMMAND_LIST_TYPE type,
+            D3D12_COMMAND_LIST_FLAGS flags,
+            REFIID riid,
+            void** ppCommandList) override;
+        HRESULT STDMETHODCALLTYPE CreateProtectedResourceSession(const D3D12_PROTECTED_RESOURCE_SESSION_DESC* pDesc, REFIID riid, void** ppSession) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE CreateCommittedResource1(
+            const D3D12_HEAP_PROPERTIES* pHeapProperties,
+            D3D12_HEAP_FLAGS HeapFlags,
+            const D3D12_RESOURCE_DESC* pDesc,
+            D3D12_RESOURCE_STATES InitialResourceState,
+            const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+            ID3D12ProtectedResourceSession* pProtectedSession,
+            REFIID riidResource,
+            void** ppvResource) override
+        {
+            return CreateCommittedResource(pHeapProperties, HeapFlags, pDesc,
+                InitialResourceState, pOptimizedClearValue, riidResource, ppvResource);
+        }
+        HRESULT STDMETHODCALLTYPE CreateHeap1(
+            const D3D12_HEAP_DESC* pDesc,
+            ID3D12ProtectedResourceSession* pProtectedSession,
+            REFIID riid,
+            void** ppvHeap) override
+        {
+            return CreateHeap(pDesc, riid, ppvHeap);
+        }
+        HRESULT STDMETHODCALLTYPE CreateReservedResource1(
+            const D3D12_RESOURCE_DESC* pDesc,
+            D3D12_RESOURCE_STATES InitialState,
+            const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+            ID3D12ProtectedResourceSession* pProtectedSession,
+            REFIID riid,
+            void** ppvResource) override
+        {
+            return CreateReservedResource(pDesc, InitialState, pOptimizedClearValue, riid, ppvResource);
+        }
+        D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GetResourceAllocationInfo1(
+            UINT visibleMask,
+            UINT numResourceDescs,
+            const D3D12_RESOURCE_DESC* pResourceDescs,
+            D3D12_RESOURCE_ALLOCATION_INFO1* pResourceAllocationInfo1) override;
+
+        // ID3D12Device5
+        HRESULT STDMETHODCALLTYPE CreateLifetimeTracker(ID3D12LifetimeOwner* pOwner, REFIID riid, void** ppvTracker) override
+        {
+            return E_NOTIMPL;
+        }
+        void STDMETHODCALLTYPE RemoveDevice() override { m_Removed = true; }
+        HRESULT STDMETHODCALLTYPE EnumerateMetaCommands(UINT* pNumMetaCommands, D3D12_META_COMMAND_DESC* pDescs) override
+        {
+            if (pNumMetaCommands == nullptr) return E_INVALIDARG;
+            *pNumMetaCommands = 0;
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE EnumerateMetaCommandParameters(
+            REFGUID CommandId,
+            D3D12_META_COMMAND_PARAMETER_STAGE Stage,
+            UINT* pTotalStructureSizeInBytes,
+            UINT* pParameterCount,
+            D3D12_META_COMMAND_PARAMETER_DESC* pParameterDescs) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE CreateMetaCommand(
+            REFGUID CommandId,
+            UINT NodeMask,
+            const void* pCreationParametersData,
+            SIZE_T CreationParametersDataSizeInBytes,
+            REFIID riid,
+            void** ppMetaCommand) override
+        {
+            return E_NOTIMPL;
+        }
+        // 空设备不支持光追
+        HRESULT STDMETHODCALLTYPE CreateStateObject(const D3D12_STATE_OBJECT_DESC* pDesc, REFIID riid, void** ppStateObject) override
+        {
+            return E_NOTIMPL;
+        }
+        void STDMETHODCALLTYPE GetRaytracingAccelerationStructurePrebuildInfo(
+            const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* pDesc,
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO* pInfo) override
+        {
+            if (pInfo != nullptr) *pInfo = {};
+        }
+        D3D12_DRIVER_MATCHING_IDENTIFIER_STATUS STDMETHODCALLTYPE CheckDriverMatchingIdentifier(
+            D3D12_SERIALIZED_DATA_TYPE SerializedDataType,
+            const D3D12_SERIALIZED_DATA_DRIVER_MATCHING_IDENTIFIER* pIdentifierToCheck) override
+        {
+            return D3D12_DRIVER_MATCHING_IDENTIFIER_UNSUPPORTED_TYPE;
+        }
+
+    private:
+        NullDeviceDesc m_Desc{};
+        std::atomic<std::uint64_t> m_SubmitTick{};
+        std::atomic<bool> m_Removed = false;
+    };
+
+
+    //
+    // 设备子对象，与 D3D12 一致会持有设备的引用
+    //
+    template <typename TInterface, typename... TOthers>
+    class NullDeviceChild : public NullObject<TInterface, ID3D12DeviceChild, TOthers...>
+    {
+    public:
+        NullDeviceChild(NullDevice* device)
+            :m_Device(device)
+        {
+            m_Device->AddRef();
+        }
+        ~NullDeviceChild() override
+        {
+            m_Device->Release();
+        }
+
+        HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override
+        {
+            return m_Device->QueryInterface(riid, ppvDevice);
+        }
+
+    protected:
+        NullDevice* m_Device = nullptr;
+    };
+
+    class NullHeap : public NullDeviceChild<ID3D12Heap, ID3D12Pageable>
+    {
+    public:
+        NullHeap(NullDevice* device, const D3D12_HEAP_DESC& desc)
+            :NullDeviceChild(device),
+            m_Desc(desc),
+            m_Memory(desc.SizeInBytes, IsCpuAccessible(desc.Properties))
+        {
+            if (m_Desc.Alignment == 0) {
+                m_Desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            }
+            ++s_NullDeviceStats.m_LiveHeaps;
+            ++s_NullDeviceStats.m_NumHeapsCreated;
+            s_NullDeviceStats.m_HeapBytes += m_Desc.SizeInBytes;
+        }
+        ~NullHeap() override
+        {
+            --s_NullDeviceStats.m_LiveHeaps;
+            s_NullDeviceStats.m_HeapBytes -= m_Desc.SizeInBytes;
+        }
+
+        D3D12_HEAP_DESC STDMETHODCALLTYPE GetDesc() override { return m_Desc; }
+
+        bool IsValid() const noexcept { return m_Memory.GetData() != nullptr; }
+        std::uint8_t* GetData() const noexcept { return m_Memory.GetData(); }
+
+    private:
+        D3D12_HEAP_DESC m_Desc{};
+        NullMemory m_Memory;
+    };
+
+    class NullResource : public NullDeviceChild<ID3D12Resource, ID3D12Pageable>
+    {
+    public:
+        // 提交资源，独占一块内存
+        NullResource(
+            NullDevice* device,
+            const D3D12_RESOURCE_DESC& desc,
+            const D3D12_HEAP_PROPERTIES& heapProps,
+            D3D12_HEAP_FLAGS heapFlags,
+            std::uint64_t allocationSize)
+            :NullDeviceChild(device),
+            m_Desc(desc),
+            m_HeapProperties(heapProps),
+            m_HeapFlags(heapFlags),
+            m_Memory(std::make_unique<NullMemory>(allocationSize, IsCpuAccessible(heapProps)))
+        {
+            m_Data = m_Memory->GetData();
+            ++s_NullDeviceStats.m_LiveResources;
+            ++s_NullDeviceStats.m_NumCommittedResources;
+            s_NullDeviceStats.m_CommittedBytes += allocationSize;
+        }
+        // 定位资源，使用堆中的内存
+        NullResource(NullDevice* device, const D3D12_RESOURCE_DESC& desc, NullHeap* heap, std::uint64_t heapOffset)
+            :NullDeviceChild(device),
+            m_Desc(desc),
+            m_HeapProperties(heap->GetDesc().Properties),
+            m_HeapFlags(heap->GetDesc().Flags),
+            m_Heap(heap),
+            m_Data(heap->GetData() + heapOffset)
+        {
+            ++s_NullDeviceStats.m_LiveResources;
+            ++s_NullDeviceStats.m_NumPlacedResources;
+        }
+        // 保留资源，没有绑定内存
+        NullResource(NullDevice* device, const D3D12_RESOURCE_DESC& desc)
+            :NullDeviceChild(device),
+            m_Desc(desc)
+        {
+            ++s_NullDeviceStats.m_LiveResources;
+        }
+        ~NullResource() override
+        {
+            --s_NullDeviceStats.m_LiveResources;
+            if (m_Memory != nullptr) {
+                s_NullDeviceStats.m_CommittedBytes -= m_Memory->GetSize();
+            }
+        }
+
+        HRESULT STDMETHODCALLTYPE Map(UINT Subresource, const D3D12_RANGE* pReadRange, void** ppData) override
+        {
+            if (m_Data == nullptr || !IsCpuAccessible(m_HeapProperties)) return E_INVALIDARG;
+            if (ppData != nullptr) {
+                *ppData = m_Data;
+            }
+            return S_OK;
+        }
+        void STDMETHODCALLTYPE Unmap(UINT Subresource, const D3D12_RANGE* pWrittenRange) override {}
+        D3D12_RESOURCE_DESC STDMETHODCALLTYPE GetDesc() override { return m_Desc; }
+        D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GetGPUVirtualAddress() override
+        {
+            // 与 D3D12 一致，只有缓冲区有虚拟地址
+            return m_Desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER ?
+                reinterpret_cast<D3D12_GPU_VIRTUAL_ADDRESS>(m_Data) : 0;
+        }
+        HRESULT STDMETHODCALLTYPE WriteToSubresource(
+            UINT DstSubresource,
+            const D3D12_BOX* pDstBox,
+            const void* pSrcData,
+            UINT SrcRowPitch,
+            UINT SrcDepthPitch) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE ReadFromSubresource(
+            void* pDstData,
+            UINT DstRowPitch,
+            UINT DstDepthPitch,
+            UINT SrcSubresource,
+            const D3D12_BOX* pSrcBox) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE GetHeapProperties(D3D12_HEAP_PROPERTIES* pHeapProperties, D3D12_HEAP_FLAGS* pHeapFlags) override
+        {
+            if (m_Data == nullptr) return E_INVALIDARG;
+            if (pHeapProperties != nullptr) *pHeapProperties = m_HeapProperties;
+            if (pHeapFlags != nullptr) *pHeapFlags = m_HeapFlags;
+            return S_OK;
+        }
+
+    private:
+        D3D12_RESOURCE_DESC m_Desc{};
+        D3D12_HEAP_PROPERTIES m_HeapProperties{};
+        D3D12_HEAP_FLAGS m_HeapFlags = D3D12_HEAP_FLAG_NONE;
+
+        Microsoft::WRL::ComPtr<NullHeap> m_Heap{};
+        std::unique_ptr<NullMemory> m_Memory{};
+        std::uint8_t* m_Data = nullptr;
+    };
+
+    class NullDescriptorHeap : public NullDeviceChild<ID3D12DescriptorHeap, ID3D12Pageable>
+    {
+    public:
+        NullDescriptorHeap(NullDevice* device, const D3D12_DESCRIPTOR_HEAP_DESC& desc)
+            :NullDeviceChild(device),
+            m_Desc(desc),
+            m_Descriptors(std::make_unique<NullDescriptor[]>(desc.NumDescriptors))
+        {
+            ++s_NullDeviceStats.m_LiveDescriptorHeaps;
+        }
+        ~NullDescriptorHeap() override
+        {
+            --s_NullDeviceStats.m_LiveDescriptorHeaps;
+        }
+
+        D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE GetDesc() override { return m_Desc; }
+        D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetCPUDescriptorHandleForHeapStart() override
+        {
+            return {reinterpret_cast<SIZE_T>(m_Descriptors.get())};
+        }
+        D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetGPUDescriptorHandleForHeapStart() override
+        {
+            // 着色器可见的堆 CPU 与 GPU 句柄相同
+            return {m_Desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE ?
+                reinterpret_cast<UINT64>(m_Descriptors.get()) : 0};
+        }
+
+    private:
+        D3D12_DESCRIPTOR_HEAP_DESC m_Desc{};
+        std::unique_ptr<NullDescriptor[]> m_Descriptors{};
+    };
+
+    // 模拟的栅栏，由队列发出的 Signal 在设备提交若干次后才完成，
+    // CPU 等待未完成的值时会直接推进时间线，保证不会死锁
+    class NullFence : public NullDeviceChild<ID3D12Fence, ID3D12Pageable>
+    {
+    public:
+        NullFence(NullDevice* device, std::uint64_t initialValue)
+            :NullDeviceChild(device),
+            m_Value(initialValue) {}
+
+        UINT64 STDMETHODCALLTYPE GetCompletedValue() override
+        {
+            std::lock_guard lock{m_Mutex};
+            RetirePending(0);
+            return m_Value;
+        }
+        HRESULT STDMETHODCALLTYPE SetEventOnCompletion(UINT64 Value, HANDLE hEvent) override
+        {
+            std::unique_lock lock{m_Mutex};
+            RetirePending(Value);
+            if (m_Value >= Value) {
+                if (hEvent != nullptr) {
+                    SetEvent(hEvent);
+                }
+                return S_OK;
+            }
+
+            // 没有队列会发出该值，只能等待 CPU 端的 Signal
+            if (hEvent != nullptr) {
+                m_Waiters.emplace_back(Value, hEvent);
+            }
+            else {
+                m_Condition.wait(lock, [this, Value]() { return m_Value >= Value; });
+            }
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE Signal(UINT64 Value) override
+        {
+            std::lock_guard lock{m_Mutex};
+            SetValue(Value);
+            return S_OK;
+        }
+
+        // 由队列调用，在设备提交到 readyTick 时完成
+        void EnqueueSignal(std::uint64_t value, std::uint64_t readyTick)
+        {
+            std::lock_guard lock{m_Mutex};
+            m_PendingSignals.emplace_back(value, readyTick);
+            RetirePending(0);
+        }
+
+    private:
+        // 完成已到期的 Signal，waitValue 不为 0 时一直推进到该值
+        void RetirePending(std::uint64_t waitValue)
+        {
+            auto currTick = m_Device->GetSubmitTick();
+            while (!m_PendingSignals.empty()) {
+                auto [value, readyTick] = m_PendingSignals.front();
+                if (readyTick > currTick && m_Value >= waitValue) break;
+                m_PendingSignals.pop_front();
+                SetValue(value);
+            }
+        }
+
+        void SetValue(std::uint64_t value)
+        {
+            m_Value = value;
+            ++s_NullDeviceStats.m_NumFenceSignals;
+
+            std::erase_if(m_Waiters, [value](const auto& waiter) {
+                if (waiter.first > value) return false;
+                SetEvent(waiter.second);
+                return true;
+            });
+            m_Condition.notify_all();
+        }
+
+    private:
+        std::mutex m_Mutex{};
+        std::condition_variable m_Condition{};
+        std::uint64_t m_Value = 0;
+        // 队列发出但未完成的 Signal，(栅栏值, 完成时的提交次数)
+        std::deque<std::pair<std::uint64_t, std::uint64_t>> m_PendingSignals{};
+        std::vector<std::pair<std::uint64_t, HANDLE>> m_Waiters{};
+    };
+
+    class NullCommandAllocator : public NullDeviceChild<ID3D12CommandAllocator, ID3D12Pageable>
+    {
+    public:
+        NullCommandAllocator(NullDevice* device, D3D12_COMMAND_LIST_TYPE type)
+            :NullDeviceChild(device), m_Type(type) {}
+
+        HRESULT STDMETHODCALLTYPE Reset() override { return S_OK; }
+
+        D3D12_COMMAND_LIST_TYPE GetType() const noexcept { return m_Type; }
+
+    private:
+        D3D12_COMMAND_LIST_TYPE m_Type;
+    };
+
+    class NullPipelineState : public NullDeviceChild<ID3D12PipelineState, ID3D12Pageable>
+    {
+    public:
+        using NullDeviceChild::NullDeviceChild;
+
+        HRESULT STDMETHODCALLTYPE GetCachedBlob(ID3DBlob** ppBlob) override { return DXGI_ERROR_UNSUPPORTED; }
+    };
+
+    class NullRootSignature : public NullDeviceChild<ID3D12RootSignature>
+    {
+    public:
+        using NullDeviceChild::NullDeviceChild;
+    };
+
+    class NullCommandSignature : public NullDeviceChild<ID3D12CommandSignature, ID3D12Pageable>
+    {
+    public:
+        using NullDeviceChild::NullDeviceChild;
+    };
+
+    class NullQueryHeap : public NullDeviceChild<ID3D12QueryHeap, ID3D12Pageable>
+    {
+    public:
+        using NullDeviceChild::NullDeviceChild;
+    };
+
+    // 只记录命令数量的命令列表
+    class NullGraphicsCommandList : public NullDeviceChild<ID3D12GraphicsCommandList, ID3D12CommandList>
+    {
+    public:
+        NullGraphicsCommandList(NullDevice* device, D3D12_COMMAND_LIST_TYPE type, bool isRecording)
+            :NullDeviceChild(device), m_Type(type), m_IsRecording(isRecording) {}
+
+        bool IsRecording() const noexcept { return m_IsRecording; }
+
+        // 提交到队列时累计统计数据
+        void Submit() const noexcept
+        {
+            s_NullDeviceStats.m_NumCommands += m_NumCommands;
+            s_NullDeviceStats.m_NumDrawCalls += m_NumDrawCalls;
+            s_NullDeviceStats.m_NumDispatches += m_NumDispatches;
+            s_NullDeviceStats.m_NumBarriers += m_NumBarriers;
+            s_NullDeviceStats.m_NumCopies += m_NumCopies;
+        }
+
+        // ID3D12CommandList
+        D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return m_Type; }
+
+        // ID3D12GraphicsCommandList
+        HRESULT STDMETHODCALLTYPE Close() override
+        {
+            if (!m_IsRecording) return E_FAIL;
+            m_IsRecording = false;
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* pInitialState) override
+        {
+            if (m_IsRecording || pAllocator == nullptr) return E_FAIL;
+            m_IsRecording = true;
+            m_NumCommands = m_NumDrawCalls = m_NumDispatches = m_NumBarriers = m_NumCopies = 0;
+            return S_OK;
+        }
+        void STDMETHODCALLTYPE ClearState(ID3D12PipelineState* pPipelineState) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE DrawInstanced(
+            UINT VertexCountPerInstance,
+            UINT InstanceCount,
+            UINT StartVertexLocation,
+            UINT StartInstanceLocation) override
+        {
+            ++m_NumCommands;
+            ++m_NumDrawCalls;
+        }
+        void STDMETHODCALLTYPE DrawIndexedInstanced(
+            UINT IndexCountPerInstance,
+            UINT InstanceCount,
+            UINT StartIndexLocation,
+            INT BaseVertexLocation,
+            UINT StartInstanceLocation) override
+        {
+            ++m_NumCommands;
+            ++m_NumDrawCalls;
+        }
+        void STDMETHODCALLTYPE Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY, UINT ThreadGroupCountZ) override
+        {
+            ++m_NumCommands;
+            ++m_NumDispatches;
+        }
+        void STDMETHODCALLTYPE CopyBufferRegion(
+            ID3D12Resource* pDstBuffer,
+            UINT64 DstOffset,
+            ID3D12Resource* pSrcBuffer,
+            UINT64 SrcOffset,
+            UINT64 NumBytes) override
+        {
+            ++m_NumCommands;
+            ++m_NumCopies;
+        }
+        void STDMETHODCALLTYPE CopyTextureRegion(
+            const D3D12_TEXTURE_COPY_LOCATION* pDst,
+            UINT DstX,
+            UINT DstY,
+            UINT DstZ,
+            const D3D12_TEXTURE_COPY_LOCATION* pSrc,
+            const D3D12_BOX* pSrcBox) override
+        {
+            ++m_NumCommands;
+            ++m_NumCopies;
+        }
+        void STDMETHODCALLTYPE CopyResource(ID3D12Resource* pDstResource, ID3D12Resource* pSrcResource) override
+        {
+            ++m_NumCommands;
+            ++m_NumCopies;
+        }
+        void STDMETHODCALLTYPE CopyTiles(
+            ID3D12Resource* pTiledResource,
+            const D3D12_TILED_RESOURCE_COORDINATE* pTileRegionStartCoordinate,
+            const D3D12_TILE_REGION_SIZE* pTileRegionSize,
+            ID3D12Resource* pBuffer,
+            UINT64 BufferStartOffsetInBytes,
+            D3D12_TILE_COPY_FLAGS Flags) override
+        {
+            ++m_NumCommands;
+            ++m_NumCopies;
+        }
+        void STDMETHODCALLTYPE ResolveSubresource(
+            ID3D12Resource* pDstResource,
+            UINT DstSubresource,
+            ID3D12Resource* pSrcResource,
+            UINT SrcSubresource,
+            DXGI_FORMAT Format) override
+        {
+            ++m_NumCommands;
+            ++m_NumCopies;
+        }
+        void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY PrimitiveTopology) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE RSSetViewports(UINT NumViewports, const D3D12_VIEWPORT* pViewports) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE RSSetScissorRects(UINT NumRects, const D3D12_RECT* pRects) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT BlendFactor[4]) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE OMSetStencilRef(UINT StencilRef) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* pPipelineState) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE ResourceBarrier(UINT NumBarriers, const D3D12_RESOURCE_BARRIER* pBarriers) override
+        {
+            ++m_NumCommands;
+            m_NumBarriers += NumBarriers;
+        }
+        void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList* pCommandList) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetDescriptorHeaps(UINT NumDescriptorHeaps, ID3D12DescriptorHeap* const* ppDescriptorHeaps) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature* pRootSignature) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* pRootSignature) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetComputeRoot32BitConstants(
+            UINT RootParameterIndex,
+            UINT Num32BitValuesToSet,
+            const void* pSrcData,
+            UINT DestOffsetIn32BitValues) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(
+            UINT RootParameterIndex,
+            UINT Num32BitValuesToSet,
+            const void* pSrcData,
+            UINT DestOffsetIn32BitValues) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* pView) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE IASetVertexBuffers(UINT StartSlot, UINT NumViews, const D3D12_VERTEX_BUFFER_VIEW* pViews) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SOSetTargets(UINT StartSlot, UINT NumViews, const D3D12_STREAM_OUTPUT_BUFFER_VIEW* pViews) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE OMSetRenderTargets(
+            UINT NumRenderTargetDescriptors,
+            const D3D12_CPU_DESCRIPTOR_HANDLE* pRenderTargetDescriptors,
+            BOOL RTsSingleHandleToDescriptorRange,
+            const D3D12_CPU_DESCRIPTOR_HANDLE* pDepthStencilDescriptor) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE ClearDepthStencilView(
+            D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView,
+            D3D12_CLEAR_FLAGS ClearFlags,
+            FLOAT Depth,
+            UINT8 Stencil,
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE ClearRenderTargetView(
+            D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView,
+            const FLOAT ColorRGBA[4],
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(
+            D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+            D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+            ID3D12Resource* pResource,
+            const UINT Values[4],
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(
+            D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap,
+            D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle,
+            ID3D12Resource* pResource,
+            const FLOAT Values[4],
+            UINT NumRects,
+            const D3D12_RECT* pRects) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE DiscardResource(ID3D12Resource* pResource, const D3D12_DISCARD_REGION* pRegion) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE ResolveQueryData(
+            ID3D12QueryHeap* pQueryHeap,
+            D3D12_QUERY_TYPE Type,
+            UINT StartIndex,
+            UINT NumQueries,
+            ID3D12Resource* pDestinationBuffer,
+            UINT64 AlignedDestinationBufferOffset) override
+        {
+            ++m_NumCommands;
+        }
+        void STDMETHODCALLTYPE SetPredication(ID3D12Resource* pBuffer, UINT64 AlignedBufferOffset, D3D12_PREDICATION_OP Operation) override { ++m_NumCommands; }
+        void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override {}
+        void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override {}
+        void STDMETHODCALLTYPE EndEvent() override {}
+        void STDMETHODCALLTYPE ExecuteIndirect(
+            ID3D12CommandSignature* pCommandSignature,
+            UINT MaxCommandCount,
+            ID3D12Resource* pArgumentBuffer,
+            UINT64 ArgumentBufferOffset,
+            ID3D12Resource* pCountBuffer,
+            UINT64 CountBufferOffset) override
+        {
+            ++m_NumCommands;
+            ++m_NumDrawCalls;
+        }
+
+    private:
+        D3D12_COMMAND_LIST_TYPE m_Type;
+        bool m_IsRecording = false;
+
+        std::uint64_t m_NumCommands = 0;
+        std::uint64_t m_NumDrawCalls = 0;
+        std::uint64_t m_NumDispatches = 0;
+        std::uint64_t m_NumBarriers = 0;
+        std::uint64_t m_NumCopies = 0;
+    };
+
+    class NullCommandQueue : public NullDeviceChild<ID3D12CommandQueue, ID3D12Pageable>
+    {
+    public:
+        NullCommandQueue(NullDevice* device, const D3D12_COMMAND_QUEUE_DESC& desc)
+            :NullDeviceChild(device), m_Desc(desc) {}
+
+        void STDMETHODCALLTYPE UpdateTileMappings(
+            ID3D12Resource* pResource,
+            UINT NumResourceRegions,
+            const D3D12_TILED_RESOURCE_COORDINATE* pResourceRegionStartCoordinates,
+            const D3D12_TILE_REGION_SIZE* pResourceRegionSizes,
+            ID3D12Heap* pHeap,
+            UINT NumRanges,
+            const D3D12_TILE_RANGE_FLAGS* pRangeFlags,
+            const UINT* pHeapRangeStartOffsets,
+            const UINT* pRangeTileCounts,
+            D3D12_TILE_MAPPING_FLAGS Flags) override {}
+        void STDMETHODCALLTYPE CopyTileMappings(
+            ID3D12Resource* pDstResource,
+            const D3D12_TILED_RESOURCE_COORDINATE* pDstRegionStartCoordinate,
+            ID3D12Resource* pSrcResource,
+            const D3D12_TILED_RESOURCE_COORDINATE* pSrcRegionStartCoordinate,
+            const D3D12_TILE_REGION_SIZE* pRegionSize,
+            D3D12_TILE_MAPPING_FLAGS Flags) override {}
+        void STDMETHODCALLTYPE ExecuteCommandLists(UINT NumCommandLists, ID3D12CommandList* const* ppCommandLists) override
+        {
+            for (UINT i = 0; i < NumCommandLists; ++i) {
+                auto pList = static_cast<NullGraphicsCommandList*>(ppCommandLists[i]);
+                ASSERT(!pList->IsRecording(), "Command list must be closed before execution");
+                pList->Submit();
+            }
+            s_NullDeviceStats.m_NumCommandListsExecuted += NumCommandLists;
+            m_Device->AdvanceSubmitTick();
+        }
+        void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override {}
+        void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override {}
+        void STDMETHODCALLTYPE EndEvent() override {}
+        HRESULT STDMETHODCALLTYPE Signal(ID3D12Fence* pFence, UINT64 Value) override
+        {
+            if (pFence == nullptr) return E_INVALIDARG;
+            static_cast<NullFence*>(pFence)->EnqueueSignal(Value, m_Device->GetSubmitTick() + m_Device->GetFenceLatency());
+            return S_OK;
+        }
+        // 模拟的 GPU 按提交顺序执行，队列间的等待无需处理
+        HRESULT STDMETHODCALLTYPE Wait(ID3D12Fence* pFence, UINT64 Value) override
+        {
+            return pFence != nullptr ? S_OK : E_INVALIDARG;
+        }
+        HRESULT STDMETHODCALLTYPE GetTimestampFrequency(UINT64* pFrequency) override
+        {
+            if (pFrequency == nullptr) return E_INVALIDARG;
+            LARGE_INTEGER frequency{};
+            QueryPerformanceFrequency(&frequency);
+            *pFrequency = frequency.QuadPart;
+            return S_OK;
+        }
+        HRESULT STDMETHODCALLTYPE GetClockCalibration(UINT64* pGpuTimestamp, UINT64* pCpuTimestamp) override
+        {
+            if (pGpuTimestamp == nullptr || pCpuTimestamp == nullptr) return E_INVALIDARG;
+            LARGE_INTEGER counter{};
+            QueryPerformanceCounter(&counter);
+            *pGpuTimestamp = *pCpuTimestamp = counter.QuadPart;
+            return S_OK;
+        }
+        D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GetDesc() override { return m_Desc; }
+
+    private:
+        D3D12_COMMAND_QUEUE_DESC m_Desc{};
+    };
+
+
+    //
+    // NullDevice Implementation
+    //
+    HRESULT NullDevice::CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc, REFIID riid, void** ppCommandQueue)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullCommandQueue>(riid, ppCommandQueue, this, *pDesc);
+    }
+
+    HRESULT NullDevice::CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE type, REFIID riid, void** ppCommandAllocator)
+    {
+        return CreateNullObject<NullCommandAllocator>(riid, ppCommandAllocator, this, type);
+    }
+
+    HRESULT NullDevice::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc, REFIID riid, void** ppPipelineState)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullPipelineState>(riid, ppPipelineState, this);
+    }
+
+    HRESULT NullDevice::CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* pDesc, REFIID riid, void** ppPipelineState)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullPipelineState>(riid, ppPipelineState, this);
+    }
+
+    HRESULT NullDevice::CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC* pDesc, REFIID riid, void** ppPipelineState)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullPipelineState>(riid, ppPipelineState, this);
+    }
+
+    HRESULT NullDevice::CreateCommandList(
+        UINT nodeMask,
+        D3D12_COMMAND_LIST_TYPE type,
+        ID3D12CommandAllocator* pCommandAllocator,
+        ID3D12PipelineState* pInitialState,
+        REFIID riid,
+        void** ppCommandList)
+    {
+        if (pCommandAllocator == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullGraphicsCommandList>(riid, ppCommandList, this, type, true);
+    }
+
+    HRESULT NullDevice::CreateCommandList1(
+        UINT nodeMask,
+        D3D12_COMMAND_LIST_TYPE type,
+        D3D12_COMMAND_LIST_FLAGS flags,
+        REFIID riid,
+        void** ppCommandList)
+    {
+        // 与 D3D12 一致，创建后处于关闭状态
+        return CreateNullObject<NullGraphicsCommandList>(riid, ppCommandList, this, type, false);
+    }
+
+    template <typename T>
+    static T* GetFeatureData(void* pFeatureSupportData, UINT featureSupportDataSize) noexcept
+    {
+        return pFeatureSupportData != nullptr && featureSupportDataSize == sizeof(T) ?
+            static_cast<T*>(pFeatureSupportData) : nullptr;
+    }
+
+    HRESULT NullDevice::CheckFeatureSupport(D3D12_FEATURE Feature, void* pFeatureSupportData, UINT FeatureSupportDataSize)
+    {
+        switch (Feature) {
+            case D3D12_FEATURE_D3D12_OPTIONS: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_D3D12_OPTIONS>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                *pData = {};
+                pData->ResourceBindingTier = D3D12_RESOURCE_BINDING_TIER_3;
+                pData->ResourceHeapTier = D3D12_RESOURCE_HEAP_TIER_2;
+                return S_OK;
+            }
+            case D3D12_FEATURE_D3D12_OPTIONS5: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_D3D12_OPTIONS5>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                *pData = {};
+                pData->RaytracingTier = D3D12_RAYTRACING_TIER_NOT_SUPPORTED;
+                return S_OK;
+            }
+            case D3D12_FEATURE_ARCHITECTURE: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_ARCHITECTURE>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                pData->TileBasedRenderer = false;
+                pData->UMA = true;
+                pData->CacheCoherentUMA = true;
+                return S_OK;
+            }
+            case D3D12_FEATURE_FEATURE_LEVELS: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_FEATURE_LEVELS>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                pData->MaxSupportedFeatureLevel = D3D_FEATURE_LEVEL_11_0;
+                for (UINT i = 0; i < pData->NumFeatureLevels; ++i) {
+                    auto level = pData->pFeatureLevelsRequested[i];
+                    if (level <= D3D_FEATURE_LEVEL_12_1 && level > pData->MaxSupportedFeatureLevel) {
+                        pData->MaxSupportedFeatureLevel = level;
+                    }
+                }
+                return S_OK;
+            }
+            case D3D12_FEATURE_FORMAT_SUPPORT: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_FORMAT_SUPPORT>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                pData->Support1 = static_cast<D3D12_FORMAT_SUPPORT1>(~0u);
+                pData->Support2 = D3D12_FORMAT_SUPPORT2_NONE;
+                return S_OK;
+            }
+            case D3D12_FEATURE_SHADER_MODEL: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_SHADER_MODEL>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                pData->HighestShaderModel = std::min(pData->HighestShaderModel, D3D_SHADER_MODEL_6_5);
+                return S_OK;
+            }
+            case D3D12_FEATURE_ROOT_SIGNATURE: {
+                auto pData = GetFeatureData<D3D12_FEATURE_DATA_ROOT_SIGNATURE>(pFeatureSupportData, FeatureSupportDataSize);
+                if (pData == nullptr) return E_INVALIDARG;
+                pData->HighestVersion = std::min(pData->HighestVersion, D3D_ROOT_SIGNATURE_VERSION_1_1);
+                return S_OK;
+            }
+            default: return E_INVALIDARG;
+        }
+    }
+
+    HRESULT NullDevice::CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc, REFIID riid, void** ppvHeap)
+    {
+        if (pDescriptorHeapDesc == nullptr || pDescriptorHeapDesc->NumDescriptors == 0) return E_INVALIDARG;
+        return CreateNullObject<NullDescriptorHeap>(riid, ppvHeap, this, *pDescriptorHeapDesc);
+    }
+
+    HRESULT NullDevice::CreateRootSignature(
+        UINT nodeMask,
+        const void* pBlobWithRootSignature,
+        SIZE_T blobLengthInBytes,
+        REFIID riid,
+        void** ppvRootSignature)
+    {
+        if (pBlobWithRootSignature == nullptr || blobLengthInBytes == 0) return E_INVALIDARG;
+        return CreateNullObject<NullRootSignature>(riid, ppvRootSignature, this);
+    }
+
+    void NullDevice::CopyDescriptors(
+        UINT NumDestDescriptorRanges,
+        const D3D12_CPU_DESCRIPTOR_HANDLE* pDestDescriptorRangeStarts,
+        const UINT* pDestDescriptorRangeSizes,
+        UINT NumSrcDescriptorRanges,
+        const D3D12_CPU_DESCRIPTOR_HANDLE* pSrcDescriptorRangeStarts,
+        const UINT* pSrcDescriptorRangeSizes,
+        D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapsType)
+    {
+        // 与 D3D12 一致，范围大小为空时每个范围只有一个描述符
+        auto getRangeSize = [](const UINT* pSizes, UINT index) { return pSizes != nullptr ? pSizes[index] : 1u; };
+
+        UINT destRange = 0, destIndex = 0;
+        for (UINT srcRange = 0; srcRange < NumSrcDescriptorRanges; ++srcRange) {
+            auto pSrc = reinterpret_cast<const NullDescriptor*>(pSrcDescriptorRangeStarts[srcRange].ptr);
+            auto srcSize = getRangeSize(pSrcDescriptorRangeSizes, srcRange);
+            for (UINT srcIndex = 0; srcIndex < srcSize; ++srcIndex) {
+                while (destRange < NumDestDescriptorRanges &&
+                    destIndex >= getRangeSize(pDestDescriptorRangeSizes, destRange)) {
+                    ++destRange;
+                    destIndex = 0;
+                }
+                ASSERT(destRange < NumDestDescriptorRanges, "Source descriptors exceed destination ranges");
+
+                auto pDest = reinterpret_cast<NullDescriptor*>(pDestDescriptorRangeStarts[destRange].ptr);
+                pDest[destIndex++] = pSrc[srcIndex];
+            }
+            s_NullDeviceStats.m_NumDescriptorsCopied += srcSize;
+        }
+    }
+
+    D3D12_RESOURCE_ALLOCATION_INFO NullDevice::GetResourceAllocationInfo1(
+        UINT visibleMask,
+        UINT numResourceDescs,
+        const D3D12_RESOURCE_DESC* pResourceDescs,
+        D3D12_RESOURCE_ALLOCATION_INFO1* pResourceAllocationInfo1)
+    {
+        D3D12_RESOURCE_ALLOCATION_INFO ret{0, 0};
+        for (UINT i = 0; i < numResourceDescs; ++i) {
+            auto info = GetNullAllocationInfo(pResourceDescs[i]);
+            if (info.SizeInBytes == UINT64_MAX) {
+                return {UINT64_MAX, info.Alignment};
+            }
+
+            auto offset = Math::AlignUp(ret.SizeInBytes, info.Alignment);
+            if (pResourceAllocationInfo1 != nullptr) {
+                pResourceAllocationInfo1[i] = {offset, info.Alignment, info.SizeInBytes};
+            }
+            ret.SizeInBytes = offset + info.SizeInBytes;
+            ret.Alignment = std::max(ret.Alignment, info.Alignment);
+        }
+        return ret;
+    }
+
+    D3D12_HEAP_PROPERTIES NullDevice::GetCustomHeapProperties(UINT nodeMask, D3D12_HEAP_TYPE heapType)
+    {
+        D3D12_HEAP_PROPERTIES heapProps{};
+        heapProps.Type = D3D12_HEAP_TYPE_CUSTOM;
+        heapProps.CreationNodeMask = heapProps.VisibleNodeMask = 1;
+        // 空设备为统一内存架构
+        heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+        switch (heapType) {
+            case D3D12_HEAP_TYPE_UPLOAD: heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE; break;
+            case D3D12_HEAP_TYPE_READBACK: heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_BACK; break;
+            default: heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE; break;
+        }
+        return heapProps;
+    }
+
+    HRESULT NullDevice::CreateCommittedResource(
+        const D3D12_HEAP_PROPERTIES* pHeapProperties,
+        D3D12_HEAP_FLAGS HeapFlags,
+        const D3D12_RESOURCE_DESC* pDesc,
+        D3D12_RESOURCE_STATES InitialResourceState,
+        const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+        REFIID riidResource,
+        void** ppvResource)
+    {
+        if (pHeapProperties == nullptr || pDesc == nullptr) return E_INVALIDARG;
+
+        auto info = GetNullAllocationInfo(*pDesc);
+        if (info.SizeInBytes == UINT64_MAX) return E_INVALIDARG;
+
+        auto desc = *pDesc;
+        desc.Alignment = info.Alignment;
+        return CreateNullObject<NullResource>(riidResource, ppvResource,
+            this, desc, *pHeapProperties, HeapFlags, info.SizeInBytes);
+    }
+
+    HRESULT NullDevice::CreateHeap(const D3D12_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap)
+    {
+        if (pDesc == nullptr || pDesc->SizeInBytes == 0) return E_INVALIDARG;
+
+        auto pHeap = new NullHeap(this, *pDesc);
+        HRESULT hr = E_OUTOFMEMORY;
+        if (pHeap->IsValid()) {
+            hr = ppvHeap != nullptr ? pHeap->QueryInterface(riid, ppvHeap) : S_FALSE;
+        }
+        pHeap->Release();
+        return hr;
+    }
+
+    HRESULT NullDevice::CreatePlacedResource(
+        ID3D12Heap* pHeap,
+        UINT64 HeapOffset,
+        const D3D12_RESOURCE_DESC* pDesc,
+        D3D12_RESOURCE_STATES InitialState,
+        const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+        REFIID riid,
+        void** ppvResource)
+    {
+        if (pHeap == nullptr || pDesc == nullptr) return E_INVALIDARG;
+
+        // 校验放置的位置，便于发现分配器的错误
+        auto info = GetNullAllocationInfo(*pDesc);
+        auto heapSize = pHeap->GetDesc().SizeInBytes;
+        if (info.SizeInBytes == UINT64_MAX ||
+            HeapOffset % info.Alignment != 0 ||
+            HeapOffset + info.SizeInBytes > heapSize) {
+            return E_INVALIDARG;
+        }
+
+        auto desc = *pDesc;
+        desc.Alignment = info.Alignment;
+        return CreateNullObject<NullResource>(riid, ppvResource,
+            this, desc, static_cast<NullHeap*>(pHeap), HeapOffset);
+    }
+
+    HRESULT NullDevice::CreateReservedResource(
+        const D3D12_RESOURCE_DESC* pDesc,
+        D3D12_RESOURCE_STATES InitialState,
+        const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+        REFIID riid,
+        void** ppvResource)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullResource>(riid, ppvResource, this, *pDesc);
+    }
+
+    HRESULT NullDevice::CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS Flags, REFIID riid, void** ppFence)
+    {
+        return CreateNullObject<NullFence>(riid, ppFence, this, InitialValue);
+    }
+
+    void NullDevice::GetCopyableFootprints(
+        const D3D12_RESOURCE_DESC* pResourceDesc,
+        UINT FirstSubresource,
+        UINT NumSubresources,
+        UINT64 BaseOffset,
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts,
+        UINT* pNumRows,
+        UINT64* pRowSizeInBytes,
+        UINT64* pTotalBytes)
+    {
+        ASSERT(pResourceDesc != nullptr);
+        const auto& desc = *pResourceDesc;
+
+        std::uint64_t offset = 0;
+        std::uint64_t totalBytes = 0;
+        for (UINT i = 0; i < NumSubresources; ++i) {
+            D3D12_SUBRESOURCE_FOOTPRINT footprint{};
+            std::uint32_t numRows = 1;
+            std::uint64_t rowSize = 0;
+
+            if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+                footprint.Format = DXGI_FORMAT_UNKNOWN;
+                footprint.Width = static_cast<UINT>(desc.Width);
+                footprint.Height = footprint.Depth = 1;
+                rowSize = desc.Width;
+            }
+            else {
+                auto mipLevels = GetNullMipLevels(desc);
+                auto mipIndex = (FirstSubresource + i) % mipLevels;
+                auto blockSize = Utility::GetFormatBlockSize(desc.Format);
+                auto width = std::max(1u, static_cast<std::uint32_t>(desc.Width) >> mipIndex);
+                auto height = std::max(1u, desc.Height >> mipIndex);
+
+                footprint.Format = desc.Format;
+                footprint.Width = Math::AlignUp(width, blockSize);
+                footprint.Height = Math::AlignUp(height, blockSize);
+                footprint.Depth = GetNullMipDepth(desc, mipIndex);
+                numRows = Math::DivideByMultiple(height, blockSize);
+                rowSize = Utility::GetRowPitch(desc.Format, static_cast<std::uint32_t>(desc.Width), mipIndex);
+            }
+            footprint.RowPitch = static_cast<UINT>(Math::AlignUp(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
+
+            offset = Math::AlignUp(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+            if (pLayouts != nullptr) pLayouts[i] = {BaseOffset + offset, footprint};
+            if (pNumRows != nullptr) pNumRows[i] = numRows;
+            if (pRowSizeInBytes != nullptr) pRowSizeInBytes[i] = rowSize;
+
+            // 最后一行不需要按行距对齐
+            auto numTotalRows = static_cast<std::uint64_t>(numRows) * footprint.Depth;
+            totalBytes = offset + footprint.RowPitch * (numTotalRows - 1) + rowSize;
+            offset += footprint.RowPitch * numTotalRows;
+        }
+
+        if (pTotalBytes != nullptr) *pTotalBytes = totalBytes;
+    }
+
+    HRESULT NullDevice::CreateQueryHeap(const D3D12_QUERY_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullQueryHeap>(riid, ppvHeap, this);
+    }
+
+    HRESULT NullDevice::CreateCommandSignature(
+        const D3D12_COMMAND_SIGNATURE_DESC* pDesc,
+        ID3D12RootSignature* pRootSignature,
+        REFIID riid,
+        void** ppvCommandSignature)
+    {
+        if (pDesc == nullptr) return E_INVALIDARG;
+        return CreateNullObject<NullCommandSignature>(riid, ppvCommandSignature, this);
+    }
+
+
+    HRESULT CreateNullDevice(const NullDeviceDesc& desc, REFIID riid, void** ppDevice)
+    {
+        return CreateNullObject<NullDevice>(riid, ppDevice, desc);
+    }
+}
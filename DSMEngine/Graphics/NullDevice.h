@@ -0,0 +1,50 @@
+#pragma once
+#ifndef __NULLDEVICE_H__
+#define __NULLDEVICE_H__
+
+#include "../pch.h"
+#include <atomic>
+
+namespace DSM {
+    // 空设备的创建参数
+    struct NullDeviceDesc
+    {
+        // 队列 Signal 的栅栏值在之后第几次提交时完成，用于模拟 GPU 落后 CPU 的帧数
+        std::uint32_t m_FenceLatency = 2;
+    };
+
+    // 空设备的统计数据，用于性能测试
+    struct NullDeviceStats
+    {
+        // 当前存活的对象与占用的内存
+        std::atomic<std::uint64_t> m_LiveHeaps{};
+        std::atomic<std::uint64_t> m_LiveResources{};
+        std::atomic<std::uint64_t> m_LiveDescriptorHeaps{};
+        std::atomic<std::uint64_t> m_HeapBytes{};
+        std::atomic<std::uint64_t> m_CommittedBytes{};
+
+        // 累计的调用次数
+        std::atomic<std::uint64_t> m_NumHeapsCreated{};
+        std::atomic<std::uint64_t> m_NumCommittedResources{};
+        std::atomic<std::uint64_t> m_NumPlacedResources{};
+        std::atomic<std::uint64_t> m_NumDescriptorsCreated{};
+        std::atomic<std::uint64_t> m_NumDescriptorsCopied{};
+        std::atomic<std::uint64_t> m_NumCommandListsExecuted{};
+        std::atomic<std::uint64_t> m_NumCommands{};
+        std::atomic<std::uint64_t> m_NumDrawCalls{};
+        std::atomic<std::uint64_t> m_NumDispatches{};
+        std::atomic<std::uint64_t> m_NumBarriers{};
+        std::atomic<std::uint64_t> m_NumCopies{};
+        std::atomic<std::uint64_t> m_NumFenceSignals{};
+
+        void ResetCounters() noexcept;
+    };
+
+    // 创建不依赖 GPU 的空设备，堆、资源、描述符与栅栏均由 CPU 内存模拟，
+    // 命令列表只记录命令数量
+    HRESULT CreateNullDevice(const NullDeviceDesc& desc, REFIID riid, void** ppDevice);
+
+    NullDeviceStats& GetNullDeviceStats() noexcept;
+}
+
+#endif
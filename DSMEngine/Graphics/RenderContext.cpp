@@ -16,6 +16,48 @@ namespace DSM {
         m_CopyQueue(D3D12_COMMAND_LIST_TYPE_COPY) {}
 
     void RenderContext::Create(bool requireDXRSupport, const Window& window)
+    {
+        m_DeviceBackend = DeviceBackend::Hardware;
+        CreateHardwareDevice(requireDXRSupport);
+        InitializeDevice();
+        
+        SwapChainDesc swapChainDesc = {};
+        swapChainDesc.m_Width = window.GetWidth();
+        swapChainDesc.m_Height = window.GetHeight();
+        swapChainDesc.m_Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        swapChainDesc.m_FullScreen = false;
+        swapChainDesc.m_hWnd = window.GetHandle();
+        m_SwapChain = std::make_unique<SwapChain>(swapChainDesc);
+
+        Graphics::InitializeCommon();
+    }
+
+    void RenderContext::CreateHeadless(DeviceBackend backend, const NullDeviceDesc& nullDeviceDesc)
+    {
+        m_DeviceBackend = backend;
+        if (backend == DeviceBackend::Null) {
+            Utility::Print("Selected GPU:  Null Device\n");
+            ASSERT_SUCCEEDED(CreateNullDevice(nullDeviceDesc, IID_PPV_ARGS(m_pDevice.GetAddressOf())));
+        }
+        else {
+            CreateHardwareDevice(false);
+        }
+        InitializeDevice();
+
+        Graphics::InitializeCommon();
+    }
+
+    void RenderContext::CreateOffscreenSwapChain(std::uint32_t width, std::uint32_t height)
+    {
+        ASSERT(m_SwapChain == nullptr);
+        SwapChainDesc swapChainDesc = {};
+        swapChainDesc.m_Width = width;
+        swapChainDesc.m_Height = height;
+        swapChainDesc.m_Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        m_SwapChain = std::make_unique<SwapChain>(swapChainDesc);
+    }
+
+    void RenderContext::CreateHardwareDevice(bool requireDXRSupport)
     {
         DWORD factoryFlags = 0;
 #if defined(DEBUG) || defined(_DEBUG) || 1
@@ -95,7 +137,10 @@ namespace DSM {
             ASSERT_SUCCEEDED(m_pFactory->EnumWarpAdapter(IID_PPV_ARGS(dxgiAdapter.GetAddressOf())));
             ASSERT_SUCCEEDED(D3D12CreateDevice(dxgiAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(m_pDevice.GetAddressOf())));
         }
+    }
 
+    void RenderContext::InitializeDevice()
+    {
         D3D12_FEATURE_DATA_D3D12_OPTIONS featureData = {};
         if (SUCCEEDED(m_pDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &featureData, sizeof(featureData)))) {
             if (featureData.TypedUAVLoadAdditionalFormats) {
@@ -119,27 +164,20 @@ namespace DSM {
         m_ComputeQueue.Create(m_pDevice.Get());
         m_CopyQueue.Create(m_pDevice.Get());
 
-        m_CpuBufferAllocator.Create(DynamicBufferAllocator::AllocateMode::CpuExclusive, sm_CpuBufferPageSize);
+        m_CpuBufferAllocator.Create(DynamicBufferAllocator::AllocateMode::Ring, sm_CpuBufferPageSize, sm_UploadRingSize);
         m_GpuBufferAllocator.Create(DynamicBufferAllocator::AllocateMode::GpuExclusive, sm_GpuAllocatorPageSize);
 
         for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i) {
             m_DescriptorAllocator[i] = std::make_unique<DescriptorAllocator>(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i));
         }
-        
-        SwapChainDesc swapChainDesc = {};
-        swapChainDesc.m_Width = window.GetWidth();
-        swapChainDesc.m_Height = window.GetHeight();
-        swapChainDesc.m_Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        swapChainDesc.m_FullScreen = false;
-        swapChainDesc.m_hWnd = window.GetHandle();
-        m_SwapChain = std::make_unique<SwapChain>(swapChainDesc);
-
-        Graphics::InitializeCommon();
+        m_BindlessHeap.Create(L"RenderContext::BindlessHeap", sm_BindlessHeapSize);
     }
 
     void RenderContext::Shutdown()
     {
         Graphics::DestroyCommon();
+        // 销毁各个池之前归还所有延迟释放的资源
+        m_DeferredReleaseQueue.Flush();
         
         m_pFactory = nullptr;
         m_pDevice = nullptr;
@@ -153,7 +191,12 @@ namespace DSM {
 
         m_SwapChain = nullptr;
 
-        DescriptorAllocator::DestroyAll();
+        m_BindlessHeap.Destroy();
+        for (auto& descriptorAllocator : m_DescriptorAllocator) {
+            if (descriptorAllocator != nullptr) {
+                descriptorAllocator->Destroy();
+            }
+        }
     }
 
     void RenderContext::OnResize(std::uint32_t width, std::uint32_t height)
@@ -179,7 +222,18 @@ namespace DSM {
 
     void RenderContext::FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE heapType, DescriptorHandle descriptor, std::uint32_t count)
     {
-        m_DescriptorAllocator[heapType]->FreeDescriptor(descriptor, count);
+        // 描述符可能仍被尚未提交的命令使用，等待下一次提交完成后再复用
+        m_DescriptorAllocator[heapType]->FreeDescriptor(descriptor, count, m_GraphicsQueue.GetNextFenceValue());
+    }
+
+    void RenderContext::FreeBindlessDescriptor(std::uint32_t index)
+    {
+        m_BindlessHeap.Free(index, m_GraphicsQueue.GetNextFenceValue());
+    }
+
+    DescriptorAllocatorStats RenderContext::GetDescriptorAllocatorStats(D3D12_DESCRIPTOR_HEAP_TYPE heapType)
+    {
+        return m_DescriptorAllocator[heapType] != nullptr ? m_DescriptorAllocator[heapType]->GetStats() : DescriptorAllocatorStats{};
     }
 
     void RenderContext::CreateCommandList(
@@ -195,7 +249,7 @@ namespace DSM {
                 *ppAllocator = GetGraphicsQueue().RequestCommandAllocator(); break;
             }
             case D3D12_COMMAND_LIST_TYPE_COMPUTE: {
-                *ppAllocator = GetCommandQueue().RequestCommandAllocator(); break;
+                *ppAllocator = GetComputeQueue().RequestCommandAllocator(); break;
             }
             case D3D12_COMMAND_LIST_TYPE_COPY: {
                 *ppAllocator = GetCopyQueue().RequestCommandAllocator(); break;
@@ -214,6 +268,25 @@ namespace DSM {
         m_CopyQueue.WaitForIdle();
     }
 
+    void RenderContext::SetFramesInFlight(std::uint32_t count)
+    {
+        count = std::clamp(count, 1u, sm_MaxFramesInFlight);
+        if (count == m_FramesInFlight) return;
+
+        // 帧与按帧资源的对应关系会改变，需等待所有帧完成
+        IdleGPU();
+        m_FramesInFlight = count;
+    }
+
+    void RenderContext::BeginFrame()
+    {
+        for (auto fenceValue : m_FrameFences[GetFrameResourceIndex()]) {
+            if (fenceValue != 0) {
+                WaitForFence(fenceValue);
+            }
+        }
+    }
+
     void RenderContext::WaitForFence(uint64_t FenceValue)
     {
         CommandQueue& Producer = GetCommandQueue((D3D12_COMMAND_LIST_TYPE)(FenceValue >> 56));
@@ -4,12 +4,27 @@
 
 #include "../pch.h"
 #include "../Utilities/Singleton.h"
+#include "../Utilities/FrameArena.h"
 #include "CommandQueue.h"
+#include "DeferredReleaseQueue.h"
+#include "MemoryTelemetry.h"
 #include "Resource/DynamicBufferAllocator.h"
+#include "Resource/GpuResourceAllocator.h"
 #include "SwapChain.h"
+#include "BindlessDescriptorHeap.h"
+#include "NullDevice.h"
+#include "CommandList/BindStateCache.h"
 
 namespace DSM {
     class Window;
+
+    // 设备后端
+    enum class DeviceBackend
+    {
+        Hardware,
+        // 由 CPU 内存模拟的空设备，用于无 GPU 环境下的测试与性能分析
+        Null
+    };
     
     class RenderContext : public Singleton<RenderContext>
     {
@@ -21,8 +36,15 @@ namespace DSM {
         }
 
         void Create(bool requireDXRSupport, const Window& window);
+        // 创建不带交换链的渲染环境
+        void CreateHeadless(DeviceBackend backend = DeviceBackend::Null, const NullDeviceDesc& nullDeviceDesc = {});
+        // 为无窗口的渲染环境创建离屏交换链，使依赖交换链的渲染代码可以运行
+        void CreateOffscreenSwapChain(std::uint32_t width, std::uint32_t height);
         void Shutdown();
 
+        DeviceBackend GetDeviceBackend() const noexcept { return m_DeviceBackend; }
+        bool IsHeadless() const noexcept { return m_SwapChain == nullptr || m_SwapChain->IsOffscreen(); }
+
         void OnResize(std::uint32_t width, std::uint32_t height);
         
         ID3D12Device5* GetDevice() const{return m_pDevice.Get();}
@@ -33,13 +55,22 @@ namespace DSM {
         CommandQueue& GetComputeQueue() noexcept { return m_ComputeQueue; }
         CommandQueue& GetCopyQueue() noexcept { return m_CopyQueue; }
 
-        SwapChain& GetSwapChain() noexcept { return *m_SwapChain; }
+        SwapChain& GetSwapChain() noexcept
+        {
+            // 无窗口时需先调用 CreateOffscreenSwapChain
+            ASSERT(m_SwapChain != nullptr);
+            return *m_SwapChain;
+        }
 
         DynamicBufferAllocator& GetCpuBufferAllocator() noexcept { return m_CpuBufferAllocator; }
         DynamicBufferAllocator& GetGpuBufferAllocator() noexcept { return m_GpuBufferAllocator; }
 
         DescriptorHandle AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE heapType, std::uint32_t count = 1);
         void FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE heapType, DescriptorHandle descriptor, std::uint32_t count = 1);
+        // 常驻的着色器可见描述符堆，纹理等资源在其中拥有固定的索引
+        BindlessDescriptorHeap& GetBindlessHeap() noexcept { return m_BindlessHeap; }
+        void FreeBindlessDescriptor(std::uint32_t index);
+        DescriptorAllocatorStats GetDescriptorAllocatorStats(D3D12_DESCRIPTOR_HEAP_TYPE heapType);
 
         void CreateCommandList(
             D3D12_COMMAND_LIST_TYPE listType,
@@ -54,10 +85,47 @@ namespace DSM {
             return GetCommandQueue(D3D12_COMMAND_LIST_TYPE(fenceValue >> QUEUE_TYPE_MOVEBITS)).IsFenceComplete(fenceValue);
         }
 
-        void CleanupDynamicBuffer(std::uint64_t fenceValue)
+        // 所有需要等待 GPU 完成后才能回收的资源都通过该队列释放
+        DeferredReleaseQueue& GetDeferredReleaseQueue() noexcept { return m_DeferredReleaseQueue; }
+        // 各个分配器的内存统计
+        MemoryTelemetry& GetMemoryTelemetry() noexcept { return m_MemoryTelemetry; }
+        // 已经结束的帧数
+        std::uint64_t GetFrameIndex() const noexcept { return m_FrameIndex; }
+        // 当前帧的 CPU 临时内存，在 EndFrame 时回收，只能在调用 EndFrame 的线程上使用
+        FrameArena& GetFrameArena() noexcept { return m_FrameArena; }
+
+        // 每帧碎片整理最多迁移的字节数，为 0 时关闭
+        void SetDefragmentBudget(std::uint64_t maxMoveBytes) noexcept { m_DefragmentBudget = maxMoveBytes; }
+        
+        // 同时在 GPU 上执行的帧数，修改时会等待 GPU 空闲
+        void SetFramesInFlight(std::uint32_t count);
+        std::uint32_t GetFramesInFlight() const noexcept { return m_FramesInFlight; }
+        // 当前帧使用的按帧资源的下标，该组资源上一次使用的帧已在 BeginFrame 中完成
+        std::uint32_t GetFrameResourceIndex() const noexcept
+        {
+            return static_cast<std::uint32_t>(m_FrameIndex % m_FramesInFlight);
+        }
+
+        // 每帧开始时调用，等待使用同一组按帧资源的帧在 GPU 上完成
+        void BeginFrame();
+        // 每帧结束时调用，用于回收按帧管理的资源
+        void EndFrame()
         {
-            m_CpuBufferAllocator.Cleanup(fenceValue);
-            m_GpuBufferAllocator.Cleanup(fenceValue);
+            // 提交本帧中排队的命令列表，并记录本帧在各个队列上完成时的栅栏值
+            auto& frameFences = m_FrameFences[GetFrameResourceIndex()];
+            frameFences[0] = m_GraphicsQueue.FlushPendingCommandLists();
+            frameFences[1] = m_ComputeQueue.FlushPendingCommandLists();
+            frameFences[2] = m_CopyQueue.FlushPendingCommandLists();
+            m_DeferredReleaseQueue.ProcessReleases();
+            DefragmentGpuResourceAllocators(m_DefragmentBudget);
+            m_CpuBufferAllocator.EndFrame();
+            m_GpuBufferAllocator.EndFrame();
+            m_GraphicsQueue.GetCommandAllocatorPool().EndFrame();
+            m_ComputeQueue.GetCommandAllocatorPool().EndFrame();
+            m_CopyQueue.GetCommandAllocatorPool().EndFrame();
+            BindStateCache::EndFrame();
+            m_MemoryTelemetry.EndFrame(++m_FrameIndex);
+            m_FrameArena.Reset();
         }
 
     public:
@@ -66,11 +134,26 @@ namespace DSM {
 
         inline static constexpr std::uint64_t sm_GpuAllocatorPageSize = DEFAULT_BUFFER_PAGE_SIZE / 2;
         inline static constexpr std::uint64_t sm_CpuBufferPageSize = 0x200000;
+        // 上传用环形缓冲区的大小
+        inline static constexpr std::uint64_t sm_UploadRingSize = 0x4000000;
+        inline static constexpr std::uint32_t sm_BindlessHeapSize = 0x10000;
+        // 碎片整理默认关闭，需要时通过 SetDefragmentBudget 开启
+        inline static constexpr std::uint64_t sm_DefaultDefragmentBudget = 0;
+        inline static constexpr std::uint32_t sm_MaxFramesInFlight = 3;
+        inline static constexpr std::uint32_t sm_DefaultFramesInFlight = 2;
+        
+    private:
+        void CreateHardwareDevice(bool requireDXRSupport);
+        void InitializeDevice();
         
     private:
+        DeviceBackend m_DeviceBackend = DeviceBackend::Hardware;
         Microsoft::WRL::ComPtr<ID3D12Device5> m_pDevice{};
         Microsoft::WRL::ComPtr<IDXGIFactory7> m_pFactory{};
 
+        // 需在各个分配器之后析构
+        DeferredReleaseQueue m_DeferredReleaseQueue;
+
         CommandQueue m_GraphicsQueue;
         CommandQueue m_ComputeQueue;
         CommandQueue m_CopyQueue;
@@ -83,6 +166,17 @@ namespace DSM {
         DynamicBufferAllocator m_GpuBufferAllocator;
 
         std::array<std::unique_ptr<DescriptorAllocator>, D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES> m_DescriptorAllocator;
+        BindlessDescriptorHeap m_BindlessHeap;
+
+        std::uint64_t m_DefragmentBudget = sm_DefaultDefragmentBudget;
+
+        MemoryTelemetry m_MemoryTelemetry;
+        std::uint64_t m_FrameIndex{};
+        FrameArena m_FrameArena;
+
+        std::uint32_t m_FramesInFlight = sm_DefaultFramesInFlight;
+        // 每组按帧资源最后一次使用时图形、计算及复制队列的栅栏值
+        std::array<std::array<std::uint64_t, 3>, sm_MaxFramesInFlight> m_FrameFences{};
 
     };
 
@@ -2,36 +2,60 @@
 #include "../RenderContext.h"
 
 namespace DSM {
-    void DynamicBufferAllocator::Create(AllocateMode mode, std::uint64_t pageSize)
+    void DynamicBufferAllocator::Create(AllocateMode mode, std::uint64_t pageSize, std::uint64_t ringSize)
     {
         std::lock_guard lock{m_Mutex};
 
         m_AllocateMode = mode;
         m_PageSize = pageSize;
 
+        if (m_AllocateMode == AllocateMode::Ring) {
+            // 环的大小需为 64KB 的整数倍，保证回绕后对齐不变
+            m_RingSize = Math::AlignUp(std::max(ringSize, pageSize), D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+            m_RingHead = m_RingTail = 0;
+            m_RingBuffer.reset(CreateNewBuffer(m_RingSize));
+            ASSERT_SUCCEEDED(m_RingBuffer->GetResource()->Map(0, nullptr, reinterpret_cast<void**>(&m_RingMappedAddress)));
+            UpdatePeakUsage();
+            return;
+        }
+
         auto buffer = CreateNewBuffer();
         bool mappedAble = m_AllocateMode == AllocateMode::CpuExclusive;
         auto newPage = std::make_unique<DynamicBufferPage>(buffer, mappedAble);
-        m_CurrPage = newPage.get();
+        m_SharedContext.m_CurrPage = newPage.get();
         m_PagePool.emplace_back(std::move(newPage));
+        m_UsedBytes += m_PageSize;
+        UpdatePeakUsage();
     }
 
     void DynamicBufferAllocator::Shutdown()
     {
+        // 归还尚未完成的退役资源，回调中会获取锁
+        g_RenderContext.GetDeferredReleaseQueue().Flush();
+        
+        std::lock_guard sharedLock{m_SharedMutex};
         std::lock_guard lock{m_Mutex};
         
-        m_CurrPage = nullptr;
-        m_FullPages.clear();
-        m_LargePages.clear();
-        while (!m_RetiredPages.empty()) {
-            m_RetiredPages.pop();
+        m_SharedContext = {};
+        m_RingRanges.clear();
+        m_RingHead = m_RingTail = 0;
+        if (m_RingBuffer != nullptr) {
+            m_RingBuffer->GetResource()->Unmap(0, nullptr);
+            m_RingMappedAddress = nullptr;
+            m_RingBuffer = nullptr;
         }
         while (!m_AvailablePages.empty()) {
             m_AvailablePages.pop();
         }
-        while (!m_DeletionPages.empty()) {
-            m_DeletionPages.pop();
+        for (auto& freeBuffers : m_FreeLargeBuffers) {
+            for (auto& buffer : freeBuffers) {
+                DestroyLargeBuffer(buffer);
+            }
+            freeBuffers.clear();
         }
+        m_LargeBufferStats = {};
+        m_UsedBytes = m_PeakUsedBytes = m_PeakReservedBytes = 0;
+        m_NumAllocations = m_AllocatedBytes = 0;
         if (m_AllocateMode == AllocateMode::CpuExclusive) {
             for (auto& page : m_PagePool) {
                 if (page->m_MappedAddress != nullptr) {
@@ -43,65 +67,333 @@ namespace DSM {
         m_PagePool.clear();
     }
 
-    GpuResourceLocatioin DynamicBufferAllocator::Allocate(std::uint64_t bufferSize, std::uint32_t alignment)
+    GpuResourceLocatioin DynamicBufferAllocator::Allocate(
+        DynamicBufferContext& context,
+        std::uint64_t bufferSize,
+        std::uint32_t alignment)
     {
         GpuResourceLocatioin ret{};
+        ++context.m_NumAllocations;
+        context.m_AllocatedBytes += bufferSize;
 
-        std::lock_guard lock(m_Mutex);
+        if (m_AllocateMode == AllocateMode::Ring && AllocateFromRing(context, bufferSize, alignment, ret)) {
+            return ret;
+        }
 
-        // 过大的资源额外管理
-        if (auto alignSize = Math::AlignUp(bufferSize, alignment); alignSize > m_PageSize) {
-            ret.m_Resource = CreateNewBuffer(alignSize);
-            ret.m_Size = alignSize;
-            ret.m_GpuAddress = ret.m_Resource->GetGpuVirtualAddress();
-            if (m_AllocateMode == AllocateMode::CpuExclusive) {
-                ASSERT_SUCCEEDED(ret.m_Resource->GetResource()->Map(0, nullptr, &ret.m_MappedAddress));
-            }
-            m_LargePages.push_back(ret.m_Resource);
+        // 过大的资源额外管理，环形缓冲区放不下时也退化为单独的缓冲区
+        if (auto alignSize = Math::AlignUp(bufferSize, alignment); 
+            alignSize > m_PageSize || m_AllocateMode == AllocateMode::Ring) {
+            AllocateLargeBuffer(context, alignSize, ret);
         }
-        else if (m_CurrPage == nullptr || !m_CurrPage->Allocate(bufferSize, alignment, ret)) {    // 创建新的Page
+        else if (context.m_CurrPage == nullptr || !context.m_CurrPage->Allocate(bufferSize, alignment, ret)) {    // 创建新的Page
             // 记录已经满的Page
-            if (m_CurrPage != nullptr) {
-                m_FullPages.push_back(m_CurrPage);
+            if (context.m_CurrPage != nullptr) {
+                context.m_FullPages.push_back(context.m_CurrPage);
             }
-            m_CurrPage = RequestPage();
-            m_CurrPage->Allocate(bufferSize, alignment, ret);
+            {
+                std::lock_guard lock(m_Mutex);
+                context.m_CurrPage = RequestPage();
+            }
+            context.m_CurrPage->Allocate(bufferSize, alignment, ret);
         }
         
         return ret;
     }
 
+    GpuResourceLocatioin DynamicBufferAllocator::Allocate(std::uint64_t bufferSize, std::uint32_t alignment)
+    {
+        std::lock_guard lock{m_SharedMutex};
+        return Allocate(m_SharedContext, bufferSize, alignment);
+    }
+
+    void DynamicBufferAllocator::Cleanup(DynamicBufferContext& context, std::uint64_t fenceValue)
+    {
+        for (auto& fullPage : context.m_FullPages) {
+            RetirePage(fullPage, fenceValue);
+        }
+        context.m_FullPages.clear();
+
+        if (m_AllocateMode == AllocateMode::Ring) {
+            RetireRingRanges(context, fenceValue);
+        }
+        if (!context.m_LargeBuffers.empty()) {
+            RetireLargeBuffers(context, fenceValue);
+        }
+
+        m_NumAllocations.fetch_add(std::exchange(context.m_NumAllocations, 0), std::memory_order_relaxed);
+        m_AllocatedBytes.fetch_add(std::exchange(context.m_AllocatedBytes, 0), std::memory_order_relaxed);
+    }
+
+    void DynamicBufferAllocator::RetireLargeBuffers(DynamicBufferContext& context, std::uint64_t fenceValue)
+    {
+        // 缓冲区保持映射，重复使用时无需再次映射
+        for (auto& location : context.m_LargeBuffers) {
+            LargeBuffer buffer{};
+            buffer.m_Resource = location.m_Resource;
+            buffer.m_MappedAddress = location.m_MappedAddress;
+            auto bufferSize = location.m_Resource->GetResource()->GetDesc().Width;
+            g_RenderContext.GetDeferredReleaseQueue().Release(fenceValue, [this, buffer]() {
+                ReturnLargeBuffer(buffer);
+            }, bufferSize);
+        }
+        context.m_LargeBuffers.clear();
+    }
+
+    void DynamicBufferAllocator::ReleaseContext(DynamicBufferContext& context, std::uint64_t fenceValue)
+    {
+        if (context.m_CurrPage != nullptr) {
+            context.m_FullPages.push_back(context.m_CurrPage);
+            context.m_CurrPage = nullptr;
+        }
+        Cleanup(context, fenceValue);
+    }
+
     void DynamicBufferAllocator::Cleanup(std::uint64_t fenceValue)
+    {
+        std::lock_guard lock{m_SharedMutex};
+        Cleanup(m_SharedContext, fenceValue);
+    }
+
+    void DynamicBufferAllocator::EndFrame()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        ++m_FrameIndex;
+
+        // 空闲列表按空闲时间排列，从头部开始释放
+        for (auto& freeBuffers : m_FreeLargeBuffers) {
+            auto it = freeBuffers.begin();
+            for (; it != freeBuffers.end() && m_FrameIndex - it->m_IdleFrame > m_LargeBufferIdleFrames; ++it) {
+                DestroyLargeBuffer(*it);
+                ++m_LargeBufferStats.m_NumTrimmed;
+            }
+            freeBuffers.erase(freeBuffers.begin(), it);
+        }
+    }
+
+    std::uint64_t DynamicBufferAllocator::GetRingUsedSize()
     {
         std::lock_guard lock{m_Mutex};
+        ReclaimRingRanges();
+        return m_RingHead - m_RingTail;
+    }
+
+    bool DynamicBufferAllocator::AllocateFromRing(
+        DynamicBufferContext& context,
+        std::uint64_t bufferSize,
+        std::uint32_t alignment,
+        GpuResourceLocatioin& outResource)
+    {
+        // 超过环一半大小的分配不进入环形缓冲区，避免频繁等待
+        if (bufferSize + alignment > m_RingSize / 2) return false;
         
-        for (auto& fullPage : m_FullPages) {
-            fullPage->Reset();
-            m_RetiredPages.push(std::make_pair(fenceValue, fullPage));
+        auto& range = context.m_CurrRange;
+        auto offset = Math::AlignUp(range.m_Offset, alignment);
+        if (range.m_End == 0 || offset + bufferSize > range.m_End) {
+            if (range.m_End != 0) {
+                context.m_FullRanges.push_back(range);
+            }
+            range = {};
+            if (!RequestRingRange(std::max(m_PageSize, bufferSize + alignment), range)) {
+                return false;
+            }
+            offset = Math::AlignUp(range.m_Offset, alignment);
         }
-        m_FullPages.clear();
+        range.m_Offset = offset + bufferSize;
+
+        auto ringOffset = offset % m_RingSize;
+        outResource.m_Resource = m_RingBuffer.get();
+        outResource.m_Offset = ringOffset;
+        outResource.m_Size = bufferSize;
+        outResource.m_GpuAddress = m_RingBuffer->GetGpuVirtualAddress() + ringOffset;
+        outResource.m_MappedAddress = m_RingMappedAddress + ringOffset;
+        return true;
+    }
+
+    bool DynamicBufferAllocator::RequestRingRange(std::uint64_t size, DynamicBufferRange& range)
+    {
+        std::unique_lock lock{m_Mutex};
+
+        while (true) {
+            ReclaimRingRanges();
 
-        while (!m_DeletionPages.empty() && g_RenderContext.IsFenceComplete(fenceValue)) {
-            delete m_DeletionPages.front().second;
-            m_DeletionPages.pop();
+            // 区间不能跨越环的末尾，剩余部分作为已退役的空区间跳过
+            if (auto ringOffset = m_RingHead % m_RingSize; ringOffset + size > m_RingSize) {
+                auto padding = m_RingSize - ringOffset;
+                m_RingRanges.push_back({m_RingHead, m_RingHead + padding, 0, true});
+                m_RingHead += padding;
+            }
+            if (m_RingHead + size - m_RingTail <= m_RingSize) break;
+
+            // 空间不足时等待最早退役的区间完成，仍在录制中的区间无法等待
+            if (m_RingRanges.empty() || !m_RingRanges.front().m_Retired) {
+                return false;
+            }
+            // 等待期间不持有锁，其他线程可以继续分配与退役，醒来后重新检查
+            auto fenceValue = m_RingRanges.front().m_FenceValue;
+            lock.unlock();
+            g_RenderContext.WaitForFence(fenceValue);
+            lock.lock();
         }
 
-        for (auto& page : m_LargePages) {
-            page->GetResource()->Unmap(0, nullptr);
-            m_DeletionPages.push(std::make_pair(fenceValue, page));
+        range.m_Begin = range.m_Offset = m_RingHead;
+        range.m_End = m_RingHead + size;
+        m_RingRanges.push_back({range.m_Begin, range.m_End});
+        m_RingHead = range.m_End;
+        UpdatePeakUsage();
+        
+        return true;
+    }
+
+    void DynamicBufferAllocator::RetireRingRanges(DynamicBufferContext& context, std::uint64_t fenceValue)
+    {
+        // 每次提交都退役当前区间，避免长期存活的上下文阻塞环的回收
+        if (context.m_CurrRange.m_End != 0) {
+            context.m_FullRanges.push_back(context.m_CurrRange);
+            context.m_CurrRange = {};
         }
-        m_LargePages.clear();
+        if (context.m_FullRanges.empty()) return;
+
+        std::lock_guard lock{m_Mutex};
+
+        for (auto& range : context.m_FullRanges) {
+            auto it = std::lower_bound(m_RingRanges.begin(), m_RingRanges.end(), range.m_Begin,
+                [](const RingRange& ringRange, std::uint64_t begin) { return ringRange.m_Begin < begin; });
+            ASSERT(it != m_RingRanges.end() && it->m_Begin == range.m_Begin);
+
+            // 最新分配的区间可以归还未使用的部分
+            if (range.m_End == m_RingHead) {
+                m_RingHead = range.m_Offset;
+                if (range.m_Offset == range.m_Begin) {
+                    m_RingRanges.erase(it);
+                    continue;
+                }
+                it->m_End = range.m_Offset;
+            }
+            it->m_FenceValue = fenceValue;
+            it->m_Retired = true;
+        }
+        context.m_FullRanges.clear();
     }
 
-    DynamicBufferPage* DynamicBufferAllocator::RequestPage()
+    void DynamicBufferAllocator::ReclaimRingRanges()
     {
-        // 清除已经完成的资源
-        while (!m_RetiredPages.empty() &&
-            g_RenderContext.IsFenceComplete(m_RetiredPages.front().first)) {
-            m_AvailablePages.push(m_RetiredPages.front().second);
-            m_RetiredPages.pop();
+        while (!m_RingRanges.empty()) {
+            const auto& range = m_RingRanges.front();
+            if (!range.m_Retired ||
+                (range.m_FenceValue != 0 && !g_RenderContext.IsFenceComplete(range.m_FenceValue))) {
+                break;
+            }
+            m_RingTail = range.m_End;
+            m_RingRanges.pop_front();
         }
+    }
+
+    DynamicLargeBufferStats DynamicBufferAllocator::GetLargeBufferStats()
+    {
+        std::lock_guard lock{m_Mutex};
+        return m_LargeBufferStats;
+    }
+
+    DynamicBufferStats DynamicBufferAllocator::GetStats()
+    {
+        std::lock_guard lock{m_Mutex};
+        ReclaimRingRanges();
+
+        DynamicBufferStats stats{};
+        stats.m_ReservedBytes = GetReservedBytes();
+        stats.m_UsedBytes = m_UsedBytes + (m_RingHead - m_RingTail);
+        stats.m_PeakReservedBytes = std::max(m_PeakReservedBytes, stats.m_ReservedBytes);
+        stats.m_PeakUsedBytes = std::max(m_PeakUsedBytes, stats.m_UsedBytes);
+        stats.m_NumPages = static_cast<std::uint32_t>(m_PagePool.size()) + m_LargeBufferStats.m_NumBuffers + (m_RingBuffer != nullptr ? 1 : 0);
+        stats.m_NumAllocations = m_NumAllocations.load(std::memory_order_relaxed);
+        stats.m_AllocatedBytes = m_AllocatedBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void DynamicBufferAllocator::UpdatePeakUsage() noexcept
+    {
+        m_PeakUsedBytes = std::max(m_PeakUsedBytes, m_UsedBytes + (m_RingHead - m_RingTail));
+        m_PeakReservedBytes = std::max(m_PeakReservedBytes, GetReservedBytes());
+    }
+
+    std::uint64_t DynamicBufferAllocator::GetReservedBytes() const noexcept
+    {
+        return m_PagePool.size() * m_PageSize + m_RingSize + m_LargeBufferStats.m_TotalSize;
+    }
+
+    std::uint32_t DynamicBufferAllocator::GetLargeBufferClass(std::uint64_t bufferSize) noexcept
+    {
+        // 最小为 64KB，与资源的放置对齐一致
+        bufferSize = std::max<std::uint64_t>(bufferSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+        return static_cast<std::uint32_t>(std::bit_width(bufferSize - 1));
+    }
 
+    void DynamicBufferAllocator::AllocateLargeBuffer(
+        DynamicBufferContext& context,
+        std::uint64_t bufferSize,
+        GpuResourceLocatioin& outResource)
+    {
+        auto sizeClass = GetLargeBufferClass(bufferSize);
+        LargeBuffer buffer{};
+        {
+            std::lock_guard lock{m_Mutex};
+
+            if (auto& freeBuffers = m_FreeLargeBuffers[sizeClass]; !freeBuffers.empty()) {
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+                ++m_LargeBufferStats.m_NumHits;
+            }
+            else {
+                ++m_LargeBufferStats.m_NumMisses;
+                ++m_LargeBufferStats.m_NumBuffers;
+                m_LargeBufferStats.m_TotalSize += 1ull << sizeClass;
+            }
+            m_UsedBytes += 1ull << sizeClass;
+            UpdatePeakUsage();
+        }
+
+        // 未命中时在锁外创建新的缓冲区
+        if (buffer.m_Resource == nullptr) {
+            buffer.m_Resource = CreateNewBuffer(1ull << sizeClass);
+            if (m_AllocateMode != AllocateMode::GpuExclusive) {
+                ASSERT_SUCCEEDED(buffer.m_Resource->GetResource()->Map(0, nullptr, &buffer.m_MappedAddress));
+            }
+        }
+
+        outResource.m_Resource = buffer.m_Resource;
+        outResource.m_Offset = 0;
+        outResource.m_Size = bufferSize;
+        outResource.m_GpuAddress = buffer.m_Resource->GetGpuVirtualAddress();
+        outResource.m_MappedAddress = buffer.m_MappedAddress;
+        context.m_LargeBuffers.push_back(outResource);
+    }
+
+    void DynamicBufferAllocator::ReturnLargeBuffer(LargeBuffer buffer)
+    {
+        std::lock_guard lock{m_Mutex};
+
+        auto bufferSize = buffer.m_Resource->GetResource()->GetDesc().Width;
+        m_UsedBytes -= bufferSize;
+        buffer.m_IdleFrame = m_FrameIndex;
+        m_FreeLargeBuffers[GetLargeBufferClass(bufferSize)].push_back(buffer);
+    }
+
+    void DynamicBufferAllocator::DestroyLargeBuffer(LargeBuffer& buffer)
+    {
+        if (buffer.m_MappedAddress != nullptr) {
+            buffer.m_Resource->GetResource()->Unmap(0, nullptr);
+        }
+        if (buffer.m_Resource != nullptr) {
+            m_LargeBufferStats.m_TotalSize -= buffer.m_Resource->GetResource()->GetDesc().Width;
+            --m_LargeBufferStats.m_NumBuffers;
+        }
+        delete buffer.m_Resource;
+        buffer = {};
+    }
+
+    DynamicBufferPage* DynamicBufferAllocator::RequestPage()
+    {
         DynamicBufferPage* ret = nullptr;
         if (m_AvailablePages.empty()) {
             bool mappedAble = m_AllocateMode == AllocateMode::CpuExclusive;
@@ -113,10 +405,24 @@ namespace DSM {
             ret = m_AvailablePages.front();
             m_AvailablePages.pop();
         }
+        m_UsedBytes += m_PageSize;
+        UpdatePeakUsage();
         
         return ret;
     }
 
+    void DynamicBufferAllocator::RetirePage(DynamicBufferPage* page, std::uint64_t fenceValue) noexcept
+    {
+        page->Reset();
+        
+        // 提交到无锁的延迟释放队列，GPU 使用完毕后再放回可用队列
+        g_RenderContext.GetDeferredReleaseQueue().Release(fenceValue, [this, page]() {
+            std::lock_guard lock{m_Mutex};
+            m_AvailablePages.push(page);
+            m_UsedBytes -= m_PageSize;
+        }, m_PageSize);
+    }
+
     GpuResource* DynamicBufferAllocator::CreateNewBuffer(std::uint64_t bufferSize)
     {
         D3D12_RESOURCE_DESC resourceDesc{};
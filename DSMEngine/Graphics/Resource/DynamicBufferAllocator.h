@@ -4,6 +4,8 @@
 
 #include "GpuBuffer.h"
 #include "../../Utilities/LinearAllocator.h"
+#include <bit>
+#include <atomic>
 
 namespace DSM {
     // 用于定位子资源在缓冲区中的位置
@@ -57,28 +59,132 @@ namespace DSM {
         LinearAllocator m_LiearAllocator;
         std::uint8_t* m_MappedAddress{};
     };
+
+    // 环形缓冲区中的一段区间，偏移为不回绕的虚拟偏移
+    struct DynamicBufferRange
+    {
+        std::uint64_t m_Begin{};
+        std::uint64_t m_Offset{};
+        std::uint64_t m_End{};
+    };
+
+    // 由单个线程或命令列表独占的分配上下文，在当前页内分配时无需加锁
+    struct DynamicBufferContext
+    {
+        DynamicBufferPage* m_CurrPage{};
+        std::vector<DynamicBufferPage*> m_FullPages{};
+        std::vector<GpuResourceLocatioin> m_LargeBuffers{};
+        
+        // 环形模式下使用的区间
+        DynamicBufferRange m_CurrRange{};
+        std::vector<DynamicBufferRange> m_FullRanges{};
+
+        // 上次 Cleanup 之后的分配，Cleanup 时汇总到分配器中
+        std::uint64_t m_NumAllocations{};
+        std::uint64_t m_AllocatedBytes{};
+    };
+    
+    // 大缓冲区缓存的使用情况
+    struct DynamicLargeBufferStats
+    {
+        std::uint64_t m_NumHits{};
+        std::uint64_t m_NumMisses{};
+        std::uint64_t m_NumTrimmed{};
+        // 当前缓存中空闲及使用中的缓冲区
+        std::uint32_t m_NumBuffers{};
+        std::uint64_t m_TotalSize{};
+    };
+
+    // 动态缓冲区的内存使用情况
+    struct DynamicBufferStats
+    {
+        // 页、环形缓冲区及大缓冲区占用的空间
+        std::uint64_t m_ReservedBytes{};
+        // 尚未归还的页、环形区间及大缓冲区
+        std::uint64_t m_UsedBytes{};
+        std::uint64_t m_PeakReservedBytes{};
+        std::uint64_t m_PeakUsedBytes{};
+        std::uint32_t m_NumPages{};
+        // 已经过 Cleanup 的分配
+        std::uint64_t m_NumAllocations{};
+        std::uint64_t m_AllocatedBytes{};
+    };
     
     class DynamicBufferAllocator
     {
     public:
         enum class AllocateMode
         {
-            CpuExclusive, GpuExclusive
+            CpuExclusive, GpuExclusive,
+            // 使用一个常驻映射的上传缓冲区作为环形缓冲区，按栅栏回收
+            Ring
         };
         
         DynamicBufferAllocator() = default;
         ~DynamicBufferAllocator() { Shutdown(); };
         DSM_NONCOPYABLE_NONMOVABLE(DynamicBufferAllocator);
 
-        void Create(AllocateMode mode, std::uint64_t pageSize = DEFAULT_BUFFER_PAGE_SIZE);
+        // 环形模式下 pageSize 为上下文每次占用的区间大小
+        void Create(AllocateMode mode, std::uint64_t pageSize = DEFAULT_BUFFER_PAGE_SIZE, std::uint64_t ringSize = 0);
         void Shutdown();
 
+        // 在上下文的当前页中分配，只有换页时才需要加锁
+        GpuResourceLocatioin Allocate(DynamicBufferContext& context, std::uint64_t bufferSize, std::uint32_t alignment = 0);
+        // 在共享的上下文中分配
         GpuResourceLocatioin Allocate(std::uint64_t bufferSize, std::uint32_t alignment = 0);
-        // 清理所有的缓冲区
+        // 退役上下文中已满的页及大缓冲区，当前页可继续使用
+        void Cleanup(DynamicBufferContext& context, std::uint64_t fenceValue);
+        // 退役上下文中的所有页，用于上下文销毁时
+        void ReleaseContext(DynamicBufferContext& context, std::uint64_t fenceValue);
+        // 清理共享上下文中的缓冲区，共享上下文不属于任何队列，需由使用者以其提交的栅栏调用
         void Cleanup(std::uint64_t fenceValue);
+        // 每帧结束时调用，释放长时间未使用的大缓冲区
+        void EndFrame();
+
+        AllocateMode GetAllocateMode() const noexcept { return m_AllocateMode; }
+        std::uint64_t GetRingSize() const noexcept { return m_RingSize; }
+        // 环形缓冲区中尚未回收的大小
+        std::uint64_t GetRingUsedSize();
+        DynamicLargeBufferStats GetLargeBufferStats();
+        DynamicBufferStats GetStats();
+        // 空闲超过该帧数的大缓冲区会被释放
+        void SetLargeBufferIdleFrames(std::uint32_t numFrames) noexcept { m_LargeBufferIdleFrames = numFrames; }
 
     private:
+        // 环形缓冲区中按分配顺序排列的区间
+        struct RingRange
+        {
+            std::uint64_t m_Begin{};
+            std::uint64_t m_End{};
+            std::uint64_t m_FenceValue{};
+            bool m_Retired{};
+        };
+        // 按 2 的幂大小分级缓存的大缓冲区
+        struct LargeBuffer
+        {
+            GpuResource* m_Resource{};
+            void* m_MappedAddress{};
+            // 变为空闲时的帧序号
+            std::uint64_t m_IdleFrame{};
+        };
+        
+        static std::uint32_t GetLargeBufferClass(std::uint64_t bufferSize) noexcept;
+        void AllocateLargeBuffer(DynamicBufferContext& context, std::uint64_t bufferSize, GpuResourceLocatioin& outResource);
+        void ReturnLargeBuffer(LargeBuffer buffer);
+        void DestroyLargeBuffer(LargeBuffer& buffer);
+
+        bool AllocateFromRing(DynamicBufferContext& context, std::uint64_t bufferSize, std::uint32_t alignment, GpuResourceLocatioin& outResource);
+        bool RequestRingRange(std::uint64_t size, DynamicBufferRange& range);
+        void RetireRingRanges(DynamicBufferContext& context, std::uint64_t fenceValue);
+        void ReclaimRingRanges();
+        void RetireLargeBuffers(DynamicBufferContext& context, std::uint64_t fenceValue);
+
+        // 使用量增加后更新峰值，需持有 m_Mutex
+        void UpdatePeakUsage() noexcept;
+        std::uint64_t GetReservedBytes() const noexcept;
+
         DynamicBufferPage* RequestPage();
+        void RetirePage(DynamicBufferPage* page, std::uint64_t fenceValue) noexcept;
         GpuResource* CreateNewBuffer(std::uint64_t bufferSize = 0);
 
     private:
@@ -86,19 +192,36 @@ namespace DSM {
         
         std::vector<std::unique_ptr<DynamicBufferPage>> m_PagePool;
 
-        std::vector<DynamicBufferPage*> m_FullPages;
-        std::vector<GpuResource*> m_LargePages;
+        // 未指定上下文时使用的共享上下文
+        DynamicBufferContext m_SharedContext{};
+        std::mutex m_SharedMutex{};
 
-        DynamicBufferPage* m_CurrPage{};
-        // 等待使用完毕的资源
-        std::queue<std::pair<std::uint64_t, DynamicBufferPage*>> m_RetiredPages{};
-        // 可重复使用的资源
+        // 可重复使用的资源，退役的页及大缓冲区由延迟释放队列在 GPU 使用完毕后归还
         std::queue<DynamicBufferPage*> m_AvailablePages{};
-        // 需要删除的资源
-        std::queue<std::pair<std::uint64_t, GpuResource*>> m_DeletionPages{};
+        // 各大小等级中可重复使用的大缓冲区，末尾为最近空闲的
+        std::array<std::vector<LargeBuffer>, 64> m_FreeLargeBuffers{};
+        DynamicLargeBufferStats m_LargeBufferStats{};
+        std::uint32_t m_LargeBufferIdleFrames = 120;
+        std::uint64_t m_FrameIndex{};
 
         std::uint64_t m_PageSize{};
+
+        std::unique_ptr<GpuResource> m_RingBuffer{};
+        std::uint8_t* m_RingMappedAddress{};
+        std::uint64_t m_RingSize{};
+        // 虚拟偏移，对环大小取模后为实际偏移
+        std::uint64_t m_RingHead{};
+        std::uint64_t m_RingTail{};
+        std::deque<RingRange> m_RingRanges{};
+
+        // 使用中的页及大缓冲区，环形缓冲区的使用量由头尾计算
+        std::uint64_t m_UsedBytes{};
+        std::uint64_t m_PeakUsedBytes{};
+        std::uint64_t m_PeakReservedBytes{};
+        std::atomic<std::uint64_t> m_NumAllocations{};
+        std::atomic<std::uint64_t> m_AllocatedBytes{};
         
+        // 仅在换页、请求环形区间、归还资源及创建、删除大缓冲区时使用
         std::mutex m_Mutex{};
         
     };
@@ -3,34 +3,78 @@
 
 namespace DSM {
 
+    // 每种堆类型一个分配器，分配器内部再按尺寸等级分别加锁
     static std::map<DSMHeapDesc, GpuResourceAllocator> s_GpuResourceAllocators{};
+    static std::mutex s_AllocatorMutex{};
 
-    
+    GpuResourceAllocator& GetGpuResourceAllocator(DSMHeapDesc heapDesc)
+    {
+        std::lock_guard lock{s_AllocatorMutex};
 
-    void GpuResource::Create(const std::wstring& name, const GpuResourceDesc& resourceDesc)
+        auto [it, inserted] = s_GpuResourceAllocators.try_emplace(heapDesc);
+        if (inserted) {
+            it->second.Create(heapDesc);
+        }
+        return it->second;
+    }
+
+    std::uint64_t DefragmentGpuResourceAllocators(std::uint64_t maxMoveBytes)
     {
-        if (m_Resource != nullptr) {
-            Destroy();
+        std::uint64_t movedBytes = 0;
+        for (auto allocator : GetGpuResourceAllocators()) {
+            if (movedBytes >= maxMoveBytes) break;
+            movedBytes += allocator->Defragment(maxMoveBytes - movedBytes);
         }
-        
-        DSMHeapDesc heapDesc{};
-        heapDesc.m_HeapType = resourceDesc.m_HeapType;
-        heapDesc.m_HeapFlags = resourceDesc.m_HeapFlags;
-        ID3D12Resource* resource = nullptr;
-        if (auto it = s_GpuResourceAllocators.find(heapDesc); it != s_GpuResourceAllocators.end()) {
-            resource =it->second.CreateResource(resourceDesc.m_Desc, resourceDesc.m_State);
-            m_Allocator = &it->second;
+        return movedBytes;
+    }
+
+    std::vector<GpuResourceAllocator*> GetGpuResourceAllocators()
+    {
+        std::lock_guard lock{s_AllocatorMutex};
+
+        std::vector<GpuResourceAllocator*> allocators{};
+        for (auto& [heapDesc, allocator] : s_GpuResourceAllocators) {
+            allocators.push_back(&allocator);
         }
-        else {
-            auto& allocator = s_GpuResourceAllocators[heapDesc];
-            allocator.Create(heapDesc);
-            resource = allocator.CreateResource(resourceDesc.m_Desc, resourceDesc.m_State);
-            m_Allocator = &allocator;
+        return allocators;
+    }
+
+
+
+    GpuResource::GpuResource(GpuResource&& resource) noexcept
+        :m_Resource(std::move(resource.m_Resource)),
+        m_UsageState(resource.m_UsageState),
+        m_SubresourceStates(std::move(resource.m_SubresourceStates)),
+        m_Allocator(std::exchange(resource.m_Allocator, nullptr)),
+        m_Allocation(std::exchange(resource.m_Allocation, {})),
+        m_RelocateCallback(std::move(resource.m_RelocateCallback))
+    {
+        // 分配器中记录了资源的持有者，移动后需要更新
+        if (m_Allocator != nullptr && m_Allocation.IsValid()) {
+            m_Allocator->UpdateOwner(m_Allocation, this);
         }
-        m_Resource = resource;
-        m_UsageState = resourceDesc.m_State;
+    }
 
-        m_Resource->SetName(name.c_str());
+    GpuResource& GpuResource::operator=(GpuResource&& resource) noexcept
+    {
+        if (this != &resource) {
+            ReleaseAllocation();
+            m_Resource = std::move(resource.m_Resource);
+            m_UsageState = resource.m_UsageState;
+            m_SubresourceStates = std::move(resource.m_SubresourceStates);
+            m_Allocator = std::exchange(resource.m_Allocator, nullptr);
+            m_Allocation = std::exchange(resource.m_Allocation, {});
+            m_RelocateCallback = std::move(resource.m_RelocateCallback);
+            if (m_Allocator != nullptr && m_Allocation.IsValid()) {
+                m_Allocator->UpdateOwner(m_Allocation, this);
+            }
+        }
+        return *this;
+    }
+
+    void GpuResource::Create(const std::wstring& name, const GpuResourceDesc& resourceDesc)
+    {
+        CreateFromAllocator(name, resourceDesc, nullptr);
     }
 
     void GpuResource::Create(const std::wstring& name, ID3D12Resource* resource)
@@ -39,45 +83,52 @@ namespace DSM {
         if (m_Resource != nullptr) {
             Destroy();
         }
-        
+
         m_Resource.Attach(resource);
         m_Resource->SetName(name.c_str());
-        m_UsageState = D3D12_RESOURCE_STATE_COMMON;
+        SetUsageState(D3D12_RESOURCE_STATE_COMMON);
         m_Allocator = nullptr;
+        m_Allocation = {};
     }
 
     void GpuResource::Create(const std::wstring& name, const GpuResourceDesc& resourceDesc, const D3D12_CLEAR_VALUE& clearValue)
+    {
+        CreateFromAllocator(name, resourceDesc, &clearValue);
+    }
+
+    void GpuResource::Destroy()
+    {
+        ReleaseAllocation();
+        m_Resource = nullptr;
+    }
+
+    void GpuResource::CreateFromAllocator(
+        const std::wstring& name,
+        const GpuResourceDesc& resourceDesc,
+        const D3D12_CLEAR_VALUE* clearValue)
     {
         if (m_Resource != nullptr) {
             Destroy();
         }
-        
+
         DSMHeapDesc heapDesc{};
         heapDesc.m_HeapType = resourceDesc.m_HeapType;
         heapDesc.m_HeapFlags = resourceDesc.m_HeapFlags;
-        ID3D12Resource* resource = nullptr;
-        if (auto it = s_GpuResourceAllocators.find(heapDesc); it != s_GpuResourceAllocators.end()) {
-            resource =it->second.CreateResource(resourceDesc.m_Desc, resourceDesc.m_State, &clearValue);
-            m_Allocator = &it->second;
-        }
-        else {
-            auto& allocator = s_GpuResourceAllocators[heapDesc];
-            allocator.Create(heapDesc);
-            resource = allocator.CreateResource(resourceDesc.m_Desc, resourceDesc.m_State);
-            m_Allocator = &allocator;
-        }
-        m_Resource = resource;
-        m_UsageState = resourceDesc.m_State;
+        m_Allocator = &GetGpuResourceAllocator(heapDesc);
+        // 分配器返回的资源已持有一个引用
+        m_Resource.Attach(m_Allocator->CreateResource(
+            resourceDesc.m_Desc, resourceDesc.m_State, clearValue, m_Allocation, this));
+        SetUsageState(resourceDesc.m_State);
 
         m_Resource->SetName(name.c_str());
     }
 
-    void GpuResource::Destroy()
+    void GpuResource::ReleaseAllocation() noexcept
     {
-        if (m_Allocator != nullptr) {
-            m_Allocator->ReleaseResource(m_Resource.Get());
+        if (m_Allocator != nullptr && m_Allocation.IsValid()) {
+            m_Allocator->ReleaseResource(m_Allocation);
         }
-        m_Resource = nullptr;
         m_Allocator = nullptr;
+        m_Allocation = {};
     }
 }
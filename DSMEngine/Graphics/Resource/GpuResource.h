@@ -14,10 +14,42 @@ namespace DSM {
         D3D12_RESOURCE_DESC m_Desc{};
         D3D12_RESOURCE_STATES m_State = D3D12_RESOURCE_STATE_COMMON;
     };
+
+    // 按资源大小划分的堆池，需要 4MB 对齐的 MSAA 资源单独使用一个池
+    enum class GpuResourceSizeClass : std::uint8_t
+    {
+        Small, Medium, Large, MSAA, Count
+    };
+
+    // 资源在分配器中的记录，释放时直接索引到所在的页
+    struct GpuAllocation
+    {
+        inline static constexpr std::uint32_t INVALID_INDEX = (std::numeric_limits<std::uint32_t>::max)();
+        
+        std::uint64_t m_Offset{};
+        std::uint64_t m_Size{};
+        // 提交资源不属于任何页
+        std::uint32_t m_PageIndex = INVALID_INDEX;
+        std::uint32_t m_Block = INVALID_INDEX;
+        // 仅用于统计
+        std::uint32_t m_PaddingSize{};
+        std::uint32_t m_SavedSize{};
+        GpuResourceSizeClass m_SizeClass{};
+        bool m_SmallAligned{};
+
+        bool IsValid() const noexcept { return m_Size != 0; }
+        bool IsPlaced() const noexcept { return m_PageIndex != INVALID_INDEX; }
+    };
     
     // GPU 资源的封装
     class GpuResource
     {
+        friend class GpuResourceAllocator;
+        friend class ResourceStateTracker;
+    public:
+        // 资源被碎片整理迁移到新的位置后调用，用于重新创建视图
+        using RelocateCallback = std::function<void(GpuResource&)>;
+        
     public:
         GpuResource() = default;
         GpuResource(const std::wstring& name, const GpuResourceDesc& resourceDesc)
@@ -29,8 +61,8 @@ namespace DSM {
             Create(name, resource);
         }
         virtual ~GpuResource() { Destroy(); }
-        GpuResource(GpuResource&& resource) noexcept = default;
-        GpuResource& operator=(GpuResource&& resource) noexcept = default;
+        GpuResource(GpuResource&& resource) noexcept;
+        GpuResource& operator=(GpuResource&& resource) noexcept;
         DSM_NONCOPYABLE(GpuResource);
 
         void Create(const std::wstring& name, const GpuResourceDesc& resourceDesc);
@@ -46,19 +78,40 @@ namespace DSM {
         ID3D12Resource** GetAddressOf() { return m_Resource.GetAddressOf(); }
         ID3D12Resource* const * GetAddressOf() const { return m_Resource.GetAddressOf(); }
 
+        // 所有子资源状态相同时有效，命令列表中的状态由各个列表单独跟踪，提交时才会更新
         D3D12_RESOURCE_STATES GetUsageState() const noexcept { return m_UsageState; }
 
         D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const noexcept { return m_Resource->GetGPUVirtualAddress(); }
 
-        void SetUsageState(D3D12_RESOURCE_STATES usageState) noexcept { m_UsageState = usageState; }
+        void SetUsageState(D3D12_RESOURCE_STATES usageState) noexcept
+        {
+            m_UsageState = usageState;
+            m_SubresourceStates.clear();
+        }
+        // 由分配器创建时的分配记录，外部创建的资源为无效记录
+        const GpuAllocation& GetAllocation() const noexcept { return m_Allocation; }
+
+        // 设置后资源可被碎片整理迁移，迁移在帧结束时完成，之后 GetResource 返回新的资源
+        // 回调在切换时调用，之前提交的命令仍可能读取旧的描述符，需为新资源分配新的着色器可见描述符
+        // 仅适用于创建后 GPU 只读的资源
+        void SetRelocateCallback(RelocateCallback callback) { m_RelocateCallback = std::move(callback); }
+        bool IsRelocatable() const noexcept { return m_RelocateCallback != nullptr; }
+        
+    private:
+        void CreateFromAllocator(const std::wstring& name, const GpuResourceDesc& resourceDesc, const D3D12_CLEAR_VALUE* clearValue);
+        void ReleaseAllocation() noexcept;
         
     protected:
         Microsoft::WRL::ComPtr<ID3D12Resource> m_Resource{};
         // 资源当前的状态
         D3D12_RESOURCE_STATES m_UsageState{};
+        // 各子资源状态不同时记录每个子资源的状态
+        std::vector<D3D12_RESOURCE_STATES> m_SubresourceStates{};
 
         // 该资源的创建者
         GpuResourceAllocator* m_Allocator{};
+        GpuAllocation m_Allocation{};
+        RelocateCallback m_RelocateCallback{};
     };
 
 
@@ -1,8 +1,45 @@
 #include "GpuResourceAllocator.h"
 #include "../RenderContext.h"
+#include "../CommandList/CommandList.h"
 #include "../../Utilities/FormatUtil.h"
+#include "../../Math/MathCommon.h"
 
 namespace DSM {
+    // 依次等待各个队列的栅栏，全部完成后执行回调
+    static void ReleaseAfterFences(
+        std::array<std::uint64_t, 3> fenceValues,
+        DeferredReleaseQueue::ReleaseCallback callback,
+        std::uint64_t size)
+    {
+        auto pending = std::ranges::find_if(fenceValues, [](std::uint64_t fenceValue) {
+            return !g_RenderContext.IsFenceComplete(fenceValue);
+        });
+        if (pending == fenceValues.end()) {
+            callback();
+            return;
+        }
+        g_RenderContext.GetDeferredReleaseQueue().Release(*pending,
+            [fenceValues, callback = std::move(callback), size]() mutable {
+                ReleaseAfterFences(fenceValues, std::move(callback), size);
+            }, size);
+    }
+
+    // 在图形、计算及复制队列上发出栅栏，覆盖此前提交的所有命令
+    static std::array<std::uint64_t, 3> SignalAllQueues()
+    {
+        return {
+            g_RenderContext.GetGraphicsQueue().IncrementFence(),
+            g_RenderContext.GetComputeQueue().IncrementFence(),
+            g_RenderContext.GetCopyQueue().IncrementFence() };
+    }
+
+    // 此前提交到图形、计算及复制队列的命令全部完成后执行回调
+    static void ReleaseAfterAllQueues(DeferredReleaseQueue::ReleaseCallback callback, std::uint64_t size)
+    {
+        ReleaseAfterFences(SignalAllQueues(), std::move(callback), size);
+    }
+
+
     //
     // GpuResourcePage Implementation
     //
@@ -11,28 +48,47 @@ namespace DSM {
         D3D12_RESOURCE_STATES resourceState,
         const D3D12_CLEAR_VALUE* clearValue,
         std::uint64_t resourceSize,
-        std::uint32_t alignment)
+        std::uint64_t alignment,
+        TLSFAllocator::Allocation& allocation)
     {
-        auto offset = m_Allocator.Allocate(resourceSize, alignment);
+        allocation = m_Allocator.Allocate(resourceSize, alignment);
         ID3D12Resource* resource = nullptr;
-        if (offset != Utility::INVALID_ALLOC_OFFSET) {
+        if (allocation.IsValid()) {
             ASSERT_SUCCEEDED(g_RenderContext.GetDevice()->CreatePlacedResource(
-                m_Heap.Get(), offset, &resourceDesc,
+                m_Heap.Get(), allocation.m_Offset, &resourceDesc,
                 resourceState, clearValue, IID_PPV_ARGS(&resource)));
-            m_SubResources.insert(resource);
+
+            if (allocation.m_Block >= m_Records.size()) {
+                m_Records.resize(allocation.m_Block + 1);
+            }
+            m_Records[allocation.m_Block] = {nullptr, 0, true};
         }
         return resource;
     }
 
-    bool GpuResourcePage::ReleaseResource(ID3D12Resource* resource)
+    GpuResourcePageStats GpuResourcePage::GetStats() const noexcept
     {
-        if (m_SubResources.contains(resource)) {
-            m_SubResources.erase(resource);
-            return true;
-        }
-        else{
-            return false;
-        }
+        GpuResourcePageStats stats{};
+        stats.m_SizeClass = m_SizeClass;
+        stats.m_HeapSize = m_Allocator.MaxSize();
+        stats.m_UsedSize = m_Allocator.UsedSize();
+        stats.m_LargestFreeBlock = m_Allocator.LargestFreeBlock();
+        stats.m_ResourceCount = static_cast<std::uint32_t>(m_Allocator.AllocationCount());
+        stats.m_Fragmentation = m_Allocator.Fragmentation();
+        return stats;
+    }
+
+
+
+
+    //
+    // TransientResourceHeap Implementation
+    //
+    void TransientResourceHeap::Reset() noexcept
+    {
+        m_Heap = nullptr;
+        m_Placements.clear();
+        m_Stats = {};
     }
 
 
@@ -41,42 +97,63 @@ namespace DSM {
     //
     // GpuResourceAllocator Implementation
     //
-    void GpuResourceAllocator::Create(DSMHeapDesc heapDesc, std::uint64_t heapSize) noexcept
+    void GpuResourceAllocator::Create(DSMHeapDesc heapDesc, const GpuResourcePoolDesc& poolDesc) noexcept
     {
-        std::lock_guard lock{m_Mutex};
+        ASSERT(poolDesc.m_SmallResourceMaxSize <= poolDesc.m_MediumResourceMaxSize);
+        ASSERT(poolDesc.m_MediumResourceMaxSize <= poolDesc.m_HeapSizes[static_cast<std::size_t>(GpuResourceSizeClass::Medium)]);
+        ASSERT(poolDesc.m_HeapSizes[static_cast<std::size_t>(GpuResourceSizeClass::MSAA)] % D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT == 0);
         
         m_HeapDesc = heapDesc;
-        m_HeapSize = heapSize;
-        auto newHeap = CreateNewHeap();
-        auto newPage = std::make_unique<GpuResourcePage>(newHeap);
-        m_CurrPage = newPage.get();
-        m_PagePool.emplace_back(std::move(newPage));
+        m_PoolDesc = poolDesc;
+        // 堆在第一次分配时按需创建
+        for (std::size_t i = 0; i < m_Pools.size(); ++i) {
+            std::lock_guard lock{m_Pools[i].m_Mutex};
+            m_Pools[i].m_HeapSize = poolDesc.m_HeapSizes[i];
+        }
     }
 
     void GpuResourceAllocator::ShutDown()
     {
-        std::lock_guard lock{m_Mutex};
-        
-        while (!m_AvailablePages.empty()) {
-            m_AvailablePages.pop();
+        for (auto& pool : m_Pools) {
+            std::lock_guard lock{pool.m_Mutex};
+            pool.m_AvailablePages = {};
+            pool.m_CurrPage = GpuAllocation::INVALID_INDEX;
+            pool.m_EvacuatingPage = GpuAllocation::INVALID_INDEX;
+            pool.m_PendingMoves.clear();
+            pool.m_FreePageSlots.clear();
+            pool.m_Pages.clear();
+            pool.m_Stats = {};
         }
-        m_FullPages.clear();
-        m_ResourceMappings.clear();
-        m_CurrPage = nullptr;
-        m_PagePool.clear();
     }
 
     ID3D12Resource* GpuResourceAllocator::CreateResource(
         const D3D12_RESOURCE_DESC& resourceDesc,
         D3D12_RESOURCE_STATES resourceState,
-            const D3D12_CLEAR_VALUE* clearValue)
+        const D3D12_CLEAR_VALUE* clearValue,
+        GpuAllocation& allocation,
+        GpuResource* owner)
     {
-        auto allocInfo = g_RenderContext.GetDevice()->GetResourceAllocationInfo(0, 1, &resourceDesc);
+        auto placedDesc = resourceDesc;
+        bool smallAligned = false;
+        auto allocInfo = GetAllocationInfo(placedDesc, smallAligned);
+        auto dataSize = GetResourceDataSize(resourceDesc);
         
-        std::lock_guard lock{m_Mutex};
+        allocation = {};
+        allocation.m_Size = allocInfo.SizeInBytes;
+        allocation.m_SizeClass = GetSizeClass(allocInfo);
+        allocation.m_SmallAligned = smallAligned;
+        allocation.m_PaddingSize = static_cast<std::uint32_t>(
+            allocInfo.SizeInBytes > dataSize ? allocInfo.SizeInBytes - dataSize : 0);
+        // 小资源对齐时默认对齐下的大小向上对齐到 64KB
+        allocation.m_SavedSize = smallAligned ? static_cast<std::uint32_t>(
+            Math::AlignUp(allocInfo.SizeInBytes, placedDesc.SampleDesc.Count > 1 ?
+                D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) - allocInfo.SizeInBytes) : 0;
         
+        auto& pool = GetPool(allocation.m_SizeClass);
+        std::lock_guard lock{pool.m_Mutex};
+
         ID3D12Resource* resource = nullptr;
-        if (allocInfo.SizeInBytes > m_HeapSize) {    // 过大或过小的资源不创建堆
+        if (allocInfo.SizeInBytes > pool.m_HeapSize) {    // 过大的资源不创建堆
             D3D12_HEAP_PROPERTIES prop = {};
             prop.Type = m_HeapDesc.m_HeapType;
             prop.CreationNodeMask = 1;
@@ -88,61 +165,612 @@ namespace DSM {
                 resourceState,
                 clearValue,
                 IID_PPV_ARGS(&resource)));
+            ++pool.m_Stats.m_NumCommittedResources;
+            pool.m_Stats.m_CommittedBytes += allocation.m_Size;
         }
         else {
-            resource = m_CurrPage->Allocate(resourceDesc, resourceState, clearValue, 
-                allocInfo.SizeInBytes, allocInfo.Alignment);
-            if (resource == nullptr) {
-                m_FullPages.insert(m_CurrPage);
-                m_CurrPage = RequestPage();
-                resource = m_CurrPage->Allocate(resourceDesc, resourceState, clearValue, 
-                    allocInfo.SizeInBytes, allocInfo.Alignment);
+            resource = AllocatePlaced(pool, placedDesc, resourceState, clearValue, allocInfo, allocation, true);
+            pool.m_Pages[allocation.m_PageIndex]->GetRecord(allocation.m_Block).m_Owner = owner;
+        }
+
+        auto& stats = pool.m_Stats;
+        ++stats.m_NumResources;
+        stats.m_AllocatedBytes += allocation.m_Size;
+        stats.m_PaddingBytes += allocation.m_PaddingSize;
+        stats.m_SmallAlignmentSavedBytes += allocation.m_SavedSize;
+        stats.m_NumSmallAlignedResources += allocation.m_SmallAligned ? 1 : 0;
+        ++stats.m_NumAllocations;
+        stats.m_PeakReservedBytes = std::max(stats.m_PeakReservedBytes, stats.m_HeapBytes + stats.m_CommittedBytes);
+        stats.m_PeakAllocatedBytes = std::max(stats.m_PeakAllocatedBytes, stats.m_AllocatedBytes);
+
+        return resource;
+    }
+
+    void GpuResourceAllocator::ReleaseResource(const GpuAllocation& allocation)
+    {
+        ASSERT(allocation.IsValid());
+        
+        auto& pool = GetPool(allocation.m_SizeClass);
+        std::lock_guard lock{pool.m_Mutex};
+
+        auto& stats = pool.m_Stats;
+        --stats.m_NumResources;
+        stats.m_AllocatedBytes -= allocation.m_Size;
+        stats.m_PaddingBytes -= allocation.m_PaddingSize;
+        stats.m_SmallAlignmentSavedBytes -= allocation.m_SavedSize;
+        stats.m_NumSmallAlignedResources -= allocation.m_SmallAligned ? 1 : 0;
+
+        if (!allocation.IsPlaced()) {
+            --stats.m_NumCommittedResources;
+            stats.m_CommittedBytes -= allocation.m_Size;
+            return;
+        }
+        
+        ASSERT(allocation.m_PageIndex < pool.m_Pages.size());
+        auto& page = pool.m_Pages[allocation.m_PageIndex];
+        // 正在迁移的资源由迁移完成时释放新的位置
+        if (auto moveID = page->GetRecord(allocation.m_Block).m_MoveID; moveID != 0) {
+            if (auto move = pool.m_PendingMoves.find(moveID); move != pool.m_PendingMoves.end()) {
+                move->second.m_Cancelled = true;
             }
+        }
+        page->Free(allocation.m_Block);
 
-            // 只对在堆中分配的资源进行映射
-            m_ResourceMappings.insert(std::make_pair(resource, m_CurrPage));
+        // 释放后的空间会与相邻的空闲块合并，已满的页可以重新参与分配
+        if (page->m_IsFull && !page->m_IsEvacuating) {
+            page->m_IsFull = false;
+            pool.m_AvailablePages.push(allocation.m_PageIndex);
         }
+    }
 
-        return resource;
+    void GpuResourceAllocator::UpdateOwner(const GpuAllocation& allocation, GpuResource* owner)
+    {
+        if (!allocation.IsPlaced()) return;
+
+        auto& pool = GetPool(allocation.m_SizeClass);
+        std::lock_guard lock{pool.m_Mutex};
+        pool.m_Pages[allocation.m_PageIndex]->GetRecord(allocation.m_Block).m_Owner = owner;
     }
 
-    void GpuResourceAllocator::ReleaseResource(ID3D12Resource* resource)
+    std::uint64_t GpuResourceAllocator::Defragment(std::uint64_t maxMoveBytes)
     {
-        ASSERT(resource != nullptr);
+        // 上传及回读堆的资源会被 CPU 映射，不能迁移
+        if (m_HeapDesc.m_HeapType != D3D12_HEAP_TYPE_DEFAULT || maxMoveBytes == 0) return 0;
+
+        struct CopyRequest
+        {
+            ID3D12Resource* m_Src;
+            ID3D12Resource* m_Dest;
+            GpuResourceSizeClass m_SizeClass;
+            std::uint64_t m_MoveID;
+            std::uint64_t m_Size;
+            // 旧资源当前的状态，子资源状态为空时整个资源处于 m_UsageState
+            D3D12_RESOURCE_STATES m_UsageState;
+            std::vector<D3D12_RESOURCE_STATES> m_SubresourceStates;
+        };
+        std::vector<CopyRequest> copyRequests{};
+        std::uint64_t movedBytes = 0;
+
+        for (std::size_t i = 0; i < m_Pools.size() && movedBytes < maxMoveBytes; ++i) {
+            auto sizeClass = static_cast<GpuResourceSizeClass>(i);
+            auto& pool = m_Pools[i];
+            std::lock_guard lock{pool.m_Mutex};
+
+            ReleaseEmptyPages(pool);
+
+            if (pool.m_EvacuatingPage == GpuAllocation::INVALID_INDEX) {
+                pool.m_EvacuatingPage = SelectSparsePage(pool);
+                if (pool.m_EvacuatingPage == GpuAllocation::INVALID_INDEX) continue;
+
+                pool.m_Pages[pool.m_EvacuatingPage]->m_IsEvacuating = true;
+                if (pool.m_CurrPage == pool.m_EvacuatingPage) {
+                    pool.m_CurrPage = GpuAllocation::INVALID_INDEX;
+                }
+            }
+
+            auto& page = pool.m_Pages[pool.m_EvacuatingPage];
+            for (TLSFAllocator::BlockHandle block = 0; block < page->m_Records.size(); ++block) {
+                if (movedBytes >= maxMoveBytes) break;
+                // 迁移只会在其他页上分配，不会使记录数组扩容
+                auto& record = page->m_Records[block];
+                if (!record.m_IsAllocated || record.m_MoveID != 0 || record.m_Owner == nullptr) continue;
+
+                auto owner = record.m_Owner;
+                auto resourceDesc = owner->m_Resource->GetDesc();
+                auto allocInfo = g_RenderContext.GetDevice()->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+                // 其他页放不下时留到之后再迁移，不为此新建堆
+                ResourceMove move{};
+                move.m_NewAllocation = owner->m_Allocation;
+                move.m_NewResource.Attach(AllocatePlaced(pool, resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST,
+                    nullptr, allocInfo, move.m_NewAllocation, false));
+                if (move.m_NewResource == nullptr) break;
+
+                move.m_OldResource = owner->m_Resource;
+                move.m_OldAllocation = owner->m_Allocation;
+                auto moveID = m_NextMoveID.fetch_add(1, std::memory_order_relaxed);
+                record.m_MoveID = moveID;
+                pool.m_Pages[move.m_NewAllocation.m_PageIndex]->GetRecord(move.m_NewAllocation.m_Block).m_MoveID = moveID;
+                ++page->m_NumPendingMoves;
+                ++pool.m_Pages[move.m_NewAllocation.m_PageIndex]->m_NumPendingMoves;
+
+                auto& request = copyRequests.emplace_back(CopyRequest{move.m_OldResource.Get(), move.m_NewResource.Get(),
+                    sizeClass, moveID, allocInfo.SizeInBytes});
+                {
+                    // 解锁后持有者可能被移动或销毁，在此读取旧资源的状态，之后只通过资源指针访问
+                    std::lock_guard stateLock{ResourceStateTracker::GetGlobalMutex()};
+                    request.m_UsageState = owner->m_UsageState;
+                    request.m_SubresourceStates = owner->m_SubresourceStates;
+                }
+                pool.m_PendingMoves.emplace(moveID, std::move(move));
+                movedBytes += allocInfo.SizeInBytes;
+            }
+        }
+
+        if (copyRequests.empty()) return 0;
+
+        // 迁移中的资源由 m_PendingMoves 持有，持有者释放资源后仍可以安全地复制
+        // 可迁移的资源上传后只读，状态不再变化，复制前后按记录的状态转换，使全局状态保持不变
+        std::vector<D3D12_RESOURCE_BARRIER> srcBarriers{};
+        auto addSrcBarrier = [&srcBarriers](ID3D12Resource* resource, std::uint32_t subresource,
+            D3D12_RESOURCE_STATES state) {
+            if ((state & D3D12_RESOURCE_STATE_COPY_SOURCE) != 0) return;
+            auto& barrier = srcBarriers.emplace_back();
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Transition.pResource = resource;
+            barrier.Transition.Subresource = subresource;
+            barrier.Transition.StateBefore = state;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+        };
+        for (const auto& request : copyRequests) {
+            if (request.m_SubresourceStates.empty()) {
+                addSrcBarrier(request.m_Src, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, request.m_UsageState);
+                continue;
+            }
+            for (std::uint32_t i = 0; i < request.m_SubresourceStates.size(); ++i) {
+                addSrcBarrier(request.m_Src, i, request.m_SubresourceStates[i]);
+            }
+        }
+
+        CommandList cmdList{L"GpuResourceAllocator Defragment"};
+        auto d3dCmdList = cmdList.GetCommandList();
+        if (!srcBarriers.empty()) {
+            d3dCmdList->ResourceBarrier(static_cast<UINT>(srcBarriers.size()), srcBarriers.data());
+        }
+
+        // 新资源在切换前不会被其他命令使用，直接转换到 COMMON，切换时再写入全局状态
+        std::vector<D3D12_RESOURCE_BARRIER> barriers{};
+        for (const auto& request : copyRequests) {
+            d3dCmdList->CopyResource(request.m_Dest, request.m_Src);
+
+            auto& barrier = barriers.emplace_back();
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Transition.pResource = request.m_Dest;
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
+        }
+        for (auto barrier : srcBarriers) {
+            std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+            barriers.push_back(barrier);
+        }
+        d3dCmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        auto fenceValue = cmdList.ExecuteCommandList();
+
+        // 之前提交的帧仍可能通过描述符访问旧的资源，复制完成后还需等待这些帧结束才能切换
+        auto& releaseQueue = g_RenderContext.GetDeferredReleaseQueue();
+        for (const auto& request : copyRequests) {
+            releaseQueue.Release(fenceValue, [this, sizeClass = request.m_SizeClass, moveID = request.m_MoveID, size = request.m_Size]() {
+                ReleaseAfterAllQueues([this, sizeClass, moveID]() {
+                    CompleteMove(sizeClass, moveID);
+                }, size);
+            }, request.m_Size);
+        }
+
+        return movedBytes;
+    }
+
+    void GpuResourceAllocator::CreateTransientResources(
+        std::span<const TransientResourceDesc> resourceDescs,
+        TransientResourceHeap& transientHeap,
+        std::span<ID3D12Resource*> resources)
+    {
+        ASSERT(resources.size() >= resourceDescs.size());
+
+        using Placement = TransientResourceHeap::Placement;
+        auto numResources = static_cast<std::uint32_t>(resourceDescs.size());
+        std::vector<D3D12_RESOURCE_DESC> placedDescs(numResources);
+        std::vector<std::uint64_t> alignments(numResources);
+        std::vector<Placement> placements(numResources);
+        std::uint64_t heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+        transientHeap.Reset();
+        auto& stats = transientHeap.m_Stats;
+        for (std::uint32_t i = 0; i < numResources; ++i) {
+            const auto& resourceDesc = resourceDescs[i];
+            ASSERT(resourceDesc.m_FirstUse <= resourceDesc.m_LastUse);
+
+            bool smallAligned = false;
+            placedDescs[i] = resourceDesc.m_Desc;
+            auto allocInfo = GetAllocationInfo(placedDescs[i], smallAligned);
+            alignments[i] = allocInfo.Alignment;
+            heapAlignment = std::max<std::uint64_t>(heapAlignment, allocInfo.Alignment);
+
+            auto& placement = placements[i];
+            placement.m_Size = allocInfo.SizeInBytes;
+            placement.m_FirstUse = resourceDesc.m_FirstUse;
+            placement.m_LastUse = resourceDesc.m_LastUse;
+            stats.m_UnaliasedBytes += Math::AlignUp(allocInfo.SizeInBytes, allocInfo.Alignment);
+        }
+
+        // 大的资源优先放置，每个资源放在与其生命周期重叠的资源之间最低的空隙中
+        std::vector<std::uint32_t> order(numResources);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&placements](std::uint32_t lhs, std::uint32_t rhs) {
+            return placements[lhs].m_Size != placements[rhs].m_Size ?
+                placements[lhs].m_Size > placements[rhs].m_Size : lhs < rhs;
+        });
+
+        auto lifetimeOverlaps = [](const Placement& lhs, const Placement& rhs) {
+            return lhs.m_FirstUse <= rhs.m_LastUse && rhs.m_FirstUse <= lhs.m_LastUse;
+        };
+        auto memoryOverlaps = [](const Placement& lhs, const Placement& rhs) {
+            return lhs.m_Offset < rhs.m_Offset + rhs.m_Size && rhs.m_Offset < lhs.m_Offset + lhs.m_Size;
+        };
+
+        std::uint64_t heapSize = 0;
+        std::vector<const Placement*> liveBlocks{};
+        for (std::uint32_t n = 0; n < numResources; ++n) {
+            auto index = order[n];
+            auto& placement = placements[index];
+
+            liveBlocks.clear();
+            for (std::uint32_t m = 0; m < n; ++m) {
+                if (lifetimeOverlaps(placement, placements[order[m]])) {
+                    liveBlocks.push_back(&placements[order[m]]);
+                }
+            }
+            std::sort(liveBlocks.begin(), liveBlocks.end(), [](const Placement* lhs, const Placement* rhs) {
+                return lhs->m_Offset < rhs->m_Offset;
+            });
+
+            std::uint64_t offset = 0;
+            for (auto block : liveBlocks) {
+                if (Math::AlignUp(offset, alignments[index]) + placement.m_Size <= block->m_Offset) {
+                    break;
+                }
+                offset = std::max(offset, block->m_Offset + block->m_Size);
+            }
+            placement.m_Offset = Math::AlignUp(offset, alignments[index]);
+            heapSize = std::max(heapSize, placement.m_Offset + placement.m_Size);
+        }
+
+        // 资源每帧都会重复使用，因此只要内存重叠就需要在首次使用前插入别名屏障
+        for (std::uint32_t i = 0; i < numResources; ++i) {
+            std::uint32_t numAliased = 0;
+            for (std::uint32_t j = 0; j < numResources; ++j) {
+                if (i != j && memoryOverlaps(placements[i], placements[j])) {
+                    ASSERT(!lifetimeOverlaps(placements[i], placements[j]));
+                    placements[i].m_AliasedIndex = j;
+                    ++numAliased;
+                }
+            }
+            placements[i].m_IsAliased = numAliased > 0;
+            if (numAliased > 1) {
+                placements[i].m_AliasedIndex = TransientResourceHeap::INVALID_INDEX;
+            }
+            stats.m_NumAliasedResources += placements[i].m_IsAliased ? 1 : 0;
+        }
+
+        if (numResources == 0) return;
+
+        heapSize = Math::AlignUp(heapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+        transientHeap.m_Heap.Attach(CreateNewHeap(heapSize, heapAlignment));
+        for (std::uint32_t i = 0; i < numResources; ++i) {
+            const auto& resourceDesc = resourceDescs[i];
+            resources[i] = nullptr;
+            ASSERT_SUCCEEDED(g_RenderContext.GetDevice()->CreatePlacedResource(
+                transientHeap.m_Heap.Get(),
+                placements[i].m_Offset,
+                &placedDescs[i],
+                resourceDesc.m_State,
+                resourceDesc.m_HasClearValue ? &resourceDesc.m_ClearValue : nullptr,
+                IID_PPV_ARGS(&resources[i])));
+        }
+
+        stats.m_HeapBytes = heapSize;
+        stats.m_NumResources = numResources;
+        transientHeap.m_Placements = std::move(placements);
+    }
+
+    std::vector<GpuResourcePageStats> GpuResourceAllocator::GetPageStats()
+    {
+        std::vector<GpuResourcePageStats> pageStats{};
+        for (auto& pool : m_Pools) {
+            std::lock_guard lock{pool.m_Mutex};
+            for (const auto& page : pool.m_Pages) {
+                if (page != nullptr) {
+                    pageStats.emplace_back(page->GetStats());
+                }
+            }
+        }
+        return pageStats;
+    }
+
+    GpuResourceClassStats GpuResourceAllocator::GetClassStats(GpuResourceSizeClass sizeClass)
+    {
+        auto& pool = GetPool(sizeClass);
+        std::lock_guard lock{pool.m_Mutex};
+        return pool.m_Stats;
+    }
+
+    GpuResourceSizeClass GpuResourceAllocator::GetSizeClass(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo) const noexcept
+    {
+        // 默认对齐的堆无法放置 4MB 对齐的资源
+        auto resourceSize = allocInfo.SizeInBytes;
+        if (allocInfo.Alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) {
+            return GpuResourceSizeClass::MSAA;
+        }
+        else if (resourceSize <= m_PoolDesc.m_SmallResourceMaxSize) {
+            return GpuResourceSizeClass::Small;
+        }
+        else if (resourceSize <= m_PoolDesc.m_MediumResourceMaxSize) {
+            return GpuResourceSizeClass::Medium;
+        }
+        else {
+            return GpuResourceSizeClass::Large;
+        }
+    }
+
+    D3D12_RESOURCE_ALLOCATION_INFO GpuResourceAllocator::GetAllocationInfo(
+        D3D12_RESOURCE_DESC& resourceDesc,
+        bool& smallAligned) const
+    {
+        auto device = g_RenderContext.GetDevice();
+        smallAligned = false;
         
-        std::lock_guard lock{m_Mutex};
+        // 缓冲区及渲染目标不能使用小资源对齐
+        bool canSmallAlign = m_PoolDesc.m_UseSmallResourceAlignment &&
+            resourceDesc.Alignment == 0 &&
+            resourceDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER &&
+            (resourceDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0;
+        if (canSmallAlign) {
+            resourceDesc.Alignment = resourceDesc.SampleDesc.Count > 1 ?
+                D3D12_SMALL_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+            auto allocInfo = device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+            // 资源过大时驱动会返回默认对齐，此时需要重新查询
+            if (allocInfo.SizeInBytes != UINT64_MAX && allocInfo.Alignment == resourceDesc.Alignment) {
+                smallAligned = true;
+                return allocInfo;
+            }
+            resourceDesc.Alignment = 0;
+        }
+        
+        return device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+    }
 
-        if (m_CurrPage != nullptr && !m_CurrPage->ReleaseResource(resource) && 
-            m_ResourceMappings.contains(resource)) {
-            auto it = m_FullPages.find(m_ResourceMappings[resource]);
-            ASSERT((*it)->ReleaseResource(resource));
-            if ((*it)->Empty()) {
-                (*it)->Reset();
-                m_AvailablePages.push(*it);
-                m_FullPages.erase(it);
+    std::uint64_t GpuResourceAllocator::GetResourceDataSize(const D3D12_RESOURCE_DESC& resourceDesc) const
+    {
+        if (resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+            return resourceDesc.Width;
+        }
+        
+        // 以各子资源紧密排列时的大小作为纹理数据的大小
+        std::uint32_t mipLevels = resourceDesc.MipLevels;
+        if (mipLevels == 0) {
+            auto maxExtent = std::max<std::uint64_t>(resourceDesc.Width, resourceDesc.Height);
+            mipLevels = static_cast<std::uint32_t>(std::bit_width(maxExtent));
+        }
+        std::uint32_t numSubresources = mipLevels *
+            (resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : resourceDesc.DepthOrArraySize);
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
+        std::vector<UINT> numRows(numSubresources);
+        std::vector<UINT64> rowSizes(numSubresources);
+        g_RenderContext.GetDevice()->GetCopyableFootprints(
+            &resourceDesc, 0, numSubresources, 0, layouts.data(), numRows.data(), rowSizes.data(), nullptr);
+
+        std::uint64_t dataSize = 0;
+        for (std::uint32_t i = 0; i < numSubresources; ++i) {
+            dataSize += rowSizes[i] * numRows[i] * layouts[i].Footprint.Depth;
+        }
+        return dataSize * std::max(1u, resourceDesc.SampleDesc.Count);
+    }
+
+    std::uint32_t GpuResourceAllocator::RequestPage(ResourcePool& pool, GpuResourceSizeClass sizeClass)
+    {
+        // 队列中可能残留已释放或正在整理的页
+        while (!pool.m_AvailablePages.empty()) {
+            auto pageIndex = pool.m_AvailablePages.front();
+            pool.m_AvailablePages.pop();
+            const auto& page = pool.m_Pages[pageIndex];
+            if (page != nullptr && !page->m_IsEvacuating) {
+                return pageIndex;
             }
-            m_ResourceMappings.erase(resource);
         }
+
+        auto heapAlignment = sizeClass == GpuResourceSizeClass::MSAA ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : 0;
+        auto newPage = std::make_unique<GpuResourcePage>(CreateNewHeap(pool.m_HeapSize, heapAlignment), sizeClass);
+        std::uint32_t pageIndex = GpuAllocation::INVALID_INDEX;
+        if (pool.m_FreePageSlots.empty()) {
+            pageIndex = static_cast<std::uint32_t>(pool.m_Pages.size());
+            pool.m_Pages.emplace_back(std::move(newPage));
+        }
+        else {
+            pageIndex = pool.m_FreePageSlots.back();
+            pool.m_FreePageSlots.pop_back();
+            pool.m_Pages[pageIndex] = std::move(newPage);
+        }
+        ++pool.m_Stats.m_NumHeaps;
+        pool.m_Stats.m_HeapBytes += pool.m_HeapSize;
+        
+        return pageIndex;
     }
 
-    GpuResourcePage* GpuResourceAllocator::RequestPage()
+    ID3D12Resource* GpuResourceAllocator::AllocatePlaced(
+        ResourcePool& pool,
+        const D3D12_RESOURCE_DESC& resourceDesc,
+        D3D12_RESOURCE_STATES resourceState,
+        const D3D12_CLEAR_VALUE* clearValue,
+        const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo,
+        GpuAllocation& allocation,
+        bool allowNewPage)
     {
-        GpuResourcePage* page = nullptr;
-        // 清除已经完成的资源
-        if (m_AvailablePages.empty()) {
-            auto newHeap = CreateNewHeap();
-            page = new GpuResourcePage{newHeap};
-            m_PagePool.emplace_back(page);
+        ID3D12Resource* resource = nullptr;
+        TLSFAllocator::Allocation block{};
+        std::uint32_t pageIndex = GpuAllocation::INVALID_INDEX;
+        if (allowNewPage) {
+            if (pool.m_CurrPage == GpuAllocation::INVALID_INDEX) {
+                pool.m_CurrPage = RequestPage(pool, allocation.m_SizeClass);
+            }
+            resource = pool.m_Pages[pool.m_CurrPage]->Allocate(resourceDesc, resourceState, clearValue, 
+                allocInfo.SizeInBytes, allocInfo.Alignment, block);
+            // 依次尝试有空闲空间的页，都放不下时创建新的堆
+            while (resource == nullptr) {
+                pool.m_Pages[pool.m_CurrPage]->m_IsFull = true;
+                pool.m_CurrPage = RequestPage(pool, allocation.m_SizeClass);
+                resource = pool.m_Pages[pool.m_CurrPage]->Allocate(resourceDesc, resourceState, clearValue, 
+                    allocInfo.SizeInBytes, allocInfo.Alignment, block);
+            }
+            pageIndex = pool.m_CurrPage;
         }
         else {
-            page = m_AvailablePages.front();
-            m_AvailablePages.pop();
+            // 只在现有的页中查找，不改变页的可用状态以免影响正常的分配
+            for (std::uint32_t i = 0; i < pool.m_Pages.size() && resource == nullptr; ++i) {
+                const auto& page = pool.m_Pages[i];
+                if (page == nullptr || page->m_IsEvacuating || page->m_Allocator.FreeSize() < allocInfo.SizeInBytes) continue;
+                
+                resource = page->Allocate(resourceDesc, resourceState, clearValue,
+                    allocInfo.SizeInBytes, allocInfo.Alignment, block);
+                pageIndex = i;
+            }
+            if (resource == nullptr) return nullptr;
         }
         
-        return page;
+        allocation.m_PageIndex = pageIndex;
+        allocation.m_Block = block.m_Block;
+        allocation.m_Offset = block.m_Offset;
+        return resource;
+    }
+
+    std::uint32_t GpuResourceAllocator::SelectSparsePage(const ResourcePool& pool) const noexcept
+    {
+        std::uint64_t totalFreeSize = 0;
+        for (const auto& page : pool.m_Pages) {
+            totalFreeSize += page != nullptr ? page->m_Allocator.FreeSize() : 0;
+        }
+
+        std::uint32_t sparsePage = GpuAllocation::INVALID_INDEX;
+        float minUsage = m_PoolDesc.m_DefragUsageThreshold;
+        for (std::uint32_t i = 0; i < pool.m_Pages.size(); ++i) {
+            const auto& page = pool.m_Pages[i];
+            if (page == nullptr || page->Empty() || i == pool.m_CurrPage) continue;
+
+            auto usedSize = page->m_Allocator.UsedSize();
+            auto usage = static_cast<float>(usedSize) / static_cast<float>(page->m_Allocator.MaxSize());
+            // 其余的页需要能容纳该页的资源
+            if (usage >= minUsage || totalFreeSize - page->m_Allocator.FreeSize() < usedSize) continue;
+
+            // 页中的所有资源都可以迁移时才整理
+            bool relocatable = std::ranges::all_of(page->m_Records, [](const auto& record) {
+                return !record.m_IsAllocated || (record.m_Owner != nullptr &&
+                    record.m_Owner->IsRelocatable() &&
+                    record.m_MoveID == 0);
+            });
+            if (relocatable) {
+                sparsePage = i;
+                minUsage = usage;
+            }
+        }
+        return sparsePage;
+    }
+
+    void GpuResourceAllocator::ReleaseEmptyPages(ResourcePool& pool)
+    {
+        for (std::uint32_t i = 0; i < pool.m_Pages.size(); ++i) {
+            auto& page = pool.m_Pages[i];
+            if (page == nullptr || !page->Empty() || page->m_NumPendingMoves > 0 || i == pool.m_CurrPage) continue;
+
+            if (pool.m_EvacuatingPage == i) {
+                pool.m_EvacuatingPage = GpuAllocation::INVALID_INDEX;
+            }
+            auto heapSize = page->m_Allocator.MaxSize();
+            --pool.m_Stats.m_NumHeaps;
+            pool.m_Stats.m_HeapBytes -= heapSize;
+            ++pool.m_Stats.m_NumReleasedHeaps;
+            pool.m_Stats.m_DefragReclaimedBytes += heapSize;
+
+            // 之前提交到任意队列的命令可能仍在访问该堆上的资源
+            ReleaseAfterAllQueues([heap = page->m_Heap]() {}, heapSize);
+            page = nullptr;
+            pool.m_FreePageSlots.push_back(i);
+        }
+    }
+
+    void GpuResourceAllocator::CompleteMove(GpuResourceSizeClass sizeClass, std::uint64_t moveID)
+    {
+        auto& pool = GetPool(sizeClass);
+        std::unique_lock lock{pool.m_Mutex};
+
+        auto it = pool.m_PendingMoves.find(moveID);
+        if (it == pool.m_PendingMoves.end()) return;
+        auto move = std::move(it->second);
+        pool.m_PendingMoves.erase(it);
+
+        auto& oldPage = pool.m_Pages[move.m_OldAllocation.m_PageIndex];
+        auto& newPage = pool.m_Pages[move.m_NewAllocation.m_PageIndex];
+        --newPage->m_NumPendingMoves;
+        if (move.m_Cancelled) {
+            // 旧的位置已由持有者释放
+            --oldPage->m_NumPendingMoves;
+            newPage->Free(move.m_NewAllocation.m_Block);
+            return;
+        }
+
+        // 旧的位置在释放前保留迁移编号，不再参与整理
+        auto& oldRecord = oldPage->GetRecord(move.m_OldAllocation.m_Block);
+        auto owner = oldRecord.m_Owner;
+        oldRecord.m_Owner = nullptr;
+        newPage->GetRecord(move.m_NewAllocation.m_Block) = {owner, 0, true};
+        {
+            // 提交时在全局锁内读取资源及其状态，需一并切换
+            std::lock_guard stateLock{ResourceStateTracker::GetGlobalMutex()};
+            owner->m_Resource = move.m_NewResource;
+            owner->m_UsageState = D3D12_RESOURCE_STATE_COMMON;
+            owner->m_SubresourceStates.clear();
+        }
+        owner->m_Allocation = move.m_NewAllocation;
+        ++pool.m_Stats.m_NumDefragMoves;
+        pool.m_Stats.m_DefragMovedBytes += move.m_NewAllocation.m_Size;
+        if (owner->m_RelocateCallback != nullptr) {
+            owner->m_RelocateCallback(*owner);
+        }
+        // 切换之前提交的命令仍引用旧的资源，栅栏需在切换时发出，而不是复制时
+        auto fenceValues = SignalAllQueues();
+        lock.unlock();
+
+        ReleaseAfterFences(fenceValues, [this, allocation = move.m_OldAllocation, resource = move.m_OldResource]() {
+            FreeMovedBlock(allocation);
+        }, move.m_OldAllocation.m_Size);
+    }
+
+    void GpuResourceAllocator::FreeMovedBlock(const GpuAllocation& allocation)
+    {
+        auto& pool = GetPool(allocation.m_SizeClass);
+        std::lock_guard lock{pool.m_Mutex};
+
+        // 分配器已关闭
+        if (allocation.m_PageIndex >= pool.m_Pages.size()) return;
+
+        auto& page = pool.m_Pages[allocation.m_PageIndex];
+        --page->m_NumPendingMoves;
+        page->Free(allocation.m_Block);
+        if (page->m_IsFull && !page->m_IsEvacuating) {
+            page->m_IsFull = false;
+            pool.m_AvailablePages.push(allocation.m_PageIndex);
+        }
     }
 
-    ID3D12Heap* GpuResourceAllocator::CreateNewHeap(std::uint64_t heapSize)
+    ID3D12Heap* GpuResourceAllocator::CreateNewHeap(std::uint64_t heapSize, std::uint64_t alignment)
     {
         D3D12_HEAP_PROPERTIES heapProperties{};
         heapProperties.Type = m_HeapDesc.m_HeapType;
@@ -152,11 +780,12 @@ namespace DSM {
         D3D12_HEAP_DESC heapDesc{};
         heapDesc.Flags = m_HeapDesc.m_HeapFlags;
         heapDesc.Properties = heapProperties;
-        heapDesc.SizeInBytes = heapSize == 0 ? m_HeapSize : heapSize;
+        heapDesc.SizeInBytes = heapSize;
+        heapDesc.Alignment = alignment;
 
         ID3D12Heap* heap = nullptr;
         ASSERT_SUCCEEDED(g_RenderContext.GetDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
-        auto heapName = L"PlacedResourceAllocator Heap" + std::to_wstring(m_PagePool.size());
+        auto heapName = L"PlacedResourceAllocator Heap" + std::to_wstring(m_NumHeaps++);
         heap->SetName(heapName.c_str());
         
         return heap;
@@ -3,7 +3,9 @@
 #define __GPURESOURCEALLOCATOR_H__
 
 #include "GpuResource.h"
-#include "../../Utilities/LinearAllocator.h"
+#include "../../Utilities/TLSFAllocator.h"
+#include <atomic>
+#include <span>
 
 namespace DSM {
     
@@ -15,13 +17,133 @@ namespace DSM {
     };
 
 
+    struct GpuResourcePoolDesc
+    {
+        // 各等级能容纳的最大资源，超过大资源堆大小的资源使用提交资源
+        std::uint64_t m_SmallResourceMaxSize = 256 * 1024;
+        std::uint64_t m_MediumResourceMaxSize = 8 * 1024 * 1024;
+        // MSAA 池的堆以 4MB 对齐创建，大小需为 4MB 的整数倍
+        std::array<std::uint64_t, static_cast<std::size_t>(GpuResourceSizeClass::Count)> m_HeapSizes{
+            4 * 1024 * 1024, DEFAULT_PLACED_RESOURCE_PAGE_SIZE, 64 * 1024 * 1024, 64 * 1024 * 1024 };
+        // 符合条件的纹理使用 4KB（MSAA 为 64KB）的小资源对齐
+        bool m_UseSmallResourceAlignment = true;
+        // 使用率低于该值的页会被碎片整理，其中的资源迁移到其他页后释放整个堆
+        float m_DefragUsageThreshold = 0.25f;
+    };
+
+    // 各尺寸等级的内存使用情况
+    struct GpuResourceClassStats
+    {
+        std::uint64_t m_HeapBytes{};
+        // 资源实际占用的堆空间
+        std::uint64_t m_AllocatedBytes{};
+        // 对齐及布局导致的浪费，为占用空间与资源数据大小之差
+        std::uint64_t m_PaddingBytes{};
+        // 使用小资源对齐相比默认 64KB 对齐节省的空间
+        std::uint64_t m_SmallAlignmentSavedBytes{};
+        std::uint32_t m_NumHeaps{};
+        std::uint32_t m_NumResources{};
+        std::uint32_t m_NumSmallAlignedResources{};
+        std::uint32_t m_NumCommittedResources{};
+        // 提交资源不占用堆空间，单独统计
+        std::uint64_t m_CommittedBytes{};
+        // 自创建以来的峰值及累计分配次数，预留空间包括堆及提交资源
+        std::uint64_t m_PeakReservedBytes{};
+        std::uint64_t m_PeakAllocatedBytes{};
+        std::uint64_t m_NumAllocations{};
+        // 碎片整理迁移的资源及释放的堆
+        std::uint64_t m_DefragMovedBytes{};
+        std::uint64_t m_DefragReclaimedBytes{};
+        std::uint32_t m_NumDefragMoves{};
+        std::uint32_t m_NumReleasedHeaps{};
+    };
+
+    // 堆的使用情况
+    struct GpuResourcePageStats
+    {
+        GpuResourceSizeClass m_SizeClass{};
+        std::uint64_t m_HeapSize{};
+        std::uint64_t m_UsedSize{};
+        std::uint64_t m_LargestFreeBlock{};
+        std::uint32_t m_ResourceCount{};
+        // 外部碎片率
+        float m_Fragmentation{};
+    };
+
+    // 帧内临时资源的描述，生命周期为 [m_FirstUse, m_LastUse] 之间的 Pass 序号
+    struct TransientResourceDesc
+    {
+        D3D12_RESOURCE_DESC m_Desc{};
+        D3D12_RESOURCE_STATES m_State = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_CLEAR_VALUE m_ClearValue{};
+        bool m_HasClearValue{};
+        std::uint32_t m_FirstUse{};
+        std::uint32_t m_LastUse{};
+    };
+
+    // 临时资源堆的使用情况
+    struct TransientResourceHeapStats
+    {
+        std::uint64_t m_HeapBytes{};
+        // 不进行别名时所有资源占用的空间之和
+        std::uint64_t m_UnaliasedBytes{};
+        std::uint32_t m_NumResources{};
+        // 与其他资源共享内存的资源数量
+        std::uint32_t m_NumAliasedResources{};
+    };
+
+    // 一组共享同一个堆的临时资源，生命周期不重叠的资源会放置在同一块内存上
+    // 只记录内存布局，资源本身由调用者持有
+    class TransientResourceHeap
+    {
+        friend class GpuResourceAllocator;
+    public:
+        inline static constexpr std::uint32_t INVALID_INDEX = (std::numeric_limits<std::uint32_t>::max)();
+
+        TransientResourceHeap() = default;
+        ~TransientResourceHeap() = default;
+        TransientResourceHeap(TransientResourceHeap&&) noexcept = default;
+        TransientResourceHeap& operator=(TransientResourceHeap&&) noexcept = default;
+        DSM_NONCOPYABLE(TransientResourceHeap);
+
+        // 释放堆前需要先销毁其上的资源
+        void Reset() noexcept;
+
+        std::uint32_t GetResourceCount() const noexcept { return static_cast<std::uint32_t>(m_Placements.size()); }
+        std::uint64_t GetOffset(std::uint32_t index) const noexcept { return m_Placements[index].m_Offset; }
+        // 首次使用前是否需要别名屏障
+        bool IsAliased(std::uint32_t index) const noexcept { return m_Placements[index].m_IsAliased; }
+        // 与该资源共享内存的唯一资源，有多个时返回 INVALID_INDEX，此时屏障的前一个资源应为空
+        std::uint32_t GetAliasedIndex(std::uint32_t index) const noexcept { return m_Placements[index].m_AliasedIndex; }
+        const TransientResourceHeapStats& GetStats() const noexcept { return m_Stats; }
+
+    private:
+        struct Placement
+        {
+            std::uint64_t m_Offset{};
+            std::uint64_t m_Size{};
+            std::uint32_t m_FirstUse{};
+            std::uint32_t m_LastUse{};
+            std::uint32_t m_AliasedIndex = INVALID_INDEX;
+            bool m_IsAliased{};
+        };
+
+        Microsoft::WRL::ComPtr<ID3D12Heap> m_Heap{};
+        std::vector<Placement> m_Placements{};
+        TransientResourceHeapStats m_Stats{};
+    };
+
     // 用于管理一个堆的内存分配,不负责管理资源的释放
     class GpuResourcePage
     {
         friend class GpuResourceAllocator;
     public:
-        GpuResourcePage(ID3D12Heap* agentHeap)
-            :m_Heap(agentHeap), m_Allocator(agentHeap->GetDesc().SizeInBytes){}
+        // 接管堆的所有权
+        GpuResourcePage(ID3D12Heap* agentHeap, GpuResourceSizeClass sizeClass)
+            :m_Allocator(agentHeap->GetDesc().SizeInBytes), m_SizeClass(sizeClass)
+        {
+            m_Heap.Attach(agentHeap);
+        }
         ~GpuResourcePage() = default;
         DSM_NONCOPYABLE_NONMOVABLE(GpuResourcePage);
 
@@ -30,25 +152,49 @@ namespace DSM {
             D3D12_RESOURCE_STATES resourceState,
             const D3D12_CLEAR_VALUE* clearValue,
             std::uint64_t resourceSize,
-            std::uint32_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
-        bool ReleaseResource(ID3D12Resource* resource);
-        void Reset() noexcept
+            std::uint64_t alignment,
+            TLSFAllocator::Allocation& allocation);
+        void Free(TLSFAllocator::BlockHandle block) noexcept
         {
-            m_SubResources.clear();
-            m_Allocator.Clear();
+            GetRecord(block) = {};
+            m_Allocator.Free(block);
         }
-        std::size_t GetSubresourcesCount() const noexcept{ return m_SubResources.size(); }
+        std::size_t GetSubresourcesCount() const noexcept{ return m_Allocator.AllocationCount(); }
 
-        bool Full() const noexcept { return m_Allocator.Full(); }
-        bool Empty() const noexcept { return m_SubResources.empty(); }
+        bool Empty() const noexcept { return m_Allocator.AllocationCount() == 0; }
+        GpuResourceSizeClass GetSizeClass() const noexcept { return m_SizeClass; }
+        GpuResourcePageStats GetStats() const noexcept;
         
     private:
+        // 页上资源的持有者，碎片整理时通过它更新资源
+        struct ResourceRecord
+        {
+            GpuResource* m_Owner{};
+            // 正在迁移时为迁移的编号
+            std::uint64_t m_MoveID{};
+            bool m_IsAllocated{};
+        };
+
+        ResourceRecord& GetRecord(TLSFAllocator::BlockHandle block) noexcept
+        {
+            ASSERT(block < m_Records.size() && m_Records[block].m_IsAllocated);
+            return m_Records[block];
+        }
+        
         Microsoft::WRL::ComPtr<ID3D12Heap> m_Heap{};
-        std::set<ID3D12Resource*> m_SubResources{};
-        LinearAllocator m_Allocator;
+        TLSFAllocator m_Allocator;
+        // 以块句柄为下标，句柄由 TLSF 复用，只在块数增长时扩容，分配与释放时无需分配节点
+        std::vector<ResourceRecord> m_Records{};
+        GpuResourceSizeClass m_SizeClass{};
+        // 迁入或迁出该页且尚未结束的迁移数量，不为零时不能释放堆
+        std::uint32_t m_NumPendingMoves{};
+        // 分配失败过的页，有资源释放后会重新变为可用
+        bool m_IsFull{};
+        // 正在被整理的页不再参与分配
+        bool m_IsEvacuating{};
     };
 
-    // 用于管理所有的资源分配
+    // 用于管理一种堆类型的资源分配，各尺寸等级的堆池单独加锁
     class GpuResourceAllocator
     {
     public:
@@ -56,40 +202,111 @@ namespace DSM {
         ~GpuResourceAllocator() { ShutDown(); };
         DSM_NONCOPYABLE(GpuResourceAllocator);
 
-        void Create(DSMHeapDesc heapDesc, std::uint64_t heapSize = DEFAULT_PLACED_RESOURCE_PAGE_SIZE) noexcept;
+        void Create(DSMHeapDesc heapDesc, const GpuResourcePoolDesc& poolDesc = sm_DefaultPoolDesc) noexcept;
         void ShutDown();
 
         ID3D12Resource* CreateResource(
             const D3D12_RESOURCE_DESC& resourceDesc,
             D3D12_RESOURCE_STATES resourceState,
-            const D3D12_CLEAR_VALUE* clearValue = nullptr);
-        void ReleaseResource(ID3D12Resource* resource);
+            const D3D12_CLEAR_VALUE* clearValue,
+            GpuAllocation& allocation,
+            GpuResource* owner = nullptr);
+        void ReleaseResource(const GpuAllocation& allocation);
+        // 资源对象移动后更新分配记录中的持有者
+        void UpdateOwner(const GpuAllocation& allocation, GpuResource* owner);
+
+        // 选择使用率低的页，将其中可迁移的资源通过 GPU 复制搬到其他页，页清空后释放堆
+        // 每次最多迁移 maxMoveBytes 字节，返回本次开始迁移的字节数，需在帧结束时调用
+        std::uint64_t Defragment(std::uint64_t maxMoveBytes);
+
+        // 按生命周期将临时资源打包到一个新建的堆中并创建放置资源
+        // 返回的资源已持有一个引用，其下标与描述一一对应
+        void CreateTransientResources(
+            std::span<const TransientResourceDesc> resourceDescs,
+            TransientResourceHeap& transientHeap,
+            std::span<ID3D12Resource*> resources);
         
-        ID3D12Heap* CreateNewHeap(std::uint64_t heapSize = 0);
+        ID3D12Heap* CreateNewHeap(std::uint64_t heapSize, std::uint64_t alignment = 0);
+
+        // 获取各个堆的使用情况
+        std::vector<GpuResourcePageStats> GetPageStats();
+        GpuResourceClassStats GetClassStats(GpuResourceSizeClass sizeClass);
+        const GpuResourcePoolDesc& GetPoolDesc() const noexcept { return m_PoolDesc; }
+        DSMHeapDesc GetHeapDesc() const noexcept { return m_HeapDesc; }
+
+        // 之后新建的分配器使用的堆池配置
+        static void SetDefaultPoolDesc(const GpuResourcePoolDesc& poolDesc) noexcept { sm_DefaultPoolDesc = poolDesc; }
         
 
     private:
-        GpuResourcePage* RequestPage();
+        // 一次资源迁移，复制完成后切换持有者，之后再释放旧的位置
+        struct ResourceMove
+        {
+            Microsoft::WRL::ComPtr<ID3D12Resource> m_OldResource{};
+            Microsoft::WRL::ComPtr<ID3D12Resource> m_NewResource{};
+            GpuAllocation m_OldAllocation{};
+            GpuAllocation m_NewAllocation{};
+            // 迁移期间持有者释放了资源
+            bool m_Cancelled{};
+        };
+        
+        // 同一尺寸等级的堆
+        struct ResourcePool
+        {
+            std::uint64_t m_HeapSize{};
+            // 页的下标即为分配记录中的页索引
+            std::vector<std::unique_ptr<GpuResourcePage>> m_Pages{};
+            std::uint32_t m_CurrPage = GpuAllocation::INVALID_INDEX;
+            // 有空闲空间可以继续分配的页
+            std::queue<std::uint32_t> m_AvailablePages{};
+            // 堆已释放的页下标，新建堆时复用
+            std::vector<std::uint32_t> m_FreePageSlots{};
+            std::uint32_t m_EvacuatingPage = GpuAllocation::INVALID_INDEX;
+            std::unordered_map<std::uint64_t, ResourceMove> m_PendingMoves{};
+            GpuResourceClassStats m_Stats{};
+            std::mutex m_Mutex{};
+        };
+
+        GpuResourceSizeClass GetSizeClass(const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo) const noexcept;
+        D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(D3D12_RESOURCE_DESC& resourceDesc, bool& smallAligned) const;
+        std::uint64_t GetResourceDataSize(const D3D12_RESOURCE_DESC& resourceDesc) const;
+        std::uint32_t RequestPage(ResourcePool& pool, GpuResourceSizeClass sizeClass);
+        // 在池中的页上放置资源，不允许新建堆时可能失败并返回空
+        ID3D12Resource* AllocatePlaced(
+            ResourcePool& pool,
+            const D3D12_RESOURCE_DESC& resourceDesc,
+            D3D12_RESOURCE_STATES resourceState,
+            const D3D12_CLEAR_VALUE* clearValue,
+            const D3D12_RESOURCE_ALLOCATION_INFO& allocInfo,
+            GpuAllocation& allocation,
+            bool allowNewPage);
+        std::uint32_t SelectSparsePage(const ResourcePool& pool) const noexcept;
+        // 释放已清空的页的堆
+        void ReleaseEmptyPages(ResourcePool& pool);
+        // 复制完成且之前提交到各队列的命令都结束后，将持有者切换到新的资源并更新描述符
+        void CompleteMove(GpuResourceSizeClass sizeClass, std::uint64_t moveID);
+        void FreeMovedBlock(const GpuAllocation& allocation);
+        ResourcePool& GetPool(GpuResourceSizeClass sizeClass) noexcept { return m_Pools[static_cast<std::size_t>(sizeClass)]; }
 
     private:
-        DSMHeapDesc m_HeapDesc{};
+        inline static GpuResourcePoolDesc sm_DefaultPoolDesc{};
         
-        std::vector<std::unique_ptr<GpuResourcePage>> m_PagePool{};
-        
-        GpuResourcePage* m_CurrPage{};
-        std::set<GpuResourcePage*> m_FullPages{};
-        // 建立各个资源与分配者的映射关系，便于快速索引
-        std::map<ID3D12Resource*, GpuResourcePage*> m_ResourceMappings{};
-        // 可重复使用的资源
-        std::queue<GpuResourcePage*> m_AvailablePages{};
-        
-        std::uint64_t m_HeapSize{};
+        DSMHeapDesc m_HeapDesc{};
+        GpuResourcePoolDesc m_PoolDesc{};
         
-        std::mutex m_Mutex{};
+        std::array<ResourcePool, static_cast<std::size_t>(GpuResourceSizeClass::Count)> m_Pools{};
+        std::atomic<std::uint32_t> m_NumHeaps{};
+        std::atomic<std::uint64_t> m_NextMoveID{1};
     };
 
+    // 获取对应堆类型的资源分配器，首次获取时创建
+    GpuResourceAllocator& GetGpuResourceAllocator(DSMHeapDesc heapDesc);
+    // 对所有分配器进行碎片整理，所有分配器共享迁移的字节预算
+    std::uint64_t DefragmentGpuResourceAllocators(std::uint64_t maxMoveBytes);
+    // 获取已创建的所有分配器，用于统计
+    std::vector<GpuResourceAllocator*> GetGpuResourceAllocators();
+
 }
 
 
 #endif
-
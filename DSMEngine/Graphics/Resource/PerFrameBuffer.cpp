@@ -0,0 +1,47 @@
+#include "PerFrameBuffer.h"
+#include "../RenderContext.h"
+
+namespace DSM {
+    void PerFrameBuffer::Create(const std::wstring& name, std::uint64_t size, std::uint32_t stride, const void* initData)
+    {
+        ASSERT(size > 0);
+
+        m_Size = size;
+        m_FrameStride = Math::AlignUp(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+        // 按最大在途帧数分配，运行时可以修改在途帧数
+        GpuBufferDesc bufferDesc{};
+        bufferDesc.m_Size = m_FrameStride * RenderContext::sm_MaxFramesInFlight;
+        bufferDesc.m_Stride = stride;
+        bufferDesc.m_HeapType = D3D12_HEAP_TYPE_UPLOAD;
+        m_Buffer.Create(name, bufferDesc);
+
+        if (initData != nullptr) {
+            for (std::uint32_t i = 0; i < RenderContext::sm_MaxFramesInFlight; ++i) {
+                m_Buffer.Update(initData, size, m_FrameStride * i);
+            }
+        }
+    }
+
+    void PerFrameBuffer::Destroy()
+    {
+        m_Buffer.Destroy();
+        m_Size = m_FrameStride = 0;
+    }
+
+    void PerFrameBuffer::Update(const void* data, std::uint64_t size, std::uint64_t offset)
+    {
+        ASSERT(offset + size <= m_Size);
+        m_Buffer.Update(data, size, GetFrameOffset() + offset);
+    }
+
+    D3D12_GPU_VIRTUAL_ADDRESS PerFrameBuffer::GetGpuVirtualAddress() const
+    {
+        return m_Buffer.GetGpuVirtualAddress() + GetFrameOffset();
+    }
+
+    std::uint64_t PerFrameBuffer::GetFrameOffset() const
+    {
+        return m_FrameStride * g_RenderContext.GetFrameResourceIndex();
+    }
+}
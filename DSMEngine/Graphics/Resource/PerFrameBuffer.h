@@ -0,0 +1,48 @@
+#pragma once
+#ifndef __PERFRAMEBUFFER_H__
+#define __PERFRAMEBUFFER_H__
+
+#include "GpuBuffer.h"
+
+namespace DSM {
+    /// <summary>
+    /// 每个在途帧拥有独立区域的上传堆缓冲区，用于每帧都会更新的常量等数据
+    /// CPU 写入当前帧的区域时 GPU 仍可读取之前帧的区域，无需等待
+    /// </summary>
+    class PerFrameBuffer
+    {
+    public:
+        PerFrameBuffer() = default;
+        ~PerFrameBuffer() = default;
+        DSM_NONCOPYABLE(PerFrameBuffer);
+
+        // initData 会写入所有帧的区域
+        void Create(const std::wstring& name, std::uint64_t size, std::uint32_t stride = 0, const void* initData = nullptr);
+        void Destroy();
+
+        // 写入当前帧的区域
+        void Update(const void* data, std::uint64_t size, std::uint64_t offset = 0);
+        template <typename T>
+        void Update(const T& data) { Update(&data, sizeof(T)); }
+
+        // 每一帧的区域大小
+        std::uint64_t GetSize() const noexcept { return m_Size; }
+        D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const;
+        template <typename T = void>
+        T* GetMappedData() const
+        {
+            return reinterpret_cast<T*>(m_Buffer.GetMappedData<std::uint8_t>() + GetFrameOffset());
+        }
+
+    private:
+        std::uint64_t GetFrameOffset() const;
+
+    private:
+        GpuBuffer m_Buffer{};
+        std::uint64_t m_Size{};
+        // 相邻两帧区域的间隔，按常量缓冲区的要求对齐
+        std::uint64_t m_FrameStride{};
+    };
+}
+
+#endif
@@ -150,8 +150,17 @@ namespace DSM{
                 
                 hash = Utility::HashState(descriptorTable.pDescriptorRanges, descriptorTable.NumDescriptorRanges, hash);
 
-                // 记录当前是何种描述符表
+                // 无边界的描述符表直接指向常驻描述符堆，不由动态描述符堆管理
                 auto& ranges = descriptorTable.pDescriptorRanges;
+                bool unbounded = std::any_of(ranges, ranges + descriptorTable.NumDescriptorRanges, [](const D3D12_DESCRIPTOR_RANGE& range) {
+                    return range.NumDescriptors == UINT_MAX;
+                });
+                if (unbounded) {
+                    m_BindlessTableBitMap |= (1 << i);
+                    continue;
+                }
+                
+                // 记录当前是何种描述符表
                 auto& bitMap = ranges->RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER ? m_SamplerTableBitMap : m_DescriptorTableBitMap;
                 bitMap |= (1 << i);
 
@@ -164,6 +173,10 @@ namespace DSM{
                 hash = Utility::HashState(&param);
             }
         }
+        // 常驻描述符堆与动态描述符堆无法同时绑定，含无边界表的根签名中其余的表也需直接指向常驻描述符堆
+        if (m_BindlessTableBitMap != 0) {
+            m_DescriptorTableBitMap = 0;
+        }
 
         // 需要考虑多线程的情况，当多个线程同时创建根签名时，为了防止重复的序列化根签名和创建根签名，需要阻止后续的线程创建根签名
         bool firstCompile = false;
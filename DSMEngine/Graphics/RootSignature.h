@@ -66,6 +66,7 @@ namespace DSM{
 
         std::uint32_t GetDescriptorTableBitMap() const { return m_DescriptorTableBitMap; }
         std::uint32_t GetSamplerTableBitMap() const { return m_SamplerTableBitMap; }
+        std::uint32_t GetBindlessTableBitMap() const { return m_BindlessTableBitMap; }
         std::uint32_t GetDescriptorTableSize(std::size_t index) const
         {
             ASSERT(index < m_DescriptorTableSize.size());
@@ -105,6 +106,8 @@ namespace DSM{
         std::uint32_t m_DescriptorTableBitMap{};
         // 采样器在根参数中的位置
         std::uint32_t m_SamplerTableBitMap{};
+        // 指向常驻描述符堆的无边界描述符表在根参数中的位置
+        std::uint32_t m_BindlessTableBitMap{};
         std::vector<std::uint32_t> m_DescriptorTableSize{};
     };
     
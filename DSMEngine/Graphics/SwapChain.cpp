@@ -5,6 +5,21 @@ namespace DSM {
     
     SwapChain::SwapChain(const SwapChainDesc& swapChainDesc)
         :m_Width(swapChainDesc.m_Width), m_Height(swapChainDesc.m_Height){
+        for (auto& backBuffer : m_BackBuffers) {
+            backBuffer = std::make_unique<Texture>();
+        }
+
+        for (auto& bufferHanlde : m_BackBufferRTVs) {
+            bufferHanlde = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+        }
+
+        m_BackBufferFormat = swapChainDesc.m_Format;
+        if (swapChainDesc.m_hWnd == nullptr) {
+            m_BackBufferIndex = 0;
+            CreateBackBuffers();
+            return;
+        }
+
         DXGI_SWAP_CHAIN_DESC1 swapChainDesc1{};
         swapChainDesc1.Width = swapChainDesc.m_Width;
         swapChainDesc1.Height = swapChainDesc.m_Height;
@@ -33,15 +48,6 @@ namespace DSM {
         ASSERT_SUCCEEDED(swapChain1->QueryInterface(&m_SwapChain));
 
         m_BackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
-        m_BackBufferFormat = swapChainDesc.m_Format;
-
-        for (auto& backBuffer : m_BackBuffers) {
-            backBuffer = std::make_unique<Texture>();
-        }
-
-        for (auto& bufferHanlde : m_BackBufferRTVs) {
-            bufferHanlde = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-        }
         
         CreateBackBuffers();
     }
@@ -51,11 +57,20 @@ namespace DSM {
         for (auto& bufferHandle : m_BackBufferRTVs) {
             g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, bufferHandle);
         }
-        ASSERT_SUCCEEDED(m_SwapChain->SetFullscreenState(false, nullptr));
+        if (m_SwapChain != nullptr) {
+            ASSERT_SUCCEEDED(m_SwapChain->SetFullscreenState(false, nullptr));
+        }
     }
 
     void SwapChain::Present(std::uint32_t sync)
     {
+        // 排队的命令列表需在呈现前提交
+        g_RenderContext.GetGraphicsQueue().FlushPendingCommandLists();
+        if (IsOffscreen()) {
+            // 离屏时没有需要呈现的窗口，只轮换后台缓冲
+            m_BackBufferIndex = (m_BackBufferIndex + 1) % sm_BackBufferCount;
+            return;
+        }
         ASSERT_SUCCEEDED(m_SwapChain->Present(sync, 0));
         m_BackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
     }
@@ -64,7 +79,6 @@ namespace DSM {
     {
         g_RenderContext.IdleGPU();
         
-        ASSERT(m_SwapChain != nullptr);
         m_Width = std::max<std::uint32_t>(width, 8);
         m_Height = std::max<std::uint32_t>(height, 8);
         m_Height = height;
@@ -73,6 +87,12 @@ namespace DSM {
             buffer->Destroy();
         }
 
+        if (IsOffscreen()) {
+            m_BackBufferIndex = 0;
+            CreateBackBuffers();
+            return;
+        }
+
         ASSERT_SUCCEEDED(m_SwapChain->ResizeBuffers(
             sm_BackBufferCount,
             m_Width, m_Height,
@@ -85,6 +105,22 @@ namespace DSM {
 
     void SwapChain::CreateBackBuffers()
     {
+        if (IsOffscreen()) {
+            TextureDesc texDesc{};
+            texDesc.m_Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            texDesc.m_Width = m_Width;
+            texDesc.m_Height = m_Height;
+            texDesc.m_Format = m_BackBufferFormat;
+            texDesc.m_Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+            D3D12_CLEAR_VALUE clearValue{};
+            clearValue.Format = m_BackBufferFormat;
+            for (std::uint32_t i = 0; i < sm_BackBufferCount; ++i) {
+                m_BackBuffers[i]->Create(L"Offscreen Back Buffer", texDesc, clearValue);
+                m_BackBuffers[i]->CreateRenderTargetView(m_BackBufferRTVs[i]);
+            }
+            return;
+        }
+
         for (std::uint32_t i = 0; i < sm_BackBufferCount; ++i) {
             ID3D12Resource* backBuffer{};
             ASSERT_SUCCEEDED(m_SwapChain->GetBuffer(i, IID_PPV_ARGS(&backBuffer)))
@@ -12,6 +12,7 @@ namespace DSM {
         std::uint32_t m_Width{};
         std::uint32_t m_Height{};
         DXGI_FORMAT m_Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        // 为空时创建离屏的后台缓冲，用于无窗口运行
         HWND m_hWnd = nullptr;
         bool m_FullScreen = false;
     };
@@ -28,6 +29,7 @@ namespace DSM {
         Texture* GetBackBuffer() { return m_BackBuffers[m_BackBufferIndex].get(); }
         std::uint32_t GetWidth() const noexcept { return m_Width; }
         std::uint32_t GetHeight() const noexcept { return m_Height; }
+        bool IsOffscreen() const noexcept { return m_SwapChain == nullptr; }
         
         void Present(std::uint32_t sync = 0);
         void OnResize(std::uint32_t width, std::uint32_t height);
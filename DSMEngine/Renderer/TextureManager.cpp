@@ -11,8 +11,8 @@ namespace DSM {
 	{
 		m_IsValid = CreateTextureFromFile(*this, filename, filename, forceSRGB);
 
+		m_Descriptor = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 		if (m_IsValid) {
-			m_Descriptor = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 			CreateShaderResourceView(m_Descriptor);
 		}
 		else {
@@ -21,6 +21,10 @@ namespace DSM {
 				Graphics::GetDefaultTexture(Graphics::kMagenta2D),
 				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 		}
+		m_BindlessIndex = g_RenderContext.GetBindlessHeap().Allocate(m_Descriptor);
+		if (m_IsValid) {
+			EnableRelocation();
+		}
 		
 		m_IsLoaded.store(false);
 	}
@@ -38,6 +42,8 @@ namespace DSM {
 
 		m_Descriptor = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 		CreateShaderResourceView(m_Descriptor);
+		m_BindlessIndex = g_RenderContext.GetBindlessHeap().Allocate(m_Descriptor);
+		EnableRelocation();
 
 		m_IsLoaded.store(false);
 	}
@@ -51,18 +57,56 @@ namespace DSM {
 
 	void TextureManager::ManagedTexture::Destroy()
 	{
-		if (m_Resource != nullptr) {
+		if (m_Descriptor.IsValid()) {
 			g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_Descriptor);
+			m_Descriptor = {};
+		}
+		if (m_BindlessIndex != BindlessDescriptorHeap::INVALID_INDEX) {
+			g_RenderContext.FreeBindlessDescriptor(m_BindlessIndex);
+			m_BindlessIndex = BindlessDescriptorHeap::INVALID_INDEX;
 		}
 		Texture::Destroy();
 	}
 
+	void TextureManager::ManagedTexture::EnableRelocation()
+	{
+		SetRelocateCallback([this](GpuResource&) {
+			// 之前提交的帧仍通过旧的槽位访问旧的资源，不能原地改写，换用新的槽位并延迟释放旧的
+			CreateShaderResourceView(m_Descriptor);
+			auto oldIndex = m_BindlessIndex;
+			m_BindlessIndex = g_RenderContext.GetBindlessHeap().Allocate(m_Descriptor);
+			g_RenderContext.FreeBindlessDescriptor(oldIndex);
+		});
+	}
+
 	void TextureManager::ManagedTexture::Unload()
 	{
 		g_TexManager.DestroyTexture(m_Name);
 	}
 
 
+	TextureManager::TextureManager()
+	{
+		m_TelemetrySourceID = g_RenderContext.GetMemoryTelemetry().AddSource([this](std::vector<AllocatorTelemetry>& allocators) {
+			auto stats = GetStats();
+			auto& telemetry = allocators.emplace_back();
+			telemetry.m_Allocator = "TextureManager";
+			telemetry.m_HeapType = "Texture";
+			telemetry.m_ReservedBytes = stats.m_TotalBytes;
+			telemetry.m_UsedBytes = stats.m_TotalBytes;
+			telemetry.m_PeakReservedBytes = stats.m_PeakBytes;
+			telemetry.m_PeakUsedBytes = stats.m_PeakBytes;
+			telemetry.m_NumPages = stats.m_NumTextures;
+			telemetry.m_NumAllocations = stats.m_NumLoads;
+			telemetry.m_CountedInTotal = false;
+		});
+	}
+
+	TextureManager::~TextureManager()
+	{
+		g_RenderContext.GetMemoryTelemetry().RemoveSource(m_TelemetrySourceID);
+	}
+
 	TextureRef TextureManager::LoadTextureFromFile(const std::string& fileName, bool forceSRGB)
 	{
 		std::shared_ptr<ManagedTexture> tex = nullptr;
@@ -81,6 +125,7 @@ namespace DSM {
 			else {
 				tex = std::make_shared<ManagedTexture>();
 				m_Textures[key] = tex;
+				++m_NumLoads;
 			}
 		}
 
@@ -104,6 +149,7 @@ namespace DSM {
 			else {
 				tex = std::make_shared<ManagedTexture>();
 				m_Textures[name] = tex;
+				++m_NumLoads;
 			}
 		}
 
@@ -126,6 +172,25 @@ namespace DSM {
 		return m_Textures.size();
 	}
 
+	TextureManagerStats TextureManager::GetStats()
+	{
+		std::lock_guard lock(m_Mutex);
+
+		TextureManagerStats stats{};
+		stats.m_NumTextures = static_cast<std::uint32_t>(m_Textures.size());
+		stats.m_NumLoads = m_NumLoads;
+		for (const auto& [name, texture] : m_Textures) {
+			// 正在加载的纹理尚未创建资源
+			if (!texture->IsLoading() && texture->IsValid()) {
+				++stats.m_NumValidTextures;
+				stats.m_TotalBytes += texture->GetAllocation().m_Size;
+			}
+		}
+		m_PeakBytes = std::max(m_PeakBytes, stats.m_TotalBytes);
+		stats.m_PeakBytes = m_PeakBytes;
+		return stats;
+	}
+
 
 
 	
@@ -141,4 +206,9 @@ namespace DSM {
 	{
 		return (m_Texture != nullptr) ? m_Texture->GetSRV() : Graphics::GetDefaultTexture(Graphics::kMagenta2D);
 	}
-}
+
+	std::uint32_t TextureRef::GetBindlessIndex() const noexcept
+	{
+		return (m_Texture != nullptr) ? m_Texture->GetBindlessIndex() : Graphics::GetDefaultTextureIndex(Graphics::kMagenta2D);
+	}
+}
\ No newline at end of file
@@ -5,9 +5,20 @@
 #include "Utilities/Singleton.h"
 #include "Graphics/Resource/Texture.h"
 #include "Graphics/DescriptorHeap.h"
+#include "Graphics/BindlessDescriptorHeap.h"
+#include "Graphics/MemoryTelemetry.h"
 
 namespace DSM {
 
+	// 纹理管理器的使用情况，纹理占用的空间同时计入资源分配器
+	struct TextureManagerStats
+	{
+		std::uint32_t m_NumTextures{};
+		std::uint32_t m_NumValidTextures{};
+		std::uint64_t m_TotalBytes{};
+		std::uint64_t m_PeakBytes{};
+		std::uint64_t m_NumLoads{};
+	};
 	
 	class TextureManager : public Singleton<TextureManager>
 	{
@@ -28,12 +39,20 @@ namespace DSM {
 			void Unload();
 
 			bool IsValid() const noexcept { return m_IsValid; };
+			bool IsLoading() const noexcept { return m_IsLoaded.load(); }
 
 			D3D12_CPU_DESCRIPTOR_HANDLE GetSRV() const noexcept { return m_Descriptor; };
+			std::uint32_t GetBindlessIndex() const noexcept { return m_BindlessIndex; }
+
+		private:
+			// 纹理上传后只读，允许碎片整理迁移，迁移后重新创建视图并换用新的常驻槽位
+			void EnableRelocation();
 
 		private:
 			std::string m_Name{};
 			DescriptorHandle m_Descriptor{};
+			// 在常驻描述符堆中的索引，迁移后会改变，缓存该索引时需在迁移后重新获取
+			std::uint32_t m_BindlessIndex = BindlessDescriptorHeap::INVALID_INDEX;
 			std::atomic<bool> m_IsLoaded{false};
 			bool m_IsValid = false;
 		};
@@ -45,15 +64,21 @@ namespace DSM {
 		void DestroyTexture(const std::string& name);
 
 		size_t GetTextureCount() const noexcept;
+		TextureManagerStats GetStats();
 
 	protected:
 		friend class Singleton<TextureManager>;
-		TextureManager() = default;
-		virtual ~TextureManager() = default;
+		TextureManager();
+		virtual ~TextureManager();
 
 	protected:
 		std::mutex m_Mutex;
 		std::unordered_map<std::string, std::shared_ptr<ManagedTexture>> m_Textures;
+
+		std::uint64_t m_NumLoads{};
+		std::uint64_t m_PeakBytes{};
+		// 在内存统计中注册的数据源
+		std::uint32_t m_TelemetrySourceID = MemoryTelemetry::INVALID_SOURCE_ID;
 	};
 
 #define g_TexManager (TextureManager::GetInstance())
@@ -68,6 +93,7 @@ namespace DSM {
 		bool IsValid() const noexcept { return m_Texture != nullptr && m_Texture->IsValid(); }
 
 		D3D12_CPU_DESCRIPTOR_HANDLE GetSRV() const noexcept;
+		std::uint32_t GetBindlessIndex() const noexcept;
 		const Texture* Get() const noexcept { return m_Texture.get(); }
 		const Texture* operator->() const { ASSERT(m_Texture != nullptr); return m_Texture.get(); }
 		
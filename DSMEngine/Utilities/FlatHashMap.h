@@ -0,0 +1,118 @@
+#pragma once
+#ifndef __FLATHASHMAP_H__
+#define __FLATHASHMAP_H__
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace DSM {
+    /// <summary>
+    /// 线性探测的开放寻址哈希表，元素连续存放，适合频繁清空的小表
+    /// Clear 时保留存储与元素对象，再次插入时复用元素中已分配的内存，因此取得的新元素需由调用者重新初始化
+    /// 键只能是整数或指针，不支持删除单个元素
+    /// </summary>
+    template <typename Key, typename Value>
+    class FlatHashMap
+    {
+    public:
+        using Entry = std::pair<Key, Value>;
+
+        // maxSize 不为 0 时容量固定，表满后无法插入新元素
+        FlatHashMap(std::uint32_t maxSize = 0) noexcept : m_MaxSize(maxSize) {}
+        ~FlatHashMap() = default;
+
+        Value* Find(Key key) noexcept
+        {
+            if (m_Size == 0) return nullptr;
+            for (auto slot = GetSlot(key);; slot = (slot + 1) & (m_Slots.size() - 1)) {
+                auto index = m_Slots[slot];
+                if (index == INVALID_INDEX) return nullptr;
+                if (m_Entries[index].first == key) return &m_Entries[index].second;
+            }
+        }
+
+        // 返回已有的元素或新的元素，容量固定且已满时返回空
+        Value* FindOrInsert(Key key, bool& inserted)
+        {
+            inserted = false;
+            if (m_MaxSize != 0 && m_Size >= m_MaxSize) {
+                return Find(key);
+            }
+            if ((m_Size + 1) * 4 > m_Slots.size() * 3) {
+                Rehash(std::max<std::size_t>(m_Slots.size() * 2, INITIAL_SLOTS));
+            }
+
+            auto slot = GetSlot(key);
+            for (; m_Slots[slot] != INVALID_INDEX; slot = (slot + 1) & (m_Slots.size() - 1)) {
+                auto& entry = m_Entries[m_Slots[slot]];
+                if (entry.first == key) return &entry.second;
+            }
+
+            if (m_Size == m_Entries.size()) {
+                m_Entries.emplace_back();
+            }
+            auto& entry = m_Entries[m_Size];
+            entry.first = key;
+            m_Slots[slot] = m_Size++;
+            inserted = true;
+            return &entry.second;
+        }
+
+        void Clear() noexcept
+        {
+            if (m_Size == 0) return;
+            std::fill(m_Slots.begin(), m_Slots.end(), INVALID_INDEX);
+            m_Size = 0;
+        }
+
+        std::uint32_t Size() const noexcept { return m_Size; }
+        bool Empty() const noexcept { return m_Size == 0; }
+        std::span<Entry> GetEntries() noexcept { return {m_Entries.data(), m_Size}; }
+
+    private:
+        inline static constexpr std::uint32_t INVALID_INDEX = ~0u;
+        inline static constexpr std::size_t INITIAL_SLOTS = 16;
+
+        std::size_t GetSlot(Key key) const noexcept
+        {
+            std::uint64_t value{};
+            if constexpr (std::is_pointer_v<Key>) {
+                value = reinterpret_cast<std::uintptr_t>(key);
+            }
+            else {
+                value = static_cast<std::uint64_t>(key);
+            }
+            // 斐波那契散列，使指针等低位相同的键也能分散开
+            return static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ull) >> 32) & (m_Slots.size() - 1);
+        }
+
+        void Rehash(std::size_t numSlots)
+        {
+            if (m_MaxSize != 0) {
+                // 固定容量时一次分配足够的槽位
+                numSlots = std::max<std::size_t>(numSlots, std::bit_ceil(std::size_t{m_MaxSize} * 4 / 3 + 1));
+            }
+            m_Slots.assign(numSlots, INVALID_INDEX);
+            for (std::uint32_t i = 0; i < m_Size; ++i) {
+                auto slot = GetSlot(m_Entries[i].first);
+                while (m_Slots[slot] != INVALID_INDEX) {
+                    slot = (slot + 1) & (m_Slots.size() - 1);
+                }
+                m_Slots[slot] = i;
+            }
+        }
+
+    private:
+        std::vector<Entry> m_Entries{};
+        std::vector<std::uint32_t> m_Slots{};
+        std::uint32_t m_Size{};
+        const std::uint32_t m_MaxSize{};
+    };
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "FrameArena.h"
+
+namespace DSM {
+    void* FrameArena::Allocate(std::uint64_t size, std::uint32_t alignment)
+    {
+        ASSERT(alignment <= MAX_ALIGNMENT);
+
+        auto& threadArena = GetThreadArena();
+        // 进入新的一帧，从第一个块重新开始分配
+        if (auto frameIndex = m_FrameIndex.load(std::memory_order_relaxed); threadArena.m_FrameIndex != frameIndex) {
+            threadArena.m_FrameIndex = frameIndex;
+            threadArena.m_CurrBlock = 0;
+            if (!threadArena.m_Blocks.empty()) {
+                threadArena.m_Blocks[0].m_Allocator.Clear();
+            }
+        }
+
+        if (threadArena.m_CurrBlock < threadArena.m_Blocks.size()) {
+            auto& block = threadArena.m_Blocks[threadArena.m_CurrBlock];
+            if (auto offset = block.m_Allocator.Allocate(size, alignment); offset != Utility::INVALID_ALLOC_OFFSET) {
+                return block.m_Data.get() + offset;
+            }
+        }
+        return AllocateFromNextBlock(threadArena, size, alignment);
+    }
+
+    FrameArenaStats FrameArena::GetStats()
+    {
+        std::lock_guard lock{m_Mutex};
+
+        FrameArenaStats stats{};
+        stats.m_ReservedBytes = m_ReservedBytes;
+        stats.m_NumBlocks = m_NumBlocks;
+        stats.m_NumThreads = static_cast<std::uint32_t>(m_ThreadArenas.size());
+        return stats;
+    }
+
+    FrameArena::ThreadArena& FrameArena::GetThreadArena()
+    {
+        // 缓存当前线程最近使用的分配器
+        struct ThreadArenaCache
+        {
+            std::uint64_t m_ArenaID{};
+            ThreadArena* m_ThreadArena{};
+        };
+        static thread_local ThreadArenaCache s_Cache{};
+
+        if (s_Cache.m_ArenaID == m_ArenaID) {
+            return *s_Cache.m_ThreadArena;
+        }
+
+        std::lock_guard lock{m_Mutex};
+
+        auto threadID = std::this_thread::get_id();
+        auto it = std::find_if(m_ThreadArenas.begin(), m_ThreadArenas.end(), [threadID](const auto& threadArena) {
+            return threadArena->m_ThreadID == threadID;
+        });
+        if (it == m_ThreadArenas.end()) {
+            auto threadArena = std::make_unique<ThreadArena>();
+            threadArena->m_ThreadID = threadID;
+            threadArena->m_FrameIndex = m_FrameIndex.load(std::memory_order_relaxed);
+            it = m_ThreadArenas.insert(m_ThreadArenas.end(), std::move(threadArena));
+        }
+
+        s_Cache.m_ArenaID = m_ArenaID;
+        s_Cache.m_ThreadArena = it->get();
+        return **it;
+    }
+
+    void* FrameArena::AllocateFromNextBlock(ThreadArena& threadArena, std::uint64_t size, std::uint32_t alignment)
+    {
+        // 复用之前帧创建的块，放不下的大块跳过
+        while (++threadArena.m_CurrBlock < threadArena.m_Blocks.size()) {
+            auto& block = threadArena.m_Blocks[threadArena.m_CurrBlock];
+            block.m_Allocator.Clear();
+            if (auto offset = block.m_Allocator.Allocate(size, alignment); offset != Utility::INVALID_ALLOC_OFFSET) {
+                return block.m_Data.get() + offset;
+            }
+        }
+
+        // 超过块大小的分配单独使用一个块，之后的帧中同样可以复用
+        auto blockSize = std::max(m_BlockSize, Math::AlignUp(size, MAX_ALIGNMENT));
+        auto data = static_cast<std::byte*>(::operator new(blockSize, std::align_val_t{MAX_ALIGNMENT}));
+        {
+            std::lock_guard lock{m_Mutex};
+            m_ReservedBytes += blockSize;
+            ++m_NumBlocks;
+        }
+
+        threadArena.m_CurrBlock = threadArena.m_Blocks.size();
+        auto& block = threadArena.m_Blocks.emplace_back(Block{
+            std::unique_ptr<std::byte, AlignedDelete>{data}, LinearAllocator{blockSize} });
+        auto offset = block.m_Allocator.Allocate(size, alignment);
+        ASSERT(offset != Utility::INVALID_ALLOC_OFFSET);
+        return block.m_Data.get() + offset;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#ifndef __FRAMEARENA_H__
+#define __FRAMEARENA_H__
+
+#include "LinearAllocator.h"
+#include "Macros.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DSM {
+    // 帧内存的使用情况
+    struct FrameArenaStats
+    {
+        std::uint64_t m_ReservedBytes{};
+        std::uint32_t m_NumBlocks{};
+        std::uint32_t m_NumThreads{};
+    };
+
+    /// <summary>
+    /// 按帧回收的 CPU 临时内存，每个线程在自己的内存块中线性分配，无需加锁
+    /// 帧结束时 Reset 整体回收，分配的内存不能跨帧持有，也不会调用析构函数
+    /// </summary>
+    class FrameArena
+    {
+    public:
+        inline static constexpr std::uint64_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+        // 内存块的起始地址按缓存行对齐，更大的对齐无法满足
+        inline static constexpr std::uint32_t MAX_ALIGNMENT = 64;
+
+        FrameArena(std::uint64_t blockSize = DEFAULT_BLOCK_SIZE) noexcept
+            :m_BlockSize(blockSize), m_ArenaID(sm_NextArenaID.fetch_add(1, std::memory_order_relaxed)) {}
+        ~FrameArena() = default;
+        DSM_NONCOPYABLE_NONMOVABLE(FrameArena);
+
+        void* Allocate(std::uint64_t size, std::uint32_t alignment = alignof(std::max_align_t));
+        template <typename T>
+        T* Allocate(std::size_t count = 1)
+        {
+            return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        // 只增加帧序号，各线程下次分配时再重置自己的内存块，调用时不能有线程正在分配
+        void Reset() noexcept { m_FrameIndex.fetch_add(1, std::memory_order_relaxed); }
+
+        FrameArenaStats GetStats();
+
+    private:
+        struct AlignedDelete
+        {
+            void operator()(std::byte* data) const noexcept
+            {
+                ::operator delete(data, std::align_val_t{MAX_ALIGNMENT});
+            }
+        };
+        struct Block
+        {
+            std::unique_ptr<std::byte, AlignedDelete> m_Data{};
+            LinearAllocator m_Allocator;
+        };
+        // 仅由所属线程访问
+        struct ThreadArena
+        {
+            std::thread::id m_ThreadID{};
+            std::vector<Block> m_Blocks{};
+            std::size_t m_CurrBlock{};
+            std::uint64_t m_FrameIndex{};
+        };
+
+        ThreadArena& GetThreadArena();
+        // 当前块不足时切换到下一个块，没有可用的块时新建
+        void* AllocateFromNextBlock(ThreadArena& threadArena, std::uint64_t size, std::uint32_t alignment);
+
+    private:
+        const std::uint64_t m_BlockSize{};
+        // 用于区分线程缓存中的分配器，地址可能被复用
+        const std::uint64_t m_ArenaID{};
+        std::atomic<std::uint64_t> m_FrameIndex{};
+
+        // 仅在线程首次分配及新建内存块时使用
+        std::mutex m_Mutex{};
+        std::vector<std::unique_ptr<ThreadArena>> m_ThreadArenas{};
+        std::uint64_t m_ReservedBytes{};
+        std::uint32_t m_NumBlocks{};
+
+        inline static std::atomic<std::uint64_t> sm_NextArenaID{1};
+    };
+
+
+    // 从帧内存中分配的 STL 分配器，释放为空操作，内存在帧结束时统一回收
+    template <typename T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameAllocator(FrameArena& arena) noexcept : m_Arena(&arena) {}
+        template <typename U>
+        FrameAllocator(const FrameAllocator<U>& other) noexcept : m_Arena(other.GetArena()) {}
+
+        T* allocate(std::size_t count)
+        {
+            return m_Arena->Allocate<T>(count);
+        }
+        void deallocate(T*, std::size_t) noexcept {}
+
+        FrameArena* GetArena() const noexcept { return m_Arena; }
+
+        template <typename U>
+        bool operator==(const FrameAllocator<U>& other) const noexcept { return m_Arena == other.GetArena(); }
+
+    private:
+        FrameArena* m_Arena{};
+    };
+
+    template <typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+}
+
+#endif
@@ -0,0 +1,331 @@
+#pragma once
+#ifndef __TLSFALLOCATOR_H__
+#define __TLSFALLOCATOR_H__
+
+#include "Macros.h"
+#include <array>
+#include <bit>
+#include <vector>
+
+namespace DSM {
+    // 两级分离适配(Two-Level Segregated Fit)分配器，只管理偏移量，
+    // 分配与释放均为 O(1)，释放时会与相邻的空闲块合并
+    class TLSFAllocator
+    {
+    public:
+        using BlockHandle = std::uint32_t;
+        static constexpr BlockHandle INVALID_BLOCK = (std::numeric_limits<BlockHandle>::max)();
+
+        struct Allocation
+        {
+            std::uint64_t m_Offset = Utility::INVALID_ALLOC_OFFSET;
+            std::uint64_t m_Size = 0;
+            // 释放时使用的句柄
+            BlockHandle m_Block = INVALID_BLOCK;
+
+            bool IsValid() const noexcept { return m_Block != INVALID_BLOCK; }
+        };
+
+    public:
+        explicit TLSFAllocator(std::uint64_t maxSize)
+            :m_MaxSize(maxSize)
+        {
+            Clear();
+        }
+        ~TLSFAllocator() = default;
+        DSM_DEFAULT_COPYABLE_MOVABLE(TLSFAllocator);
+
+        // alignment 需为 2 的幂
+        Allocation Allocate(std::uint64_t size, std::uint64_t alignment = 1) noexcept
+        {
+            if (size == 0 || size > m_MaxSize - m_UsedSize) return {};
+            alignment = std::max<std::uint64_t>(alignment, 1);
+
+            auto blockHandle = FindFreeBlock(size, alignment);
+            if (blockHandle == INVALID_BLOCK) return {};
+
+            RemoveFreeBlock(blockHandle);
+
+            // 对齐产生的空隙作为新的空闲块
+            auto alignedOffset = AlignOffset(m_Blocks[blockHandle].m_Offset, alignment);
+            if (auto gap = alignedOffset - m_Blocks[blockHandle].m_Offset; gap > 0) {
+                auto gapHandle = SplitBlock(blockHandle, gap);
+                std::swap(gapHandle, blockHandle);
+                InsertFreeBlock(gapHandle);
+            }
+            // 多余的部分放回空闲链表
+            if (m_Blocks[blockHandle].m_Size > size) {
+                InsertFreeBlock(SplitBlock(blockHandle, size));
+            }
+
+            auto& block = m_Blocks[blockHandle];
+            block.m_IsFree = false;
+            m_UsedSize += block.m_Size;
+            ++m_AllocationCount;
+
+            return {block.m_Offset, block.m_Size, blockHandle};
+        }
+
+        void Free(BlockHandle blockHandle) noexcept
+        {
+            ASSERT(blockHandle < m_Blocks.size() && !m_Blocks[blockHandle].m_IsFree);
+
+            m_UsedSize -= m_Blocks[blockHandle].m_Size;
+            --m_AllocationCount;
+
+            // 与前后相邻的空闲块合并
+            if (auto prev = m_Blocks[blockHandle].m_PrevPhysical; prev != INVALID_BLOCK && m_Blocks[prev].m_IsFree) {
+                RemoveFreeBlock(prev);
+                MergeBlock(prev, blockHandle);
+                blockHandle = prev;
+            }
+            if (auto next = m_Blocks[blockHandle].m_NextPhysical; next != INVALID_BLOCK && m_Blocks[next].m_IsFree) {
+                RemoveFreeBlock(next);
+                MergeBlock(blockHandle, next);
+            }
+            InsertFreeBlock(blockHandle);
+        }
+
+        // 释放所有分配
+        void Clear() noexcept
+        {
+            m_Blocks.clear();
+            m_UnusedBlocks = INVALID_BLOCK;
+            m_FLBitmap = 0;
+            m_SLBitmaps.fill(0);
+            for (auto& freeList : m_FreeLists) {
+                freeList.fill(INVALID_BLOCK);
+            }
+            m_UsedSize = 0;
+            m_AllocationCount = 0;
+
+            if (m_MaxSize > 0) {
+                auto blockHandle = CreateBlock();
+                m_Blocks[blockHandle].m_Size = m_MaxSize;
+                InsertFreeBlock(blockHandle);
+            }
+        }
+
+        bool Empty() const noexcept { return m_AllocationCount == 0; }
+        std::uint64_t MaxSize() const noexcept { return m_MaxSize; }
+        std::uint64_t UsedSize() const noexcept { return m_UsedSize; }
+        std::uint64_t FreeSize() const noexcept { return m_MaxSize - m_UsedSize; }
+        std::uint32_t AllocationCount() const noexcept { return m_AllocationCount; }
+
+        std::uint64_t LargestFreeBlock() const noexcept
+        {
+            if (m_FLBitmap == 0) return 0;
+
+            // 最大的块一定位于最高的非空区间中
+            auto fl = static_cast<std::uint32_t>(std::bit_width(m_FLBitmap) - 1);
+            auto sl = static_cast<std::uint32_t>(std::bit_width(m_SLBitmaps[fl]) - 1);
+            std::uint64_t largestSize = 0;
+            for (auto blockHandle = m_FreeLists[fl][sl]; blockHandle != INVALID_BLOCK; blockHandle = m_Blocks[blockHandle].m_NextFree) {
+                largestSize = std::max(largestSize, m_Blocks[blockHandle].m_Size);
+            }
+            return largestSize;
+        }
+
+        // 外部碎片率，0 表示空闲空间完全连续，越接近 1 越分散
+        float Fragmentation() const noexcept
+        {
+            auto freeSize = FreeSize();
+            return freeSize == 0 ? 0.f : 1.f - static_cast<float>(LargestFreeBlock()) / static_cast<float>(freeSize);
+        }
+
+    private:
+        static constexpr std::uint32_t SL_INDEX_COUNT_LOG2 = 5;
+        static constexpr std::uint32_t SL_INDEX_COUNT = 1u << SL_INDEX_COUNT_LOG2;
+        static constexpr std::uint32_t FL_INDEX_COUNT = 64 - SL_INDEX_COUNT_LOG2 + 1;
+
+        struct Block
+        {
+            std::uint64_t m_Offset = 0;
+            std::uint64_t m_Size = 0;
+            // 物理上相邻的块
+            BlockHandle m_PrevPhysical = INVALID_BLOCK;
+            BlockHandle m_NextPhysical = INVALID_BLOCK;
+            // 空闲链表中相邻的块，未使用的块也通过 m_NextFree 串联
+            BlockHandle m_PrevFree = INVALID_BLOCK;
+            BlockHandle m_NextFree = INVALID_BLOCK;
+            bool m_IsFree = false;
+        };
+
+        static std::uint64_t AlignOffset(std::uint64_t offset, std::uint64_t alignment) noexcept
+        {
+            return (offset + alignment - 1) & ~(alignment - 1);
+        }
+
+        // 计算大小所在的区间
+        static void MappingInsert(std::uint64_t size, std::uint32_t& fl, std::uint32_t& sl) noexcept
+        {
+            if (size < SL_INDEX_COUNT) {
+                fl = 0;
+                sl = static_cast<std::uint32_t>(size);
+            }
+            else {
+                auto msb = static_cast<std::uint32_t>(std::bit_width(size) - 1);
+                sl = static_cast<std::uint32_t>(size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+                fl = msb - SL_INDEX_COUNT_LOG2 + 1;
+            }
+        }
+
+        // 向上取整到下一个区间，使得区间内的任意块都能满足该大小
+        static void MappingSearch(std::uint64_t size, std::uint32_t& fl, std::uint32_t& sl) noexcept
+        {
+            if (size >= SL_INDEX_COUNT) {
+                auto msb = static_cast<std::uint32_t>(std::bit_width(size) - 1);
+                size += (1ull << (msb - SL_INDEX_COUNT_LOG2)) - 1;
+            }
+            MappingInsert(size, fl, sl);
+        }
+
+        BlockHandle FindSuitableBlock(std::uint64_t size) const noexcept
+        {
+            std::uint32_t fl, sl;
+            MappingSearch(size, fl, sl);
+            if (fl >= FL_INDEX_COUNT) return INVALID_BLOCK;
+
+            auto slBitmap = m_SLBitmaps[fl] & (~0u << sl);
+            if (slBitmap == 0) {
+                auto flBitmap = fl + 1 < 64 ? m_FLBitmap & (~0ull << (fl + 1)) : 0;
+                if (flBitmap == 0) return INVALID_BLOCK;
+
+                fl = static_cast<std::uint32_t>(std::countr_zero(flBitmap));
+                slBitmap = m_SLBitmaps[fl];
+            }
+            sl = static_cast<std::uint32_t>(std::countr_zero(slBitmap));
+            return m_FreeLists[fl][sl];
+        }
+
+        BlockHandle FindFreeBlock(std::uint64_t size, std::uint64_t alignment) const noexcept
+        {
+            // 先按原大小查找，找到的块满足对齐时不需要额外的空间
+            auto blockHandle = FindSuitableBlock(size);
+            if (blockHandle != INVALID_BLOCK) {
+                const auto& block = m_Blocks[blockHandle];
+                if (AlignOffset(block.m_Offset, alignment) + size <= block.m_Offset + block.m_Size) {
+                    return blockHandle;
+                }
+            }
+            // 再按最坏情况查找，保证对齐后仍有足够的空间
+            return alignment > 1 ? FindSuitableBlock(size + alignment - 1) : INVALID_BLOCK;
+        }
+
+        void InsertFreeBlock(BlockHandle blockHandle) noexcept
+        {
+            auto& block = m_Blocks[blockHandle];
+            std::uint32_t fl, sl;
+            MappingInsert(block.m_Size, fl, sl);
+
+            auto& head = m_FreeLists[fl][sl];
+            block.m_IsFree = true;
+            block.m_PrevFree = INVALID_BLOCK;
+            block.m_NextFree = head;
+            if (head != INVALID_BLOCK) {
+                m_Blocks[head].m_PrevFree = blockHandle;
+            }
+            head = blockHandle;
+
+            m_FLBitmap |= 1ull << fl;
+            m_SLBitmaps[fl] |= 1u << sl;
+        }
+
+        void RemoveFreeBlock(BlockHandle blockHandle) noexcept
+        {
+            auto& block = m_Blocks[blockHandle];
+            std::uint32_t fl, sl;
+            MappingInsert(block.m_Size, fl, sl);
+
+            if (block.m_PrevFree != INVALID_BLOCK) {
+                m_Blocks[block.m_PrevFree].m_NextFree = block.m_NextFree;
+            }
+            if (block.m_NextFree != INVALID_BLOCK) {
+                m_Blocks[block.m_NextFree].m_PrevFree = block.m_PrevFree;
+            }
+
+            auto& head = m_FreeLists[fl][sl];
+            if (head == blockHandle) {
+                head = block.m_NextFree;
+                if (head == INVALID_BLOCK) {
+                    m_SLBitmaps[fl] &= ~(1u << sl);
+                    if (m_SLBitmaps[fl] == 0) {
+                        m_FLBitmap &= ~(1ull << fl);
+                    }
+                }
+            }
+            block.m_IsFree = false;
+            block.m_PrevFree = block.m_NextFree = INVALID_BLOCK;
+        }
+
+        // 从块中切下前 size 字节，返回剩余部分的句柄
+        BlockHandle SplitBlock(BlockHandle blockHandle, std::uint64_t size) noexcept
+        {
+            auto remainHandle = CreateBlock();
+            auto& block = m_Blocks[blockHandle];
+            auto& remain = m_Blocks[remainHandle];
+
+            remain.m_Offset = block.m_Offset + size;
+            remain.m_Size = block.m_Size - size;
+            remain.m_PrevPhysical = blockHandle;
+            remain.m_NextPhysical = block.m_NextPhysical;
+            if (block.m_NextPhysical != INVALID_BLOCK) {
+                m_Blocks[block.m_NextPhysical].m_PrevPhysical = remainHandle;
+            }
+            block.m_Size = size;
+            block.m_NextPhysical = remainHandle;
+
+            return remainHandle;
+        }
+
+        // 将 next 合并到物理上相邻的 prev 中
+        void MergeBlock(BlockHandle prevHandle, BlockHandle nextHandle) noexcept
+        {
+            auto& prev = m_Blocks[prevHandle];
+            auto& next = m_Blocks[nextHandle];
+
+            prev.m_Size += next.m_Size;
+            prev.m_NextPhysical = next.m_NextPhysical;
+            if (next.m_NextPhysical != INVALID_BLOCK) {
+                m_Blocks[next.m_NextPhysical].m_PrevPhysical = prevHandle;
+            }
+            DestroyBlock(nextHandle);
+        }
+
+        BlockHandle CreateBlock()
+        {
+            BlockHandle blockHandle = m_UnusedBlocks;
+            if (blockHandle != INVALID_BLOCK) {
+                m_UnusedBlocks = m_Blocks[blockHandle].m_NextFree;
+                m_Blocks[blockHandle] = {};
+            }
+            else {
+                blockHandle = static_cast<BlockHandle>(m_Blocks.size());
+                m_Blocks.emplace_back();
+            }
+            return blockHandle;
+        }
+
+        void DestroyBlock(BlockHandle blockHandle) noexcept
+        {
+            m_Blocks[blockHandle] = {};
+            m_Blocks[blockHandle].m_NextFree = m_UnusedBlocks;
+            m_UnusedBlocks = blockHandle;
+        }
+
+    private:
+        std::uint64_t m_MaxSize{};
+        std::uint64_t m_UsedSize{};
+        std::uint32_t m_AllocationCount{};
+
+        std::vector<Block> m_Blocks{};
+        // 可复用的块记录
+        BlockHandle m_UnusedBlocks = INVALID_BLOCK;
+
+        std::uint64_t m_FLBitmap{};
+        std::array<std::uint32_t, FL_INDEX_COUNT> m_SLBitmaps{};
+        std::array<std::array<BlockHandle, SL_INDEX_COUNT>, FL_INDEX_COUNT> m_FreeLists{};
+    };
+}
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "pch.h"
+#include <chrono>
+
+namespace DSM::Benchmark {
+    struct BenchmarkArgs
+    {
+        // 回放的分配记录文件，为空时生成模拟数据
+        std::string m_TracePath{};
+        // 将生成的分配记录保存到文件
+        std::string m_RecordPath{};
+        std::uint32_t m_NumOps = 200000;
+        // 资源创建与释放的次数
+        std::uint32_t m_NumPairs = 100000;
+        std::uint32_t m_Seed = 1;
+    };
+
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : m_Start(std::chrono::steady_clock::now()) {}
+
+        void Restart() noexcept { m_Start = std::chrono::steady_clock::now(); }
+        double ElapsedMilliseconds() const noexcept
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    // 回放放置资源堆的分配记录，对比线性分配与 TLSF 分配
+    int RunHeapTraceBenchmark(const BenchmarkArgs& args);
+    // 以下测试需要先以空设备创建渲染环境
+    // 检查 MSAA 渲染目标的放置，并测量 GpuResource 创建与释放的开销
+    int RunResourceAllocatorBenchmark(const BenchmarkArgs& args);
+    // 对比多线程下共享上下文与独立上下文分配上传缓冲区的开销
+    int RunDynamicBufferBenchmark(const BenchmarkArgs& args);
+    // 对比直接录制命令列表与录制到命令流的开销，并测量命令流回放的吞吐量
+    int RunCommandStreamBenchmark(const BenchmarkArgs& args);
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "Benchmark.h"
+#include "Graphics/RenderContext.h"
+#include "Graphics/CommandList/CommandStream.h"
+#include <barrier>
+#include <span>
+#include <thread>
+
+namespace DSM::Benchmark {
+    using Microsoft::WRL::ComPtr;
+
+    // 录制一帧模拟的绘制命令，对象只是占位的指针，不会被访问
+    static void RecordFrame(ID3D12GraphicsCommandList* cmdList, std::uint32_t numDraws)
+    {
+        constexpr std::uint32_t drawsPerPipeline = 16;
+        constexpr D3D12_GPU_VIRTUAL_ADDRESS baseAddress = 0x100000;
+
+        std::array<D3D12_VERTEX_BUFFER_VIEW, 4> VBVs{};
+        for (std::uint32_t i = 0; i < VBVs.size(); ++i) {
+            VBVs[i] = {baseAddress + i * 0x10000, 0x10000, 16};
+        }
+        D3D12_INDEX_BUFFER_VIEW IBV{baseAddress + 0x40000, 0x10000, DXGI_FORMAT_R32_UINT};
+
+        for (std::uint32_t i = 0; i < numDraws; ++i) {
+            if (i % drawsPerPipeline == 0) {
+                auto pipelineState = reinterpret_cast<ID3D12PipelineState*>(std::uintptr_t{0x1000} + i / drawsPerPipeline * 8);
+                cmdList->SetPipelineState(pipelineState);
+            }
+            cmdList->SetGraphicsRootConstantBufferView(0, baseAddress + i * 256);
+            cmdList->SetGraphicsRootConstantBufferView(1, baseAddress + 0x80000);
+            cmdList->IASetVertexBuffers(0, static_cast<UINT>(VBVs.size()), VBVs.data());
+            cmdList->IASetIndexBuffer(&IBV);
+            cmdList->DrawIndexedInstanced(36, 1, 0, 0, 0);
+        }
+    }
+
+    struct CommandStreamResult
+    {
+        // 在空设备的命令列表上直接录制，只反映空设备本身的调用开销，作为对照
+        double m_NullDeviceMilliseconds{};
+        double m_RecordMilliseconds{};
+        double m_ReplayMilliseconds{};
+        std::uint64_t m_NumCommands{};
+        std::uint64_t m_SizeInBytes{};
+    };
+
+    // 每个线程使用独立的命令流与命令列表，各阶段开始前同步，使各线程同时执行同一阶段
+    static void RunCommandStreamThread(
+        CommandStreamResult& result,
+        std::barrier<>& sync,
+        std::uint32_t numFrames,
+        std::uint32_t numDraws)
+    {
+        auto device = g_RenderContext.GetDevice();
+        ComPtr<ID3D12CommandAllocator> allocator{};
+        ComPtr<ID3D12GraphicsCommandList> nativeCmdList{};
+        ASSERT_SUCCEEDED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(allocator.GetAddressOf())));
+        ASSERT_SUCCEEDED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            allocator.Get(), nullptr, IID_PPV_ARGS(nativeCmdList.GetAddressOf())));
+        ASSERT_SUCCEEDED(nativeCmdList->Close());
+
+        CommandStream stream{};
+        ComPtr<ID3D12GraphicsCommandList> streamCmdList{};
+        ASSERT_SUCCEEDED(CreateCommandStreamList(stream, D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(streamCmdList.GetAddressOf())));
+
+        sync.arrive_and_wait();
+        Stopwatch stopwatch{};
+        for (std::uint32_t frame = 0; frame < numFrames; ++frame) {
+            ASSERT_SUCCEEDED(nativeCmdList->Reset(allocator.Get(), nullptr));
+            RecordFrame(nativeCmdList.Get(), numDraws);
+            ASSERT_SUCCEEDED(nativeCmdList->Close());
+        }
+        result.m_NullDeviceMilliseconds = stopwatch.ElapsedMilliseconds();
+
+        sync.arrive_and_wait();
+        stopwatch.Restart();
+        for (std::uint32_t frame = 0; frame < numFrames; ++frame) {
+            ASSERT_SUCCEEDED(streamCmdList->Reset(allocator.Get(), nullptr));
+            RecordFrame(streamCmdList.Get(), numDraws);
+            ASSERT_SUCCEEDED(streamCmdList->Close());
+        }
+        result.m_RecordMilliseconds = stopwatch.ElapsedMilliseconds();
+
+        // 回放最后一帧录制的命令流
+        sync.arrive_and_wait();
+        stopwatch.Restart();
+        for (std::uint32_t frame = 0; frame < numFrames; ++frame) {
+            ASSERT_SUCCEEDED(nativeCmdList->Reset(allocator.Get(), nullptr));
+            stream.Replay(nativeCmdList.Get());
+            ASSERT_SUCCEEDED(nativeCmdList->Close());
+        }
+        result.m_ReplayMilliseconds = stopwatch.ElapsedMilliseconds();
+
+        result.m_NumCommands = static_cast<std::uint64_t>(stream.GetNumCommands()) * numFrames;
+        result.m_SizeInBytes = static_cast<std::uint64_t>(stream.GetSizeInBytes()) * numFrames;
+    }
+
+    // 单个线程的平均每条命令耗时，以及所有线程合计的吞吐量（以最慢的线程作为墙钟时间）
+    struct PhaseStats
+    {
+        double m_NanosecondsPerCommand{};
+        double m_MillionCommandsPerSecond{};
+    };
+
+    static PhaseStats GetPhaseStats(std::span<const CommandStreamResult> results, double CommandStreamResult::* milliseconds)
+    {
+        PhaseStats stats{};
+        double wallMilliseconds{};
+        std::uint64_t numCommands{};
+        for (const auto& result : results) {
+            stats.m_NanosecondsPerCommand += result.*milliseconds * 1e6 / result.m_NumCommands;
+            wallMilliseconds = std::max(wallMilliseconds, result.*milliseconds);
+            numCommands += result.m_NumCommands;
+        }
+        stats.m_NanosecondsPerCommand /= results.size();
+        stats.m_MillionCommandsPerSecond = numCommands / (wallMilliseconds * 1e3);
+        return stats;
+    }
+
+    int RunCommandStreamBenchmark(const BenchmarkArgs& args)
+    {
+        constexpr std::uint32_t numFrames = 100;
+        std::uint32_t numDraws = std::max(args.m_NumOps / numFrames, 1u);
+
+        std::printf("CommandStream: %u frames x %u draws per thread\n", numFrames, numDraws);
+        for (std::uint32_t numThreads : {1u, 2u, 4u, 8u}) {
+            std::vector<CommandStreamResult> results(numThreads);
+            std::barrier sync{static_cast<std::ptrdiff_t>(numThreads)};
+            std::vector<std::thread> threads{};
+            for (std::uint32_t i = 0; i < numThreads; ++i) {
+                threads.emplace_back(RunCommandStreamThread, std::ref(results[i]), std::ref(sync), numFrames, numDraws);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            auto nullDevice = GetPhaseStats(results, &CommandStreamResult::m_NullDeviceMilliseconds);
+            auto record = GetPhaseStats(results, &CommandStreamResult::m_RecordMilliseconds);
+            auto replay = GetPhaseStats(results, &CommandStreamResult::m_ReplayMilliseconds);
+            std::uint64_t numCommands{};
+            std::uint64_t numBytes{};
+            for (const auto& result : results) {
+                numCommands += result.m_NumCommands;
+                numBytes += result.m_SizeInBytes;
+            }
+
+            // ns/cmd 为单个线程的平均值，Mcmd/s 为所有线程的合计
+            std::printf("%u thread(s)   null-device: %6.1f ns/cmd %7.1f Mcmd/s   record: %6.1f ns/cmd %7.1f Mcmd/s   "
+                "replay: %6.1f ns/cmd %7.1f Mcmd/s   %5.1f bytes/cmd\n",
+                numThreads,
+                nullDevice.m_NanosecondsPerCommand, nullDevice.m_MillionCommandsPerSecond,
+                record.m_NanosecondsPerCommand, record.m_MillionCommandsPerSecond,
+                replay.m_NanosecondsPerCommand, replay.m_MillionCommandsPerSecond,
+                static_cast<double>(numBytes) / numCommands);
+        }
+
+        return 0;
+    }
+}
@@ -0,0 +1,88 @@
+#include "Benchmark.h"
+#include "Graphics/RenderContext.h"
+#include "Graphics/Resource/DynamicBufferAllocator.h"
+
+namespace DSM::Benchmark {
+
+    // 模拟每帧录制常量缓冲区，两帧后等待 GPU 完成
+    template <bool UseContext>
+    static void RunDynamicBufferThread(DynamicBufferAllocator& allocator, std::uint32_t numFrames, std::uint32_t allocationsPerFrame)
+    {
+        constexpr std::uint32_t framesInFlight = 2;
+
+        auto& queue = g_RenderContext.GetGraphicsQueue();
+        DynamicBufferContext context{};
+        std::array<std::uint64_t, framesInFlight> fenceValues{};
+
+        for (std::uint32_t frame = 0; frame < numFrames; ++frame) {
+            auto& fenceValue = fenceValues[frame % framesInFlight];
+            if (fenceValue != 0) {
+                queue.WaitForFence(fenceValue);
+            }
+            // 归还 GPU 已使用完毕的页
+            g_RenderContext.GetDeferredReleaseQueue().ProcessReleases();
+
+            for (std::uint32_t i = 0; i < allocationsPerFrame; ++i) {
+                auto location = UseContext ?
+                    allocator.Allocate(context, 256, DEFAULT_ALIGN) :
+                    allocator.Allocate(256, DEFAULT_ALIGN);
+                *static_cast<std::uint32_t*>(location.m_MappedAddress) = i;
+            }
+
+            fenceValue = queue.IncrementFence();
+            if constexpr (UseContext) {
+                allocator.Cleanup(context, fenceValue);
+            }
+            else {
+                allocator.Cleanup(fenceValue);
+            }
+        }
+
+        if constexpr (UseContext) {
+            allocator.ReleaseContext(context, queue.IncrementFence());
+        }
+    }
+
+    template <bool UseContext>
+    static double MeasureDynamicBuffer(
+        DynamicBufferAllocator::AllocateMode mode,
+        std::uint32_t numThreads,
+        std::uint32_t numFrames,
+        std::uint32_t allocationsPerFrame)
+    {
+        DynamicBufferAllocator allocator{};
+        allocator.Create(mode, 0x200000, 0x4000000);
+
+        std::vector<std::thread> threads{};
+        Stopwatch stopwatch{};
+        for (std::uint32_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back(RunDynamicBufferThread<UseContext>, std::ref(allocator), numFrames, allocationsPerFrame);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto milliseconds = stopwatch.ElapsedMilliseconds();
+
+        g_RenderContext.IdleGPU();
+        return milliseconds;
+    }
+
+    int RunDynamicBufferBenchmark(const BenchmarkArgs& args)
+    {
+        constexpr std::uint32_t numFrames = 100;
+        std::uint32_t allocationsPerFrame = std::max(args.m_NumOps / numFrames, 1u);
+
+        std::printf("DynamicBufferAllocator: %u frames x %u allocations per thread\n", numFrames, allocationsPerFrame);
+        for (std::uint32_t numThreads : {1u, 2u, 4u, 8u}) {
+            using AllocateMode = DynamicBufferAllocator::AllocateMode;
+            auto shared = MeasureDynamicBuffer<false>(AllocateMode::CpuExclusive, numThreads, numFrames, allocationsPerFrame);
+            auto perContext = MeasureDynamicBuffer<true>(AllocateMode::CpuExclusive, numThreads, numFrames, allocationsPerFrame);
+            auto ring = MeasureDynamicBuffer<true>(AllocateMode::Ring, numThreads, numFrames, allocationsPerFrame);
+            double numAllocations = static_cast<double>(numThreads) * numFrames * allocationsPerFrame;
+            std::printf("%u thread(s)   shared: %8.1f ns/alloc   per-context: %8.1f ns/alloc   ring: %8.1f ns/alloc\n",
+                numThreads, shared * 1e6 / numAllocations, perContext * 1e6 / numAllocations, ring * 1e6 / numAllocations);
+        }
+
+        return 0;
+    }
+}
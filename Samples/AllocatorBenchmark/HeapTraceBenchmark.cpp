@@ -0,0 +1,322 @@
+#include "Benchmark.h"
+#include "Math/MathCommon.h"
+#include "Utilities/LinearAllocator.h"
+#include "Utilities/TLSFAllocator.h"
+#include <bit>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+namespace DSM::Benchmark {
+    struct HeapTraceOp
+    {
+        enum class Type : std::uint8_t { Allocate, Free };
+
+        Type m_Type = Type::Allocate;
+        std::uint32_t m_Id = 0;
+        std::uint64_t m_Size = 0;
+        std::uint64_t m_Alignment = 0;
+    };
+
+    struct HeapReplayResult
+    {
+        double m_Milliseconds = 0;
+        std::uint32_t m_NumHeaps = 0;
+        std::uint32_t m_NumCommitted = 0;
+        std::uint64_t m_PeakUsedSize = 0;
+        float m_Fragmentation = 0;
+    };
+
+    static constexpr std::uint64_t kHeapSize = DEFAULT_PLACED_RESOURCE_PAGE_SIZE;
+
+    // 模拟纹理流送：常驻的资源数量在上限附近波动，
+    // 大小为 64KB ~ 22MB，少量 MSAA 资源需要 4MB 对齐
+    static std::vector<HeapTraceOp> GenerateStreamingTrace(std::uint32_t numOps, std::uint32_t seed)
+    {
+        constexpr std::size_t maxLiveResources = 512;
+
+        std::mt19937 rng{seed};
+        std::vector<HeapTraceOp> ops{};
+        std::vector<std::uint32_t> liveIds{};
+        std::uint32_t nextId = 0;
+        ops.reserve(numOps);
+
+        for (std::uint32_t i = 0; i < numOps; ++i) {
+            bool allocate = liveIds.empty() || (liveIds.size() < maxLiveResources && rng() % 100 < 55);
+            if (allocate) {
+                std::uint64_t extent = 64ull << (rng() % 6);
+                std::uint64_t bytesPerPixel = rng() % 3 == 0 ? 1 : 4;
+                // 带完整 Mip 链约为原大小的 4/3
+                std::uint64_t size = extent * extent * bytesPerPixel * 4 / 3;
+                std::uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+                if (extent <= 1024 && rng() % 20 == 0) {
+                    size *= 4;
+                    alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+                }
+                size = Math::AlignUp(size, alignment);
+
+                ops.push_back({HeapTraceOp::Type::Allocate, nextId, size, alignment});
+                liveIds.push_back(nextId++);
+            }
+            else {
+                auto index = rng() % liveIds.size();
+                ops.push_back({HeapTraceOp::Type::Free, liveIds[index]});
+                liveIds[index] = liveIds.back();
+                liveIds.pop_back();
+            }
+        }
+        return ops;
+    }
+
+    // 每行为 "a <id> <size> <alignment>" 或 "f <id>"
+    // 记录中的 id 重新映射为连续的编号，重复分配、释放未分配的 id 及格式错误的行会被跳过
+    static bool LoadTrace(const std::string& path, std::vector<HeapTraceOp>& ops)
+    {
+        std::ifstream file{path};
+        if (!file.is_open()) return false;
+
+        std::unordered_map<std::uint32_t, std::uint32_t> liveIds{};
+        std::uint32_t nextId = 0;
+        std::uint32_t numSkipped = 0;
+        std::string line{};
+        while (std::getline(file, line)) {
+            std::istringstream stream{line};
+            char type{};
+            std::uint32_t id{};
+            if (!(stream >> type >> id)) continue;
+
+            HeapTraceOp op{};
+            if (type == 'a') {
+                if (!(stream >> op.m_Size >> op.m_Alignment) || op.m_Size == 0 ||
+                    !std::has_single_bit(op.m_Alignment) || !liveIds.emplace(id, nextId).second) {
+                    ++numSkipped;
+                    continue;
+                }
+                op.m_Type = HeapTraceOp::Type::Allocate;
+                op.m_Id = nextId++;
+            }
+            else if (type == 'f') {
+                auto it = liveIds.find(id);
+                if (it == liveIds.end()) {
+                    ++numSkipped;
+                    continue;
+                }
+                op.m_Type = HeapTraceOp::Type::Free;
+                op.m_Id = it->second;
+                liveIds.erase(it);
+            }
+            else {
+                ++numSkipped;
+                continue;
+            }
+            ops.push_back(op);
+        }
+
+        if (numSkipped > 0) {
+            std::printf("Skipped %u invalid trace ops\n", numSkipped);
+        }
+        return true;
+    }
+
+    static void SaveTrace(const std::string& path, const std::vector<HeapTraceOp>& ops)
+    {
+        std::ofstream file{path};
+        for (const auto& op : ops) {
+            if (op.m_Type == HeapTraceOp::Type::Allocate) {
+                file << "a " << op.m_Id << ' ' << op.m_Size << ' ' << op.m_Alignment << '\n';
+            }
+            else {
+                file << "f " << op.m_Id << '\n';
+            }
+        }
+    }
+
+    // 与 GpuResourceAllocator 相同的换页策略，不创建设备对象
+    template <typename TAllocator>
+    class HeapPool
+    {
+    public:
+        bool Allocate(std::uint32_t id, std::uint64_t size, std::uint64_t alignment)
+        {
+            if (id >= m_Records.size()) {
+                m_Records.resize(id + 1);
+            }
+            if (size > kHeapSize) {
+                m_Records[id] = {kCommitted};
+                ++m_NumCommitted;
+                return true;
+            }
+
+            if (m_CurrPage == kInvalidPage) {
+                m_CurrPage = RequestPage();
+            }
+            while (!TryAllocate(m_CurrPage, id, size, alignment)) {
+                m_FullPages.insert(m_CurrPage);
+                m_CurrPage = RequestPage();
+            }
+            m_UsedSize += size;
+            m_PeakUsedSize = std::max(m_PeakUsedSize, m_UsedSize);
+            return true;
+        }
+
+        void Free(std::uint32_t id)
+        {
+            // 未分配或已释放的 id 直接忽略
+            if (id >= m_Records.size() || m_Records[id].m_Page == kInvalidPage) return;
+            auto record = std::exchange(m_Records[id], {});
+            if (record.m_Page == kCommitted) return;
+
+            auto& page = m_Pages[record.m_Page];
+            --page.m_NumResources;
+            m_UsedSize -= record.m_Size;
+            if constexpr (std::is_same_v<TAllocator, TLSFAllocator>) {
+                page.m_Allocator.Free(record.m_Block);
+                if (m_FullPages.erase(record.m_Page) > 0) {
+                    m_AvailablePages.push(record.m_Page);
+                }
+            }
+            else {
+                // 线性分配只能在页中所有资源都释放后才能复用
+                if (page.m_NumResources == 0 && m_FullPages.erase(record.m_Page) > 0) {
+                    page.m_Allocator.Clear();
+                    m_AvailablePages.push(record.m_Page);
+                }
+            }
+        }
+
+        HeapReplayResult GetResult() const
+        {
+            HeapReplayResult result{};
+            result.m_NumHeaps = static_cast<std::uint32_t>(m_Pages.size());
+            result.m_NumCommitted = m_NumCommitted;
+            result.m_PeakUsedSize = m_PeakUsedSize;
+
+            // 线性分配器的空闲空间只有尾部，不存在外部碎片
+            if constexpr (std::is_same_v<TAllocator, TLSFAllocator>) {
+                float fragmentation = 0;
+                for (const auto& page : m_Pages) {
+                    fragmentation += page.m_Allocator.Fragmentation();
+                }
+                result.m_Fragmentation = m_Pages.empty() ? 0 : fragmentation / m_Pages.size();
+            }
+            return result;
+        }
+
+    private:
+        static constexpr std::uint32_t kInvalidPage = (std::numeric_limits<std::uint32_t>::max)();
+        static constexpr std::uint32_t kCommitted = kInvalidPage - 1;
+
+        struct Page
+        {
+            Page() : m_Allocator(kHeapSize) {}
+
+            TAllocator m_Allocator;
+            std::uint32_t m_NumResources = 0;
+        };
+        struct Record
+        {
+            std::uint32_t m_Page = kInvalidPage;
+            TLSFAllocator::BlockHandle m_Block = TLSFAllocator::INVALID_BLOCK;
+            std::uint64_t m_Size = 0;
+        };
+
+        bool TryAllocate(std::uint32_t pageIndex, std::uint32_t id, std::uint64_t size, std::uint64_t alignment)
+        {
+            auto& page = m_Pages[pageIndex];
+            auto& record = m_Records[id];
+            if constexpr (std::is_same_v<TAllocator, TLSFAllocator>) {
+                auto allocation = page.m_Allocator.Allocate(size, alignment);
+                if (!allocation.IsValid()) return false;
+                record.m_Block = allocation.m_Block;
+            }
+            else {
+                if (page.m_Allocator.Allocate(size, static_cast<std::uint32_t>(alignment)) == Utility::INVALID_ALLOC_OFFSET) {
+                    return false;
+                }
+            }
+            record.m_Page = pageIndex;
+            record.m_Size = size;
+            ++page.m_NumResources;
+            return true;
+        }
+
+        std::uint32_t RequestPage()
+        {
+            if (!m_AvailablePages.empty()) {
+                auto pageIndex = m_AvailablePages.front();
+                m_AvailablePages.pop();
+                return pageIndex;
+            }
+            m_Pages.emplace_back();
+            return static_cast<std::uint32_t>(m_Pages.size() - 1);
+        }
+
+    private:
+        std::deque<Page> m_Pages{};
+        std::vector<Record> m_Records{};
+        std::uint32_t m_CurrPage = kInvalidPage;
+        std::set<std::uint32_t> m_FullPages{};
+        std::queue<std::uint32_t> m_AvailablePages{};
+
+        std::uint32_t m_NumCommitted = 0;
+        std::uint64_t m_UsedSize = 0;
+        std::uint64_t m_PeakUsedSize = 0;
+    };
+
+    template <typename TAllocator>
+    static HeapReplayResult ReplayTrace(const std::vector<HeapTraceOp>& ops)
+    {
+        HeapPool<TAllocator> pool{};
+        Stopwatch stopwatch{};
+        for (const auto& op : ops) {
+            if (op.m_Type == HeapTraceOp::Type::Allocate) {
+                pool.Allocate(op.m_Id, op.m_Size, op.m_Alignment);
+            }
+            else {
+                pool.Free(op.m_Id);
+            }
+        }
+        auto milliseconds = stopwatch.ElapsedMilliseconds();
+
+        auto result = pool.GetResult();
+        result.m_Milliseconds = milliseconds;
+        return result;
+    }
+
+    static void PrintResult(const char* name, const HeapReplayResult& result, std::size_t numOps)
+    {
+        std::printf("%-8s %10.3f ms %8.1f ns/op   heaps: %4u (%6llu MB)   committed: %4u   peak used: %6llu MB   fragmentation: %.3f\n",
+            name,
+            result.m_Milliseconds,
+            result.m_Milliseconds * 1e6 / std::max<std::size_t>(numOps, 1),
+            result.m_NumHeaps,
+            static_cast<unsigned long long>(result.m_NumHeaps * kHeapSize >> 20),
+            result.m_NumCommitted,
+            static_cast<unsigned long long>(result.m_PeakUsedSize >> 20),
+            result.m_Fragmentation);
+    }
+
+    int RunHeapTraceBenchmark(const BenchmarkArgs& args)
+    {
+        std::vector<HeapTraceOp> ops{};
+        if (!args.m_TracePath.empty()) {
+            if (!LoadTrace(args.m_TracePath, ops)) {
+                std::printf("Failed to open trace file: %s\n", args.m_TracePath.c_str());
+                return 1;
+            }
+        }
+        else {
+            ops = GenerateStreamingTrace(args.m_NumOps, args.m_Seed);
+        }
+        if (!args.m_RecordPath.empty()) {
+            SaveTrace(args.m_RecordPath, ops);
+        }
+
+        std::printf("Heap trace replay: %zu ops, heap size %llu MB\n",
+            ops.size(), static_cast<unsigned long long>(kHeapSize >> 20));
+        PrintResult("Linear", ReplayTrace<LinearAllocator>(ops), ops.size());
+        PrintResult("TLSF", ReplayTrace<TLSFAllocator>(ops), ops.size());
+
+        return 0;
+    }
+}
@@ -0,0 +1,100 @@
+#include "Benchmark.h"
+#include "Graphics/RenderContext.h"
+#include "Graphics/Resource/GpuResource.h"
+#include <random>
+
+namespace DSM::Benchmark {
+
+    static GpuResourceDesc GetRandomResourceDesc(std::mt19937& rng)
+    {
+        GpuResourceDesc resourceDesc{};
+        auto& desc = resourceDesc.m_Desc;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.SampleDesc.Count = 1;
+
+        // 大部分为小纹理，少量缓冲区和渲染目标
+        auto type = rng() % 10;
+        if (type < 2) {
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Width = 1024ull << (rng() % 8);
+            desc.Height = 1;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        }
+        else {
+            std::uint32_t extent = 32u << (rng() % 6);
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            desc.Width = extent;
+            desc.Height = extent;
+            desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (type == 9) {
+                desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+            }
+        }
+        return resourceDesc;
+    }
+
+    // 每个线程保留一定数量的常驻资源，每次创建一个新资源并释放最早的资源
+    static void RunCreateReleasePairs(std::uint32_t numPairs, std::uint32_t seed)
+    {
+        constexpr std::size_t numLiveResources = 256;
+
+        std::mt19937 rng{seed};
+        std::vector<GpuResource> liveResources(numLiveResources);
+        for (std::uint32_t i = 0; i < numPairs; ++i) {
+            auto& resource = liveResources[i % numLiveResources];
+            // 重新创建时会先释放旧的资源
+            resource.Create(L"BenchmarkResource", GetRandomResourceDesc(rng));
+        }
+    }
+
+    // MSAA 渲染目标需要 4MB 对齐，应放置在 MSAA 池中
+    static bool CheckMsaaRenderTarget()
+    {
+        GpuResourceDesc resourceDesc{};
+        auto& desc = resourceDesc.m_Desc;
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = 1280;
+        desc.Height = 720;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 4;
+        desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+        GpuResource resource{L"MsaaRenderTarget", resourceDesc};
+        const auto& allocation = resource.GetAllocation();
+        bool passed = resource.GetResource() != nullptr &&
+            allocation.IsPlaced() &&
+            allocation.m_SizeClass == GpuResourceSizeClass::MSAA &&
+            allocation.m_Offset % D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT == 0;
+        std::printf("MSAA render target placement: %s\n", passed ? "passed" : "failed");
+        return passed;
+    }
+
+    int RunResourceAllocatorBenchmark(const BenchmarkArgs& args)
+    {
+        if (!CheckMsaaRenderTarget()) {
+            return 1;
+        }
+
+        std::printf("GpuResource create/release: %u pairs\n", args.m_NumPairs);
+        for (std::uint32_t numThreads : {1u, 4u}) {
+            std::vector<std::thread> threads{};
+            Stopwatch stopwatch{};
+            for (std::uint32_t i = 0; i < numThreads; ++i) {
+                threads.emplace_back(RunCreateReleasePairs, args.m_NumPairs / numThreads, args.m_Seed + i);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            auto milliseconds = stopwatch.ElapsedMilliseconds();
+
+            std::printf("%u thread(s) %10.3f ms %8.1f ns/pair\n",
+                numThreads, milliseconds, milliseconds * 1e6 / std::max(args.m_NumPairs, 1u));
+        }
+
+        return 0;
+    }
+}
@@ -0,0 +1,48 @@
+#include "Benchmark.h"
+#include "Graphics/RenderContext.h"
+
+using namespace DSM;
+
+// 用法: AllocatorBenchmark [--trace <file>] [--record <file>] [--ops <count>] [--pairs <count>] [--seed <seed>]
+int main(int argc, char* argv[])
+{
+    Benchmark::BenchmarkArgs args{};
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view option{argv[i]};
+        if (option == "--trace") {
+            args.m_TracePath = argv[i + 1];
+        }
+        else if (option == "--record") {
+            args.m_RecordPath = argv[i + 1];
+        }
+        else if (option == "--ops") {
+            args.m_NumOps = static_cast<std::uint32_t>(std::stoul(argv[i + 1]));
+        }
+        else if (option == "--pairs") {
+            args.m_NumPairs = static_cast<std::uint32_t>(std::stoul(argv[i + 1]));
+        }
+        else if (option == "--seed") {
+            args.m_Seed = static_cast<std::uint32_t>(std::stoul(argv[i + 1]));
+        }
+        else {
+            std::printf("Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (int ret = Benchmark::RunHeapTraceBenchmark(args); ret != 0) {
+        return ret;
+    }
+
+    g_RenderContext.CreateHeadless(DeviceBackend::Null);
+    int ret = Benchmark::RunResourceAllocatorBenchmark(args);
+    if (ret == 0) {
+        ret = Benchmark::RunDynamicBufferBenchmark(args);
+    }
+    if (ret == 0) {
+        ret = Benchmark::RunCommandStreamBenchmark(args);
+    }
+    g_RenderContext.Shutdown();
+
+    return ret;
+}
@@ -0,0 +1,12 @@
+targetName = "AllocatorBenchmark"
+target(targetName)
+    set_kind("binary")
+    set_targetdir(path.join(binDir, targetName))
+
+    add_deps("DSMEngine")
+    add_defines("_CONSOLE")
+
+    add_files("**.cpp")
+    add_headerfiles("**.h")
+
+target_end()
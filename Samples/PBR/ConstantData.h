@@ -3,6 +3,7 @@
 #define  __CONSTANTDATA_H__
 
 #include "Math/Matrix.h"
+#include "Material.h"
 
 
 namespace DSM {
@@ -20,6 +21,8 @@ namespace DSM {
         float m_NormalTexScale = 1;
         float m_MetallicFactor = 1;
         float m_RoughnessFactor = 1;
+        // 纹理在常驻描述符堆中的索引
+        std::array<std::uint32_t, kNumTextures> m_TextureIndices{};
     };
 
     __declspec(align(256)) struct PassConstants
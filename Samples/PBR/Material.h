@@ -18,7 +18,7 @@ namespace DSM {
         float m_NormalTexScale = 1;
         float m_MetallicFactor = 1;
         float m_RoughnessFactor = 1;
-		std::array<std::uint32_t, kNumTextures> m_TextureIndices;
+		std::array<std::uint32_t, kNumTextures> m_TextureIndices{};
     };
 }
 
@@ -41,8 +41,6 @@ namespace DSM {
 			std::uint32_t m_IndexOffset;
 			std::uint32_t m_VertexOffset;
 			std::uint16_t m_MaterialIndex;
-			// 使用的纹理在描述符堆中的偏移
-			std::uint16_t m_SRVTableOffset;
 		};
 		std::map<std::string, SubMesh> m_SubMeshes;
 
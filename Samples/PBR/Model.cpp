@@ -5,7 +5,7 @@
 using namespace DirectX;
 
 namespace DSM {
-    void Model::Render(MeshSorter& meshSorter, GpuBuffer& meshConstant, const Transform& meshTransforms)
+    void Model::Render(MeshSorter& meshSorter, PerFrameBuffer& meshConstant, const Transform& meshTransforms) const
     {
         BoundingBox modelBoudingVS{};
         Math::Matrix4 MV = meshTransforms.GetLocalToWorld() * meshSorter.GetViewMatrix();
@@ -21,7 +21,7 @@ namespace DSM {
             //if (meshSorter.GetViewFrustum().Intersects(boxVS)) {
                 for (const auto& [name, submesh] : mesh->m_SubMeshes) {
                     float distance = boxVS.Center.z - boxVS.Extents.z;
-                    meshSorter.AddMesh(*mesh, distance,
+                    meshSorter.AddMesh(*mesh, submesh, distance,
                         meshConstant.GetGpuVirtualAddress(),
                         m_MaterialData.GetGpuVirtualAddress() + 
                             submesh.m_MaterialIndex * sizeof(MaterialConstants));
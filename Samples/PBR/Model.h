@@ -5,6 +5,7 @@
 #include "Mesh.h"
 #include "Renderer/TextureManager.h"
 #include "Math/Transform.h"
+#include "Graphics/Resource/PerFrameBuffer.h"
 
 namespace DSM {
     class MeshSorter;
@@ -12,7 +13,7 @@ namespace DSM {
     // 模型的数据
     struct Model
     {
-        void Render(MeshSorter& meshSorter, GpuBuffer& meshConstant, const Transform& meshTransforms);
+        void Render(MeshSorter& meshSorter, PerFrameBuffer& meshConstant, const Transform& meshTransforms) const;
         
         std::string m_Name{};
         DirectX::BoundingBox m_BoundingBox{};
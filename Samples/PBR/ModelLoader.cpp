@@ -6,6 +6,7 @@
 #include "Material.h"
 #include "Renderer.h"
 #include "Graphics/CommandList/CommandList.h"
+#include "Graphics/CommandList/UploadBatch.h"
 #include "Graphics/GraphicsCommon.h"
 #include <filesystem>
 
@@ -232,29 +233,33 @@ namespace DSM {
 		
 		D3D12_GPU_VIRTUAL_ADDRESS bufferLocation = mesh.m_MeshData.GetGpuVirtualAddress();
 		std::uint32_t offset = 0;
-		CommandList::InitBuffer(mesh.m_MeshData, positions.data(), posByteSize, offset);
+		// 网格的所有数据流合并为一次复制队列提交
+		UploadBatch uploadBatch{L"MeshData"};
+		uploadBatch.UploadBuffer(mesh.m_MeshData, positions.data(), posByteSize, offset);
 		mesh.m_PositionStream = {bufferLocation + offset, posByteSize, sizeof(XMFLOAT3)};
 		offset += posByteSize;
 
 		if (normals.size() > 0) {
-			CommandList::InitBuffer(mesh.m_MeshData, normals.data(), normalByteSize, offset);
+			uploadBatch.UploadBuffer(mesh.m_MeshData, normals.data(), normalByteSize, offset);
 			mesh.m_NormalStream = {bufferLocation + offset, normalByteSize, sizeof(XMFLOAT3)};
 			offset += normalByteSize;
 		}
 		if (uvs.size() > 0) {
-			CommandList::InitBuffer(mesh.m_MeshData, uvs.data(), uvsByteSize, offset);
+			uploadBatch.UploadBuffer(mesh.m_MeshData, uvs.data(), uvsByteSize, offset);
 			mesh.m_UVStream = {bufferLocation + offset, uvsByteSize, sizeof(XMFLOAT2)};
 			offset += uvsByteSize;
 		}
 		if (tangents.size() > 0) {
-			CommandList::InitBuffer(mesh.m_MeshData, tangents.data(), tangentsByteSize, offset);
+			uploadBatch.UploadBuffer(mesh.m_MeshData, tangents.data(), tangentsByteSize, offset);
 			mesh.m_TangentStream = {bufferLocation + offset, tangentsByteSize, sizeof(XMFLOAT4)};
 			offset += tangentsByteSize;
 		}
 
-		CommandList::InitBuffer(mesh.m_MeshData, indices.data(), indexByteSize, offset);
+		uploadBatch.UploadBuffer(mesh.m_MeshData, indices.data(), indexByteSize, offset);
 		mesh.m_IndexBufferViews = D3D12_INDEX_BUFFER_VIEW{bufferLocation + offset, indexByteSize, DXGI_FORMAT_R32_UINT};
 		offset += indexByteSize;
+
+		uploadBatch.Submit().StallQueue(g_RenderContext.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT));
 	}
 
 	void ProcessMaterial(
@@ -262,8 +267,6 @@ namespace DSM {
 		const std::string& filename,
 		const aiScene* scene)
 	{
-		std::vector<std::uint32_t> srvOffsets(scene->mNumMaterials);
-		
 		model.m_Materials.resize(scene->mNumMaterials);
 		for (UINT i = 0; i < scene->mNumMaterials; ++i) {
 			auto& modelMaterial = model.m_Materials[i];
@@ -297,16 +300,16 @@ namespace DSM {
 			std::filesystem::path texFilename;
 			std::string texName;
 
-			D3D12_CPU_DESCRIPTOR_HANDLE defaultTexture[kNumTextures] = {
-				Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-				Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-				Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-				Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-				Graphics::GetDefaultTexture(Graphics::kBlackTransparent2D),
-				Graphics::GetDefaultTexture(Graphics::kDefaultNormalTex)
+			std::uint32_t defaultTexture[kNumTextures] = {
+				Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+				Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+				Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+				Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+				Graphics::GetDefaultTextureIndex(Graphics::kBlackTransparent2D),
+				Graphics::GetDefaultTextureIndex(Graphics::kDefaultNormalTex)
 			};
 			
-			D3D12_CPU_DESCRIPTOR_HANDLE srcHandle[kNumTextures];
+			auto& textureIndices = modelMaterial->m_TextureIndices;
 			
 			auto tryCreateTexture = [&](aiTextureType type) {
 				MaterialTex materialTex;
@@ -320,7 +323,7 @@ namespace DSM {
 					default: materialTex = kBaseColor; break;
 				}
 				if (material->GetTextureCount(type) == 0) {
-					srcHandle[materialTex] = defaultTexture[materialTex];
+					textureIndices[materialTex] = defaultTexture[materialTex];
 					return;
 				}
 				
@@ -342,14 +345,14 @@ namespace DSM {
 					texDesc.m_DepthOrArraySize = 1;
 					TextureRef& texRef = model.m_Textures.emplace_back(
 						g_TexManager.LoadTextureFromMemory(texName, texDesc, pTex->pcData));
-					srcHandle[materialTex] = texRef.GetSRV();
+					textureIndices[materialTex] = texRef.GetBindlessIndex();
 				}
 				else {	// 纹理通过文件名索引
 					texFilename = filename;
 					texFilename = texFilename.parent_path() / aiPath.C_Str();
 					TextureRef& texRef = model.m_Textures.emplace_back(
 						g_TexManager.LoadTextureFromFile(texFilename.string()));
-					srcHandle[materialTex] = texRef.GetSRV();
+					textureIndices[materialTex] = texRef.GetBindlessIndex();
 				}
 			};
 			// 加载纹理
@@ -359,22 +362,12 @@ namespace DSM {
 			tryCreateTexture(aiTextureType_AMBIENT_OCCLUSION);
 			tryCreateTexture(aiTextureType_EMISSIVE);
 			tryCreateTexture(aiTextureType_NORMALS);
-
-			// 将纹理描述符拷贝到纹理堆中
-			DescriptorHandle texHandle = g_Renderer.m_TextureHeap.Allocate(kNumTextures);
-			std::uint32_t destCount = kNumTextures;
-			std::uint32_t srcCount[kNumTextures] = {1,1,1,1,1,1};
-			g_RenderContext.GetDevice()->CopyDescriptors(
-				1, &texHandle, &destCount, destCount, srcHandle, srcCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-			srvOffsets[i] = g_Renderer.m_TextureHeap.GetOffsetOfHandle(texHandle);
 		}
 
 		for (auto& mesh : model.m_Meshes) {
 			int psoFlags = 0;
 			std::uint32_t num = 1;
 			for (auto& [name, submesh] : mesh->m_SubMeshes) {
-				submesh.m_SRVTableOffset = srvOffsets[submesh.m_MaterialIndex];
 				auto& material = scene->mMaterials[submesh.m_MaterialIndex];
 				if (aiReturn_SUCCESS == material->Get(AI_MATKEY_TWOSIDED, &psoFlags, &num)) {
 					mesh->m_PSOFlags |= (psoFlags == 0) ? mesh->m_PSOFlags : kBothSide;
@@ -385,7 +378,7 @@ namespace DSM {
 
 		std::vector<MaterialConstants> materialConstants(model.m_Materials.size());
 		for (std::size_t i = 0; i < model.m_Materials.size(); i++) {
-			memcpy(&materialConstants[i], model.m_Materials[i].get(), sizeof(MaterialConstants));
+			memcpy(&materialConstants[i], model.m_Materials[i].get(), sizeof(Material));
 		}
 		GpuBufferDesc bufferDesc = {};
 		bufferDesc.m_Size = sizeof(MaterialConstants) * materialConstants.size();
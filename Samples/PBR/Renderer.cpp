@@ -3,6 +3,7 @@
 #include "ConstantData.h"
 #include "Mesh.h"
 #include "Renderer/TextureManager.h"
+#include "Core/JobSystem.h"
 #include "Graphics/GraphicsCommon.h"
 #include "Graphics/RenderContext.h"
 #include "Graphics/CommandList/GraphicsCommandList.h"
@@ -21,16 +22,18 @@ namespace DSM {
         m_RootSignature[kMeshConstants].InitAsConstantBuffer(kMeshConstants);
         m_RootSignature[kMaterialConstants].InitAsConstantBuffer(kMaterialConstants);
         m_RootSignature[kPassConstants].InitAsConstantBuffer(kPassConstants);
-        m_RootSignature[kMaterialSRVs].InitAsDescriptorRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 0, 10, D3D12_SHADER_VISIBILITY_PIXEL);
+        // 材质纹理通过索引从常驻描述符堆中访问
+        m_RootSignature[kBindlessSRVs].InitAsDescriptorRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 0, UINT_MAX, D3D12_SHADER_VISIBILITY_PIXEL, 1);
 		m_RootSignature[kCommonSRVs].InitAsDescriptorRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 10, 10, D3D12_SHADER_VISIBILITY_PIXEL);
         m_RootSignature.Finalize(L"RendererRootSignature", D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
         const auto& swapChain = g_RenderContext.GetSwapChain();
-        m_CommonTexture = m_TextureHeap.Allocate(1);
+        m_CommonTextureIndex = g_RenderContext.GetBindlessHeap().Allocate();
         m_SceneColorSRV = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
         m_SceneColorRTV = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
         m_SceneDepthSRV = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
         m_SceneDepthDSV = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+        m_SceneDepthDSVReadOnly = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
         m_ShadowMapSRV = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
         m_ShadowMapDSV = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
         m_ShadowMapDSVReadOnly = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
@@ -147,16 +150,18 @@ namespace DSM {
     void Renderer::Shutdown()
     {
         m_Initialized = false;
-        m_TextureHeap.Clear();
-        m_ShadowMap.GetDesc();
-        m_SceneColorTexture.Destroy();
-        m_SceneDepthTexture.Destroy();
+        m_ParallelCmdLists.clear();
+        g_RenderContext.FreeBindlessDescriptor(m_CommonTextureIndex);
+        m_CommonTextureIndex = BindlessDescriptorHeap::INVALID_INDEX;
+        DestroyTransientResources();
         g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_SceneColorSRV);
         g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, m_SceneColorRTV);
         g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_SceneDepthSRV);
         g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, m_SceneDepthDSV);
+        g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, m_SceneDepthDSVReadOnly);
         g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_ShadowMapSRV);
         g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, m_ShadowMapDSV);
+        g_RenderContext.FreeDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, m_ShadowMapDSVReadOnly);
     }
 
     std::uint16_t Renderer::GetPSO(std::uint16_t psoFlags)
@@ -219,65 +224,144 @@ namespace DSM {
 
     void Renderer::OnResize(std::uint32_t width, std::uint32_t height)
     {
-		width = max(width, 1u);
-		height = max(height, 1u);
-        TextureDesc texDesc{};
-        texDesc.m_Width = width;
-        texDesc.m_Height = height;
-        texDesc.m_Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-        texDesc.m_Format = g_RenderContext.GetSwapChain().GetBackBuffer()->GetFormat();
-        texDesc.m_Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-        D3D12_CLEAR_VALUE clearValue{};
-        clearValue.Format = texDesc.m_Format;
-        m_SceneColorTexture.Create(L"Renderer::SceneColorTexture", texDesc, clearValue);
+		m_Width = max(width, 1u);
+		m_Height = max(height, 1u);
+        // 阴影贴图与屏幕大小一致
+        m_ShadowMapWidth = m_Width;
+        m_ShadowMapHeight = m_Height;
+        CreateTransientResources();
+    }
+    
+    void Renderer::ResizeShadowMap(std::uint32_t width, std::uint32_t height)
+    {
+        ASSERT(width > 0 && height > 0);
+        m_ShadowMapWidth = width;
+        m_ShadowMapHeight = height;
+        CreateTransientResources();
+    }
+
+    void Renderer::BeginTransientPass(CommandList& cmdList, TransientPass pass)
+    {
+        auto textures = GetTransientTextures();
+        for (std::uint32_t i = 0; i < kNumTransientResources; ++i) {
+            if (m_TransientFirstUse[i] != pass || !m_TransientHeap.IsAliased(i)) continue;
+
+            auto aliasedIndex = m_TransientHeap.GetAliasedIndex(i);
+            auto before = aliasedIndex == TransientResourceHeap::INVALID_INDEX ? nullptr : textures[aliasedIndex];
+            cmdList.InsertAliasBarrier(before, *textures[i]);
+        }
+    }
+
+    GraphicsCommandList& Renderer::GetParallelCommandList(std::uint32_t index)
+    {
+        while (m_ParallelCmdLists.size() <= index) {
+            auto name = L"Renderer::Parallel" + std::to_wstring(m_ParallelCmdLists.size());
+            // 并行录制到命令流，提交时再统一翻译
+            m_ParallelCmdLists.emplace_back(std::make_unique<GraphicsCommandList>(name, true));
+        }
+        return *m_ParallelCmdLists[index];
+    }
+
+    void Renderer::CreateTransientResources()
+    {
+        DestroyTransientResources();
+
+        auto getTextureDesc = [](std::uint32_t width, std::uint32_t height, DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags) {
+            D3D12_RESOURCE_DESC resourceDesc{};
+            resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            resourceDesc.Width = width;
+            resourceDesc.Height = height;
+            resourceDesc.DepthOrArraySize = 1;
+            resourceDesc.MipLevels = 1;
+            resourceDesc.Format = format;
+            resourceDesc.SampleDesc = { 1, 0 };
+            resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            resourceDesc.Flags = flags;
+            return resourceDesc;
+        };
+
+        // 生命周期重叠的资源分开放置，其余的共享内存
+        std::array<TransientResourceDesc, kNumTransientResources> transientDescs{};
+        auto& sceneColor = transientDescs[kSceneColor];
+        auto colorFormat = g_RenderContext.GetSwapChain().GetBackBuffer()->GetFormat();
+        sceneColor.m_Desc = getTextureDesc(m_Width, m_Height, colorFormat, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+        sceneColor.m_ClearValue.Format = colorFormat;
+        sceneColor.m_HasClearValue = true;
+        sceneColor.m_FirstUse = kOpaquePass;
+        // 最后复制到后台缓冲区
+        sceneColor.m_LastUse = kPostPass;
+
+        auto& sceneDepth = transientDescs[kSceneDepth];
+        sceneDepth.m_Desc = getTextureDesc(m_Width, m_Height, DXGI_FORMAT_D24_UNORM_S8_UINT, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+        sceneDepth.m_ClearValue.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+        sceneDepth.m_ClearValue.DepthStencil.Depth = 1.f;
+        sceneDepth.m_ClearValue.DepthStencil.Stencil = 0;
+        sceneDepth.m_HasClearValue = true;
+        sceneDepth.m_FirstUse = kOpaquePass;
+        sceneDepth.m_LastUse = kOpaquePass;
+
+        auto& shadowMap = transientDescs[kShadowMap];
+        shadowMap.m_Desc = getTextureDesc(m_ShadowMapWidth, m_ShadowMapHeight, DXGI_FORMAT_R24G8_TYPELESS, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+        shadowMap.m_ClearValue = D3D12_CLEAR_VALUE{DXGI_FORMAT_D24_UNORM_S8_UINT, 1, 0};
+        shadowMap.m_HasClearValue = true;
+        shadowMap.m_FirstUse = kShadowPass;
+        // 不透明 Pass 中会采样阴影贴图
+        shadowMap.m_LastUse = kOpaquePass;
+
+        std::array<ID3D12Resource*, kNumTransientResources> resources{};
+        auto& allocator = GetGpuResourceAllocator(DSMHeapDesc{ D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_NONE });
+        allocator.CreateTransientResources(transientDescs, m_TransientHeap, resources);
+        for (std::uint32_t i = 0; i < kNumTransientResources; ++i) {
+            m_TransientFirstUse[i] = transientDescs[i].m_FirstUse;
+        }
+
+        m_SceneColorTexture.Create(L"Renderer::SceneColorTexture", resources[kSceneColor]);
         m_SceneColorTexture.CreateShaderResourceView(m_SceneColorSRV);
         m_SceneColorTexture.CreateRenderTargetView(m_SceneColorRTV);
 
-        texDesc.m_Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-        texDesc.m_Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
-        clearValue.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-        clearValue.DepthStencil.Depth = 1.f;
-        clearValue.DepthStencil.Stencil = 0;
-        m_SceneDepthTexture.Create(L"Renderer::SceneDepthTexture", texDesc, clearValue);
-        m_SceneDepthDSVReadOnly = g_RenderContext.AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+        m_SceneDepthTexture.Create(L"Renderer::SceneDepthTexture", resources[kSceneDepth]);
         m_SceneDepthTexture.CreateShaderResourceView(m_SceneDepthSRV);
         m_SceneDepthTexture.CreateDepthStencilView(m_SceneDepthDSV);
         m_SceneDepthTexture.CreateDepthStencilView(m_SceneDepthDSVReadOnly, D3D12_DSV_FLAG_READ_ONLY_DEPTH);
 
-        ResizeShadowMap(width, height);
-    }
-    
-    void Renderer::ResizeShadowMap(std::uint32_t width, std::uint32_t height)
-    {
-        ASSERT(width > 0 && height > 0);
-        TextureDesc shadowMapDesc = {};
-        shadowMapDesc.m_Width = width;
-        shadowMapDesc.m_Height = height;
-        shadowMapDesc.m_Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-        shadowMapDesc.m_Format = DXGI_FORMAT_R24G8_TYPELESS;
-        shadowMapDesc.m_Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
-        m_ShadowMap.Create(L"Renderer::ShadowMap", shadowMapDesc, D3D12_CLEAR_VALUE{DXGI_FORMAT_D24_UNORM_S8_UINT, 1, 0});
+        m_ShadowMap.Create(L"Renderer::ShadowMap", resources[kShadowMap]);
         m_ShadowMap.CreateShaderResourceView(m_ShadowMapSRV);
         m_ShadowMap.CreateDepthStencilView(m_ShadowMapDSV);
         m_ShadowMap.CreateDepthStencilView(m_ShadowMapDSVReadOnly, D3D12_DSV_FLAG_READ_ONLY_DEPTH);
         
-        std::uint32_t destCount = 1;
-        std::uint32_t srcCount[] = {1};
-        D3D12_CPU_DESCRIPTOR_HANDLE srcTex[] = {
-            m_ShadowMapSRV
-        };
-        g_RenderContext.GetDevice()->CopyDescriptors(
-            1, &m_CommonTexture, &destCount, 1, srcTex, srcCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        g_RenderContext.GetBindlessHeap().Update(m_CommonTextureIndex, m_ShadowMapSRV);
+    }
+
+    void Renderer::DestroyTransientResources()
+    {
+        // 放置资源需要先于堆释放
+        for (auto texture : GetTransientTextures()) {
+            texture->Destroy();
+        }
+        m_TransientHeap.Reset();
     }
     
     Renderer::Renderer()
-        :m_TextureHeap(L"Renderer::TexHeap", D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, sm_MaxTextureSize),
-        m_RootSignature(kNumRootBindings, 3),
+        :m_RootSignature(kNumRootBindings, 3),
         m_DefaultPSO(L"Renderer::DefaultPSO"),
         m_SkyboxPSO(L"Renderer::SkyboxPSO"){
     }
 
-    void MeshSorter::AddMesh(const Mesh& mesh, float distance,
+    Renderer::~Renderer()
+    {
+        Shutdown();
+    }
+
+    MeshSorter::MeshSorter(BatchType batchType)
+        :m_SortObjects(g_RenderContext.GetFrameArena()),
+        m_SortKey(g_RenderContext.GetFrameArena()),
+        m_BatchType(batchType)
+    {
+        m_SortObjects.reserve(sm_LastNumObjects[batchType]);
+        m_SortKey.reserve(sm_LastNumKeys[batchType]);
+    }
+
+    void MeshSorter::AddMesh(const Mesh& mesh, const Mesh::SubMesh& subMesh, float distance,
         D3D12_GPU_VIRTUAL_ADDRESS meshCBV,
         D3D12_GPU_VIRTUAL_ADDRESS matCBV)
     {
@@ -330,13 +414,16 @@ namespace DSM {
             m_PassCounts[kOpaque]++;
         }
 
-        SortObject sortObject{&mesh, meshCBV, matCBV};
+        SortObject sortObject{&mesh, &subMesh, meshCBV, matCBV};
         m_SortObjects.emplace_back(std::move(sortObject));
     }
 
     void MeshSorter::Sort()
     {
         std::sort(m_SortKey.begin(), m_SortKey.end());
+
+        sm_LastNumObjects[m_BatchType] = m_SortObjects.size();
+        sm_LastNumKeys[m_BatchType] = m_SortKey.size();
     }
 
     void MeshSorter::Render(DrawPass pass, GraphicsCommandList& cmdList, PassConstants& passConstants)
@@ -355,57 +442,110 @@ namespace DSM {
         cmdList.TransitionResource(*m_DepthTex, D3D12_RESOURCE_STATE_DEPTH_WRITE);
         cmdList.ClearDepth(m_DSV);
 
-        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> RTVs{};
         for (int i = 0; i < m_NumRTVs; ++i) {
             auto& renderTex = m_RenderTexs[i];
             cmdList.TransitionResource(*renderTex.m_RenderTex, D3D12_RESOURCE_STATE_RENDER_TARGET);
             cmdList.ClearRenderTarget(renderTex.m_RTV);
-            RTVs.emplace_back(renderTex.m_RTV);
         }
 
-        cmdList.SetRenderTargets(RTVs, m_DSV);
+        // 通道常量只上传一次，由各个命令列表共享
+        auto passCB = cmdList.GetUploadBuffer(sizeof(PassConstants), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        memcpy(passCB.m_MappedAddress, &passConstants, sizeof(PassConstants));
+
+        // 键值按 Pass 排序，不透明物体位于深度 Pass 之后
+        std::uint32_t drawBegin = 0;
+        for (uint32_t currPass = 0; currPass < kOpaque; ++currPass) {
+            drawBegin += m_PassCounts[currPass];
+        }
+        std::uint32_t drawEnd = drawBegin;
+        for (uint32_t currPass = kOpaque; currPass < kTransparent; ++currPass) {
+            drawEnd += m_PassCounts[currPass];
+        }
+
+        auto numDraws = drawEnd - drawBegin;
+        auto numLists = std::min({ (numDraws + sm_MinDrawsPerList - 1) / sm_MinDrawsPerList,
+            g_JobSystem.GetNumWorkers() + 1, sm_MaxParallelLists });
+        if (numLists <= 1) {
+            SetupPass(cmdList, passCB.m_GpuAddress);
+            RenderDraws(cmdList, drawBegin, drawEnd);
+            return;
+        }
+
+        // 第一个为调用者的命令列表，其中的屏障与清除需先于绘制执行
+        std::array<CommandList*, sm_MaxParallelLists + 1> cmdLists{};
+        cmdLists[0] = &cmdList;
+        for (std::uint32_t i = 0; i < numLists; ++i) {
+            cmdLists[i + 1] = &g_Renderer.GetParallelCommandList(i);
+        }
+
+        auto drawsPerList = (numDraws + numLists - 1) / numLists;
+        g_JobSystem.ParallelFor(numLists, 1, [&](std::uint32_t begin, std::uint32_t end) {
+            for (auto i = begin; i < end; ++i) {
+                auto& parallelList = cmdLists[i + 1]->GetGraphicsCommandList();
+                SetupPass(parallelList, passCB.m_GpuAddress);
+                RenderDraws(parallelList,
+                    drawBegin + i * drawsPerList,
+                    std::min(drawBegin + (i + 1) * drawsPerList, drawEnd));
+            }
+        });
+
+        // 按顺序排队，与调用者之后提交的命令列表一并提交，cmdList 可继续录制但需重新设置渲染目标
+        CommandList::QueueCommandLists({ cmdLists.data(), numLists + 1 });
+    }
+
+    void MeshSorter::SetupPass(GraphicsCommandList& cmdList, D3D12_GPU_VIRTUAL_ADDRESS passCBV)
+    {
+        std::array<D3D12_CPU_DESCRIPTOR_HANDLE, 8> RTVs{};
+        for (int i = 0; i < m_NumRTVs; ++i) {
+            RTVs[i] = m_RenderTexs[i].m_RTV;
+        }
+
+        cmdList.SetRenderTargets(std::span{RTVs.data(), m_NumRTVs}, m_DSV);
         cmdList.SetViewportAndScissor(m_Camera->GetViewPort(), m_Scissor);
     
         cmdList.SetRootSignature(g_Renderer.m_RootSignature);
         cmdList.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-        cmdList.SetDescriptorHeap(g_Renderer.m_TextureHeap.GetHeap());
-        cmdList.SetDynamicConstantBuffer(Renderer::kPassConstants, sizeof(PassConstants), &passConstants);
-        cmdList.SetDescriptorTable(Renderer::kCommonSRVs, g_Renderer.m_CommonTexture);
+        // 所有纹理都位于常驻描述符堆中，整个 Pass 只需绑定一次
+        auto& bindlessHeap = g_RenderContext.GetBindlessHeap();
+        cmdList.SetDescriptorHeap(bindlessHeap.GetHeap());
+        cmdList.SetConstantBuffer(Renderer::kPassConstants, passCBV);
+        cmdList.SetDescriptorTable(Renderer::kBindlessSRVs, bindlessHeap[0]);
+        cmdList.SetDescriptorTable(Renderer::kCommonSRVs, bindlessHeap[g_Renderer.m_CommonTextureIndex]);
+    }
 
-        for (uint32_t currPass = kOpaque; currPass < kTransparent; ++currPass) {
-            const uint32_t passCount = m_PassCounts[currPass];
-
-            for (uint32_t currDraw = 0; currDraw < passCount; ++currDraw) {
-                SortKey key{};
-                key.m_Value = m_SortKey[currDraw];
-                const SortObject& sortObject = m_SortObjects[key.m_ObjIndex];
-                const Mesh* mesh = sortObject.m_Mesh;
-
-                cmdList.SetConstantBuffer(Renderer::kMeshConstants, sortObject.m_MeshCBV);
-                cmdList.SetConstantBuffer(Renderer::kMaterialConstants, sortObject.m_MaterialCBV);
-
-                cmdList.SetPipelineState(g_Renderer.m_PSOs[key.m_PSOIndex]);
-
-                std::vector<D3D12_VERTEX_BUFFER_VIEW> vertexBufferViews{};
-                vertexBufferViews.emplace_back(mesh->m_PositionStream);
-                if ((mesh->m_PSOFlags & kHasUV) != 0) {
-                    vertexBufferViews.emplace_back(mesh->m_UVStream);
-                }
-                if ((mesh->m_PSOFlags & kHasNormal) != 0) {
-                    vertexBufferViews.emplace_back(mesh->m_NormalStream);
-                }
-                if ((mesh->m_PSOFlags & kHasTangent) != 0) {
-                    vertexBufferViews.emplace_back(mesh->m_TangentStream);
-                }
-                cmdList.SetVertexBuffers(0, vertexBufferViews);
-                cmdList.SetIndexBuffer(mesh->m_IndexBufferViews);
-
-                for (const auto& [name, submesh] : mesh->m_SubMeshes) {
-                    cmdList.SetDescriptorTable(Renderer::kMaterialSRVs, g_Renderer.m_TextureHeap[submesh.m_SRVTableOffset]);
-                    cmdList.DrawIndexed(submesh.m_IndexCount, submesh.m_IndexOffset, submesh.m_VertexOffset);
-                }
+    void MeshSorter::RenderDraws(GraphicsCommandList& cmdList, std::uint32_t begin, std::uint32_t end)
+    {
+        for (uint32_t currDraw = begin; currDraw < end; ++currDraw) {
+            SortKey key{};
+            key.m_Value = m_SortKey[currDraw];
+            const SortObject& sortObject = m_SortObjects[key.m_ObjIndex];
+            const Mesh* mesh = sortObject.m_Mesh;
+
+            cmdList.SetConstantBuffer(Renderer::kMeshConstants, sortObject.m_MeshCBV);
+            cmdList.SetConstantBuffer(Renderer::kMaterialConstants, sortObject.m_MaterialCBV);
+
+            cmdList.SetPipelineState(g_Renderer.m_PSOs[key.m_PSOIndex]);
+
+            // 最多包含位置、UV、法线及切线四个顶点流
+            std::array<D3D12_VERTEX_BUFFER_VIEW, 4> vertexBufferViews{};
+            std::uint32_t numViews = 0;
+            vertexBufferViews[numViews++] = mesh->m_PositionStream;
+            if ((mesh->m_PSOFlags & kHasUV) != 0) {
+                vertexBufferViews[numViews++] = mesh->m_UVStream;
             }
+            if ((mesh->m_PSOFlags & kHasNormal) != 0) {
+                vertexBufferViews[numViews++] = mesh->m_NormalStream;
+            }
+            if ((mesh->m_PSOFlags & kHasTangent) != 0) {
+                vertexBufferViews[numViews++] = mesh->m_TangentStream;
+            }
+            cmdList.SetVertexBuffers(0, std::span{vertexBufferViews.data(), numViews});
+            cmdList.SetIndexBuffer(mesh->m_IndexBufferViews);
+
+            // 材质常量中记录了纹理索引，无需切换描述符表
+            const auto& submesh = *sortObject.m_SubMesh;
+            cmdList.DrawIndexed(submesh.m_IndexCount, submesh.m_IndexOffset, submesh.m_VertexOffset);
         }
     }
 }
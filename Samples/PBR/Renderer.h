@@ -5,10 +5,13 @@
 #include "Mesh.h"
 #include "Core/Camera.h"
 #include "Graphics/DescriptorHeap.h"
+#include "Graphics/BindlessDescriptorHeap.h"
 #include "Graphics/RootSignature.h"
 #include "Graphics/PipelineState.h"
 #include "Graphics/Resource/Texture.h"
+#include "Graphics/Resource/GpuResourceAllocator.h"
 #include "Utilities/Singleton.h"
+#include "Utilities/FrameArena.h"
 #include "Graphics/ShaderCompiler.h"
 
 namespace DSM {
@@ -16,6 +19,7 @@ namespace DSM {
 }
 
 namespace DSM {
+    class CommandList;
     class GraphicsCommandList;
 }
 
@@ -32,11 +36,22 @@ namespace DSM {
             kMeshConstants,
             kMaterialConstants,
             kPassConstants,
-            kMaterialSRVs,
+            // 整个常驻描述符堆
+            kBindlessSRVs,
             kCommonSRVs,
 
             kNumRootBindings
         };
+
+        // 帧内使用临时资源的 Pass，用于确定资源的生命周期
+        enum TransientPass
+        {
+            kShadowPass,
+            kOpaquePass,
+            kPostPass,
+
+            kNumTransientPasses
+        };
         
     public:
         void Create();
@@ -45,11 +60,32 @@ namespace DSM {
         std::uint16_t GetPSO(std::uint16_t psoFlags);
         void OnResize(std::uint32_t width, std::uint32_t height);
         void ResizeShadowMap(std::uint32_t width, std::uint32_t height);
+        // 在 Pass 开始前为首次使用的临时资源插入别名屏障
+        void BeginTransientPass(CommandList& cmdList, TransientPass pass);
+        // 并行录制绘制命令使用的命令列表，跨帧复用
+        GraphicsCommandList& GetParallelCommandList(std::uint32_t index);
 
     private:
+        enum TransientResource
+        {
+            kSceneColor,
+            kSceneDepth,
+            kShadowMap,
+
+            kNumTransientResources
+        };
+        
         friend class Singleton<Renderer>;
         Renderer();
-        ~Renderer() { Shutdown(); }
+        ~Renderer();
+
+        // 颜色、深度及阴影贴图共享一个堆，尺寸改变时需要重新打包
+        void CreateTransientResources();
+        void DestroyTransientResources();
+        std::array<Texture*, kNumTransientResources> GetTransientTextures() noexcept
+        {
+            return { &m_SceneColorTexture, &m_SceneDepthTexture, &m_ShadowMap };
+        }
 
     public:
         // 是否使用PreZPass
@@ -70,9 +106,9 @@ namespace DSM {
         DescriptorHandle m_ShadowMapDSV{};
         DescriptorHandle m_ShadowMapDSVReadOnly{};
         
-        DescriptorHandle m_CommonTexture{};
+        // 通用纹理在常驻描述符堆中的起始索引
+        std::uint32_t m_CommonTextureIndex = BindlessDescriptorHeap::INVALID_INDEX;
         
-        DescriptorHeap m_TextureHeap;
         RootSignature m_RootSignature;
 
         std::unique_ptr<ShaderByteCode> m_LitVS;
@@ -84,11 +120,19 @@ namespace DSM {
         std::vector<GraphicsPSO> m_PSOs;
         
     private:
-        static constexpr std::uint32_t sm_MaxTextureSize = 4096;
         static constexpr std::uint32_t sm_MaxSamplerSize = 2048;
 
         GraphicsPSO m_DefaultPSO;
         GraphicsPSO m_SkyboxPSO;
+
+        std::vector<std::unique_ptr<GraphicsCommandList>> m_ParallelCmdLists{};
+
+        TransientResourceHeap m_TransientHeap{};
+        std::array<std::uint32_t, kNumTransientResources> m_TransientFirstUse{};
+        std::uint32_t m_Width = 1;
+        std::uint32_t m_Height = 1;
+        std::uint32_t m_ShadowMapWidth = 1;
+        std::uint32_t m_ShadowMapHeight = 1;
     };
 #define g_Renderer (Renderer::GetInstance())
 
@@ -101,7 +145,7 @@ namespace DSM {
         enum DrawPass{ kZPass, kOpaque, kTransparent, kNumDrawPasses };
 
     public:
-        MeshSorter(BatchType batchType) : m_BatchType(batchType) {}
+        MeshSorter(BatchType batchType);
         
         Math::Matrix4 GetViewMatrix() const noexcept { return m_Camera->GetViewMatrix(); }
         const DirectX::BoundingFrustum& GetViewFrustum() const noexcept { return m_Frustum; }
@@ -135,13 +179,25 @@ namespace DSM {
         }
 
         void AddMesh(const Mesh& mesh,
+            const Mesh::SubMesh& subMesh,
             float distance,
             D3D12_GPU_VIRTUAL_ADDRESS meshCBV,
             D3D12_GPU_VIRTUAL_ADDRESS matCBV);
         void Sort();
+        // 绘制数量较多时分段在工作线程中录制到各自的命令列表，并与 cmdList 一起按顺序提交
         void Render(DrawPass pass, GraphicsCommandList& cmdList, PassConstants& passConstants);
 
     private:
+        // 每个命令列表都需要重新设置的状态
+        void SetupPass(GraphicsCommandList& cmdList, D3D12_GPU_VIRTUAL_ADDRESS passCBV);
+        // 录制排序后 [begin, end) 范围内的绘制命令
+        void RenderDraws(GraphicsCommandList& cmdList, std::uint32_t begin, std::uint32_t end);
+
+    private:
+        // 单个命令列表至少录制的绘制数量，过少时并行的开销大于收益
+        inline static constexpr std::uint32_t sm_MinDrawsPerList = 256;
+        inline static constexpr std::uint32_t sm_MaxParallelLists = 8;
+
         // 用于排序的键值
         struct SortKey
         {
@@ -162,6 +218,7 @@ namespace DSM {
         struct SortObject
         {
             const Mesh* m_Mesh;
+            const Mesh::SubMesh* m_SubMesh;
             D3D12_GPU_VIRTUAL_ADDRESS m_MeshCBV;
             D3D12_GPU_VIRTUAL_ADDRESS m_MaterialCBV;
         };
@@ -173,8 +230,9 @@ namespace DSM {
             DescriptorHandle m_SRV;
         };
 
-        std::vector<SortObject> m_SortObjects{};
-        std::vector<std::uint64_t> m_SortKey{};
+        // 从帧内存中分配，只能在当前帧内使用
+        FrameVector<SortObject> m_SortObjects;
+        FrameVector<std::uint64_t> m_SortKey;
         BatchType m_BatchType{};
         std::array<std::uint32_t, kNumDrawPasses> m_PassCounts{};
 
@@ -189,6 +247,10 @@ namespace DSM {
         DescriptorHandle m_DSVReadOnly{};
         
         DirectX::BoundingFrustum m_Frustum{};
+
+        // 上一帧的物体及键值数量，用于预留空间
+        inline static std::array<std::size_t, kNumBatchTypes> sm_LastNumObjects{};
+        inline static std::array<std::size_t, kNumBatchTypes> sm_LastNumKeys{};
     };
 
 }
@@ -14,6 +14,13 @@ struct MaterialConstants
     float NormalTexScale;
     float MetallicFactor;
     float RoughnessFactor;
+    // 纹理在常驻描述符堆中的索引
+    uint BaseColorTexIndex;
+    uint DiffuseRoughnessTexIndex;
+    uint MetalnessTexIndex;
+    uint OcclusionTexIndex;
+    uint EmissiveTexIndex;
+    uint NormalTexIndex;
 };
 struct PassConstants
 {
@@ -6,7 +6,7 @@ ConstantBuffer<MeshConstants> _MeshConstants : register(b0);
 ConstantBuffer<MaterialConstants> _MaterialConstants : register(b1);
 ConstantBuffer<PassConstants> _PassConstants : register(b2);
 
-Texture2D<float4> _DiffuseTex : register(t0);
+Texture2D<float4> _BindlessTextures[] : register(t0, space1);
 
 struct Attributes
 {
@@ -32,7 +32,7 @@ Varyings DepthOnlyPassVS(Attributes i)
 
 void DepthOnlyPassPS(Varyings i)
 {
-	float4 col = _DiffuseTex.Sample(defaultSampler, i.uv);
+	float4 col = _BindlessTextures[_MaterialConstants.BaseColorTexIndex].Sample(defaultSampler, i.uv);
 	float alpha = col.a * _MaterialConstants.BaseColor.a;
 #ifdef ALPHA_TEST
 	clip(alpha - 0.1f);
@@ -41,6 +41,6 @@ void DepthOnlyPassPS(Varyings i)
 
 float4 DepthOnlyDebugPassPS(Attributes i)
 {
-	float depth = _DiffuseTex.Sample(defaultSampler, i.uv).r;
+	float depth = _BindlessTextures[_MaterialConstants.BaseColorTexIndex].Sample(defaultSampler, i.uv).r;
 	return float4(depth.rrr, 1);
 }
\ No newline at end of file
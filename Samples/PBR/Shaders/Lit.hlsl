@@ -5,13 +5,8 @@ ConstantBuffer<MeshConstants> _MeshConstants : register(b0);
 ConstantBuffer<MaterialConstants> _MaterialConstants : register(b1);
 ConstantBuffer<PassConstants> _PassConstants : register(b2);
 
-// PBR相关纹理
-Texture2D<float4> _BaseColorTex : register(t0);
-Texture2D<float4> _DiffuseRoughnessTex : register(t1);
-Texture2D<float> _MetalnessTex : register(t2);
-Texture2D<float> _OcclusionTex : register(t3);
-Texture2D<float3> _EmissiveTex : register(t4);
-Texture2D<float3> _NormalTex : register(t5);
+// 常驻描述符堆中的所有纹理，通过材质中的索引访问
+Texture2D<float4> _BindlessTextures[] : register(t0, space1);
 
 // 从第十个纹理开始
 Texture2D<float> _ShadowTex : register(t10);
@@ -64,12 +59,12 @@ Varyings LitPassVS(Attributes i)
 
 float4 LitPassPS(Varyings i) : SV_TARGET0
 {
-    float4 baseCol = _BaseColorTex.Sample(defaultSampler, i.uv);
-    float4 diffuseRoughness = _DiffuseRoughnessTex.Sample(defaultSampler, i.uv);
-    float metalness = _MetalnessTex.Sample(defaultSampler, i.uv);
-    float occlusion = _OcclusionTex.Sample(defaultSampler, i.uv);
-    float3 emissive = _EmissiveTex.Sample(defaultSampler, i.uv);
-    float3 normal = _NormalTex.Sample(defaultSampler, i.uv);
+    float4 baseCol = _BindlessTextures[_MaterialConstants.BaseColorTexIndex].Sample(defaultSampler, i.uv);
+    float4 diffuseRoughness = _BindlessTextures[_MaterialConstants.DiffuseRoughnessTexIndex].Sample(defaultSampler, i.uv);
+    float metalness = _BindlessTextures[_MaterialConstants.MetalnessTexIndex].Sample(defaultSampler, i.uv).r;
+    float occlusion = _BindlessTextures[_MaterialConstants.OcclusionTexIndex].Sample(defaultSampler, i.uv).r;
+    float3 emissive = _BindlessTextures[_MaterialConstants.EmissiveTexIndex].Sample(defaultSampler, i.uv).rgb;
+    float3 normal = _BindlessTextures[_MaterialConstants.NormalTexIndex].Sample(defaultSampler, i.uv).rgb;
 
     baseCol.rgb += emissive;
     baseCol.rgb *= occlusion;
@@ -6,6 +6,7 @@
 #include "Graphics/RootSignature.h"
 #include "Graphics/ShaderCompiler.h"
 #include "Graphics/CommandList/GraphicsCommandList.h"
+#include "Graphics/CommandList/UploadBatch.h"
 #include "Graphics/Resource/GpuBuffer.h"
 #include "Math/Matrix.h"
 #include "Math/Random.h"
@@ -13,6 +14,7 @@
 #include "Utilities/Utility.h"
 #include "Graphics/CommandSignature.h"
 #include <iostream>
+#include <string_view>
 #include "ModelLoader.h"
 #include "Renderer.h"
 #include "ConstantData.h"
@@ -22,6 +24,18 @@
 using namespace DSM;
 using namespace DirectX;
 
+// 渲染线程使用的场景快照
+struct SceneSnapshot : public RenderSnapshot
+{
+    Camera m_Camera{};
+    D3D12_RECT m_Scissor{};
+    PassConstants m_PassConstants{};
+
+    // 模型资源在渲染期间保持不变，只记录指针
+    const Model* m_Model{};
+    Transform m_ModelTrans{};
+};
+
 
 class Sandbox : public GameCore::IGameApp
 {
@@ -81,38 +95,24 @@ public:
 
         D3D12_GPU_VIRTUAL_ADDRESS bufferLocation = m_BoxMesh.m_MeshData.GetGpuVirtualAddress();
         std::uint32_t offset = 0;
-        CommandList::InitBuffer(m_BoxMesh.m_MeshData, boxPos.data(), posByteSize, offset);
+        UploadBatch uploadBatch{L"BoxMeshData"};
+        uploadBatch.UploadBuffer(m_BoxMesh.m_MeshData, boxPos.data(), posByteSize, offset);
         m_BoxMesh.m_PositionStream = { bufferLocation + offset, (UINT)posByteSize, sizeof(XMFLOAT3) };
         offset += posByteSize;
 
-        CommandList::InitBuffer(m_BoxMesh.m_MeshData, boxNormal.data(), normalByteSize, offset);
+        uploadBatch.UploadBuffer(m_BoxMesh.m_MeshData, boxNormal.data(), normalByteSize, offset);
         m_BoxMesh.m_NormalStream = { bufferLocation + offset, (UINT)normalByteSize, sizeof(XMFLOAT3) };
         offset += normalByteSize;
 
-        CommandList::InitBuffer(m_BoxMesh.m_MeshData, boxUV.data(), uvByteSize, offset);
+        uploadBatch.UploadBuffer(m_BoxMesh.m_MeshData, boxUV.data(), uvByteSize, offset);
         m_BoxMesh.m_UVStream = { bufferLocation + offset, (UINT)uvByteSize, sizeof(XMFLOAT2)};
         offset += uvByteSize;
 
-        CommandList::InitBuffer(m_BoxMesh.m_MeshData, boxGeometry.m_Indices32.data(), indexByteSize, offset);
+        uploadBatch.UploadBuffer(m_BoxMesh.m_MeshData, boxGeometry.m_Indices32.data(), indexByteSize, offset);
         m_BoxMesh.m_IndexBufferViews = D3D12_INDEX_BUFFER_VIEW{ bufferLocation + offset, (UINT)indexByteSize, DXGI_FORMAT_R32_UINT };
         offset += indexByteSize;
+        uploadBatch.Submit().StallQueue(g_RenderContext.GetCommandQueue(D3D12_COMMAND_LIST_TYPE_DIRECT));
 
-        D3D12_CPU_DESCRIPTOR_HANDLE defaultTexture[kNumTextures] = {
-            Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-            Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-            Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-            Graphics::GetDefaultTexture(Graphics::kWhiteOpaque2D),
-            Graphics::GetDefaultTexture(Graphics::kBlackTransparent2D),
-            Graphics::GetDefaultTexture(Graphics::kDefaultNormalTex)
-        };
-
-        DescriptorHandle texHandle = g_Renderer.m_TextureHeap.Allocate(kNumTextures);
-        std::uint32_t destCount = kNumTextures;
-        std::uint32_t srcCount[kNumTextures] = { 1,1,1,1,1,1 };
-        g_RenderContext.GetDevice()->CopyDescriptors(
-            1, &texHandle, &destCount, destCount, defaultTexture, srcCount, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-        
         m_BoxMesh.m_Name = "Box";
         m_BoxMesh.m_PSOFlags = kHasPosition | kHasNormal | kHasUV;
         m_BoxMesh.m_PSOIndex = g_Renderer.GetPSO(m_BoxMesh.m_PSOFlags);
@@ -120,11 +120,18 @@ public:
             .m_IndexCount = (UINT)boxGeometry.m_Indices32.size(),
             .m_IndexOffset = 0,
             .m_VertexOffset = 0,
-            .m_MaterialIndex = 0,
-            .m_SRVTableOffset = (uint16_t)g_Renderer.m_TextureHeap.GetOffsetOfHandle(texHandle) });
+            .m_MaterialIndex = 0 });
 
 
         MaterialConstants materialConstant{};
+        materialConstant.m_TextureIndices = {
+            Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+            Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+            Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+            Graphics::GetDefaultTextureIndex(Graphics::kWhiteOpaque2D),
+            Graphics::GetDefaultTextureIndex(Graphics::kBlackTransparent2D),
+            Graphics::GetDefaultTextureIndex(Graphics::kDefaultNormalTex)
+        };
         GpuBufferDesc bufferDesc = {};
         bufferDesc.m_Size = sizeof(MaterialConstants);
         bufferDesc.m_Stride = sizeof(MaterialConstants);
@@ -145,14 +152,8 @@ public:
         m_Camera->LookAt({ 0,0,0 }, { 0,1,0 });
 
         m_SceneTrans.SetScale({ 0.05f, 0.05f, 0.05f });
-        MeshConstants meshConstants{};
-		meshConstants.m_World = Math::Matrix4::Transpose(m_SceneTrans.GetLocalToWorld());
-        meshConstants.m_WorldIT = Math::Matrix4::InverseTranspose(m_SceneTrans.GetLocalToWorld());
-		GpuBufferDesc meshConstantsDesc{};
-        meshConstantsDesc.m_Size = sizeof(MeshConstants);
-		meshConstantsDesc.m_Stride = sizeof(MeshConstants);
-		meshConstantsDesc.m_HeapType = D3D12_HEAP_TYPE_UPLOAD;
-		m_MeshConstants.Create(L"MeshConstants", meshConstantsDesc, &meshConstants);
+        // 每帧更新，GPU 读取上一帧的数据时不会被覆盖
+        m_MeshConstants.Create(L"MeshConstants", sizeof(MeshConstants), sizeof(MeshConstants));
 
         m_Model = LoadModel("Models//Sponza//sponza.gltf");
     }
@@ -173,28 +174,61 @@ public:
 	}
     virtual void RenderScene(RenderContext& renderContext) override
     {
+        // 不使用渲染线程时直接在当前线程写入并渲染快照
+        WriteRenderSnapshot(m_Snapshot);
+        RenderFrame(renderContext, m_Snapshot);
+    }
+
+    virtual bool UseRenderThread() const override { return true; }
+    virtual std::unique_ptr<RenderSnapshot> CreateRenderSnapshot() override
+    {
+        return std::make_unique<SceneSnapshot>();
+    }
+    virtual void WriteRenderSnapshot(RenderSnapshot& snapshot) override
+    {
+        auto& sceneSnapshot = static_cast<SceneSnapshot&>(snapshot);
+        sceneSnapshot.m_Camera = *m_Camera;
+        sceneSnapshot.m_Scissor = m_Scissor;
+        sceneSnapshot.m_PassConstants = m_PassConstants;
+        sceneSnapshot.m_Model = m_Model.get();
+        sceneSnapshot.m_ModelTrans = m_SceneTrans;
+    }
+    virtual void RenderFrame(RenderContext& renderContext, const RenderSnapshot& snapshot) override
+    {
+        const auto& sceneSnapshot = static_cast<const SceneSnapshot&>(snapshot);
         auto& swapChain = renderContext.GetSwapChain();
 
+        // 按帧的常量缓冲区属于渲染帧，在渲染线程中写入
+        MeshConstants meshConstants{};
+        meshConstants.m_World = Math::Matrix4::Transpose(sceneSnapshot.m_ModelTrans.GetLocalToWorld());
+        meshConstants.m_WorldIT = Math::Matrix4::InverseTranspose(sceneSnapshot.m_ModelTrans.GetLocalToWorld());
+        m_MeshConstants.Update(meshConstants);
+
         g_Renderer.m_SeparateZPass = false;
 
         GraphicsCommandList cmdList{ L"Render Scene" };
 
         MeshSorter sorter{ MeshSorter::kDefault };
-        sorter.SetCamera(*m_Camera);
-        sorter.SetScissor(m_Scissor);
+        sorter.SetCamera(sceneSnapshot.m_Camera);
+        sorter.SetScissor(sceneSnapshot.m_Scissor);
         sorter.SetDepthStencilTarget(g_Renderer.m_SceneDepthTexture, 
             g_Renderer.m_SceneDepthDSV, g_Renderer.m_SceneDepthDSVReadOnly);
 
         sorter.AddRenderTarget(g_Renderer.m_SceneColorTexture,
             g_Renderer.m_SceneColorRTV, g_Renderer.m_SceneColorSRV);
 
-        m_Model->Render(sorter, m_MeshConstants, m_SceneTrans);
-        /*sorter.AddMesh(m_BoxMesh, 2, 
+        sceneSnapshot.m_Model->Render(sorter, m_MeshConstants, sceneSnapshot.m_ModelTrans);
+        /*sorter.AddMesh(m_BoxMesh, m_BoxMesh.m_SubMeshes.begin()->second, 2, 
             m_MeshConstants.GetGpuVirtualAddress(), 
             m_BoxMaterial.GetGpuVirtualAddress());*/
 
-        sorter.Render(MeshSorter::kOpaque, cmdList, m_PassConstants);
+        // 临时资源共享内存，各 Pass 开始前需要切换到本 Pass 使用的资源
+        g_Renderer.BeginTransientPass(cmdList, Renderer::kShadowPass);
+        g_Renderer.BeginTransientPass(cmdList, Renderer::kOpaquePass);
+        auto passConstants = sceneSnapshot.m_PassConstants;
+        sorter.Render(MeshSorter::kOpaque, cmdList, passConstants);
 
+        g_Renderer.BeginTransientPass(cmdList, Renderer::kPostPass);
         cmdList.CopyResource(*swapChain.GetBackBuffer(), g_Renderer.m_SceneColorTexture);
 
         cmdList.TransitionResource(*swapChain.GetBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
@@ -214,7 +248,10 @@ private:
     D3D12_RECT m_Scissor{};
 
     Transform m_SceneTrans{};
-    GpuBuffer m_MeshConstants{};
+    // 只在渲染线程中访问
+    PerFrameBuffer m_MeshConstants{};
+    // 不使用渲染线程时的快照
+    SceneSnapshot m_Snapshot{};
 
     PassConstants m_PassConstants{};
 
@@ -231,5 +268,13 @@ int WinMain(
     _In_ int nShowCmd)
 {
     Sandbox sandbox{};
+    // 用法: PBR [--headless <frames>]，无窗口时在空设备上渲染指定帧数
+    std::string_view cmdLine{lpCmdLine != nullptr ? lpCmdLine : ""};
+    constexpr std::string_view headlessOption{"--headless"};
+    if (auto pos = cmdLine.find(headlessOption); pos != std::string_view::npos) {
+        auto frameCount = std::strtoul(cmdLine.data() + pos + headlessOption.size(), nullptr, 10);
+        return GameCore::RunHeadlessApplication(sandbox, 1024, 768,
+            frameCount > 0 ? static_cast<std::uint32_t>(frameCount) : 100u, DeviceBackend::Null);
+    }
     return GameCore::RunApplication(sandbox, 1024, 768, L"DSMEngine", hInstance, nShowCmd);
 }
\ No newline at end of file